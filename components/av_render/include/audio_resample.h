@@ -47,6 +47,8 @@ typedef struct {
     av_render_audio_frame_info_t output_info;  /*!< Output frame information */
     audio_resample_frame_cb      resample_cb;  /*!< Resample output callback */
     void                        *ctx;          /*!< User context */
+    bool                         use_fused;    /*!< Use built-in single pass converter for supported formats
+                                                    instead of chained `esp_audio_effects` operations */
 } audio_resample_cfg_t;
 
 /**
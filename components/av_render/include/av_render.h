@@ -24,6 +24,7 @@
 #pragma once
 
 #include "av_render_types.h"
+#include "mem_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,33 @@ typedef struct {
     bool                  pause_on_first_frame;   /*!< Whether automatically pause when render receive first frame */
     void                 *ctx;                    /*!< User context */
     bool                  video_cvt_in_render;    /*!< Convert color in render*/
+    uint8_t               video_cvt_workers;      /*!< Extra threads (named "ClrCvt") to convert color in horizontal stripes
+                                                       Set core through thread scheduler to run on other core, 0 to disable */
+    uint16_t              video_out_width;        /*!< Output width (typically LCD resolution), set with `video_out_height` to
+                                                       scale decoded video during color convert, 0 to render in video resolution
+                                                       Scaled convert costs more per output pixel, nearest is only faster than
+                                                       convert without scaling for about 4 times fewer pixels or more */
+    uint16_t              video_out_height;       /*!< Output height */
+    av_render_video_scale_mode_t video_scale_mode; /*!< Scale mode when output resolution set */
+    av_render_video_color_std_t  video_color_std;  /*!< Color space standard to convert YUV to RGB */
+    bool                  video_cvt_reference;    /*!< Convert color per pixel in full precision instead of table kernel,
+                                                       slower but output is exact to the standard, hardware convert is not used */
+    mem_arena_handle_t    mem_arena;              /*!< Memory arena to allocate FIFOs and video convert output from (optional)
+                                                       Buffers go back to arena on `av_render_reset` and are reused by next stream,
+                                                       arena must stay valid until `av_render_close`
+                                                       Use together with `reuse_session` of `esp_webrtc` only: arena alone keeps
+                                                       its regions reserved while peer buffers are still freed and allocated again
+                                                       around them, largest free block then ends lower than without arena */
+    uint8_t               video_fb_num;           /*!< Decode into pool of frame buffers (2-8) handed to render thread instead of
+                                                       render fifo, so that decode does not wait for display of earlier frames
+                                                       0 to decode into `video_render_fifo_size` fifo directly
+                                                       Render thread is still needed, fifo then only holds frame references (1kB is enough) */
+    bool                  video_fb_latest;        /*!< Latest-wins for frame buffer pool (suit for live call): when display is behind,
+                                                       newest frame replaces oldest one not shown yet, decoder never waits
+                                                       if `video_fb_num` >= 3 */
+    bool                  audio_fused_resample;   /*!< Resample 16 bits audio in one pass (windowed sinc, upsampling only)
+                                                       instead of `esp_audio_effects`, cheaper but not the same filter,
+                                                       other formats still use `esp_audio_effects` */
 } av_render_cfg_t;
 
 /**
@@ -84,8 +112,34 @@ typedef struct {
     int      data_size;        /*!< Data size */
     int      render_q_num;     /*!< Render queue number */
     int      render_data_size; /*!< Render queue data number */
+    uint32_t frame_num;        /*!< Total frames queued into decoder fifo (video only) */
+    uint32_t copied_size;      /*!< Total bytes copied when queue frames into decoder fifo (video only) */
 } av_render_fifo_stat_t;
 
+/**
+ * @brief  AV render stage time
+ */
+typedef struct {
+    uint32_t count; /*!< Processed frame count */
+    uint32_t avg;   /*!< Average cost time (unit us) */
+    uint32_t max;   /*!< Maximum cost time (unit us) */
+} av_render_stage_time_t;
+
+/**
+ * @brief  AV render video stage statistics
+ *
+ * @note  Decode and convert in decoder run serially, convert in render (`video_cvt_in_render`) overlaps with decode
+ *        Frame rate upper limit can be estimated by 1000000 / (decode.avg + convert.avg)
+ */
+typedef struct {
+    av_render_stage_time_t decode;         /*!< Video decode stage */
+    av_render_stage_time_t convert;        /*!< Color convert stage in decoder thread */
+    av_render_stage_time_t render_convert; /*!< Color convert stage in render thread */
+    av_render_stage_time_t fb_wait;        /*!< Decoder waiting for free frame buffer (`video_fb_num` set only)
+                                                `count` is number of stalls */
+    uint32_t               fb_dropped;     /*!< Decoded frames replaced by newer ones before shown (`video_fb_latest` only) */
+} av_render_video_stage_stat_t;
+
 /**
  * @brief  AV render fifo configuration
  */
@@ -243,6 +297,59 @@ int av_render_add_audio_data(av_render_handle_t render, av_render_audio_data_t *
  */
 int av_render_set_audio_threshold(av_render_handle_t render, uint32_t audio_threshold);
 
+/**
+ * @brief  Adaptive audio playout configuration
+ *
+ * @note  Playout controller tracks audio render fifo depth and inter-arrival jitter of `av_render_add_audio_data`
+ *        Target delay follows network jitter, render speed is steered within [min_speed, max_speed] through
+ *        `audio_render_set_speed` so that fifo depth converges to target without audible gap or drop
+ *        It replaces `av_render_set_audio_threshold` prebuffer, `audio_render_fifo_size` must hold more than `max_delay` of audio
+ */
+typedef struct {
+    uint16_t min_delay; /*!< Lowest target delay of audio render fifo (unit ms), default 40 if set to 0 */
+    uint16_t max_delay; /*!< Fifo depth beyond it is dropped (unit ms), target delay stays within half of it, default 300 if set to 0 */
+    float    min_speed; /*!< Slowest speed used to grow fifo, default 0.9 if set to 0 */
+    float    max_speed; /*!< Fastest speed used to drain fifo, default 1.1 if set to 0, limited to 1.25 */
+} av_render_playout_cfg_t;
+
+/**
+ * @brief  Adaptive audio playout statistics
+ */
+typedef struct {
+    uint32_t target_delay; /*!< Current target delay (unit ms) */
+    uint32_t delay;        /*!< Latest audio render fifo depth (unit ms) */
+    uint32_t jitter;       /*!< Smoothed inter-arrival jitter (unit ms) */
+    float    speed;        /*!< Current render speed */
+    uint32_t underrun;     /*!< Times fifo ran dry and rebuffered */
+    uint32_t dropped;      /*!< Frames dropped for exceeding `max_delay` */
+} av_render_playout_stats_t;
+
+/**
+ * @brief  Enable or disable adaptive audio playout
+ *
+ * @note  When enabled, render speed is owned by playout controller, do not call `av_render_set_speed` at same time
+ *
+ * @param[in]  render  AV render handle
+ * @param[in]  cfg     Playout configuration, set to NULL to disable
+ *
+ * @return
+ *       - 0       On success
+ *       - Others  Fail to set
+ */
+int av_render_set_playout_cfg(av_render_handle_t render, av_render_playout_cfg_t *cfg);
+
+/**
+ * @brief  Get adaptive audio playout statistics
+ *
+ * @param[in]   render  AV render handle
+ * @param[out]  stats   Playout statistics
+ *
+ * @return
+ *       - 0       On success
+ *       - Others  Playout not enabled or invalid argument
+ */
+int av_render_get_playout_stats(av_render_handle_t render, av_render_playout_stats_t *stats);
+
 /**
  * @brief  Add video data for AV render
  *
@@ -255,6 +362,53 @@ int av_render_set_audio_threshold(av_render_handle_t render, uint32_t audio_thre
  */
 int av_render_add_video_data(av_render_handle_t render, av_render_video_data_t *video_data);
 
+/**
+ * @brief  Get buffer from video decoder fifo to fill compressed video data directly
+ *
+ * @note  It avoids copy of `av_render_add_video_data` when caller assembles frame by itself
+ *        Buffer must be committed or cancelled by `av_render_commit_video_buffer`, which can be called from any thread
+ *        Space is reserved without holding fifo lock, so other writers of decoder fifo are not blocked
+ *        Decoder keeps order and waits for the reserved frame, so flush and close also wait until it is committed
+ *        So caller should reserve only when data is expected soon and cancel it if data is late
+ *        It is only supported when video decoder runs in its own thread and data pool is not used
+ *
+ * @param[in]   render  AV render handle
+ * @param[in]   size    Maximum video data size to fill
+ * @param[out]  buffer  Buffer to fill video data
+ *
+ * @return
+ *       - 0                          On success
+ *       - ESP_MEDIA_ERR_NOT_SUPPORT  Not supported for current setting, use `av_render_add_video_data` instead
+ *       - Others                     Fail to get buffer
+ */
+int av_render_get_video_buffer(av_render_handle_t render, uint32_t size, uint8_t **buffer);
+
+/**
+ * @brief  Commit video data filled into buffer got from `av_render_get_video_buffer`
+ *
+ * @param[in]  render      AV render handle
+ * @param[in]  video_data  Video data, `data` is ignored, `size` must not exceed size when get buffer
+ *                         Set to NULL or set `size` to 0 to cancel the buffer
+ *
+ * @return
+ *       - 0       On success
+ *       - Others  Fail to commit video data
+ */
+int av_render_commit_video_buffer(av_render_handle_t render, av_render_video_data_t *video_data);
+
+/**
+ * @brief  Get video stage time statistics
+ *
+ * @param[in]   render  AV render handle
+ * @param[out]  stat    Video stage statistics
+ * @param[in]   reset   Whether reset statistics after get
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ */
+int av_render_get_video_stage_stat(av_render_handle_t render, av_render_video_stage_stat_t *stat, bool reset);
+
 /**
  * @brief  Check audio fifo enough
  *
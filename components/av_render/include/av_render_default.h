@@ -51,12 +51,23 @@ typedef struct {
 
 /**
  * @brief  LCD render configuration
+ *
+ * @note  When `use_frame_buffer` is set, panel is better configured with 3 frame buffers
+ *        Decoder then writes into a free buffer while one is scanned out and another one is queued
+ *        With 2 frame buffers decoder waits for panel refresh to avoid tearing
  */
 typedef struct {
-    esp_lcd_panel_handle_t lcd_handle;        /*!< LCD display handle */
-    bool                   rgb_panel;         /*!< Whether RGB panel */
-    bool                   dsi_panel;         /*!< Whether DSI panel */
-    bool                   use_frame_buffer;  /*!< Use display frame buffer */
+    esp_lcd_panel_handle_t    lcd_handle;             /*!< LCD display handle */
+    esp_lcd_panel_io_handle_t io_handle;              /*!< Panel IO handle of SPI panel (optional)
+                                                           Enables pipelined draw through DMA capable bounce buffers
+                                                           Render registers color transfer done callback on it */
+    bool                      rgb_panel;              /*!< Whether RGB panel */
+    bool                      dsi_panel;              /*!< Whether DSI panel */
+    bool                      use_frame_buffer;       /*!< Use display frame buffer */
+    bool                      skip_unchanged;         /*!< Only send stripes changed since last frame, needs `io_handle`
+                                                           Helps mostly static content decoded from inter-coded stream */
+    uint16_t                  full_refresh_interval;  /*!< Resend whole frame every N frames when `skip_unchanged` is set
+                                                           default: 30 if set to 0 */
 } lcd_render_cfg_t;
 
 /**
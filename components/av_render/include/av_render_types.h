@@ -54,6 +54,24 @@ typedef enum {
     AV_RENDER_VIDEO_CODEC_RGB565, /*!< RGB565 video type */
 } av_render_video_codec_t;
 
+/**
+ * @brief  Video scale mode
+ */
+typedef enum {
+    AV_RENDER_VIDEO_SCALE_NEAREST,  /*!< Nearest neighbor, fastest */
+    AV_RENDER_VIDEO_SCALE_BILINEAR, /*!< Bilinear interpolation, suitable for upscale and mild downscale */
+    AV_RENDER_VIDEO_SCALE_BOX,      /*!< Box filter average, best quality for large downscale */
+} av_render_video_scale_mode_t;
+
+/**
+ * @brief  Video color space standard used to convert YUV to RGB
+ */
+typedef enum {
+    AV_RENDER_VIDEO_COLOR_STD_DEFAULT, /*!< Platform default, BT.709 when hardware accelerated (ESP32-P4), else BT.601 */
+    AV_RENDER_VIDEO_COLOR_STD_BT601,   /*!< ITU-R BT.601 limited range */
+    AV_RENDER_VIDEO_COLOR_STD_BT709,   /*!< ITU-R BT.709 limited range */
+} av_render_video_color_std_t;
+
 /**
  * @brief  Audio codec type
  */
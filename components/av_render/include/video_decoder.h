@@ -42,6 +42,10 @@ typedef struct {
     av_render_video_frame_type_t out_type;   /*!< Output frame type */
     vdec_frame_cb                frame_cb;   /*!< Video decoded frame callback */
     void                        *ctx;        /*!< Decoder context */
+    uint8_t                      cvt_workers; /*!< Extra threads to do color convert in stripes, 0 to convert in decoder thread only */
+    uint16_t                     out_width;   /*!< Output width, set with `out_height` to scale decoded frame, 0 to disable */
+    uint16_t                     out_height;  /*!< Output height */
+    av_render_video_scale_mode_t scale_mode;  /*!< Scale mode */
 } vdec_cfg_t;
 
 /**
@@ -53,6 +57,23 @@ typedef struct {
     void *ctx;                                             /*!< Context */
 } vdec_fb_cb_cfg_t;
 
+/**
+ * @brief  Video decoder stage time statistics
+ */
+typedef struct {
+    uint32_t count; /*!< Processed frame count */
+    uint64_t total; /*!< Total cost time (unit us) */
+    uint32_t max;   /*!< Maximum cost time (unit us) */
+} vdec_stage_time_t;
+
+/**
+ * @brief  Video decoder statistics
+ */
+typedef struct {
+    vdec_stage_time_t decode;  /*!< Decode stage */
+    vdec_stage_time_t convert; /*!< Color convert stage */
+} vdec_stat_t;
+
 /**
  * @brief  Video decoder handle
  */
@@ -132,6 +153,19 @@ int vdec_set_frame_buffer(vdec_handle_t h, av_render_frame_buffer_t *buffer);
  */
 int vdec_get_frame_info(vdec_handle_t h, av_render_video_frame_info_t *frame_info);
 
+/**
+ * @brief  Get stage time statistics of video decoder
+ *
+ * @param[in]   h      Video decoder handle
+ * @param[out]  stat   Statistics to be filled
+ * @param[in]   reset  Whether reset statistics after get
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ */
+int vdec_get_stat(vdec_handle_t h, vdec_stat_t *stat, bool reset);
+
 /**
  * @brief  Close video decoder
  *
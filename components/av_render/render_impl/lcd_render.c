@@ -28,6 +28,7 @@
 #include "media_lib_os.h"
 #include "esp_log.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_io.h"
 #if SOC_LCD_RGB_SUPPORTED
 #include "esp_lcd_panel_rgb.h"
 #endif
@@ -35,31 +36,335 @@
 #include "esp_lcd_mipi_dsi.h"
 #endif
 #include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #define TAG "LCD_RENDER"
 
+#define LCD_MAX_FRAME_BUFFER     (3)
+#define LCD_SPI_BOUNCE_NUM       (2)
+#define LCD_SPI_BOUNCE_LINES     (40)
+#define LCD_SPI_BOUNCE_MAX_SIZE  (32 * 1024)
+#define LCD_DEFAULT_FULL_REFRESH (30)
+#define LCD_DRAW_TIMEOUT_MS      (200)
+#define LCD_REFRESH_TIMEOUT_MS   (50)
+
 typedef struct {
     av_render_video_frame_info_t info;
     esp_lcd_panel_handle_t       handle;
+    esp_lcd_panel_io_handle_t    io_handle;
     bool                         rgb_panel;
     bool                         dsi_panel;
-    uint8_t                     *frame_buffer[2];
-    bool                         sel;
+    uint8_t                     *frame_buffer[LCD_MAX_FRAME_BUFFER];
+    uint8_t                      fb_num;
+    volatile int8_t              fb_displaying;
+    volatile int8_t              fb_pending;
     uint32_t                     start_time;
     uint8_t                      frame_num;
-    bool                         drawing;
+    SemaphoreHandle_t            trans_done;
+    SemaphoreHandle_t            refresh_done;
+    uint8_t                      trans_slots;
+    uint8_t                     *bounce[LCD_SPI_BOUNCE_NUM];
+    uint8_t                      bounce_sel;
+    int                          bounce_lines;
+    bool                         skip_unchanged;
+    uint16_t                     full_refresh_interval;
+    uint16_t                     partial_frames;
+    uint32_t                    *stripe_hash;
+    int                          stripe_num;
+    bool                         hash_valid;
 } lcd_render_t;
 
 static int lcd_render_close(video_render_handle_t h);
 
+static bool give_from_cb(SemaphoreHandle_t sem)
+{
+    // Panel driver may call back directly inside draw when nothing left to transfer
+    if (xPortInIsrContext() == false) {
+        xSemaphoreGive(sem);
+        return false;
+    }
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(sem, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+static bool spi_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *data, void *ctx)
+{
+    lcd_render_t *lcd = (lcd_render_t *)ctx;
+    return give_from_cb(lcd->trans_done);
+}
+
 #if CONFIG_IDF_TARGET_ESP32P4
 static bool draw_finished(esp_lcd_panel_handle_t panel, esp_lcd_dpi_panel_event_data_t *data, void *ctx)
 {
     lcd_render_t *lcd = (lcd_render_t *)ctx;
-    lcd->drawing      = false;
-    return true;
+    return give_from_cb(lcd->trans_done);
+}
+
+static bool refresh_finished(esp_lcd_panel_handle_t panel, esp_lcd_dpi_panel_event_data_t *data, void *ctx)
+{
+    lcd_render_t *lcd = (lcd_render_t *)ctx;
+    // Panel scans out the queued frame buffer from now on, the old one is free to write
+    if (lcd->fb_pending < 0) {
+        return false;
+    }
+    lcd->fb_displaying = lcd->fb_pending;
+    lcd->fb_pending = -1;
+    return give_from_cb(lcd->refresh_done);
+}
+#endif
+
+static bool use_spi_bounce(lcd_render_t *lcd)
+{
+    return lcd->io_handle && lcd->rgb_panel == false && lcd->dsi_panel == false && lcd->fb_num == 0;
 }
+
+static int get_panel_frame_buffer(lcd_render_t *lcd)
+{
+    // Prefer triple buffer so that decoder never waits for the panel to leave the buffer it writes
+    for (int num = LCD_MAX_FRAME_BUFFER; num >= 2; num--) {
+        esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+        if (lcd->rgb_panel) {
+#if SOC_LCD_RGB_SUPPORTED
+            ret = esp_lcd_rgb_panel_get_frame_buffer(lcd->handle, num, (void **)&lcd->frame_buffer[0],
+                                                     (void **)&lcd->frame_buffer[1], (void **)&lcd->frame_buffer[2]);
+#endif
+        }
+        if (lcd->dsi_panel) {
+#if CONFIG_IDF_TARGET_ESP32P4
+            ret = esp_lcd_dpi_panel_get_frame_buffer(lcd->handle, num, (void **)&lcd->frame_buffer[0],
+                                                     (void **)&lcd->frame_buffer[1], (void **)&lcd->frame_buffer[2]);
 #endif
+        }
+        if (ret == ESP_OK && lcd->frame_buffer[0]) {
+            lcd->fb_num = num;
+            return 0;
+        }
+        memset(lcd->frame_buffer, 0, sizeof(lcd->frame_buffer));
+    }
+    return -1;
+}
+
+static int wait_trans_done(lcd_render_t *lcd)
+{
+    // No completion callback, draw returns once panel consumed data
+    if (lcd->trans_done == NULL) {
+        return 0;
+    }
+    if (xSemaphoreTake(lcd->trans_done, pdMS_TO_TICKS(LCD_DRAW_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Timeout to wait for draw finished");
+        return ESP_MEDIA_ERR_FAIL;
+    }
+    return 0;
+}
+
+/* Give back slot taken by `wait_trans_done` when nothing got queued, no semaphore when panel has no callback */
+static void release_trans(lcd_render_t *lcd)
+{
+    if (lcd->trans_done) {
+        xSemaphoreGive(lcd->trans_done);
+    }
+}
+
+static void wait_all_trans_done(lcd_render_t *lcd)
+{
+    if (lcd->trans_done == NULL) {
+        return;
+    }
+    int n = 0;
+    while (n < lcd->trans_slots && wait_trans_done(lcd) == 0) {
+        n++;
+    }
+    while (n--) {
+        release_trans(lcd);
+    }
+}
+
+static int lcd_draw(lcd_render_t *lcd, int x_end, int y_start, int y_end, const void *data)
+{
+    int ret = wait_trans_done(lcd);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = esp_lcd_panel_draw_bitmap(lcd->handle, 0, y_start, x_end, y_end, data);
+    if (ret != ESP_OK) {
+        release_trans(lcd);
+    }
+    return ret;
+}
+
+static void free_bounce(lcd_render_t *lcd)
+{
+    wait_all_trans_done(lcd);
+    for (int i = 0; i < LCD_SPI_BOUNCE_NUM; i++) {
+        if (lcd->bounce[i]) {
+            heap_caps_free(lcd->bounce[i]);
+            lcd->bounce[i] = NULL;
+        }
+    }
+    lcd->bounce_lines = 0;
+    if (lcd->stripe_hash) {
+        media_lib_free(lcd->stripe_hash);
+        lcd->stripe_hash = NULL;
+    }
+    lcd->stripe_num = 0;
+}
+
+static int alloc_stripe_hash(lcd_render_t *lcd)
+{
+    lcd->hash_valid = false;
+    int stripe_num = (lcd->info.height + lcd->bounce_lines - 1) / lcd->bounce_lines;
+    if (stripe_num == lcd->stripe_num) {
+        return 0;
+    }
+    if (lcd->stripe_hash) {
+        media_lib_free(lcd->stripe_hash);
+    }
+    lcd->stripe_hash = (uint32_t *)media_lib_calloc(stripe_num, sizeof(uint32_t));
+    if (lcd->stripe_hash == NULL) {
+        lcd->stripe_num = 0;
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    lcd->stripe_num = stripe_num;
+    return 0;
+}
+
+static int alloc_bounce(lcd_render_t *lcd)
+{
+    int line_size = lcd->info.width * 2;
+    int lines = LCD_SPI_BOUNCE_LINES;
+    if (lines * line_size > LCD_SPI_BOUNCE_MAX_SIZE) {
+        lines = LCD_SPI_BOUNCE_MAX_SIZE / line_size;
+    }
+    if (lines == 0) {
+        lines = 1;
+    }
+    if (lines > lcd->info.height) {
+        lines = lcd->info.height;
+    }
+    if (lines == lcd->bounce_lines) {
+        return lcd->skip_unchanged ? alloc_stripe_hash(lcd) : 0;
+    }
+    free_bounce(lcd);
+    for (int i = 0; i < LCD_SPI_BOUNCE_NUM; i++) {
+        lcd->bounce[i] = heap_caps_malloc(lines * line_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (lcd->bounce[i] == NULL) {
+            ESP_LOGE(TAG, "No memory for %d bytes bounce buffer", lines * line_size);
+            free_bounce(lcd);
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+    }
+    lcd->bounce_lines = lines;
+    return lcd->skip_unchanged ? alloc_stripe_hash(lcd) : 0;
+}
+
+static void copy_swap_rgb565(uint16_t *dst, const uint8_t *src, int pixels)
+{
+    for (int i = 0; i < pixels; i++) {
+        dst[i] = (uint16_t)(src[0] << 8 | src[1]);
+        src += 2;
+    }
+}
+
+static uint32_t copy_rgb565_hash(uint16_t *dst, const uint8_t *src, int pixels, bool swap)
+{
+    // FNV-1a over output pixels, collision only delays update until next full refresh
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < pixels; i++) {
+        uint16_t pixel = swap ? (uint16_t)(src[0] << 8 | src[1]) : (uint16_t)(src[1] << 8 | src[0]);
+        dst[i] = pixel;
+        hash = (hash ^ pixel) * 16777619u;
+        src += 2;
+    }
+    return hash;
+}
+
+static bool need_full_refresh(lcd_render_t *lcd)
+{
+    if (lcd->hash_valid == false || ++lcd->partial_frames >= lcd->full_refresh_interval) {
+        lcd->partial_frames = 0;
+        return true;
+    }
+    return false;
+}
+
+static int spi_draw_frame(lcd_render_t *lcd, const uint8_t *rgb_data)
+{
+    // Fill one bounce buffer (byte swap when needed) while panel IO sends the other one
+    int w = lcd->info.width;
+    int h = lcd->info.height;
+    bool swap = (lcd->info.type == AV_RENDER_VIDEO_RAW_TYPE_RGB565);
+    bool check_dirty = (rgb_data && lcd->stripe_hash);
+    bool full = check_dirty ? need_full_refresh(lcd) : true;
+    int stripe = 0;
+    int ret = 0;
+    for (int i = 0; i < h; stripe++) {
+        int n = (h - i < lcd->bounce_lines) ? h - i : lcd->bounce_lines;
+        int size = n * w * 2;
+        ret = wait_trans_done(lcd);
+        if (ret != 0) {
+            break;
+        }
+        uint8_t *bounce = lcd->bounce[lcd->bounce_sel];
+        bool unchanged = false;
+        if (rgb_data == NULL) {
+            memset(bounce, 0, size);
+        } else if (check_dirty) {
+            uint32_t hash = copy_rgb565_hash((uint16_t *)bounce, rgb_data, n * w, swap);
+            unchanged = (full == false && hash == lcd->stripe_hash[stripe]);
+            lcd->stripe_hash[stripe] = hash;
+            rgb_data += size;
+        } else if (swap) {
+            copy_swap_rgb565((uint16_t *)bounce, rgb_data, n * w);
+            rgb_data += size;
+        } else {
+            memcpy(bounce, rgb_data, size);
+            rgb_data += size;
+        }
+        if (unchanged) {
+            // Panel still holds this stripe, keep bounce buffer for next one
+            release_trans(lcd);
+            i += n;
+            continue;
+        }
+        ret = esp_lcd_panel_draw_bitmap(lcd->handle, 0, i, w, i + n, bounce);
+        if (ret != ESP_OK) {
+            release_trans(lcd);
+            break;
+        }
+        lcd->bounce_sel = (lcd->bounce_sel + 1) % LCD_SPI_BOUNCE_NUM;
+        i += n;
+    }
+    // Panel content unknown after clear or failed draw
+    lcd->hash_valid = (check_dirty && ret == 0);
+    return ret;
+}
+
+static int register_callbacks(lcd_render_t *lcd, bool enable)
+{
+    int ret = 0;
+    if (use_spi_bounce(lcd)) {
+        esp_lcd_panel_io_callbacks_t io_cb = {
+            .on_color_trans_done = enable ? spi_trans_done : NULL,
+        };
+        ret = esp_lcd_panel_io_register_event_callbacks(lcd->io_handle, &io_cb, enable ? lcd : NULL);
+        lcd->trans_slots = LCD_SPI_BOUNCE_NUM;
+        return ret;
+    }
+#if CONFIG_IDF_TARGET_ESP32P4
+    if (lcd->rgb_panel == false) {
+        esp_lcd_dpi_panel_event_callbacks_t dpi_cb = {
+            .on_color_trans_done = enable ? draw_finished : NULL,
+            .on_refresh_done = (enable && lcd->fb_num) ? refresh_finished : NULL,
+        };
+        ret = esp_lcd_dpi_panel_register_event_callbacks(lcd->handle, &dpi_cb, enable ? lcd : NULL);
+        lcd->trans_slots = 1;
+    }
+#endif
+    return ret;
+}
 
 static video_render_handle_t lcd_render_open(void *cfg, int size)
 {
@@ -73,33 +378,36 @@ static video_render_handle_t lcd_render_open(void *cfg, int size)
         return NULL;
     }
     lcd->handle = lcd_cfg->lcd_handle; // lcd_cfg->lcd_handle;
+    lcd->io_handle = lcd_cfg->io_handle;
     lcd->rgb_panel = lcd_cfg->rgb_panel;
     lcd->dsi_panel = lcd_cfg->dsi_panel;
+    lcd->skip_unchanged = lcd_cfg->skip_unchanged;
+    lcd->full_refresh_interval = lcd_cfg->full_refresh_interval ? lcd_cfg->full_refresh_interval : LCD_DEFAULT_FULL_REFRESH;
+    // Panel starts scanning out from the first frame buffer
+    lcd->fb_displaying = 0;
+    lcd->fb_pending = -1;
     if (lcd_cfg->use_frame_buffer) {
-        if (lcd->rgb_panel) {
-#if SOC_LCD_RGB_SUPPORTED
-            esp_lcd_rgb_panel_get_frame_buffer(lcd->handle, 2, (void **)&lcd->frame_buffer[0],
-                                               (void **)&lcd->frame_buffer[1]);
-#endif
+        if (get_panel_frame_buffer(lcd) != 0) {
+            ESP_LOGE(TAG, "Fail to get frame buffer");
+            lcd_render_close(lcd);
+            return NULL;
         }
-        if (lcd->dsi_panel) {
-#if CONFIG_IDF_TARGET_ESP32P4
-            esp_lcd_dpi_panel_get_frame_buffer(lcd->handle, 2, (void **)&lcd->frame_buffer[0],
-                                               (void **)&lcd->frame_buffer[1]);
-#endif
+    }
+    if (register_callbacks(lcd, true) != ESP_OK) {
+        ESP_LOGW(TAG, "Fail to register draw callback, draw without pipeline");
+        lcd->trans_slots = 0;
+    }
+    if (lcd->trans_slots) {
+        lcd->trans_done = xSemaphoreCreateCounting(lcd->trans_slots, lcd->trans_slots);
+        if (lcd->fb_num) {
+            lcd->refresh_done = xSemaphoreCreateBinary();
         }
-        if (lcd->frame_buffer[0] == NULL) {
-            ESP_LOGE(TAG, "Fail to get frame buffer");
+        if (lcd->trans_done == NULL || (lcd->fb_num && lcd->refresh_done == NULL)) {
+            ESP_LOGE(TAG, "Fail to create draw semaphore");
             lcd_render_close(lcd);
             return NULL;
         }
     }
-#if CONFIG_IDF_TARGET_ESP32P4
-    esp_lcd_dpi_panel_event_callbacks_t dpi_cb = {
-        .on_color_trans_done = draw_finished,
-    };
-    esp_lcd_dpi_panel_register_event_callbacks(lcd->handle, &dpi_cb, lcd);
-#endif
     return lcd;
 }
 
@@ -122,6 +430,10 @@ static bool lcd_render_format_supported(video_render_handle_t h, av_render_video
         if (frame_type == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
             return true;
         }
+        // Byte swap is done when copy into bounce buffer
+        if (frame_type == AV_RENDER_VIDEO_RAW_TYPE_RGB565 && use_spi_bounce(lcd)) {
+            return true;
+        }
 #endif
     }
     return false;
@@ -138,10 +450,42 @@ static int lcd_render_set_frame_info(video_render_handle_t h, av_render_video_fr
     }
     lcd_render_t *lcd = (lcd_render_t *)h;
     memcpy(&lcd->info, info, sizeof(av_render_video_frame_info_t));
+    if (use_spi_bounce(lcd) && lcd->trans_done) {
+        int ret = alloc_bounce(lcd);
+        if (ret != 0) {
+            return ret;
+        }
+    }
     ESP_LOGI(TAG, "Render started %dx%d", info->width, info->height);
     return 0;
 }
 
+static int get_fb_index(lcd_render_t *lcd, uint8_t *data)
+{
+    for (int i = 0; i < lcd->fb_num; i++) {
+        if (lcd->frame_buffer[i] == data) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int present_frame_buffer(lcd_render_t *lcd, int x_end, int y_end, uint8_t *data)
+{
+    int ret = lcd_draw(lcd, x_end, 0, y_end, data);
+    int idx = get_fb_index(lcd, data);
+    if (ret != ESP_OK || idx < 0) {
+        return ret;
+    }
+    // Buffer is switched to at next refresh, before that old one is still scanned out
+    if (lcd->refresh_done) {
+        lcd->fb_pending = idx;
+    } else {
+        lcd->fb_displaying = idx;
+    }
+    return ret;
+}
+
 static int lcd_render_write(video_render_handle_t h, av_render_video_frame_t *video_data)
 {
     lcd_render_t *lcd = (lcd_render_t *)h;
@@ -160,12 +504,6 @@ static int lcd_render_write(video_render_handle_t h, av_render_video_frame_t *vi
         lcd->start_time = cur_time;
         lcd->frame_num = 0;
     }
-#if CONFIG_IDF_TARGET_ESP32P4
-    while (lcd->drawing) {
-        media_lib_thread_sleep(10);
-    }
-    lcd->drawing = true;
-#endif
     if (lcd->info.type == AV_RENDER_VIDEO_RAW_TYPE_RGB565 || lcd->info.type == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
         uint8_t *rgb_data = video_data->data;
         ESP_LOGD(TAG, "pts:%d size %d", (int)video_data->pts, (int)video_data->size);
@@ -173,12 +511,13 @@ static int lcd_render_write(video_render_handle_t h, av_render_video_frame_t *vi
             return ESP_MEDIA_ERR_INVALID_ARG;
         }
         if (lcd->frame_buffer[0]) {
-            // Check whether input ptr is frame buffer or not
-            lcd->sel = !lcd->sel;
-            return esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, rgb_data);
+            return present_frame_buffer(lcd, lcd->info.width, lcd->info.height, rgb_data);
+        }
+        if (lcd->bounce_lines) {
+            return spi_draw_frame(lcd, rgb_data);
         }
 #if CONFIG_IDF_TARGET_ESP32P4
-        return esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, rgb_data);
+        return lcd_draw(lcd, lcd->info.width, 0, lcd->info.height, rgb_data);
 #endif
         int w = lcd->info.width;
         int h = lcd->info.height;
@@ -198,6 +537,17 @@ static int lcd_render_write(video_render_handle_t h, av_render_video_frame_t *vi
     return ESP_MEDIA_ERR_NOT_SUPPORT;
 }
 
+static int get_free_fb_index(lcd_render_t *lcd)
+{
+    for (int i = 1; i <= lcd->fb_num; i++) {
+        int idx = (lcd->fb_displaying + i) % lcd->fb_num;
+        if (idx != lcd->fb_displaying && idx != lcd->fb_pending) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
 static int lcd_render_get_frame_buffer(video_render_handle_t h, av_render_frame_buffer_t *buffer)
 {
     lcd_render_t *lcd = (lcd_render_t *)h;
@@ -207,12 +557,20 @@ static int lcd_render_get_frame_buffer(video_render_handle_t h, av_render_frame_
     if (lcd->frame_buffer[0] == NULL) {
         return ESP_MEDIA_ERR_NOT_SUPPORT;
     }
-    uint8_t *frame_buffer = lcd->frame_buffer[lcd->sel];
-    if (frame_buffer == NULL) {
-        frame_buffer = lcd->frame_buffer[0];
+    int idx = get_free_fb_index(lcd);
+    // Double buffer: wait until panel switched to the queued one
+    while (idx < 0 && lcd->refresh_done) {
+        if (xSemaphoreTake(lcd->refresh_done, pdMS_TO_TICKS(LCD_REFRESH_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "Timeout to wait for panel refresh");
+            break;
+        }
+        idx = get_free_fb_index(lcd);
+    }
+    if (idx < 0) {
+        idx = lcd->fb_displaying;
     }
     // Only support RGB565 currently
-    buffer->data = frame_buffer;
+    buffer->data = lcd->frame_buffer[idx];
     buffer->size = lcd->info.width * lcd->info.height * 2;
     return 0;
 }
@@ -244,8 +602,16 @@ static int lcd_render_clear(video_render_handle_t h)
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     if (lcd->handle && lcd->info.width) {
-        uint8_t *frame_buffer = lcd->frame_buffer[lcd->sel];
-        if (frame_buffer == NULL) {
+        if (lcd->frame_buffer[0]) {
+            int idx = get_free_fb_index(lcd);
+            uint8_t *frame_buffer = lcd->frame_buffer[idx < 0 ? lcd->fb_displaying : idx];
+            int len = lcd->info.width * lcd->info.height * 2;
+            memset(frame_buffer, 0, len);
+            present_frame_buffer(lcd, 1, 1, frame_buffer);
+        } else if (lcd->bounce_lines) {
+            spi_draw_frame(lcd, NULL);
+            wait_all_trans_done(lcd);
+        } else {
 #ifndef CONFIG_IDF_TARGET_ESP32P4
             uint8_t *line_buffer = (uint8_t *)media_lib_malloc(lcd->info.width * 2);
             if (line_buffer) {
@@ -256,10 +622,6 @@ static int lcd_render_clear(video_render_handle_t h)
                 media_lib_free(line_buffer);
             }
 #endif
-        } else {
-            int len = lcd->info.width * lcd->info.height * 2;
-            memset(frame_buffer, 0, len);
-            esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, 1, 1, frame_buffer);
         }
     }
     return 0;
@@ -272,6 +634,17 @@ static int lcd_render_close(video_render_handle_t h)
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     lcd_render_clear(h);
+    wait_all_trans_done(lcd);
+    if (lcd->trans_slots) {
+        register_callbacks(lcd, false);
+    }
+    free_bounce(lcd);
+    if (lcd->trans_done) {
+        vSemaphoreDelete(lcd->trans_done);
+    }
+    if (lcd->refresh_done) {
+        vSemaphoreDelete(lcd->refresh_done);
+    }
     media_lib_free(lcd);
     return 0;
 }
@@ -0,0 +1,168 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "audio_playout.h"
+
+#define PLAYOUT_DEFAULT_MIN_DELAY (40)
+#define PLAYOUT_DEFAULT_MAX_DELAY (300)
+#define PLAYOUT_DEFAULT_MIN_SPEED (0.9f)
+#define PLAYOUT_DEFAULT_MAX_SPEED (1.1f)
+// Time stretch faster than this is clearly audible
+#define PLAYOUT_MAX_SPEED_LIMIT   (1.25f)
+// Peak variation decays to half in about 4.6 minutes of 20ms packets, Wi-Fi stalls tend to recur
+#define PLAYOUT_PEAK_DECAY        (0.99995f)
+// Baseline transit rises slowly so that clock drift and route change are followed
+#define PLAYOUT_BASE_RISE         (0.002f)
+#define PLAYOUT_JITTER_FACTOR     (4)
+// Deadband in ms around target where speed stays 1.0
+#define PLAYOUT_DEADBAND          (10)
+// Delay error in ms which reaches full speed deviation
+#define PLAYOUT_FULL_ERROR        (60)
+#define PLAYOUT_SPEED_STEP        (0.02f)
+
+void audio_playout_init(audio_playout_t *p, av_render_playout_cfg_t *cfg)
+{
+    memset(p, 0, sizeof(audio_playout_t));
+    if (cfg) {
+        p->cfg = *cfg;
+    }
+    if (p->cfg.min_delay == 0) {
+        p->cfg.min_delay = PLAYOUT_DEFAULT_MIN_DELAY;
+    }
+    if (p->cfg.max_delay == 0) {
+        p->cfg.max_delay = PLAYOUT_DEFAULT_MAX_DELAY;
+    }
+    if (p->cfg.max_delay < p->cfg.min_delay * 2) {
+        p->cfg.max_delay = p->cfg.min_delay * 2;
+    }
+    if (p->cfg.min_speed <= 0.0f || p->cfg.min_speed > 1.0f) {
+        p->cfg.min_speed = PLAYOUT_DEFAULT_MIN_SPEED;
+    }
+    if (p->cfg.max_speed < 1.0f) {
+        p->cfg.max_speed = PLAYOUT_DEFAULT_MAX_SPEED;
+    } else if (p->cfg.max_speed > PLAYOUT_MAX_SPEED_LIMIT) {
+        p->cfg.max_speed = PLAYOUT_MAX_SPEED_LIMIT;
+    }
+    audio_playout_reset(p);
+}
+
+void audio_playout_reset(audio_playout_t *p)
+{
+    p->has_arrival = false;
+    p->jitter = 0;
+    p->peak = 0;
+    p->target = p->cfg.min_delay;
+    p->delay = 0;
+    p->speed = 1.0f;
+    p->buffering = true;
+}
+
+void audio_playout_on_arrival(audio_playout_t *p, uint32_t pts, uint32_t now)
+{
+    float transit = (float)(int32_t)(now - pts);
+    if (p->has_arrival == false) {
+        p->has_arrival = true;
+        p->base_transit = transit;
+    } else {
+        // RFC 3550 inter-arrival jitter
+        int32_t d = (int32_t)(now - p->last_arrival) - (int32_t)(pts - p->last_pts);
+        if (d < 0) {
+            d = -d;
+        }
+        p->jitter += ((float)d - p->jitter) / 16;
+        if (transit < p->base_transit) {
+            p->base_transit = transit;
+        } else {
+            p->base_transit += (transit - p->base_transit) * PLAYOUT_BASE_RISE;
+        }
+    }
+    p->last_pts = pts;
+    p->last_arrival = now;
+    // Packet arriving later than baseline by this variation must still find data left in fifo
+    float variation = transit - p->base_transit;
+    p->peak *= PLAYOUT_PEAK_DECAY;
+    if (variation > p->peak) {
+        p->peak = variation;
+    }
+    float target = p->jitter * PLAYOUT_JITTER_FACTOR;
+    if (p->peak > target) {
+        target = p->peak;
+    }
+    if (target < p->cfg.min_delay) {
+        target = p->cfg.min_delay;
+    }
+    // Keep headroom below drop limit so that speed control has room to work
+    // Stalls longer than half of it cost less as one gap than as latency for the whole call
+    if (target > p->cfg.max_delay / 2) {
+        target = p->cfg.max_delay / 2;
+    }
+    p->target = (uint32_t)target;
+}
+
+bool audio_playout_check(audio_playout_t *p, uint32_t delay, bool dry, bool *skip)
+{
+    p->delay = delay;
+    if (p->buffering) {
+        if (delay < p->target) {
+            return false;
+        }
+        p->buffering = false;
+    } else if (dry) {
+        // Play on directly, holding frame to rebuild target only lengthens the gap already heard
+        // Slow speed grows fifo back to target afterwards
+        p->underrun++;
+    }
+    if (delay > p->cfg.max_delay) {
+        p->dropped++;
+        *skip = true;
+    }
+    return true;
+}
+
+float audio_playout_get_speed(audio_playout_t *p, uint32_t delay)
+{
+    int32_t err = (int32_t)delay - (int32_t)p->target;
+    float speed = 1.0f;
+    if (err > PLAYOUT_DEADBAND || err < -PLAYOUT_DEADBAND) {
+        err += (err > 0) ? -PLAYOUT_DEADBAND : PLAYOUT_DEADBAND;
+        float range = (err > 0) ? p->cfg.max_speed - 1.0f : 1.0f - p->cfg.min_speed;
+        float ratio = (float)err / PLAYOUT_FULL_ERROR;
+        if (ratio > 1.0f) {
+            ratio = 1.0f;
+        } else if (ratio < -1.0f) {
+            ratio = -1.0f;
+        }
+        speed = 1.0f + ratio * range;
+        // Quantize so that render is not reconfigured for tiny change
+        speed = (int)(speed / PLAYOUT_SPEED_STEP + 0.5f) * PLAYOUT_SPEED_STEP;
+    }
+    if (speed > p->cfg.max_speed) {
+        speed = p->cfg.max_speed;
+    } else if (speed < p->cfg.min_speed) {
+        speed = p->cfg.min_speed;
+    }
+    p->speed = speed;
+    return speed;
+}
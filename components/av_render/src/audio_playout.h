@@ -0,0 +1,105 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef AUDIO_PLAYOUT_H
+#define AUDIO_PLAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "av_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Adaptive audio playout controller state
+ *
+ * @note  Arrival side (`audio_playout_on_arrival`) and render side (`audio_playout_get_speed`) run in different
+ *        threads, they only exchange `target` which is updated as a whole
+ */
+typedef struct {
+    av_render_playout_cfg_t cfg;
+    bool     has_arrival;
+    uint32_t last_pts;
+    uint32_t last_arrival;
+    float    base_transit; /*!< Slowly rising minimum of arrival time minus pts */
+    float    jitter;       /*!< Smoothed inter-arrival jitter (RFC 3550) */
+    float    peak;         /*!< Decaying peak of transit variation, covers Wi-Fi burst stalls */
+    uint32_t target;       /*!< Target delay */
+    uint32_t delay;        /*!< Latest fifo depth */
+    float    speed;        /*!< Last speed returned */
+    bool     buffering;    /*!< Waiting fifo to reach target after start or reset */
+    uint32_t underrun;
+    uint32_t dropped;
+} audio_playout_t;
+
+/**
+ * @brief  Initialize controller, zero fields in `cfg` take default value
+ */
+void audio_playout_init(audio_playout_t *p, av_render_playout_cfg_t *cfg);
+
+/**
+ * @brief  Clear runtime state and restart buffering, configuration is kept
+ */
+void audio_playout_reset(audio_playout_t *p);
+
+/**
+ * @brief  Feed arrival of one audio packet
+ *
+ * @param[in]  p    Controller
+ * @param[in]  pts  Packet pts (unit ms)
+ * @param[in]  now  Local arrival time (unit ms)
+ */
+void audio_playout_on_arrival(audio_playout_t *p, uint32_t pts, uint32_t now);
+
+/**
+ * @brief  Check whether frame at fifo head can be rendered
+ *
+ * @param[in]   p      Controller
+ * @param[in]   delay  Fifo depth including frame at head (unit ms)
+ * @param[in]   dry    Whether fifo was empty when render asked for this frame
+ * @param[out]  skip   Set to true when frame should be dropped
+ *
+ * @return
+ *       - true   Render (or drop) the frame
+ *       - false  Keep buffering, retry later
+ */
+bool audio_playout_check(audio_playout_t *p, uint32_t delay, bool dry, bool *skip);
+
+/**
+ * @brief  Get render speed which steers fifo depth toward target
+ *
+ * @param[in]  p      Controller
+ * @param[in]  delay  Fifo depth (unit ms)
+ *
+ * @return  Speed within configured range, quantized so that small change does not reconfigure render
+ */
+float audio_playout_get_speed(audio_playout_t *p, uint32_t delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,7 @@
 #include "esp_ae_ch_cvt.h"
 #include "esp_ae_rate_cvt.h"
 #include "esp_ae_bit_cvt.h"
+#include "fused_resample.h"
 #include "media_lib_os.h"
 #include "esp_log.h"
 
@@ -52,6 +53,7 @@ typedef struct {
     esp_ae_ch_cvt_handle_t   ch_cvt_handle;
     esp_ae_rate_cvt_handle_t rate_cvt_handle;
     esp_ae_bit_cvt_handle_t  bit_cvt_handle;
+    fused_resample_handle_t  fused;
     resample_ops_t           ops[3];
     work_buf_t               work_buf[2];
 } resample_t;
@@ -125,6 +127,23 @@ static int get_need_size(resample_t *resample, resample_ops_t op, uint32_t *samp
     return 0;
 }
 
+static int fused_resample_write(resample_t *resample, av_render_audio_frame_t *data)
+{
+    uint32_t sample_num = data->size / SAMPLE_SIZE(resample->cfg.input_info);
+    uint32_t max_sample = fused_resample_get_max_out_sample(resample->fused, sample_num);
+    work_buf_t *cur = alloc_work_buf(resample, max_sample * SAMPLE_SIZE(resample->cfg.output_info));
+    if (cur == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    uint32_t out_sample = fused_resample_process(resample->fused, data->data, sample_num, cur->data);
+    release_work_buf(cur);
+    av_render_audio_frame_t new_frame = *data;
+    new_frame.data = cur->data;
+    new_frame.size = out_sample * SAMPLE_SIZE(resample->cfg.output_info);
+    resample->cfg.resample_cb(&new_frame, resample->cfg.ctx);
+    return ESP_MEDIA_ERR_OK;
+}
+
 audio_resample_handle_t audio_resample_open(audio_resample_cfg_t *cfg)
 {
     resample_t *resample = (resample_t *)media_lib_calloc(1, sizeof(resample_t));
@@ -133,6 +152,15 @@ audio_resample_handle_t audio_resample_open(audio_resample_cfg_t *cfg)
             break;
         }
         sort_resample_ops(resample, cfg);
+        // Fused path touches each sample once, only used when asked since its filter differs from AE one
+        if (cfg->use_fused && resample->ops[0] != RESAMPLE_OPS_NONE &&
+            fused_resample_supported(&cfg->input_info, &cfg->output_info)) {
+            resample->fused = fused_resample_open(&cfg->input_info, &cfg->output_info);
+            if (resample->fused) {
+                resample->cfg = *cfg;
+                return resample;
+            }
+        }
         av_render_audio_frame_info_t cur_info = cfg->input_info;
         esp_ae_err_t ret = ESP_AE_ERR_OK;
         for (int i = 0; i < ELEMS(resample->ops); i++) {
@@ -198,6 +226,9 @@ int audio_resample_write(audio_resample_handle_t h, av_render_audio_frame_t *dat
         resample->cfg.resample_cb(data, resample->cfg.ctx);
         return ESP_MEDIA_ERR_OK;
     }
+    if (resample->fused) {
+        return fused_resample_write(resample, data);
+    }
     av_render_audio_frame_info_t cur_info = resample->cfg.input_info;
     work_buf_t *cur = NULL;
     work_buf_t *last = NULL;
@@ -258,6 +289,10 @@ void audio_resample_close(audio_resample_handle_t h)
         esp_ae_rate_cvt_close(resample->rate_cvt_handle);
         resample->rate_cvt_handle = NULL;
     }
+    if (resample->fused) {
+        fused_resample_close(resample->fused);
+        resample->fused = NULL;
+    }
     for (int i = 0; i < ELEMS(resample->work_buf); i++) {
         if (resample->work_buf[i].data) {
             media_lib_free(resample->work_buf[i].data);
@@ -30,11 +30,14 @@
 #include "av_render.h"
 #include "audio_decoder.h"
 #include "video_decoder.h"
+#include "video_decoder_priv.h"
 #include "audio_render.h"
 #include "video_render.h"
 #include "audio_resample.h"
 #include "esp_timer.h"
 #include "color_convert.h"
+#include "audio_playout.h"
+#include "frame_pool.h"
 #include "esp_log.h"
 
 #define TAG "AV_RENDER"
@@ -69,6 +72,15 @@ typedef struct {
     uint32_t             data;
 } av_render_msg_t;
 
+/**
+ * @brief  Reference of decoded frame in frame buffer pool, queued to video render instead of frame data
+ */
+typedef struct {
+    av_render_video_frame_t frame;
+    int                     slot;
+    uint32_t                seq;
+} av_render_pool_frame_t;
+
 typedef struct _render_thread_res_t {
     media_lib_thread_handle_t thread;
     msg_q_handle_t            msg_q;
@@ -93,11 +105,19 @@ typedef struct {
     vdec_handle_t                vdec;
     int                          video_err_cnt;
     av_render_video_frame_t     *fb_frame;
+    frame_pool_handle_t          fb_pool;
+    av_render_video_frame_t      fb_pool_frame;
+    int                          fb_pool_slot;
     av_render_video_frame_type_t dec_out_fmt;
     av_render_video_frame_type_t out_fmt;
     color_convert_table_t       *vid_convert;
     uint8_t                     *vid_convert_out;
     int                          vid_convert_out_size;
+    uint8_t                     *reserve_buf;
+    uint32_t                     reserve_size;
+    uint32_t                     queued_frames;
+    uint32_t                     copied_size;
+    vdec_stage_time_t            convert_time;
 } av_render_vdec_res_t;
 
 struct _av_render;
@@ -145,6 +165,9 @@ typedef struct _av_render {
     media_lib_event_grp_handle_t event_group;
     media_lib_mutex_handle_t     api_lock;
     uint32_t                     audio_threshold;
+    bool                         playout_enable;
+    audio_playout_t              playout;
+    float                        playout_speed;
     av_render_event_cb           event_cb;
     void                        *event_ctx;
     av_render_pool_data_free     pool_free;
@@ -277,7 +300,8 @@ static int read_for_vdec(data_queue_t *q, av_render_video_data_t *data, bool use
         return ret;
     }
     int head_size = sizeof(av_render_video_data_t);
-    if (r->size + head_size != size) {
+    // Reserved block may keep its whole reserved size
+    if (r->size + head_size > size) {
         ret = -1;
     } else {
         *data = *r;
@@ -304,12 +328,23 @@ static int read_for_a_render(data_queue_t *q, av_render_audio_frame_t *data)
     return ret;
 }
 
-static int read_for_v_render(data_queue_t *q, av_render_video_frame_t *data)
+static int read_for_v_render(data_queue_t *q, frame_pool_handle_t pool, av_render_video_frame_t *data, int *pool_slot)
 {
     uint8_t *b;
     int size;
     int ret = data_queue_read_lock(q, (void **)&b, &size);
     RETURN_ON_FAIL(ret);
+    if (pool && size == sizeof(av_render_pool_frame_t)) {
+        av_render_pool_frame_t *ref = (av_render_pool_frame_t *)b;
+        *data = ref->frame;
+        // Frame reclaimed by decoder or skipped for newer one, nothing to show
+        if (frame_pool_lock(pool, ref->slot, ref->seq)) {
+            *pool_slot = ref->slot;
+        } else {
+            data->size = 0;
+        }
+        return ret;
+    }
     av_render_video_frame_t *r = (av_render_video_frame_t *)b;
     if (r->data > b && r->data + r->size == b + size) {
         *data = *r;
@@ -680,16 +715,61 @@ static int _render_write_video(av_render_thread_res_t *res, av_render_video_fram
     return ret;
 }
 
+static uint32_t audio_fifo_latency(av_render_t *render, int q_num, int q_size)
+{
+    av_render_audio_frame_info_t *info = &render->a_render_res->out_frame_info;
+    int sample_size = info->channel * info->bits_per_sample >> 3;
+    if (sample_size == 0 || info->sample_rate == 0) {
+        return 0;
+    }
+    // Queue size counts frame header of each item also
+    int size = q_size - q_num * (int)sizeof(av_render_audio_frame_t);
+    if (size <= 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)(size / sample_size) * 1000 / info->sample_rate);
+}
+
+static bool audio_playout_before_render(av_render_t *render, int q_num, int q_size, bool dry, bool *skip)
+{
+    uint32_t delay = audio_fifo_latency(render, q_num, q_size);
+    if (audio_playout_check(&render->playout, delay, dry, skip) == false) {
+        return false;
+    }
+    if (*skip == false) {
+        float speed = audio_playout_get_speed(&render->playout, delay);
+        // Render speed only owned by render thread when playout enabled, so set here directly
+        if (speed != render->playout_speed) {
+            audio_render_set_speed(render->cfg.audio_render, speed);
+            render->playout_speed = speed;
+        }
+    }
+    return true;
+}
+
 static int a_render_body(av_render_thread_res_t *res, bool drop)
 {
     av_render_audio_frame_t data;
+    bool dry = false;
+    if (res->render->playout_enable) {
+        int q_num = 0, q_size = 0;
+        data_queue_query(res->data_q, &q_num, &q_size);
+        dry = (q_num == 0);
+    }
     int ret = read_for_a_render(res->data_q, &data);
     RETURN_ON_FAIL(ret);
     bool skip = false;
     if (data.size) {
         int q_num = 0, q_size = 0;
         data_queue_query(res->data_q, &q_num, &q_size);
-        if (res->paused == false && res->render->audio_threshold) {
+        if (res->paused == false && res->render->playout_enable) {
+            if (audio_playout_before_render(res->render, q_num, q_size, dry, &skip) == false) {
+                data_queue_peek_unlock(res->data_q);
+                // Wait for data reach target delay
+                media_lib_thread_sleep(10);
+                return 0;
+            }
+        } else if (res->paused == false && res->render->audio_threshold) {
             if (res->render->a_render_res->audio_rendered == false) {
                 if (q_size < res->render->audio_threshold) {
                     data_queue_peek_unlock(res->data_q);
@@ -704,7 +784,9 @@ static int a_render_body(av_render_thread_res_t *res, bool drop)
                 return 0;
             }
         }
-        audio_drop_before_render(res->render, q_size, &skip);
+        if (res->render->playout_enable == false) {
+            audio_drop_before_render(res->render, q_size, &skip);
+        }
     }
     if (drop == false && skip == false && (data.size || data.eos)) {
         ret = _render_write_audio(res, &data);
@@ -723,15 +805,19 @@ static int a_render_body(av_render_thread_res_t *res, bool drop)
 static int v_render_body(av_render_thread_res_t *res, bool drop)
 {
     av_render_video_frame_t data;
-    int ret = read_for_v_render(res->data_q, &data);
+    int pool_slot = -1;
+    av_render_vdec_res_t *pool_vdec = res->render->vdec_res;
+    int ret = read_for_v_render(res->data_q, pool_vdec ? pool_vdec->fb_pool : NULL, &data, &pool_slot);
     RETURN_ON_FAIL(ret);
     if (drop == false && (data.size || data.eos)) {
         av_render_vdec_res_t *vdec_res = res->render->vdec_res;
         if (vdec_res && vdec_res->vid_convert) {
             // Do color convert firstly
+            int64_t start_time = esp_timer_get_time();
             ret = convert_color(vdec_res->vid_convert,
                  data.data, data.size,
                  vdec_res->vid_convert_out, vdec_res->vid_convert_out_size);
+            vdec_stage_time_add(&vdec_res->convert_time, (uint32_t)(esp_timer_get_time() - start_time));
             data.data = vdec_res->vid_convert_out;
             data.size = vdec_res->vid_convert_out_size;
         }
@@ -741,13 +827,37 @@ static int v_render_body(av_render_thread_res_t *res, bool drop)
         }
     }
     if (res->paused) {
+        // Keep pool frame held so that it can be shown again after resume
         data_queue_peek_unlock(res->data_q);
     } else {
+        if (pool_slot >= 0) {
+            frame_pool_unlock(pool_vdec->fb_pool, pool_slot);
+        }
         data_queue_read_unlock(res->data_q);
     }
     return 0;
 }
 
+static uint8_t *realloc_convert_out(av_render_t *render, uint8_t **data, int size)
+{
+    if (render->cfg.mem_arena == NULL) {
+        return media_lib_realloc(*data, size);
+    }
+    // Content need not be kept, return old region so that arena can hand out the best fitting one
+    mem_arena_free(render->cfg.mem_arena, *data);
+    *data = NULL;
+    return mem_arena_alloc(render->cfg.mem_arena, size);
+}
+
+static void free_convert_out(av_render_t *render, uint8_t *data)
+{
+    if (render->cfg.mem_arena) {
+        mem_arena_free(render->cfg.mem_arena, data);
+    } else {
+        media_lib_free(data);
+    }
+}
+
 static int create_thread_res(av_render_thread_res_t *res, const char *name,
                              int (*body)(av_render_thread_res_t *res, bool drop),
                              int buffer_size, int wait_bits)
@@ -761,7 +871,7 @@ static int create_thread_res(av_render_thread_res_t *res, const char *name,
         }
         res->name = name;
         if (res->data_q == NULL) {
-            res->data_q = data_queue_init(buffer_size);
+            res->data_q = data_queue_init_from_arena(buffer_size, res->render->cfg.mem_arena);
         }
         if (res->data_q == NULL) {
             break;
@@ -978,6 +1088,7 @@ static int av_render_audio_frame_reached(av_render_audio_frame_t *frame, void *c
                 .output_info = a_render->out_frame_info,
                 .resample_cb = audio_render_frame_reached,
                 .ctx = a_render,
+                .use_fused = render->cfg.audio_fused_resample,
             };
             a_render->resample_handle = audio_resample_open(&resample_cfg);
             if (a_render->resample_handle == NULL) {
@@ -1032,6 +1143,17 @@ static uint8_t *av_render_fetch_vid_fb(int align, int size, void *ctx)
         return NULL;
     }
     av_render_vdec_res_t *vdec_res = render->vdec_res;
+    if (vdec_res->fb_pool) {
+        uint8_t *data = NULL;
+        vdec_res->fb_pool_slot = frame_pool_acquire(vdec_res->fb_pool, size, align, &data);
+        if (vdec_res->fb_pool_slot < 0) {
+            return NULL;
+        }
+        vdec_res->fb_frame = &vdec_res->fb_pool_frame;
+        vdec_res->fb_frame->data = data;
+        vdec_res->fb_frame->size = 0;
+        return data;
+    }
     size = sizeof(av_render_video_frame_t) + size + align;
     uint8_t *b = (uint8_t *)data_queue_get_buffer(v_render->thread_res.data_q, size);
     if (b == NULL) {
@@ -1045,6 +1167,24 @@ static uint8_t *av_render_fetch_vid_fb(int align, int size, void *ctx)
     return vdec_res->fb_frame->data;
 }
 
+static int release_pool_frame(av_render_video_res_t *v_render, av_render_vdec_res_t *vdec_res, bool drop)
+{
+    if (drop) {
+        frame_pool_cancel(vdec_res->fb_pool, vdec_res->fb_pool_slot);
+        return 0;
+    }
+    av_render_pool_frame_t *ref = (av_render_pool_frame_t *)data_queue_get_buffer(v_render->thread_res.data_q,
+                                                                                   sizeof(av_render_pool_frame_t));
+    if (ref == NULL) {
+        frame_pool_cancel(vdec_res->fb_pool, vdec_res->fb_pool_slot);
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    ref->frame = vdec_res->fb_pool_frame;
+    ref->slot = vdec_res->fb_pool_slot;
+    ref->seq = frame_pool_submit(vdec_res->fb_pool, vdec_res->fb_pool_slot);
+    return data_queue_send_buffer(v_render->thread_res.data_q, sizeof(av_render_pool_frame_t));
+}
+
 static int av_render_release_vid_fb(uint8_t *addr, bool drop, void *ctx)
 {
     av_render_t *render = (av_render_t *)ctx;
@@ -1056,6 +1196,9 @@ static int av_render_release_vid_fb(uint8_t *addr, bool drop, void *ctx)
     if (vdec_res->fb_frame == NULL || addr != vdec_res->fb_frame->data) {
         ESP_LOGE(TAG, "Release wrong data");
     }
+    if (vdec_res->fb_pool) {
+        return release_pool_frame(v_render, vdec_res, drop);
+    }
     uint32_t size = 0;
     if (drop == false) {
         size = vdec_res->fb_frame->size + (uint32_t)(addr - (uint8_t *)vdec_res->fb_frame);
@@ -1092,19 +1235,33 @@ static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *c
                     .to = vdec_res->out_fmt,
                     .width = v_render->video_frame_info.width,
                     .height = v_render->video_frame_info.height,
+                    .workers = render->cfg.video_cvt_workers,
+                    .out_width = render->cfg.video_out_width,
+                    .out_height = render->cfg.video_out_height,
+                    .scale_mode = render->cfg.video_scale_mode,
+                    .std = render->cfg.video_color_std,
+                    .reference = render->cfg.video_cvt_reference,
                 };
+                // Only scale from YUV420, keep size if decoder already scaled
+                if (convert_cfg.from != AV_RENDER_VIDEO_RAW_TYPE_YUV420 || convert_cfg.out_height == 0) {
+                    convert_cfg.out_width = convert_cfg.out_height = 0;
+                }
                 vdec_res->vid_convert = init_convert_table(&convert_cfg);
                 if (vdec_res->vid_convert == NULL) {
                     ESP_LOGE(TAG, "Fail to init video convert");
                     return ESP_MEDIA_ERR_NO_MEM;
                 }
+                if (convert_cfg.out_width) {
+                    v_render->video_frame_info.width = convert_cfg.out_width;
+                    v_render->video_frame_info.height = convert_cfg.out_height;
+                }
             }
             if (vdec_res && vdec_res->vid_convert) {
                 // Delay to malloc video convert output size
                 int image_size = convert_table_get_image_size(vdec_res->out_fmt,
                         v_render->video_frame_info.width,
                         v_render->video_frame_info.height);
-                uint8_t* vid_cvt_out = media_lib_realloc(vdec_res->vid_convert_out, image_size);
+                uint8_t* vid_cvt_out = realloc_convert_out(render, &vdec_res->vid_convert_out, image_size);
                 if (vid_cvt_out == NULL) {
                     ESP_LOGE(TAG, "Fail to allocate video convert output");
                     return ESP_MEDIA_ERR_NO_MEM;
@@ -1293,6 +1450,10 @@ int av_render_add_audio_stream(av_render_handle_t h, av_render_audio_info_t *aud
         // Clear frame number
         a_render->audio_packet_reached = false;
         a_render->audio_rendered = false;
+        if (render->playout_enable) {
+            audio_playout_reset(&render->playout);
+            render->playout_speed = 1.0f;
+        }
         // Create new decoder if needed
         a_render->audio_is_pcm = (audio_info->codec == AV_RENDER_AUDIO_CODEC_PCM);
 
@@ -1478,6 +1639,10 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
                 .video_info = *video_info,
                 .frame_cb = av_render_video_frame_reached,
                 .ctx = render,
+                .cvt_workers = render->cfg.video_cvt_workers,
+                .out_width = render->cfg.video_out_width,
+                .out_height = render->cfg.video_out_height,
+                .scale_mode = render->cfg.video_scale_mode,
             };
             if (get_support_output_format(render, video_info, &cfg) == false) {
                 break;
@@ -1499,6 +1664,13 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
                     ESP_LOGE(TAG, "Fail to create video render thread resource");
                 } else {
                     v_render->v_render_in_sync = false;
+                    // Pool outlives decoder re-open, render thread may still hold references to its frames
+                    if (render->cfg.video_fb_num && vdec_res->fb_pool == NULL) {
+                        vdec_res->fb_pool = frame_pool_create(render->cfg.video_fb_num, render->cfg.video_fb_latest);
+                        if (vdec_res->fb_pool == NULL) {
+                            ESP_LOGW(TAG, "Fail to create frame buffer pool, decode into render fifo");
+                        }
+                    }
                     vdec_fb_cb_cfg_t vdec_cfg = {
                         .fb_fetch = av_render_fetch_vid_fb,
                         .fb_return = av_render_release_vid_fb,
@@ -1557,6 +1729,9 @@ int av_render_add_audio_data(av_render_handle_t h, av_render_audio_data_t *audio
             ret = ESP_MEDIA_ERR_WRONG_STATE;
             break;
         }
+        if (render->playout_enable && audio_data->size) {
+            audio_playout_on_arrival(&render->playout, audio_data->pts, (uint32_t)(esp_timer_get_time() / 1000));
+        }
         // If no need decode, notify raw data reached directly
         if (a_render->audio_is_pcm) {
             av_render_audio_frame_t audio_frame = {
@@ -1616,6 +1791,51 @@ int av_render_set_audio_threshold(av_render_handle_t h, uint32_t audio_threshold
     return 0;
 }
 
+int av_render_set_playout_cfg(av_render_handle_t h, av_render_playout_cfg_t *cfg)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL) {
+        return -1;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = 0;
+    if (cfg == NULL) {
+        render->playout_enable = false;
+        if (render->cfg.audio_render && render->playout_speed != 1.0f) {
+            audio_render_set_speed(render->cfg.audio_render, 1.0f);
+        }
+        render->playout_speed = 1.0f;
+    } else if (render->cfg.audio_render_fifo_size == 0) {
+        ESP_LOGW(TAG, "Not support adaptive playout without render fifo");
+        ret = -1;
+    } else {
+        render->playout_enable = false;
+        audio_playout_init(&render->playout, cfg);
+        render->playout_speed = 1.0f;
+        render->playout_enable = true;
+        ESP_LOGI(TAG, "Adaptive playout delay %d-%dms speed %.2f-%.2f", render->playout.cfg.min_delay,
+                 render->playout.cfg.max_delay, render->playout.cfg.min_speed, render->playout.cfg.max_speed);
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ret;
+}
+
+int av_render_get_playout_stats(av_render_handle_t h, av_render_playout_stats_t *stats)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || stats == NULL || render->playout_enable == false) {
+        return -1;
+    }
+    audio_playout_t *playout = &render->playout;
+    stats->target_delay = playout->target;
+    stats->delay = playout->delay;
+    stats->jitter = (uint32_t)playout->jitter;
+    stats->speed = playout->speed;
+    stats->underrun = playout->underrun;
+    stats->dropped = playout->dropped;
+    return 0;
+}
+
 int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video_data)
 {
     av_render_t *render = (av_render_t *)h;
@@ -1657,6 +1877,9 @@ int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video
                 if (render->pool_free && video_data->data) {
                     render->pool_free(video_data->data, render->pool);
                 }
+            } else {
+                vdec->queued_frames++;
+                vdec->copied_size += vdec->thread_res.use_pool ? 0 : video_data->size;
             }
             return ret;
         } else {
@@ -1670,6 +1893,115 @@ int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video
     return ret;
 }
 
+int av_render_get_video_buffer(av_render_handle_t h, uint32_t size, uint8_t **buffer)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || buffer == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_vdec_res_t *vdec = render->vdec_res;
+    int ret = ESP_MEDIA_ERR_OK;
+    do {
+        if (render->v_render_res == NULL) {
+            ret = ESP_MEDIA_ERR_WRONG_STATE;
+            break;
+        }
+        if (render->v_render_res->video_is_raw || vdec == NULL || vdec->vdec == NULL ||
+            vdec->thread_res.thread == NULL || vdec->thread_res.use_pool) {
+            ret = ESP_MEDIA_ERR_NOT_SUPPORT;
+            break;
+        }
+        if (vdec->reserve_buf) {
+            ret = ESP_MEDIA_ERR_WRONG_STATE;
+            break;
+        }
+    } while (0);
+    media_lib_mutex_unlock(render->api_lock);
+    RETURN_ON_FAIL(ret);
+    // Same as `put_to_vdec` wait for fifo space without holding API lock
+    int head_size = sizeof(av_render_video_data_t);
+    uint8_t *b = (uint8_t *)data_queue_reserve_buffer(vdec->thread_res.data_q, head_size + size);
+    if (b == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    vdec->reserve_buf = b;
+    vdec->reserve_size = size;
+    *buffer = b + head_size;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int av_render_commit_video_buffer(av_render_handle_t h, av_render_video_data_t *video_data)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    av_render_vdec_res_t *vdec = render->vdec_res;
+    if (vdec == NULL || vdec->reserve_buf == NULL) {
+        return ESP_MEDIA_ERR_WRONG_STATE;
+    }
+    uint8_t *b = vdec->reserve_buf;
+    vdec->reserve_buf = NULL;
+    if (video_data == NULL || video_data->size == 0 || video_data->size > vdec->reserve_size) {
+        data_queue_commit_buffer(vdec->thread_res.data_q, b, 0);
+        return (video_data && video_data->size > vdec->reserve_size) ? ESP_MEDIA_ERR_INVALID_ARG : ESP_MEDIA_ERR_OK;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (render->v_render_res && render->v_render_res->video_frame_info.fps == 0) {
+        correct_video_fps(render->v_render_res, video_data->pts);
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    int head_size = sizeof(av_render_video_data_t);
+    av_render_video_data_t *head = (av_render_video_data_t *)b;
+    *head = *video_data;
+    head->data = NULL;
+    int ret = data_queue_commit_buffer(vdec->thread_res.data_q, b, head_size + video_data->size);
+    if (ret == 0) {
+        vdec->queued_frames++;
+    }
+    return ret;
+}
+
+static void get_stage_time(vdec_stage_time_t *from, av_render_stage_time_t *to)
+{
+    to->count = from->count;
+    to->avg = from->count ? (uint32_t)(from->total / from->count) : 0;
+    to->max = from->max;
+}
+
+int av_render_get_video_stage_stat(av_render_handle_t h, av_render_video_stage_stat_t *stat, bool reset)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || stat == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    memset(stat, 0, sizeof(av_render_video_stage_stat_t));
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_vdec_res_t *vdec_res = render->vdec_res;
+    if (vdec_res) {
+        vdec_stat_t vdec_stat = {};
+        if (vdec_res->vdec && vdec_get_stat(vdec_res->vdec, &vdec_stat, reset) == ESP_MEDIA_ERR_OK) {
+            get_stage_time(&vdec_stat.decode, &stat->decode);
+            get_stage_time(&vdec_stat.convert, &stat->convert);
+        }
+        get_stage_time(&vdec_res->convert_time, &stat->render_convert);
+        if (reset) {
+            memset(&vdec_res->convert_time, 0, sizeof(vdec_stage_time_t));
+        }
+        if (vdec_res->fb_pool) {
+            frame_pool_stat_t pool_stat;
+            frame_pool_get_stat(vdec_res->fb_pool, &pool_stat, reset);
+            stat->fb_wait.count = pool_stat.wait_num;
+            stat->fb_wait.avg = pool_stat.wait_num ? (uint32_t)(pool_stat.wait_total / pool_stat.wait_num) : 0;
+            stat->fb_wait.max = pool_stat.wait_max;
+            stat->fb_dropped = pool_stat.dropped;
+        }
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ESP_MEDIA_ERR_OK;
+}
+
 bool av_render_audio_fifo_enough(av_render_handle_t h, av_render_audio_data_t *audio_data)
 {
     av_render_t *render = (av_render_t *)h;
@@ -1768,6 +2100,10 @@ int av_render_get_video_fifo_level(av_render_handle_t h, av_render_fifo_stat_t *
     memset(fifo_stat, 0, sizeof(av_render_fifo_stat_t));
     av_render_video_res_t *v_render = render->v_render_res;
     if (v_render) {
+        if (render->vdec_res) {
+            fifo_stat->frame_num = render->vdec_res->queued_frames;
+            fifo_stat->copied_size = render->vdec_res->copied_size;
+        }
         if (render->vdec_res && render->vdec_res->thread_res.data_q) {
             data_queue_query(render->vdec_res->thread_res.data_q, &fifo_stat->q_num, &fifo_stat->data_size);
         } else if (v_render->thread_res.data_q) {
@@ -1842,6 +2178,8 @@ static int render_flush(av_render_t *render)
         if (render->v_render_res && render->v_render_res->thread_res.data_q) {
             render->v_render_res->thread_res.flushing = true;
             render_consume_all(&render->v_render_res->thread_res);
+            // Frame references are consumed, return their frames so that decoder can go on
+            frame_pool_flush(render->vdec_res->fb_pool, false);
         }
         send_msg_to_thread(&render->vdec_res->thread_res, sizeof(av_render_video_data_t), &msg);
         wait_bits = render->vdec_res->thread_res.wait_bits << FLUSH_SHIFT_BITS;
@@ -1860,6 +2198,10 @@ static int render_flush(av_render_t *render)
         wait_bits = render->v_render_res->thread_res.wait_bits << FLUSH_SHIFT_BITS;
     }
     _WAIT_BITS(render->event_group, wait_bits);
+    if (render->vdec_res && render->v_render_res) {
+        // Paused render thread is idle and may hold frame for showing after resume
+        frame_pool_flush(render->vdec_res->fb_pool, render->v_render_res->thread_res.paused);
+    }
     // Resend first frame pts
     if (render->v_render_res) {
         render->v_render_res->video_rendered = false;
@@ -1868,6 +2210,9 @@ static int render_flush(av_render_t *render)
     if (render->a_render_res) {
         render->a_render_res->audio_rendered = false;
     }
+    if (render->playout_enable) {
+        audio_playout_reset(&render->playout);
+    }
     return 0;
 }
 
@@ -2009,6 +2354,16 @@ int av_render_query(av_render_handle_t h)
         ESP_LOGI(TAG, "Video decoder fifo size %d items %d err:%d", q_size, q_num, render->vdec_res->video_err_cnt);
         ESP_LOGI(TAG, "Video decoder status flashing: %d paused: %d",
                  render->vdec_res->thread_res.flushing, render->vdec_res->thread_res.paused);
+        vdec_stat_t vdec_stat = {};
+        if (render->vdec_res->vdec) {
+            vdec_get_stat(render->vdec_res->vdec, &vdec_stat, false);
+        }
+        av_render_stage_time_t decode, convert, render_convert;
+        get_stage_time(&vdec_stat.decode, &decode);
+        get_stage_time(&vdec_stat.convert, &convert);
+        get_stage_time(&render->vdec_res->convert_time, &render_convert);
+        ESP_LOGI(TAG, "Video decode %" PRIu32 "/%" PRIu32 "us convert %" PRIu32 "/%" PRIu32 "us render convert %" PRIu32 "/%" PRIu32 "us (avg/max)",
+                 decode.avg, decode.max, convert.avg, convert.max, render_convert.avg, render_convert.max);
     }
     if (render->v_render_res) {
         data_queue_t *q = render->v_render_res->thread_res.data_q;
@@ -2072,6 +2427,10 @@ int av_render_reset(av_render_handle_t h)
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    // Decoder may wait for free frame buffer, wake it up so that it can quit
+    if (render->vdec_res) {
+        frame_pool_abort(render->vdec_res->fb_pool);
+    }
     // wait thread quit
     av_render_msg_t msg = {
         .type = AV_RENDER_MSG_CLOSE,
@@ -2134,9 +2493,13 @@ int av_render_reset(av_render_handle_t h)
             vdec_res->vid_convert = NULL;
         }
         if (vdec_res->vid_convert_out) {
-            media_lib_free(vdec_res->vid_convert_out);
+            free_convert_out(render, vdec_res->vid_convert_out);
             vdec_res->vid_convert_out = NULL;
         }
+        if (vdec_res->fb_pool) {
+            frame_pool_destroy(vdec_res->fb_pool);
+            vdec_res->fb_pool = NULL;
+        }
         destroy_thread_res(&render->vdec_res->thread_res);
         media_lib_free(render->vdec_res);
         render->vdec_res = NULL;
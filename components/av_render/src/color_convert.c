@@ -23,6 +23,7 @@
  */
 #include <sdkconfig.h>
 #include "color_convert.h"
+#include "media_lib_os.h"
 #include "esp_log.h"
 #include "esp_idf_version.h"
 #include "esp_imgfx_color_convert.h"
@@ -32,74 +33,173 @@
 #define COLOR_LIMIT(a) (a > 255 ? 255 : a < 0 ? 0 \
                                               : a)
 
-#define YUV2RO(C, D, E) COLOR_LIMIT((298 * (C) + 409 * (E) + 128) >> 8)
-#define YUV2GO(C, D, E) COLOR_LIMIT((298 * (C)-100 * (D)-208 * (E) + 128) >> 8)
-#define YUV2BO(C, D, E) COLOR_LIMIT((298 * (C) + 516 * (D) + 128) >> 8)
-#define RGB565(r, g, b) (((((r) << 6) | (g)) << 5) | (b))
+// Coefficients of limited range YUV to RGB in Q16
+#define CLR_Q16_ROUND  (1 << 15)
+#define CLR_COEF_Y     (76309)
+
+// Index range of clamp tables, covers every sum of luma and chroma terms in luma unit
+#define CLR_TAB_OFFSET (256)
+#define CLR_TAB_SIZE   (768)
+
+#define CLR_GREEN_FRAC_BITS (3)
+#define CLR_GREEN_ROUND     (1 << (CLR_GREEN_FRAC_BITS - 1))
+
+#define CLR_WORKER_START_BIT(i) (1 << (i))
+#define CLR_WORKER_DONE_BIT(i)  (1 << (8 + (i)))
+
+typedef struct {
+    int32_t rv;
+    int32_t gu;
+    int32_t gv;
+    int32_t bu;
+} clr_coef_t;
+
+static const clr_coef_t bt601_coef = {104597, -25675, -53279, 132201};
+static const clr_coef_t bt709_coef = {117489, -13975, -34925, 138438};
+
+/**
+ * Coefficients of reference path in Q32 (luma gain, rv, gu, gv, bu)
+ * Q16 rounding of coefficients changes result of about 2000 YUV values, Q32 matches double precision for all
+ */
+typedef struct {
+    int64_t y;
+    int64_t rv;
+    int64_t gu;
+    int64_t gv;
+    int64_t bu;
+} clr_ref_coef_t;
+
+#define CLR_Q32_ROUND (1LL << 31)
+
+static const clr_ref_coef_t bt601_ref_coef = {5000989317LL, 6854882848LL, -1682606224LL, -3491669458LL, 8663946082LL};
+static const clr_ref_coef_t bt709_ref_coef = {5000989317LL, 7699764272LL, -915895824LL, -2288828138LL, 9072696586LL};
+
+/**
+ * Tables are indexed by luma plus chroma term, chroma terms are pre-divided by luma gain
+ * So per pixel only needs 3 lookups into tables which hold gained, clamped and shifted RGB565 channel
+ */
+typedef struct {
+    uint16_t r[CLR_TAB_SIZE];
+    uint16_t g[CLR_TAB_SIZE];
+    uint16_t b[CLR_TAB_SIZE];
+    int16_t  rv[256];
+    int16_t  gu[256];
+    int16_t  gv[256];
+    int16_t  bu[256];
+} clr_table_t;
+
+/**
+ * Scale map of one output position
+ * Nearest: `pos` is source sample, `num` is 0
+ * Bilinear: interpolate between `pos` and `pos + 1`, `num` is fraction in Q8
+ * Box: average `num` samples starting from `pos`
+ */
+typedef struct {
+    uint16_t pos;
+    uint16_t num;
+} clr_scale_map_t;
+
+typedef struct _color_convert color_convert_t;
 
 typedef struct {
-    uint8_t                     *table;
+    color_convert_t          *convert;
+    int                       index;
+    int                       row_start;
+    int                       row_end;
+    media_lib_thread_handle_t thread;
+} clr_worker_t;
+
+struct _color_convert {
+    clr_table_t                 *table;
     av_render_video_frame_type_t from;
     av_render_video_frame_type_t to;
     int                          width;
     int                          height;
+    const clr_coef_t            *coef;
+    const clr_ref_coef_t        *ref_coef;
+    bool                         reference;
+    int                          out_width;
+    int                          out_height;
+    bool                         scaling;
+    av_render_video_scale_mode_t scale_mode;
+    clr_scale_map_t             *x_map;
+    clr_scale_map_t             *uv_x_map;
+    uint32_t                    *box_recip;
+    uint8_t                      worker_num;
+    clr_worker_t                 workers[COLOR_CONVERT_MAX_WORKERS];
+    media_lib_event_grp_handle_t worker_event;
+    int                          main_rows;
+    uint8_t                     *stripe_src;
+    uint8_t                     *stripe_dst;
+    bool                         stripe_quit;
 #if CONFIG_IDF_TARGET_ESP32P4
     esp_imgfx_color_convert_handle_t convert_hd;
 #endif
-} color_convert_t;
+};
 
-static int get_table_size(av_render_video_frame_type_t from, av_render_video_frame_type_t to)
+static inline int round_q16(int32_t v)
 {
-    if (from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
-        return 256 * 256 * 2;
-    }
-    if (from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
-        return 256 * 256 * 2;
+    // Arithmetic shift rounds half up for negative value also
+    return (int)((v + CLR_Q16_ROUND) >> 16);
+}
+
+/* Quantize 8bit value to 5 or 6 bits with rounding */
+static inline uint16_t quantize_bits(int v, int bits)
+{
+    int max = (1 << bits) - 1;
+    v = COLOR_LIMIT(v);
+    return (uint16_t)((v * max + 127) / 255);
+}
+
+static inline uint16_t rgb565_pack(int r, int g, int b)
+{
+    return (quantize_bits(r, 5) << 11) | (quantize_bits(g, 6) << 5) | quantize_bits(b, 5);
+}
+
+static inline uint16_t swap16(uint16_t v)
+{
+    return (v >> 8) | (v << 8);
+}
+
+/* Chroma term divided by luma gain with rounding, keep `frac_bits` fraction bits */
+static inline int16_t chroma_in_luma(int32_t coef, int c, int frac_bits)
+{
+    int64_t v = (int64_t)coef * c * (1 << frac_bits);
+    return (int16_t)((v + (v >= 0 ? CLR_COEF_Y / 2 : -CLR_COEF_Y / 2)) / CLR_COEF_Y);
+}
+
+static bool need_table(av_render_video_frame_type_t from, av_render_video_frame_type_t to)
+{
+    if (from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 &&
+        (to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE || to == AV_RENDER_VIDEO_RAW_TYPE_RGB565)) {
+        return true;
     }
-    return 0;
+    return false;
 }
 
 static int init_table(color_convert_t *convert)
 {
-    uint16_t *table16 = (uint16_t *)convert->table;
-    if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
-        for (int u0 = 0; u0 < 32; u0++) {
-            for (int v0 = 0; v0 < 32; v0++) {
-                for (int y0 = 0; y0 < 64; y0++) {
-                    int idx = (y0 << 10) + (u0 << 5) + v0;
-                    int y = (y0 << 2) + (y0 & 0x3);
-                    int u = (u0 << 3) + (y0 & 0x7);
-                    int v = (v0 << 3) + (v0 & 0x7);
-                    y -= 16;
-                    u -= 128;
-                    v -= 128;
-                    uint16_t r = (YUV2RO(y, u, v) >> 3) & 0x1f;
-                    uint16_t g = (YUV2GO(y, u, v) >> 2) & 0x3f;
-                    uint16_t b = (YUV2BO(y, u, v) >> 3) & 0x1f;
-                    table16[idx] = RGB565(r, g, b);
-                    table16[idx] = (table16[idx] >> 8) | (table16[idx] << 8);
-                }
-            }
+    clr_table_t *table = convert->table;
+    const clr_coef_t *coef = convert->coef;
+    bool be = (convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE);
+    for (int i = 0; i < CLR_TAB_SIZE; i++) {
+        int v = round_q16(CLR_COEF_Y * (i - CLR_TAB_OFFSET - 16));
+        // Endian swap is baked in so channels can be ORed directly
+        table->r[i] = rgb565_pack(v, 0, 0);
+        table->g[i] = rgb565_pack(0, v, 0);
+        table->b[i] = rgb565_pack(0, 0, v);
+        if (be) {
+            table->r[i] = swap16(table->r[i]);
+            table->g[i] = swap16(table->g[i]);
+            table->b[i] = swap16(table->b[i]);
         }
     }
-    if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
-        for (int u0 = 0; u0 < 32; u0++) {
-            for (int v0 = 0; v0 < 32; v0++) {
-                for (int y0 = 0; y0 < 64; y0++) {
-                    int idx = (y0 << 10) + (u0 << 5) + v0;
-                    int y = (y0 << 2) + (y0 & 0x3);
-                    int u = (u0 << 3) + (y0 & 0x7);
-                    int v = (v0 << 3) + (v0 & 0x7);
-                    y -= 16;
-                    u -= 128;
-                    v -= 128;
-                    uint16_t r = (YUV2RO(y, u, v) >> 3) & 0x1f;
-                    uint16_t g = (YUV2GO(y, u, v) >> 2) & 0x3f;
-                    uint16_t b = (YUV2BO(y, u, v) >> 3) & 0x1f;
-                    table16[idx] = RGB565(r, g, b);
-                }
-            }
-        }
+    // Keep fraction bits for green which sums 2 chroma terms
+    for (int i = 0; i < 256; i++) {
+        table->rv[i] = chroma_in_luma(coef->rv, i - 128, 0);
+        table->gu[i] = chroma_in_luma(coef->gu, i - 128, CLR_GREEN_FRAC_BITS);
+        table->gv[i] = chroma_in_luma(coef->gv, i - 128, CLR_GREEN_FRAC_BITS);
+        table->bu[i] = chroma_in_luma(coef->bu, i - 128, 0);
     }
     return 0;
 }
@@ -119,6 +219,331 @@ int convert_table_get_image_size(av_render_video_frame_type_t fmt, int width, in
     return 0;
 }
 
+/* Convert one pixel through tables, same math as `yuv_quad_to_rgb565` */
+static inline uint16_t yuv_to_rgb565_table(clr_table_t *table, int y, int u, int v)
+{
+    int guv = (table->gu[u] + table->gv[v] + CLR_GREEN_ROUND) >> CLR_GREEN_FRAC_BITS;
+    return table->r[CLR_TAB_OFFSET + y + table->rv[v]] | table->g[CLR_TAB_OFFSET + y + guv] |
+           table->b[CLR_TAB_OFFSET + y + table->bu[u]];
+}
+
+static inline uint16_t yuv_to_rgb565_reference(color_convert_t *convert, int y, int u, int v)
+{
+    const clr_ref_coef_t *coef = convert->ref_coef;
+    int64_t c = coef->y * (y - 16) + CLR_Q32_ROUND;
+    int d = u - 128;
+    int e = v - 128;
+    int r = (int)((c + coef->rv * e) >> 32);
+    int g = (int)((c + coef->gu * d + coef->gv * e) >> 32);
+    int b = (int)((c + coef->bu * d) >> 32);
+    uint16_t pixel = rgb565_pack(r, g, b);
+    return (convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) ? swap16(pixel) : pixel;
+}
+
+/* Convert two horizontal pixels sharing chroma, packed as one little-endian word */
+static inline uint32_t yuv_pair_to_rgb565(const uint16_t *r, const uint16_t *g, const uint16_t *b, const uint8_t *y)
+{
+    uint32_t p0 = r[y[0]] | g[y[0]] | b[y[0]];
+    uint32_t p1 = r[y[1]] | g[y[1]] | b[y[1]];
+    return p0 | (p1 << 16);
+}
+
+/* Convert 2x2 pixels which share one chroma sample */
+static inline void yuv_quad_to_rgb565(clr_table_t *table, const uint8_t *y0, const uint8_t *y1,
+                                      uint8_t u, uint8_t v, uint32_t *d0, uint32_t *d1)
+{
+    // Offset tables by chroma term once, then index by luma directly
+    const uint16_t *r = table->r + CLR_TAB_OFFSET + table->rv[v];
+    const uint16_t *g = table->g + CLR_TAB_OFFSET + ((table->gu[u] + table->gv[v] + CLR_GREEN_ROUND) >> CLR_GREEN_FRAC_BITS);
+    const uint16_t *b = table->b + CLR_TAB_OFFSET + table->bu[u];
+    *d0 = yuv_pair_to_rgb565(r, g, b, y0);
+    *d1 = yuv_pair_to_rgb565(r, g, b, y1);
+}
+
+/* Table driven path, process 2 rows and 8 columns (16 pixels) each iteration */
+static void yuv420_to_rgb565(color_convert_t *convert, uint8_t *src, uint8_t *dst, int row_start, int row_end)
+{
+    int width = convert->width;
+    int height = convert->height;
+    int uv_width = width >> 1;
+    uint8_t *y_plane = src;
+    uint8_t *u_plane = src + (width * height);
+    uint8_t *v_plane = u_plane + (width * height / 4);
+    clr_table_t *table = convert->table;
+    for (int i = row_start; i < row_end; i += 2) {
+        const uint8_t *y0 = y_plane + i * width;
+        uint32_t *d0 = (uint32_t *)(dst + i * width * 2);
+        // Odd height: convert last row twice into same place
+        const uint8_t *y1 = (i + 1 < row_end) ? y0 + width : y0;
+        uint32_t *d1 = (i + 1 < row_end) ? d0 + uv_width : d0;
+        const uint8_t *u = u_plane + (i >> 1) * uv_width;
+        const uint8_t *v = v_plane + (i >> 1) * uv_width;
+        int x = 0;
+        for (; x + 4 <= uv_width; x += 4) {
+            yuv_quad_to_rgb565(table, y0 + 2 * x, y1 + 2 * x, u[x], v[x], d0 + x, d1 + x);
+            yuv_quad_to_rgb565(table, y0 + 2 * x + 2, y1 + 2 * x + 2, u[x + 1], v[x + 1], d0 + x + 1, d1 + x + 1);
+            yuv_quad_to_rgb565(table, y0 + 2 * x + 4, y1 + 2 * x + 4, u[x + 2], v[x + 2], d0 + x + 2, d1 + x + 2);
+            yuv_quad_to_rgb565(table, y0 + 2 * x + 6, y1 + 2 * x + 6, u[x + 3], v[x + 3], d0 + x + 3, d1 + x + 3);
+        }
+        for (; x < uv_width; x++) {
+            yuv_quad_to_rgb565(table, y0 + 2 * x, y1 + 2 * x, u[x], v[x], d0 + x, d1 + x);
+        }
+    }
+}
+
+/* Reference path, full Q32 precision per pixel without intermediate rounding */
+static void yuv420_to_rgb565_reference(color_convert_t *convert, uint8_t *src, uint8_t *dst, int row_start, int row_end)
+{
+    int width = convert->width;
+    int height = convert->height;
+    int uv_width = width >> 1;
+    uint8_t *u_plane = src + (width * height);
+    uint8_t *v_plane = u_plane + (width * height / 4);
+    uint16_t *rgb565 = (uint16_t *)dst + row_start * width;
+    for (int i = row_start; i < row_end; i++) {
+        const uint8_t *y_row = src + i * width;
+        const uint8_t *u = u_plane + (i >> 1) * uv_width;
+        const uint8_t *v = v_plane + (i >> 1) * uv_width;
+        for (int j = 0; j < width; j++) {
+            *(rgb565++) = yuv_to_rgb565_reference(convert, y_row[j], u[j >> 1], v[j >> 1]);
+        }
+    }
+}
+
+static void get_scale_map(clr_scale_map_t *map, int dst_pos, int src_len, int dst_len, av_render_video_scale_mode_t mode)
+{
+    if (mode == AV_RENDER_VIDEO_SCALE_BILINEAR) {
+        // Align pixel centers: src = (dst + 0.5) * src_len / dst_len - 0.5 in Q8
+        int pos = (int)(((int64_t)(2 * dst_pos + 1) * src_len * 128) / dst_len) - 128;
+        if (pos < 0) {
+            pos = 0;
+        }
+        map->pos = pos >> 8;
+        map->num = pos & 0xFF;
+        if (map->pos >= src_len - 1) {
+            map->pos = src_len - 1;
+            map->num = 0;
+        }
+    } else if (mode == AV_RENDER_VIDEO_SCALE_BOX) {
+        int start = dst_pos * src_len / dst_len;
+        int end = (dst_pos + 1) * src_len / dst_len;
+        map->pos = start;
+        map->num = end > start ? end - start : 1;
+    } else {
+        map->pos = (2 * dst_pos + 1) * src_len / (2 * dst_len);
+        map->num = 0;
+    }
+}
+
+static inline int bilinear_sample(const uint8_t *r0, const uint8_t *r1, clr_scale_map_t *x, int fy)
+{
+    int x1 = x->num ? x->pos + 1 : x->pos;
+    int a = r0[x->pos] * (256 - x->num) + r0[x1] * x->num;
+    int b = r1[x->pos] * (256 - x->num) + r1[x1] * x->num;
+    return (a * (256 - fy) + b * fy + (1 << 15)) >> 16;
+}
+
+static inline int box_sample(const uint8_t *row, int stride, clr_scale_map_t *x, clr_scale_map_t *y, uint32_t *recip)
+{
+    const uint8_t *p = row + x->pos;
+    uint32_t sum = 0;
+    for (int i = 0; i < y->num; i++) {
+        for (int j = 0; j < x->num; j++) {
+            sum += p[j];
+        }
+        p += stride;
+    }
+    return (sum * recip[x->num * y->num] + (1 << 15)) >> 16;
+}
+
+/* Scale and convert output rows [row_start, row_end), source is only read at sampled positions */
+static void scale_yuv420_to_rgb565(color_convert_t *convert, uint8_t *src, uint8_t *dst, int row_start, int row_end)
+{
+    int width = convert->width;
+    int height = convert->height;
+    int uv_width = width >> 1;
+    int uv_height = height >> 1;
+    uint8_t *u_plane = src + (width * height);
+    uint8_t *v_plane = u_plane + (width * height / 4);
+    clr_table_t *table = convert->table;
+    uint16_t *rgb565 = (uint16_t *)dst + row_start * convert->out_width;
+    for (int i = row_start; i < row_end; i++) {
+        clr_scale_map_t y_map, uv_y_map;
+        get_scale_map(&y_map, i, height, convert->out_height, convert->scale_mode);
+        get_scale_map(&uv_y_map, i, uv_height, convert->out_height, convert->scale_mode);
+        const uint8_t *y0 = src + y_map.pos * width;
+        const uint8_t *u0 = u_plane + uv_y_map.pos * uv_width;
+        const uint8_t *v0 = v_plane + uv_y_map.pos * uv_width;
+        // Next rows for bilinear
+        const uint8_t *y1 = y_map.num ? y0 + width : y0;
+        const uint8_t *u1 = uv_y_map.num ? u0 + uv_width : u0;
+        const uint8_t *v1 = uv_y_map.num ? v0 + uv_width : v0;
+        if (convert->scale_mode == AV_RENDER_VIDEO_SCALE_NEAREST) {
+            u0 = u_plane + (y_map.pos >> 1) * uv_width;
+            v0 = v_plane + (y_map.pos >> 1) * uv_width;
+        }
+        for (int j = 0; j < convert->out_width; j++) {
+            clr_scale_map_t *x = &convert->x_map[j];
+            clr_scale_map_t *uv_x = &convert->uv_x_map[j];
+            int y, u, v;
+            if (convert->scale_mode == AV_RENDER_VIDEO_SCALE_BILINEAR) {
+                y = bilinear_sample(y0, y1, x, y_map.num);
+                u = bilinear_sample(u0, u1, uv_x, uv_y_map.num);
+                v = bilinear_sample(v0, v1, uv_x, uv_y_map.num);
+            } else if (convert->scale_mode == AV_RENDER_VIDEO_SCALE_BOX) {
+                y = box_sample(y0, width, x, &y_map, convert->box_recip);
+                u = box_sample(u0, uv_width, uv_x, &uv_y_map, convert->box_recip);
+                v = box_sample(v0, uv_width, uv_x, &uv_y_map, convert->box_recip);
+            } else {
+                y = y0[x->pos];
+                u = u0[x->pos >> 1];
+                v = v0[x->pos >> 1];
+            }
+            *(rgb565++) = table ? yuv_to_rgb565_table(table, y, u, v) : yuv_to_rgb565_reference(convert, y, u, v);
+        }
+    }
+}
+
+static int init_scale(color_convert_t *convert)
+{
+    int out_width = convert->out_width;
+    convert->x_map = (clr_scale_map_t *)media_lib_malloc(sizeof(clr_scale_map_t) * out_width * 2);
+    if (convert->x_map == NULL) {
+        return -1;
+    }
+    convert->uv_x_map = convert->x_map + out_width;
+    for (int i = 0; i < out_width; i++) {
+        get_scale_map(&convert->x_map[i], i, convert->width, out_width, convert->scale_mode);
+        get_scale_map(&convert->uv_x_map[i], i, convert->width >> 1, out_width, convert->scale_mode);
+    }
+    if (convert->scale_mode == AV_RENDER_VIDEO_SCALE_BOX) {
+        // Reciprocal of box area in Q16 avoid division per sample
+        int max_w = (convert->width + out_width - 1) / out_width + 1;
+        int max_h = (convert->height + convert->out_height - 1) / convert->out_height + 1;
+        int max_area = max_w * max_h;
+        convert->box_recip = (uint32_t *)media_lib_malloc(sizeof(uint32_t) * (max_area + 1));
+        if (convert->box_recip == NULL) {
+            return -1;
+        }
+        convert->box_recip[0] = 0;
+        for (int i = 1; i <= max_area; i++) {
+            convert->box_recip[i] = ((1 << 16) + i / 2) / i;
+        }
+    }
+    return 0;
+}
+
+static void convert_yuv420_to_rgb565_rows(color_convert_t *convert, uint8_t *src, uint8_t *dst, int row_start, int row_end)
+{
+    if (row_start >= row_end) {
+        return;
+    }
+    if (convert->scaling) {
+        scale_yuv420_to_rgb565(convert, src, dst, row_start, row_end);
+        return;
+    }
+    // Word store need 4 bytes aligned output, path decided by frame base so all stripes match
+    if (convert->reference || convert->table == NULL || ((uintptr_t)dst & 3) || (convert->width & 1)) {
+        yuv420_to_rgb565_reference(convert, src, dst, row_start, row_end);
+    } else {
+        yuv420_to_rgb565(convert, src, dst, row_start, row_end);
+    }
+}
+
+/* Worker converts its own stripe each time kicked by caller thread */
+static void clr_worker_thread(void *arg)
+{
+    clr_worker_t *worker = (clr_worker_t *)arg;
+    color_convert_t *convert = worker->convert;
+    uint32_t start_bit = CLR_WORKER_START_BIT(worker->index);
+    while (1) {
+        media_lib_event_group_wait_bits(convert->worker_event, start_bit, MEDIA_LIB_MAX_LOCK_TIME);
+        media_lib_event_group_clr_bits(convert->worker_event, start_bit);
+        if (convert->stripe_quit) {
+            break;
+        }
+        convert_yuv420_to_rgb565_rows(convert, convert->stripe_src, convert->stripe_dst,
+                                      worker->row_start, worker->row_end);
+        media_lib_event_group_set_bits(convert->worker_event, CLR_WORKER_DONE_BIT(worker->index));
+    }
+    media_lib_event_group_set_bits(convert->worker_event, CLR_WORKER_DONE_BIT(worker->index));
+    media_lib_thread_destroy(NULL);
+}
+
+static uint32_t get_worker_bits(color_convert_t *convert, bool start)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < convert->worker_num; i++) {
+        bits |= start ? CLR_WORKER_START_BIT(i) : CLR_WORKER_DONE_BIT(i);
+    }
+    return bits;
+}
+
+static void stop_workers(color_convert_t *convert)
+{
+    if (convert->worker_num == 0) {
+        return;
+    }
+    convert->stripe_quit = true;
+    media_lib_event_group_set_bits(convert->worker_event, get_worker_bits(convert, true));
+    uint32_t done_bits = get_worker_bits(convert, false);
+    media_lib_event_group_wait_bits(convert->worker_event, done_bits, MEDIA_LIB_MAX_LOCK_TIME);
+    convert->worker_num = 0;
+}
+
+/* Split frame into horizontal stripes, caller thread converts first stripe */
+static int start_workers(color_convert_t *convert, uint8_t worker_num)
+{
+    if (worker_num > COLOR_CONVERT_MAX_WORKERS) {
+        worker_num = COLOR_CONVERT_MAX_WORKERS;
+    }
+    // Stripe row must be even to keep chroma rows inside one stripe
+    int height = convert->out_height;
+    int rows = ((height + worker_num) / (worker_num + 1) + 1) & ~1;
+    convert->main_rows = rows < height ? rows : height;
+    if (media_lib_event_group_create(&convert->worker_event) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < worker_num; i++) {
+        clr_worker_t *worker = &convert->workers[i];
+        worker->convert = convert;
+        worker->index = i;
+        worker->row_start = rows * (i + 1);
+        worker->row_end = rows * (i + 2);
+        if (worker->row_start > height) {
+            worker->row_start = height;
+        }
+        if (worker->row_end > height || i == worker_num - 1) {
+            worker->row_end = height;
+        }
+        if (media_lib_thread_create_from_scheduler(&worker->thread, "ClrCvt", clr_worker_thread, worker) != 0) {
+            ESP_LOGE(TAG, "Fail to create convert worker %d", i);
+            break;
+        }
+        convert->worker_num++;
+    }
+    if (convert->worker_num != worker_num) {
+        stop_workers(convert);
+        return -1;
+    }
+    return 0;
+}
+
+static void convert_yuv420_to_rgb565(color_convert_t *convert, uint8_t *src, uint8_t *dst)
+{
+    if (convert->worker_num == 0) {
+        convert_yuv420_to_rgb565_rows(convert, src, dst, 0, convert->out_height);
+        return;
+    }
+    convert->stripe_src = src;
+    convert->stripe_dst = dst;
+    media_lib_event_group_set_bits(convert->worker_event, get_worker_bits(convert, true));
+    convert_yuv420_to_rgb565_rows(convert, src, dst, 0, convert->main_rows);
+    uint32_t done_bits = get_worker_bits(convert, false);
+    media_lib_event_group_wait_bits(convert->worker_event, done_bits, MEDIA_LIB_MAX_LOCK_TIME);
+    media_lib_event_group_clr_bits(convert->worker_event, done_bits);
+}
+
 color_convert_table_t init_convert_table(color_convert_cfg_t *cfg)
 {
     color_convert_t *convert = (color_convert_t *)calloc(1, sizeof(color_convert_t));
@@ -130,8 +555,16 @@ color_convert_table_t init_convert_table(color_convert_cfg_t *cfg)
         convert->to = cfg->to;
         convert->width = cfg->width;
         convert->height = cfg->height;
+        convert->reference = cfg->reference;
+        convert->coef = (cfg->std == AV_RENDER_VIDEO_COLOR_STD_BT709) ? &bt709_coef : &bt601_coef;
+        convert->ref_coef = (cfg->std == AV_RENDER_VIDEO_COLOR_STD_BT709) ? &bt709_ref_coef : &bt601_ref_coef;
+        convert->out_width = cfg->out_width ? cfg->out_width : cfg->width;
+        convert->out_height = cfg->out_height ? cfg->out_height : cfg->height;
+        convert->scale_mode = cfg->scale_mode;
+        convert->scaling = (convert->out_width != convert->width || convert->out_height != convert->height);
 #if CONFIG_IDF_TARGET_ESP32P4
-        if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
+        if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565 &&
+            convert->reference == false && convert->scaling == false) {
             esp_imgfx_color_convert_cfg_t convert_cfg = {
                 .in_res = {
                     .width = cfg->width,
@@ -139,7 +572,7 @@ color_convert_table_t init_convert_table(color_convert_cfg_t *cfg)
                 },
                 .in_pixel_fmt = ESP_IMGFX_PIXEL_FMT_I420,
                 .out_pixel_fmt = ESP_IMGFX_PIXEL_FMT_RGB565_LE,
-                .color_space_std = ESP_IMGFX_COLOR_SPACE_STD_BT709,
+                .color_space_std = (cfg->std == AV_RENDER_VIDEO_COLOR_STD_BT601) ? ESP_IMGFX_COLOR_SPACE_STD_BT601 : ESP_IMGFX_COLOR_SPACE_STD_BT709,
             };
             esp_imgfx_color_convert_open(&convert_cfg, &convert->convert_hd);
             if (convert->convert_hd == NULL) {
@@ -148,82 +581,63 @@ color_convert_table_t init_convert_table(color_convert_cfg_t *cfg)
             return (color_convert_table_t)convert;
         }
 #endif
-        int table_size = get_table_size(cfg->from, cfg->to);
-        if (table_size) {
-            convert->table = (uint8_t *)malloc(table_size);
+        if (need_table(cfg->from, cfg->to) && convert->reference == false) {
+            convert->table = (clr_table_t *)malloc(sizeof(clr_table_t));
             if (convert->table == NULL) {
                 break;
             }
+            init_table(convert);
+        }
+        if (convert->scaling) {
+            if (need_table(cfg->from, cfg->to) == false) {
+                ESP_LOGE(TAG, "Scale not supported from %d to %d", cfg->from, cfg->to);
+                break;
+            }
+            if (init_scale(convert) != 0) {
+                break;
+            }
+        }
+        if (cfg->workers && need_table(cfg->from, cfg->to) && start_workers(convert, cfg->workers) != 0) {
+            break;
         }
-        init_table(convert);
         return (color_convert_table_t)convert;
     } while (0);
     deinit_convert_table(convert);
     return NULL;
 }
 
-static void yuv420_to_rgb565(color_convert_t *convert, uint8_t *src, uint8_t *dst)
-{
-    uint8_t *y_plane = src;
-    uint8_t *u_plane = src + (convert->width * convert->height);
-    uint8_t *v_plane = src + (convert->width * convert->height * 5 / 4);
-    int y_pos = 0, u_pos = 0, rgb_idx = 0;
-    uint16_t *rgb565 = (uint16_t *)dst;
-    uint16_t *table16 = (uint16_t *)convert->table;
-    for (int i = 0; i < convert->height; i++) {
-        for (int j = 0; j < convert->width; j += 2) {
-            int y = y_plane[y_pos];
-            int u = u_plane[u_pos];
-            int v = v_plane[u_pos];
-            int y_idx = (y >> 2) << 10;
-            int uv_idx = ((u >> 3) << 5) + (v >> 3);
-
-            rgb565[rgb_idx++] = table16[y_idx + uv_idx];
-
-            y = y_plane[y_pos + 1];
-            y_idx = (y >> 2) << 10;
-            rgb565[rgb_idx++] = table16[y_idx + uv_idx];
-            y_pos += 2;
-            u_pos++;
-        }
-        // odd line not increase
-        if ((i & 1) == 0) {
-            u_pos -= convert->width >> 1;
-        }
-    }
-}
-
 int convert_color(color_convert_table_t table, uint8_t *src, int src_size, uint8_t *dst, int dst_size)
 {
     color_convert_t *convert = (color_convert_t *)table;
     if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
 #if CONFIG_IDF_TARGET_ESP32P4
-        esp_imgfx_data_t from_image = {
-            .data = src,
-            .data_len = src_size,
-        };
-        esp_imgfx_data_t to_image = {
-            .data = dst,
-            .data_len = dst_size,
-        };
-        esp_imgfx_color_convert_process(convert->convert_hd, &from_image, &to_image);
-        return 0;
-#else
+        if (convert->convert_hd) {
+            esp_imgfx_data_t from_image = {
+                .data = src,
+                .data_len = src_size,
+            };
+            esp_imgfx_data_t to_image = {
+                .data = dst,
+                .data_len = dst_size,
+            };
+            esp_imgfx_color_convert_process(convert->convert_hd, &from_image, &to_image);
+            return 0;
+        }
+#endif
         int src_need = convert->width * convert->height * 3 / 2;
-        int dst_need = convert->width * convert->height * 2;
+        int dst_need = convert->out_width * convert->out_height * 2;
         if (src_size != src_need || dst_size < dst_need) {
             ESP_LOGE(TAG, "size dismatch");
             return -1;
         }
-        yuv420_to_rgb565(convert, src, dst);
+        convert_yuv420_to_rgb565(convert, src, dst);
         return 0;
-#endif
     }
 
     switch (convert->from) {
         case AV_RENDER_VIDEO_RAW_TYPE_YUV420: {
             int src_need = convert->width * convert->height * 3 / 2;
-            int dst_need = convert->width * convert->height * 2;
+            int dst_need = convert->out_width * convert->out_height * 2;
             if (src_size != src_need || dst_size < dst_need) {
                 ESP_LOGE(TAG, "size dismatch");
                 return -1;
@@ -231,7 +645,7 @@ int convert_color(color_convert_table_t table, uint8_t *src, int src_size, uint8
             switch (convert->to) {
                 case AV_RENDER_VIDEO_RAW_TYPE_RGB565:
                 case AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE:
-                    yuv420_to_rgb565(convert, src, dst);
+                    convert_yuv420_to_rgb565(convert, src, dst);
                     break;
                 default:
                     ESP_LOGE(TAG, "Bad format to %d", convert->to);
@@ -250,6 +664,11 @@ void deinit_convert_table(color_convert_table_t t)
 {
     color_convert_t *convert = (color_convert_t *)t;
     if (convert) {
+        stop_workers(convert);
+        if (convert->worker_event) {
+            media_lib_event_group_destroy(convert->worker_event);
+            convert->worker_event = NULL;
+        }
 #if CONFIG_IDF_TARGET_ESP32P4
         if (convert->convert_hd) {
             esp_imgfx_color_convert_close(convert->convert_hd);
@@ -260,6 +679,14 @@ void deinit_convert_table(color_convert_table_t t)
             free(convert->table);
             convert->table = NULL;
         }
+        if (convert->x_map) {
+            media_lib_free(convert->x_map);
+            convert->x_map = NULL;
+        }
+        if (convert->box_recip) {
+            media_lib_free(convert->box_recip);
+            convert->box_recip = NULL;
+        }
         free(convert);
     }
 }
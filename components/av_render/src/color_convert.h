@@ -27,6 +27,8 @@
 
 #include "av_render_types.h"
 
+#define COLOR_CONVERT_MAX_WORKERS (3)
+
 typedef void *color_convert_table_t;
 
 typedef struct {
@@ -34,6 +36,13 @@ typedef struct {
     av_render_video_frame_type_t to;
     int                          width;
     int                          height;
+    av_render_video_color_std_t  std;       /*!< Color space standard */
+    bool                         reference; /*!< Use per-pixel full precision path, output is bit-exact to the standard */
+    uint8_t                      workers;   /*!< Extra threads (named "ClrCvt") to convert horizontal stripes in parallel
+                                                 Pin them to other core through thread scheduler, output is identical to 0 */
+    int                          out_width;  /*!< Output width, 0 or same as `width` to disable scale */
+    int                          out_height; /*!< Output height, 0 or same as `height` to disable scale */
+    av_render_video_scale_mode_t scale_mode; /*!< Scale mode fused into conversion */
 } color_convert_cfg_t;
 
 int convert_table_get_image_size(av_render_video_frame_type_t fmt, int width, int height);
@@ -0,0 +1,275 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "frame_pool.h"
+#include "media_lib_os.h"
+#include "esp_timer.h"
+
+#define FRAME_POOL_MAX_SLOT  (8)
+#define FRAME_POOL_FREE_BITS (1)
+
+typedef enum {
+    FRAME_SLOT_FREE,
+    FRAME_SLOT_DECODING,
+    FRAME_SLOT_READY,
+    FRAME_SLOT_DISPLAYING,
+} frame_slot_state_t;
+
+typedef struct {
+    uint8_t           *buffer;
+    int                cap;
+    frame_slot_state_t state;
+    uint32_t           seq;
+} frame_slot_t;
+
+typedef struct {
+    frame_slot_t                 slots[FRAME_POOL_MAX_SLOT];
+    uint8_t                      num;
+    bool                         latest;
+    bool                         aborted;
+    uint32_t                     seq;
+    media_lib_mutex_handle_t     lock;
+    media_lib_event_grp_handle_t event;
+    frame_pool_stat_t            stat;
+} frame_pool_t;
+
+frame_pool_handle_t frame_pool_create(uint8_t num, bool latest)
+{
+    if (num < 2) {
+        return NULL;
+    }
+    frame_pool_t *pool = (frame_pool_t *)media_lib_calloc(1, sizeof(frame_pool_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->num = num > FRAME_POOL_MAX_SLOT ? FRAME_POOL_MAX_SLOT : num;
+    pool->latest = latest;
+    media_lib_mutex_create(&pool->lock);
+    media_lib_event_group_create(&pool->event);
+    if (pool->lock == NULL || pool->event == NULL) {
+        frame_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static int find_slot(frame_pool_t *pool)
+{
+    int oldest = -1;
+    for (int i = 0; i < pool->num; i++) {
+        frame_slot_t *slot = &pool->slots[i];
+        if (slot->state == FRAME_SLOT_FREE) {
+            return i;
+        }
+        if (slot->state == FRAME_SLOT_READY && (oldest < 0 || (int32_t)(slot->seq - pool->slots[oldest].seq) < 0)) {
+            oldest = i;
+        }
+    }
+    if (pool->latest && oldest >= 0) {
+        // Display is behind, newer frame replaces oldest one not shown yet
+        pool->stat.dropped++;
+        return oldest;
+    }
+    return -1;
+}
+
+int frame_pool_acquire(frame_pool_handle_t h, int size, int align, uint8_t **data)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    if (pool == NULL || size <= 0 || data == NULL) {
+        return -1;
+    }
+    int64_t start = 0;
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    pool->stat.acquire_num++;
+    int idx;
+    while ((idx = find_slot(pool)) < 0 && pool->aborted == false) {
+        if (start == 0) {
+            start = esp_timer_get_time();
+            pool->stat.wait_num++;
+        }
+        // Clear under lock so that slot released after unlock is not missed
+        media_lib_event_group_clr_bits(pool->event, FRAME_POOL_FREE_BITS);
+        media_lib_mutex_unlock(pool->lock);
+        media_lib_event_group_wait_bits(pool->event, FRAME_POOL_FREE_BITS, MEDIA_LIB_MAX_LOCK_TIME);
+        media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    }
+    if (start) {
+        uint32_t cost = (uint32_t)(esp_timer_get_time() - start);
+        pool->stat.wait_total += cost;
+        if (cost > pool->stat.wait_max) {
+            pool->stat.wait_max = cost;
+        }
+    }
+    if (idx < 0) {
+        media_lib_mutex_unlock(pool->lock);
+        return -1;
+    }
+    frame_slot_t *slot = &pool->slots[idx];
+    slot->state = FRAME_SLOT_DECODING;
+    media_lib_mutex_unlock(pool->lock);
+    // Slot is owned by producer now, grow it outside lock
+    if (align < 1) {
+        align = 1;
+    }
+    if (slot->cap < size + align) {
+        if (slot->buffer) {
+            media_lib_free(slot->buffer);
+        }
+        slot->buffer = (uint8_t *)media_lib_malloc(size + align);
+        slot->cap = slot->buffer ? size + align : 0;
+        if (slot->buffer == NULL) {
+            frame_pool_cancel(pool, idx);
+            return -1;
+        }
+    }
+    align -= 1;
+    *data = (uint8_t *)(((uintptr_t)slot->buffer + align) & ~(uintptr_t)align);
+    return idx;
+}
+
+uint32_t frame_pool_submit(frame_pool_handle_t h, int slot)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    uint32_t seq = ++pool->seq;
+    pool->slots[slot].seq = seq;
+    pool->slots[slot].state = FRAME_SLOT_READY;
+    media_lib_mutex_unlock(pool->lock);
+    return seq;
+}
+
+static void release_slot(frame_pool_t *pool, int slot)
+{
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    pool->slots[slot].state = FRAME_SLOT_FREE;
+    media_lib_event_group_set_bits(pool->event, FRAME_POOL_FREE_BITS);
+    media_lib_mutex_unlock(pool->lock);
+}
+
+void frame_pool_cancel(frame_pool_handle_t h, int slot)
+{
+    release_slot((frame_pool_t *)h, slot);
+}
+
+bool frame_pool_lock(frame_pool_handle_t h, int slot, uint32_t seq)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    if (slot < 0 || slot >= pool->num) {
+        return false;
+    }
+    bool locked = false;
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    frame_slot_t *cur = &pool->slots[slot];
+    // Sequence mismatch means frame was reclaimed by producer, reference is stale
+    if (cur->state == FRAME_SLOT_DISPLAYING && cur->seq == seq) {
+        // Still held by consumer (paused), show it again
+        locked = true;
+    } else if (cur->state == FRAME_SLOT_READY && cur->seq == seq) {
+        locked = true;
+        if (pool->latest) {
+            for (int i = 0; i < pool->num; i++) {
+                if (pool->slots[i].state == FRAME_SLOT_READY && (int32_t)(pool->slots[i].seq - seq) > 0) {
+                    // Newer frame waiting, skip this one to catch up
+                    locked = false;
+                    break;
+                }
+            }
+        }
+        if (locked) {
+            cur->state = FRAME_SLOT_DISPLAYING;
+        } else {
+            cur->state = FRAME_SLOT_FREE;
+            pool->stat.dropped++;
+            media_lib_event_group_set_bits(pool->event, FRAME_POOL_FREE_BITS);
+        }
+    }
+    media_lib_mutex_unlock(pool->lock);
+    return locked;
+}
+
+void frame_pool_unlock(frame_pool_handle_t h, int slot)
+{
+    release_slot((frame_pool_t *)h, slot);
+}
+
+void frame_pool_flush(frame_pool_handle_t h, bool displaying)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    if (pool == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    for (int i = 0; i < pool->num; i++) {
+        if (pool->slots[i].state == FRAME_SLOT_READY || (displaying && pool->slots[i].state == FRAME_SLOT_DISPLAYING)) {
+            pool->slots[i].state = FRAME_SLOT_FREE;
+        }
+    }
+    media_lib_event_group_set_bits(pool->event, FRAME_POOL_FREE_BITS);
+    media_lib_mutex_unlock(pool->lock);
+}
+
+void frame_pool_abort(frame_pool_handle_t h)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    if (pool == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    pool->aborted = true;
+    media_lib_event_group_set_bits(pool->event, FRAME_POOL_FREE_BITS);
+    media_lib_mutex_unlock(pool->lock);
+}
+
+void frame_pool_get_stat(frame_pool_handle_t h, frame_pool_stat_t *stat, bool reset)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    *stat = pool->stat;
+    if (reset) {
+        memset(&pool->stat, 0, sizeof(frame_pool_stat_t));
+    }
+    media_lib_mutex_unlock(pool->lock);
+}
+
+void frame_pool_destroy(frame_pool_handle_t h)
+{
+    frame_pool_t *pool = (frame_pool_t *)h;
+    if (pool == NULL) {
+        return;
+    }
+    for (int i = 0; i < pool->num; i++) {
+        if (pool->slots[i].buffer) {
+            media_lib_free(pool->slots[i].buffer);
+        }
+    }
+    if (pool->event) {
+        media_lib_event_group_destroy(pool->event);
+    }
+    if (pool->lock) {
+        media_lib_mutex_destroy(pool->lock);
+    }
+    media_lib_free(pool);
+}
@@ -0,0 +1,82 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Decoder output frame buffer pool
+ * Each slot is owned by one side at a time: free -> decoding (producer) -> ready -> displaying (consumer) -> free
+ * Ready frames are identified by slot and sequence, a frame reclaimed by latest-wins mode gets new sequence
+ * so that consumer can detect stale reference and skip it
+ */
+typedef void *frame_pool_handle_t;
+
+typedef struct {
+    uint32_t acquire_num;
+    uint32_t wait_num;     /*!< Acquires which had to wait for free slot */
+    uint64_t wait_total;   /*!< Total wait time (unit us) */
+    uint32_t wait_max;     /*!< Maximum wait time (unit us) */
+    uint32_t dropped;      /*!< Ready frames reclaimed before display */
+} frame_pool_stat_t;
+
+/*
+ * In latest-wins mode producer never waits once `num` >= 3 (one decoding, one displaying, one ready)
+ */
+frame_pool_handle_t frame_pool_create(uint8_t num, bool latest);
+
+int frame_pool_acquire(frame_pool_handle_t h, int size, int align, uint8_t **data);
+
+uint32_t frame_pool_submit(frame_pool_handle_t h, int slot);
+
+void frame_pool_cancel(frame_pool_handle_t h, int slot);
+
+bool frame_pool_lock(frame_pool_handle_t h, int slot, uint32_t seq);
+
+void frame_pool_unlock(frame_pool_handle_t h, int slot);
+
+/*
+ * Return ready frames to pool, frames held by consumer are returned also when `displaying` is set
+ * which is only safe when consumer is idle
+ */
+void frame_pool_flush(frame_pool_handle_t h, bool displaying);
+
+void frame_pool_abort(frame_pool_handle_t h);
+
+void frame_pool_get_stat(frame_pool_handle_t h, frame_pool_stat_t *stat, bool reset);
+
+void frame_pool_destroy(frame_pool_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
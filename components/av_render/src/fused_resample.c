@@ -0,0 +1,296 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include "fused_resample.h"
+#include "media_lib_os.h"
+
+// Taps of each polyphase branch, also history kept across frames
+#define FUSED_TAPS      (16)
+// Limit coefficient table to 16kB (e.g. 8k or 16k to 44.1k need 441 phases)
+#define FUSED_MAX_PHASE (512)
+// Cutoff relative to input Nyquist, keeps images of 8k voice away from 4k-5k region
+#define FUSED_CUTOFF    (0.85f)
+
+#define FUSED_PI        (3.14159265f)
+
+typedef struct {
+    uint8_t  in_ch;
+    uint8_t  out_ch;
+    uint8_t  filter_ch; /*!< Channels go through filter, stereo to mono is mixed before filter */
+    uint8_t  out_bytes;
+    uint32_t up;
+    uint32_t down;
+    int16_t *coef;      /*!< `up` branches, tap k of branch applies to x[idx - k] */
+    int16_t  hist[2][FUSED_TAPS];
+    uint32_t phase;
+    int32_t  idx;       /*!< Input index of next output relative to next frame */
+} fused_resample_t;
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool fused_resample_supported(av_render_audio_frame_info_t *in, av_render_audio_frame_info_t *out)
+{
+    if (in->bits_per_sample != 16 || in->sample_rate == 0 || out->sample_rate < in->sample_rate) {
+        return false;
+    }
+    if (out->bits_per_sample != 16 && out->bits_per_sample != 24 && out->bits_per_sample != 32) {
+        return false;
+    }
+    if (in->channel == 0 || in->channel > 2 || out->channel == 0 || out->channel > 2) {
+        return false;
+    }
+    return out->sample_rate / gcd(out->sample_rate, in->sample_rate) <= FUSED_MAX_PHASE;
+}
+
+static int gen_coef(fused_resample_t *f)
+{
+    int n = f->up * FUSED_TAPS;
+    f->coef = (int16_t *)media_lib_malloc(n * sizeof(int16_t));
+    if (f->coef == NULL) {
+        return -1;
+    }
+    // Blackman windowed sinc, each branch normalized to unity gain so that no DC ripple across phases
+    float center = (n - 1) / 2.0f;
+    for (int p = 0; p < (int)f->up; p++) {
+        float v[FUSED_TAPS];
+        float sum = 0;
+        for (int k = 0; k < FUSED_TAPS; k++) {
+            int j = p + k * f->up;
+            float x = FUSED_CUTOFF * (j - center) / f->up;
+            float s = (x == 0) ? 1.0f : sinf(FUSED_PI * x) / (FUSED_PI * x);
+            float w = 0.42f - 0.5f * cosf(2 * FUSED_PI * j / (n - 1)) + 0.08f * cosf(4 * FUSED_PI * j / (n - 1));
+            v[k] = s * w;
+            sum += v[k];
+        }
+        int16_t *c = f->coef + p * FUSED_TAPS;
+        int total = 0, peak = 0;
+        for (int k = 0; k < FUSED_TAPS; k++) {
+            c[k] = (int16_t)lrintf(v[k] / sum * 32768);
+            total += c[k];
+            if (c[k] > c[peak]) {
+                peak = k;
+            }
+        }
+        c[peak] += 32768 - total;
+    }
+    return 0;
+}
+
+fused_resample_handle_t fused_resample_open(av_render_audio_frame_info_t *in, av_render_audio_frame_info_t *out)
+{
+    if (fused_resample_supported(in, out) == false) {
+        return NULL;
+    }
+    fused_resample_t *f = (fused_resample_t *)media_lib_calloc(1, sizeof(fused_resample_t));
+    if (f == NULL) {
+        return NULL;
+    }
+    uint32_t g = gcd(out->sample_rate, in->sample_rate);
+    f->up = out->sample_rate / g;
+    f->down = in->sample_rate / g;
+    f->in_ch = in->channel;
+    f->out_ch = out->channel;
+    f->filter_ch = (out->channel == 1) ? 1 : in->channel;
+    f->out_bytes = out->bits_per_sample >> 3;
+    if (f->up != f->down && gen_coef(f) != 0) {
+        media_lib_free(f);
+        return NULL;
+    }
+    return f;
+}
+
+uint32_t fused_resample_get_max_out_sample(fused_resample_handle_t h, uint32_t in_sample)
+{
+    fused_resample_t *f = (fused_resample_t *)h;
+    return (uint32_t)((uint64_t)in_sample * f->up / f->down) + 2;
+}
+
+static inline int16_t sat16(int32_t v)
+{
+    v = (v + (1 << 14)) >> 15;
+    if (v > 32767) {
+        return 32767;
+    }
+    if (v < -32768) {
+        return -32768;
+    }
+    return (int16_t)v;
+}
+
+// Input sample of filter channel `c` at frame `i`, stereo to mono is averaged
+static inline int16_t src_sample(fused_resample_t *f, int16_t *x, int32_t i, int c)
+{
+    if (f->in_ch == f->filter_ch) {
+        return x[i * f->in_ch + c];
+    }
+    return (int16_t)((x[i * 2] + x[i * 2 + 1]) >> 1);
+}
+
+static inline uint8_t *store_sample(fused_resample_t *f, uint8_t *o, int16_t l, int16_t r)
+{
+    if (f->filter_ch == 1) {
+        r = l;
+    }
+    if (f->out_bytes == 2) {
+        int16_t *d = (int16_t *)o;
+        d[0] = l;
+        if (f->out_ch == 2) {
+            d[1] = r;
+        }
+    } else if (f->out_bytes == 4) {
+        int32_t *d = (int32_t *)o;
+        d[0] = (int32_t)l << 16;
+        if (f->out_ch == 2) {
+            d[1] = (int32_t)r << 16;
+        }
+    } else {
+        o[0] = 0;
+        o[1] = (uint8_t)l;
+        o[2] = (uint8_t)(l >> 8);
+        if (f->out_ch == 2) {
+            o[3] = 0;
+            o[4] = (uint8_t)r;
+            o[5] = (uint8_t)(r >> 8);
+        }
+    }
+    return o + f->out_bytes * f->out_ch;
+}
+
+static void convert_no_rate(fused_resample_t *f, int16_t *x, uint32_t in_sample, uint8_t *o)
+{
+    // Common 16 bits cases handled directly so that compiler can vectorize them
+    if (f->out_bytes == 2) {
+        int16_t *d = (int16_t *)o;
+        if (f->in_ch == 1 && f->out_ch == 2) {
+            for (uint32_t i = 0; i < in_sample; i++) {
+                d[2 * i] = d[2 * i + 1] = x[i];
+            }
+            return;
+        }
+        if (f->in_ch == 2 && f->out_ch == 1) {
+            for (uint32_t i = 0; i < in_sample; i++) {
+                d[i] = (int16_t)((x[2 * i] + x[2 * i + 1]) >> 1);
+            }
+            return;
+        }
+    }
+    for (uint32_t i = 0; i < in_sample; i++) {
+        o = store_sample(f, o, src_sample(f, x, i, 0), f->filter_ch == 2 ? src_sample(f, x, i, 1) : 0);
+    }
+}
+
+static void update_hist(fused_resample_t *f, int16_t *x, uint32_t in_sample)
+{
+    int keep = FUSED_TAPS - 1;
+    for (int c = 0; c < f->filter_ch; c++) {
+        int16_t *hist = f->hist[c];
+        int start = 0;
+        if ((int)in_sample < keep) {
+            start = keep - in_sample;
+            memmove(hist, hist + in_sample, start * sizeof(int16_t));
+        }
+        for (int j = start; j < keep; j++) {
+            hist[j] = src_sample(f, x, (int32_t)in_sample - keep + j, c);
+        }
+    }
+}
+
+uint32_t fused_resample_process(fused_resample_handle_t h, uint8_t *in, uint32_t in_sample, uint8_t *out)
+{
+    fused_resample_t *f = (fused_resample_t *)h;
+    int16_t *x = (int16_t *)in;
+    uint8_t *o = out;
+    if (f->up == f->down) {
+        convert_no_rate(f, x, in_sample, o);
+        return in_sample;
+    }
+    uint32_t out_sample = 0;
+    int32_t idx = f->idx;
+    uint32_t phase = f->phase;
+    int stride = f->in_ch;
+    while (idx < (int32_t)in_sample) {
+        const int16_t *c = f->coef + phase * FUSED_TAPS;
+        int32_t acc[2] = { 0, 0 };
+        if (idx >= FUSED_TAPS - 1) {
+            // Read input directly, newest sample first
+            int16_t *s = x + idx * stride;
+            if (f->filter_ch == stride) {
+                for (int k = 0; k < FUSED_TAPS; k++) {
+                    acc[0] += s[-k * stride] * c[k];
+                }
+                if (stride == 2) {
+                    for (int k = 0; k < FUSED_TAPS; k++) {
+                        acc[1] += s[-k * 2 + 1] * c[k];
+                    }
+                }
+            } else {
+                for (int k = 0; k < FUSED_TAPS; k++) {
+                    acc[0] += ((s[-k * 2] + s[-k * 2 + 1]) >> 1) * c[k];
+                }
+            }
+        } else {
+            // Window crosses frame boundary, take older samples from history
+            for (int ch = 0; ch < f->filter_ch; ch++) {
+                for (int k = 0; k < FUSED_TAPS; k++) {
+                    int32_t i = idx - k;
+                    int16_t v = (i >= 0) ? src_sample(f, x, i, ch) : f->hist[ch][FUSED_TAPS - 1 + i];
+                    acc[ch] += v * c[k];
+                }
+            }
+        }
+        o = store_sample(f, o, sat16(acc[0]), sat16(acc[1]));
+        out_sample++;
+        phase += f->down;
+        if (phase >= f->up) {
+            phase -= f->up;
+            idx++;
+        }
+    }
+    f->idx = idx - (int32_t)in_sample;
+    f->phase = phase;
+    update_hist(f, x, in_sample);
+    return out_sample;
+}
+
+void fused_resample_close(fused_resample_handle_t h)
+{
+    fused_resample_t *f = (fused_resample_t *)h;
+    if (f == NULL) {
+        return;
+    }
+    if (f->coef) {
+        media_lib_free(f->coef);
+    }
+    media_lib_free(f);
+}
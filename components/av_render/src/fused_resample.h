@@ -0,0 +1,55 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef FUSED_RESAMPLE_H
+#define FUSED_RESAMPLE_H
+
+#include <stdbool.h>
+#include "av_render_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *fused_resample_handle_t;
+
+/*
+ * Fused path converts channel, bit depth and up sample rate in one pass without intermediate buffers
+ * Only 16 bits input of 1 or 2 channels with output rate not lower than input rate are supported
+ */
+bool fused_resample_supported(av_render_audio_frame_info_t *in, av_render_audio_frame_info_t *out);
+
+fused_resample_handle_t fused_resample_open(av_render_audio_frame_info_t *in, av_render_audio_frame_info_t *out);
+
+uint32_t fused_resample_get_max_out_sample(fused_resample_handle_t h, uint32_t in_sample);
+
+uint32_t fused_resample_process(fused_resample_handle_t h, uint8_t *in, uint32_t in_sample, uint8_t *out);
+
+void fused_resample_close(fused_resample_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,11 +23,13 @@
  */
 
 #include "video_decoder.h"
+#include "video_decoder_priv.h"
 #include "media_lib_os.h"
 #include "media_lib_err.h"
 #include "esp_log.h"
 #include "color_convert.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_video_dec.h"
 #include "esp_video_codec_utils.h"
 
@@ -50,6 +52,11 @@ typedef struct {
     uint8_t                     *raw_buffer;
     int                          raw_buffer_size;
     vdec_fb_cb_cfg_t             fb_cb;
+    uint8_t                      cvt_workers;
+    uint16_t                     out_width;
+    uint16_t                     out_height;
+    av_render_video_scale_mode_t scale_mode;
+    vdec_stat_t                  stat;
 } vdec_t;
 
 static esp_video_codec_type_t get_codec_type(av_render_video_codec_t codec)
@@ -151,12 +158,23 @@ static int do_decode(vdec_t *vdec, av_render_video_data_t *data, av_render_video
                 .height = frame_info.res.height,
                 .from = get_frame_type(vdec->dec_out_fmt),
                 .to = vdec->frame_info.type,
+                .workers = vdec->cvt_workers,
+                .out_width = vdec->out_width,
+                .out_height = vdec->out_height,
+                .scale_mode = vdec->scale_mode,
             };
             vdec->convert_table = init_convert_table(&color_cfg);
             if (vdec->convert_table == NULL) {
                 ESP_LOGE(TAG, "No memory for color convert from %d to %d", color_cfg.from, color_cfg.to);
                 return -1;
             }
+            // Scale is fused into color convert, report and allocate using output resolution
+            if (vdec->out_width && vdec->out_height) {
+                frame_info.res.width = vdec->out_width;
+                frame_info.res.height = vdec->out_height;
+                vdec->frame_info.width = vdec->out_width;
+                vdec->frame_info.height = vdec->out_height;
+            }
             vdec->raw_buffer_size = esp_video_codec_get_image_size(get_out_fmt(vdec->frame_info.type), &frame_info.res);
             /* Always allocate raw_buffer as fallback - fb_fetch may fail if data queue is too small */
             /* This ensures we have a buffer even if fb_fetch returns NULL */
@@ -186,7 +204,9 @@ static int do_decode(vdec_t *vdec, av_render_video_data_t *data, av_render_video
         decoded_frame.data = vdec->out_data;
     }
     decoded_frame.size = vdec->out_size;
+    int64_t start_time = esp_timer_get_time();
     ret = esp_video_dec_process(vdec->dec_handle, &in_frame, &decoded_frame);
+    int64_t decode_end = esp_timer_get_time();
     if (ret != ESP_VC_ERR_OK) {
         printf("Data size %d ", (int)data->size);
 #define CC(a) a[0], a[1], a[2], a[3]
@@ -206,6 +226,7 @@ static int do_decode(vdec_t *vdec, av_render_video_data_t *data, av_render_video
         }
         return ret;
     }
+    vdec_stage_time_add(&vdec->stat.decode, (uint32_t)(decode_end - start_time));
     if (vdec->need_clr_convert == false) {
         out_frame->pts = data->pts;
         out_frame->data = decoded_frame.data;
@@ -231,8 +252,10 @@ static int do_decode(vdec_t *vdec, av_render_video_data_t *data, av_render_video
             using_fb_buffer = true;  /* Using buffer from fb_fetch */
         }
     }
+    start_time = esp_timer_get_time();
     ret = convert_color(vdec->convert_table, decoded_frame.data, decoded_frame.decoded_size,
                         out_data, vdec->raw_buffer_size);
+    vdec_stage_time_add(&vdec->stat.convert, (uint32_t)(esp_timer_get_time() - start_time));
     if (ret != 0) {
         ESP_LOGE(TAG, "Fail to convert color");
         /* Only call fb_return if we're using a buffer from fb_fetch */
@@ -259,6 +282,21 @@ static int check_input_format_support(vdec_t *vdec, esp_video_dec_cfg_t *dec_cfg
         return ESP_MEDIA_ERR_NOT_SUPPORT;
     }
     esp_video_codec_pixel_fmt_t dec_out_fmt = get_out_fmt(out_fmt);
+    if (vdec->out_width && vdec->out_height) {
+        // Scale is fused into YUV420 to RGB565 convert, so let decoder output YUV420
+        if (dec_out_fmt == ESP_VIDEO_CODEC_PIXEL_FMT_RGB565_LE || dec_out_fmt == ESP_VIDEO_CODEC_PIXEL_FMT_RGB565_BE) {
+            for (int i = 0; i < caps.out_fmt_num; i++) {
+                if (caps.out_fmts[i] == ESP_VIDEO_CODEC_PIXEL_FMT_YUV420P) {
+                    vdec->need_clr_convert = true;
+                    dec_cfg->out_fmt = caps.out_fmts[i];
+                    ESP_LOGI(TAG, "Scale to %dx%d in color convert", vdec->out_width, vdec->out_height);
+                    return ESP_MEDIA_ERR_OK;
+                }
+            }
+        }
+        // Not scale in decoder, may scale in render when color convert in render
+        vdec->out_width = vdec->out_height = 0;
+    }
     for (int i = 0; i < caps.out_fmt_num; i++) {
         if (caps.out_fmts[i] == dec_out_fmt) {
             dec_cfg->out_fmt = dec_out_fmt;
@@ -307,6 +345,10 @@ vdec_handle_t vdec_open(vdec_cfg_t *cfg)
     vdec->frame_info.fps = cfg->video_info.fps;
     vdec->frame_cb = cfg->frame_cb;
     vdec->ctx = cfg->ctx;
+    vdec->cvt_workers = cfg->cvt_workers;
+    vdec->out_width = cfg->out_width;
+    vdec->out_height = cfg->out_height;
+    vdec->scale_mode = cfg->scale_mode;
 
     av_render_video_frame_type_t output_type = cfg->out_type;
     if (output_type == AV_RENDER_VIDEO_RAW_TYPE_NONE) {
@@ -396,6 +438,28 @@ int vdec_get_frame_info(vdec_handle_t h, av_render_video_frame_info_t *frame_inf
     return ESP_MEDIA_ERR_OK;
 }
 
+void vdec_stage_time_add(vdec_stage_time_t *stage, uint32_t cost)
+{
+    stage->count++;
+    stage->total += cost;
+    if (cost > stage->max) {
+        stage->max = cost;
+    }
+}
+
+int vdec_get_stat(vdec_handle_t h, vdec_stat_t *stat, bool reset)
+{
+    vdec_t *vdec = (vdec_t *)h;
+    if (vdec == NULL || stat == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    *stat = vdec->stat;
+    if (reset) {
+        memset(&vdec->stat, 0, sizeof(vdec_stat_t));
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
 int vdec_close(vdec_handle_t h)
 {
     vdec_t *vdec = (vdec_t *)h;
@@ -0,0 +1,600 @@
+/*
+ * YUV420 to RGB565 convert benchmark and quality check on host
+ *
+ * Compares table kernel and reference path of `src/color_convert.c` with the old 128KB lookup table
+ * (kept below as `old_*`, same code as before the table kernel was added)
+ *
+ * Checks, exit with failure when any does not hold:
+ *   - Reference path is bit-exact to double precision BT.601 / BT.709 over all 2^24 YUV values
+ *   - Table kernel differs from reference path by at most 1 step of RGB565 per channel
+ *   - PSNR of table kernel is not lower than old table
+ *   - `stage` mode: output with convert workers is identical to single thread
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "color_convert.h"
+#include "media_lib_os.h"
+
+#define BENCH_SECONDS (0.5)
+#define BENCH_REPEAT  (3)
+#define SWEEP_WIDTH   (4096)
+#define SWEEP_HEIGHT  (4096)
+#define STAGE_FRAMES  (300)
+#define STAGE_WARM_UP (20)
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint32_t        bits;
+} event_t;
+
+typedef struct {
+    void (*body)(void *arg);
+    void *arg;
+} thread_arg_t;
+
+typedef struct {
+    int width;
+    int height;
+} bench_res_t;
+
+static const bench_res_t bench_res[] = {
+    {320, 240},
+    {800, 480},
+    {1024, 600},
+    {1280, 720},
+};
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    return calloc(num, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+int media_lib_event_group_create(media_lib_event_grp_handle_t *group)
+{
+    event_t *e = calloc(1, sizeof(event_t));
+    pthread_mutex_init(&e->m, NULL);
+    pthread_cond_init(&e->c, NULL);
+    *group = e;
+    return 0;
+}
+
+int media_lib_event_group_destroy(media_lib_event_grp_handle_t group)
+{
+    free(group);
+    return 0;
+}
+
+uint32_t media_lib_event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits |= bits;
+    pthread_cond_broadcast(&e->c);
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits &= ~bits;
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+/* Wait for all bits like FreeRTOS event group used by media_lib */
+uint32_t media_lib_event_group_wait_bits(media_lib_event_grp_handle_t group, uint32_t bits, uint32_t timeout)
+{
+    (void)timeout;
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    while ((e->bits & bits) != bits) {
+        pthread_cond_wait(&e->c, &e->m);
+    }
+    uint32_t r = e->bits;
+    pthread_mutex_unlock(&e->m);
+    return r;
+}
+
+static void *thread_entry(void *arg)
+{
+    thread_arg_t t = *(thread_arg_t *)arg;
+    free(arg);
+    t.body(t.arg);
+    return NULL;
+}
+
+int media_lib_thread_create_from_scheduler(media_lib_thread_handle_t *handle, const char *name, void (*body)(void *arg),
+                                           void *arg)
+{
+    (void)name;
+    thread_arg_t *t = malloc(sizeof(thread_arg_t));
+    t->body = body;
+    t->arg = arg;
+    pthread_t *th = malloc(sizeof(pthread_t));
+    if (pthread_create(th, NULL, thread_entry, t) != 0) {
+        free(th);
+        free(t);
+        return -1;
+    }
+    pthread_detach(*th);
+    *handle = th;
+    return 0;
+}
+
+void media_lib_thread_destroy(media_lib_thread_handle_t handle)
+{
+    (void)handle;
+}
+
+#define COLOR_LIMIT(a) (a > 255 ? 255 : a < 0 ? 0 : a)
+#define YUV2RO(C, D, E) COLOR_LIMIT((298 * (C) + 409 * (E) + 128) >> 8)
+#define YUV2GO(C, D, E) COLOR_LIMIT((298 * (C)-100 * (D)-208 * (E) + 128) >> 8)
+#define YUV2BO(C, D, E) COLOR_LIMIT((298 * (C) + 516 * (D) + 128) >> 8)
+#define RGB565(r, g, b) (((((r) << 6) | (g)) << 5) | (b))
+
+static uint16_t *old_init_table(void)
+{
+    uint16_t *table16 = malloc(256 * 256 * 2);
+    for (int u0 = 0; u0 < 32; u0++) {
+        for (int v0 = 0; v0 < 32; v0++) {
+            for (int y0 = 0; y0 < 64; y0++) {
+                int idx = (y0 << 10) + (u0 << 5) + v0;
+                int y = (y0 << 2) + (y0 & 0x3);
+                int u = (u0 << 3) + (y0 & 0x7);
+                int v = (v0 << 3) + (v0 & 0x7);
+                y -= 16;
+                u -= 128;
+                v -= 128;
+                uint16_t r = (YUV2RO(y, u, v) >> 3) & 0x1f;
+                uint16_t g = (YUV2GO(y, u, v) >> 2) & 0x3f;
+                uint16_t b = (YUV2BO(y, u, v) >> 3) & 0x1f;
+                table16[idx] = RGB565(r, g, b);
+            }
+        }
+    }
+    return table16;
+}
+
+static void old_yuv420_to_rgb565(uint16_t *table16, int width, int height, uint8_t *src, uint8_t *dst)
+{
+    uint8_t *y_plane = src;
+    uint8_t *u_plane = src + (width * height);
+    uint8_t *v_plane = src + (width * height * 5 / 4);
+    int y_pos = 0, u_pos = 0, rgb_idx = 0;
+    uint16_t *rgb565 = (uint16_t *)dst;
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j += 2) {
+            int y = y_plane[y_pos];
+            int u = u_plane[u_pos];
+            int v = v_plane[u_pos];
+            int y_idx = (y >> 2) << 10;
+            int uv_idx = ((u >> 3) << 5) + (v >> 3);
+            rgb565[rgb_idx++] = table16[y_idx + uv_idx];
+            y = y_plane[y_pos + 1];
+            y_idx = (y >> 2) << 10;
+            rgb565[rgb_idx++] = table16[y_idx + uv_idx];
+            y_pos += 2;
+            u_pos++;
+        }
+        if ((i & 1) == 0) {
+            u_pos -= width >> 1;
+        }
+    }
+}
+
+static double now_sec(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* Ideal limited range YUV to RGB in double, not clamped */
+static void ideal_rgb(bool bt709, int y, int u, int v, double rgb[3])
+{
+    double kr = bt709 ? 0.2126 : 0.299;
+    double kb = bt709 ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+    double c = (y - 16) * 255.0 / 219.0;
+    double d = (u - 128) * 255.0 / 224.0;
+    double e = (v - 128) * 255.0 / 224.0;
+    rgb[0] = c + 2.0 * (1.0 - kr) * e;
+    rgb[1] = c - 2.0 * (1.0 - kb) * kb / kg * d - 2.0 * (1.0 - kr) * kr / kg * e;
+    rgb[2] = c + 2.0 * (1.0 - kb) * d;
+}
+
+static int clamp8(double v)
+{
+    int i = (int)floor(v + 0.5);
+    return i < 0 ? 0 : i > 255 ? 255 : i;
+}
+
+static int quantize(int v, int bits)
+{
+    int max = (1 << bits) - 1;
+    return (v * max + 127) / 255;
+}
+
+static uint16_t ideal_rgb565(bool bt709, int y, int u, int v)
+{
+    double rgb[3];
+    ideal_rgb(bt709, y, u, v, rgb);
+    return (quantize(clamp8(rgb[0]), 5) << 11) | (quantize(clamp8(rgb[1]), 6) << 5) | quantize(clamp8(rgb[2]), 5);
+}
+
+/* Synthetic picture: smooth luma and chroma gradients with mild luma noise, 4:2:0 */
+static void make_picture(uint8_t *src, int width, int height)
+{
+    uint8_t *y_plane = src;
+    uint8_t *u_plane = src + width * height;
+    uint8_t *v_plane = u_plane + width * height / 4;
+    srand(1);
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            double fx = (double)j / width, fy = (double)i / height;
+            double luma = 16 + 219 * (0.5 + 0.35 * sin(6.0 * fx + 2.0 * fy) + 0.15 * cos(17.0 * fx * fy));
+            luma += (rand() % 9) - 4;
+            y_plane[i * width + j] = (uint8_t)(luma < 16 ? 16 : luma > 235 ? 235 : luma);
+        }
+    }
+    for (int i = 0; i < height / 2; i++) {
+        for (int j = 0; j < width / 2; j++) {
+            double fx = (double)j / (width / 2), fy = (double)i / (height / 2);
+            double u = 128 + 100 * sin(3.0 * fx + 1.0) * cos(2.0 * fy);
+            double v = 128 + 100 * cos(4.0 * fy + 0.5) * sin(2.5 * fx + fy);
+            u_plane[i * (width / 2) + j] = (uint8_t)u;
+            v_plane[i * (width / 2) + j] = (uint8_t)v;
+        }
+    }
+}
+
+/* Every YUV combination once: each 2x2 block holds one chroma pair and 4 luma values */
+static void make_sweep(uint8_t *src, int width, int height)
+{
+    uint8_t *y_plane = src;
+    uint8_t *u_plane = src + width * height;
+    uint8_t *v_plane = u_plane + width * height / 4;
+    int uv_width = width / 2;
+    for (int by = 0; by < height / 2; by++) {
+        for (int bx = 0; bx < uv_width; bx++) {
+            int block = by * uv_width + bx;
+            int uv = block & 0xFFFF;
+            int y_base = (block >> 16) * 4;
+            u_plane[block] = uv >> 8;
+            v_plane[block] = uv & 0xFF;
+            y_plane[(2 * by) * width + 2 * bx] = y_base;
+            y_plane[(2 * by) * width + 2 * bx + 1] = y_base + 1;
+            y_plane[(2 * by + 1) * width + 2 * bx] = y_base + 2;
+            y_plane[(2 * by + 1) * width + 2 * bx + 1] = y_base + 3;
+        }
+    }
+}
+
+static int get_y(uint8_t *src, int width, int i, int j)
+{
+    return src[i * width + j];
+}
+
+static int get_u(uint8_t *src, int width, int height, int i, int j)
+{
+    return src[width * height + (i / 2) * (width / 2) + j / 2];
+}
+
+static int get_v(uint8_t *src, int width, int height, int i, int j)
+{
+    return src[width * height * 5 / 4 + (i / 2) * (width / 2) + j / 2];
+}
+
+static double expand(int v, int bits)
+{
+    return v * 255.0 / ((1 << bits) - 1);
+}
+
+/* PSNR of RGB565 output against unquantized ideal RGB clamped to 8 bits range */
+static double get_psnr(uint8_t *src, uint16_t *out, int width, int height, bool bt709)
+{
+    double se = 0;
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            double rgb[3];
+            ideal_rgb(bt709, get_y(src, width, i, j), get_u(src, width, height, i, j), get_v(src, width, height, i, j), rgb);
+            uint16_t p = out[i * width + j];
+            double got[3] = {expand(p >> 11, 5), expand((p >> 5) & 0x3F, 6), expand(p & 0x1F, 5)};
+            for (int c = 0; c < 3; c++) {
+                double want = rgb[c] < 0 ? 0 : rgb[c] > 255 ? 255 : rgb[c];
+                se += (got[c] - want) * (got[c] - want);
+            }
+        }
+    }
+    double mse = se / (3.0 * width * height);
+    return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+static color_convert_table_t open_convert(int width, int height, bool reference, bool bt709)
+{
+    color_convert_cfg_t cfg = {
+        .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+        .to = AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+        .width = width,
+        .height = height,
+        .std = bt709 ? AV_RENDER_VIDEO_COLOR_STD_BT709 : AV_RENDER_VIDEO_COLOR_STD_BT601,
+        .reference = reference,
+    };
+    return init_convert_table(&cfg);
+}
+
+static int channel_diff(uint16_t a, uint16_t b)
+{
+    int dr = abs((a >> 11) - (b >> 11));
+    int dg = abs(((a >> 5) & 0x3F) - ((b >> 5) & 0x3F));
+    int db = abs((a & 0x1F) - (b & 0x1F));
+    int d = dr > dg ? dr : dg;
+    return d > db ? d : db;
+}
+
+/* Compare reference path with double precision and table kernel with reference over every YUV value */
+static int check_sweep(bool bt709)
+{
+    int width = SWEEP_WIDTH, height = SWEEP_HEIGHT;
+    int src_size = width * height * 3 / 2;
+    uint8_t *src = malloc(src_size);
+    uint16_t *ref = malloc(width * height * 2);
+    uint16_t *fast = malloc(width * height * 2);
+    make_sweep(src, width, height);
+    color_convert_table_t ref_cvt = open_convert(width, height, true, bt709);
+    color_convert_table_t fast_cvt = open_convert(width, height, false, bt709);
+    convert_color(ref_cvt, src, src_size, (uint8_t *)ref, width * height * 2);
+    convert_color(fast_cvt, src, src_size, (uint8_t *)fast, width * height * 2);
+    long ref_miss = 0, fast_miss = 0;
+    int fast_max = 0;
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            int idx = i * width + j;
+            uint16_t want = ideal_rgb565(bt709, get_y(src, width, i, j), get_u(src, width, height, i, j),
+                                         get_v(src, width, height, i, j));
+            ref_miss += (ref[idx] != want);
+            if (fast[idx] != ref[idx]) {
+                int d = channel_diff(fast[idx], ref[idx]);
+                fast_miss++;
+                fast_max = d > fast_max ? d : fast_max;
+            }
+        }
+    }
+    printf("%s all YUV: reference differs from double on %ld pixels, table kernel differs from reference on "
+           "%ld pixels (%.3f%%, max %d step)\n",
+           bt709 ? "BT.709" : "BT.601", ref_miss, fast_miss, 100.0 * fast_miss / (width * height), fast_max);
+    deinit_convert_table(ref_cvt);
+    deinit_convert_table(fast_cvt);
+    free(src);
+    free(ref);
+    free(fast);
+    return (ref_miss == 0 && fast_max <= 1) ? 0 : -1;
+}
+
+typedef void (*run_func_t)(void *ctx, uint8_t *src, int src_size, uint8_t *dst, int dst_size);
+
+typedef struct {
+    uint16_t *table;
+    int       width;
+    int       height;
+} old_ctx_t;
+
+static void run_old(void *ctx, uint8_t *src, int src_size, uint8_t *dst, int dst_size)
+{
+    (void)src_size;
+    (void)dst_size;
+    old_ctx_t *old = ctx;
+    old_yuv420_to_rgb565(old->table, old->width, old->height, src, dst);
+}
+
+static void run_new(void *ctx, uint8_t *src, int src_size, uint8_t *dst, int dst_size)
+{
+    convert_color(ctx, src, src_size, dst, dst_size);
+}
+
+/* Best of repeats in mega pixels per second */
+static double get_speed(run_func_t run, void *ctx, uint8_t *src, int src_size, uint8_t *dst, int dst_size, int pixels)
+{
+    double best = 0;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        int frames = 0;
+        double start = now_sec(), cost = 0;
+        while (cost < BENCH_SECONDS) {
+            run(ctx, src, src_size, dst, dst_size);
+            frames++;
+            cost = now_sec() - start;
+        }
+        double speed = (double)frames * pixels / cost / 1e6;
+        best = speed > best ? speed : best;
+    }
+    return best;
+}
+
+static int run_quality(void)
+{
+    int ret = 0;
+    ret |= check_sweep(false);
+    ret |= check_sweep(true);
+    uint16_t *old_table = old_init_table();
+    printf("\n%-10s %10s %10s %10s %12s %12s %12s\n", "size", "old Mpix/s", "tab Mpix/s", "ref Mpix/s",
+           "old PSNR dB", "tab PSNR dB", "ref PSNR dB");
+    for (size_t k = 0; k < sizeof(bench_res) / sizeof(bench_res[0]); k++) {
+        int width = bench_res[k].width, height = bench_res[k].height;
+        int src_size = width * height * 3 / 2;
+        uint8_t *src = malloc(src_size);
+        uint8_t *dst = malloc(width * height * 2);
+        make_picture(src, width, height);
+        old_ctx_t old = {old_table, width, height};
+        color_convert_table_t fast_cvt = open_convert(width, height, false, false);
+        color_convert_table_t ref_cvt = open_convert(width, height, true, false);
+        double speed[3], psnr[3];
+        speed[0] = get_speed(run_old, &old, src, src_size, dst, width * height * 2, width * height);
+        psnr[0] = get_psnr(src, (uint16_t *)dst, width, height, false);
+        speed[1] = get_speed(run_new, fast_cvt, src, src_size, dst, width * height * 2, width * height);
+        psnr[1] = get_psnr(src, (uint16_t *)dst, width, height, false);
+        speed[2] = get_speed(run_new, ref_cvt, src, src_size, dst, width * height * 2, width * height);
+        psnr[2] = get_psnr(src, (uint16_t *)dst, width, height, false);
+        char name[16];
+        snprintf(name, sizeof(name), "%dx%d", width, height);
+        printf("%-10s %10.1f %10.1f %10.1f %12.2f %12.2f %12.2f\n", name, speed[0], speed[1], speed[2],
+               psnr[0], psnr[1], psnr[2]);
+        if (psnr[1] < psnr[0]) {
+            ret = -1;
+        }
+        deinit_convert_table(fast_cvt);
+        deinit_convert_table(ref_cvt);
+        free(src);
+        free(dst);
+    }
+    free(old_table);
+    return ret;
+}
+
+/* Convert stage time per frame like `vdec_get_stat` reports, for each worker number */
+static int run_stage(void)
+{
+    int ret = 0;
+    printf("%ld CPU online, %d frames each\n", sysconf(_SC_NPROCESSORS_ONLN), STAGE_FRAMES);
+    printf("%-10s %8s %10s %10s %10s %10s\n", "size", "workers", "avg us", "max us", "fps", "identical");
+    for (size_t k = 0; k < sizeof(bench_res) / sizeof(bench_res[0]); k++) {
+        int width = bench_res[k].width, height = bench_res[k].height;
+        int src_size = width * height * 3 / 2;
+        int dst_size = width * height * 2;
+        uint8_t *src = malloc(src_size);
+        uint8_t *dst = malloc(dst_size);
+        uint8_t *first = malloc(dst_size);
+        make_picture(src, width, height);
+        for (int workers = 0; workers <= COLOR_CONVERT_MAX_WORKERS; workers++) {
+            color_convert_cfg_t cfg = {
+                .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+                .to = AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+                .width = width,
+                .height = height,
+                .workers = workers,
+            };
+            color_convert_table_t cvt = init_convert_table(&cfg);
+            // Warm up caches and wake workers before timing
+            for (int i = 0; i < STAGE_WARM_UP; i++) {
+                convert_color(cvt, src, src_size, dst, dst_size);
+            }
+            double total = 0, max = 0;
+            for (int i = 0; i < STAGE_FRAMES; i++) {
+                double start = now_sec();
+                convert_color(cvt, src, src_size, dst, dst_size);
+                double cost = (now_sec() - start) * 1e6;
+                total += cost;
+                max = cost > max ? cost : max;
+            }
+            deinit_convert_table(cvt);
+            bool same = true;
+            if (workers == 0) {
+                memcpy(first, dst, dst_size);
+            } else {
+                same = memcmp(first, dst, dst_size) == 0;
+            }
+            char name[16];
+            snprintf(name, sizeof(name), "%dx%d", width, height);
+            printf("%-10s %8d %10.1f %10.1f %10.1f %10s\n", name, workers, total / STAGE_FRAMES, max,
+                   STAGE_FRAMES * 1e6 / total, same ? "yes" : "no");
+            if (same == false) {
+                ret = -1;
+            }
+        }
+        free(src);
+        free(dst);
+        free(first);
+    }
+    return ret;
+}
+
+/* Frames per second of convert with fused scaling compared with convert in source resolution */
+static int run_scale(void)
+{
+    static const struct {
+        int width;
+        int height;
+        int out_width;
+        int out_height;
+    } scale_res[] = {
+        {1280, 720, 320, 240},
+        {1280, 720, 800, 480},
+        {800, 480, 320, 240},
+        {640, 480, 1024, 600},
+    };
+    static const char *mode_name[] = {"nearest", "bilinear", "box"};
+    printf("%-22s %10s %10s %10s %10s\n", "size", "unscaled", "nearest", "bilinear", "box");
+    for (size_t k = 0; k < sizeof(scale_res) / sizeof(scale_res[0]); k++) {
+        int width = scale_res[k].width, height = scale_res[k].height;
+        int src_size = width * height * 3 / 2;
+        uint8_t *src = malloc(src_size);
+        int out_size = scale_res[k].out_width * scale_res[k].out_height * 2;
+        int dst_size = width * height * 2 > out_size ? width * height * 2 : out_size;
+        uint8_t *dst = malloc(dst_size);
+        make_picture(src, width, height);
+        double fps[4];
+        for (int m = 0; m < 4; m++) {
+            color_convert_cfg_t cfg = {
+                .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+                .to = AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+                .width = width,
+                .height = height,
+            };
+            if (m) {
+                cfg.out_width = scale_res[k].out_width;
+                cfg.out_height = scale_res[k].out_height;
+                cfg.scale_mode = (av_render_video_scale_mode_t)(m - 1);
+            }
+            color_convert_table_t cvt = init_convert_table(&cfg);
+            if (cvt == NULL) {
+                printf("Fail to open %s\n", m ? mode_name[m - 1] : "unscaled");
+                free(src);
+                free(dst);
+                return -1;
+            }
+            fps[m] = get_speed(run_new, cvt, src, src_size, dst, dst_size, 1) * 1e6;
+            deinit_convert_table(cvt);
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d->%dx%d", width, height, scale_res[k].out_width, scale_res[k].out_height);
+        printf("%-22s %10.1f %10.1f %10.1f %10.1f\n", name, fps[0], fps[1], fps[2], fps[3]);
+        free(src);
+        free(dst);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *mode = argc > 1 ? argv[1] : "quality";
+    int ret;
+    if (strcmp(mode, "quality") == 0) {
+        ret = run_quality();
+    } else if (strcmp(mode, "stage") == 0) {
+        ret = run_stage();
+    } else if (strcmp(mode, "scale") == 0) {
+        ret = run_scale();
+    } else {
+        printf("Usage: %s [quality|stage|scale]\n", argv[0]);
+        return 1;
+    }
+    printf("%s\n", ret == 0 ? "PASS" : "FAIL");
+    return ret == 0 ? 0 : 1;
+}
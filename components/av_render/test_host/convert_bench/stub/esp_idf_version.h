@@ -0,0 +1,2 @@
+/* Host stub of esp_idf_version.h */
+#pragma once
@@ -0,0 +1,2 @@
+/* Host stub of esp_imgfx_color_convert.h, hardware convert is only used on ESP32-P4 */
+#pragma once
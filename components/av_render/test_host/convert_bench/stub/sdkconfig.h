@@ -0,0 +1,2 @@
+/* Host stub of sdkconfig.h, not ESP32-P4 so software path is used */
+#pragma once
@@ -0,0 +1,344 @@
+/*
+ * Decoder output frame pool model on host
+ *
+ * A network thread replays a 30fps source whose frames arrive in a burst at the end of every stall
+ * Sync mode decodes then displays in one thread like video render without render fifo, display blocks decoding
+ * Pool modes decode into `src/frame_pool.c` slots and hand small references to a display thread,
+ * in FIFO order or latest-wins (stale READY frames are reclaimed by the decoder and skipped on display)
+ * Decode and display are busy waits of fixed length, media_lib is mocked with pthread
+ * Reports decoder time blocked by display, displayed frame rate, capture to display start latency and
+ * frames reclaimed before display
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "media_lib_os.h"
+#include "esp_timer.h"
+#include "frame_pool.h"
+
+#define MAX_FRAMES     (4096)
+#define SOURCE_FPS     (30)
+#define DECODE_US      (12000)
+#define STALL_EVERY_MS (1000)
+#define RUN_MS         (10000)
+#define POOL_NUM       (3)
+#define FRAME_SIZE     (1024)
+#define FRAME_ALIGN    (64)
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint32_t        bits;
+} event_t;
+
+typedef enum {
+    MODEL_MODE_SYNC,
+    MODEL_MODE_POOL,
+} model_mode_t;
+
+/* Unbounded queue of frame index, stands for decoder input and render fifo */
+typedef struct {
+    int64_t         v[MAX_FRAMES];
+    int             wp;
+    int             rp;
+    bool            end;
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+} queue_t;
+
+typedef struct {
+    int64_t  capture;
+    int      slot;
+    uint32_t seq;
+} frame_ref_t;
+
+static int                 display_us = 30000;
+static int                 stall_ms = 400;
+static int64_t             start_us;
+static model_mode_t        mode;
+static frame_pool_handle_t pool;
+static queue_t             in_q;
+static queue_t             ref_q;
+static frame_ref_t         refs[MAX_FRAMES];
+static int64_t             stall_total;
+static int64_t             displayed;
+static int64_t             latency_sum;
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000LL + t.tv_nsec / 1000;
+}
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    return calloc(num, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+int media_lib_mutex_create(media_lib_mutex_handle_t *mutex)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(m, &attr);
+    *mutex = m;
+    return 0;
+}
+
+int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+    return 0;
+}
+
+int media_lib_mutex_lock(media_lib_mutex_handle_t mutex, uint32_t timeout)
+{
+    (void)timeout;
+    return pthread_mutex_lock(mutex);
+}
+
+int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex)
+{
+    return pthread_mutex_unlock(mutex);
+}
+
+int media_lib_event_group_create(media_lib_event_grp_handle_t *group)
+{
+    event_t *e = calloc(1, sizeof(event_t));
+    pthread_mutex_init(&e->m, NULL);
+    pthread_cond_init(&e->c, NULL);
+    *group = e;
+    return 0;
+}
+
+int media_lib_event_group_destroy(media_lib_event_grp_handle_t group)
+{
+    free(group);
+    return 0;
+}
+
+uint32_t media_lib_event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits |= bits;
+    pthread_cond_broadcast(&e->c);
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits &= ~bits;
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_wait_bits(media_lib_event_grp_handle_t group, uint32_t bits, uint32_t timeout)
+{
+    (void)timeout;
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    while ((e->bits & bits) == 0) {
+        pthread_cond_wait(&e->c, &e->m);
+    }
+    uint32_t r = e->bits;
+    pthread_mutex_unlock(&e->m);
+    return r;
+}
+
+static int64_t now_us(void)
+{
+    return esp_timer_get_time() - start_us;
+}
+
+/* Busy wait with short sleeps so that a single core host still runs other threads */
+static void work_us(int us)
+{
+    int64_t end = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < end) {
+        if (end - esp_timer_get_time() > 2000) {
+            usleep(1000);
+        }
+    }
+}
+
+static void queue_init(queue_t *q)
+{
+    memset(q, 0, sizeof(queue_t));
+    pthread_mutex_init(&q->m, NULL);
+    pthread_cond_init(&q->c, NULL);
+}
+
+static void queue_push(queue_t *q, int64_t v)
+{
+    pthread_mutex_lock(&q->m);
+    q->v[q->wp++ % MAX_FRAMES] = v;
+    pthread_cond_broadcast(&q->c);
+    pthread_mutex_unlock(&q->m);
+}
+
+static void queue_close(queue_t *q)
+{
+    pthread_mutex_lock(&q->m);
+    q->end = true;
+    pthread_cond_broadcast(&q->c);
+    pthread_mutex_unlock(&q->m);
+}
+
+static bool queue_pop(queue_t *q, int64_t *v)
+{
+    pthread_mutex_lock(&q->m);
+    while (q->rp == q->wp && q->end == false) {
+        pthread_cond_wait(&q->c, &q->m);
+    }
+    bool ok = q->rp != q->wp;
+    if (ok) {
+        *v = q->v[q->rp++ % MAX_FRAMES];
+    }
+    pthread_mutex_unlock(&q->m);
+    return ok;
+}
+
+static void *net_thread(void *arg)
+{
+    (void)arg;
+    int64_t period = 1000000 / SOURCE_FPS;
+    for (int i = 0;; i++) {
+        int64_t capture = i * period;
+        if (capture > RUN_MS * 1000LL) {
+            break;
+        }
+        // Frames captured during stall arrive together at its end
+        int64_t arrive = capture;
+        int64_t phase = capture % (STALL_EVERY_MS * 1000LL);
+        if (phase < stall_ms * 1000LL) {
+            arrive = capture - phase + stall_ms * 1000LL;
+        }
+        while (now_us() < arrive) {
+            usleep(200);
+        }
+        queue_push(&in_q, capture);
+    }
+    queue_close(&in_q);
+    return NULL;
+}
+
+static void *decode_thread(void *arg)
+{
+    (void)arg;
+    int64_t capture;
+    int n = 0;
+    while (queue_pop(&in_q, &capture)) {
+        if (mode == MODEL_MODE_SYNC) {
+            work_us(DECODE_US);
+            // Render in decoder thread, next decode waits until display is done
+            int64_t start = now_us();
+            latency_sum += start - capture;
+            displayed++;
+            work_us(display_us);
+            stall_total += now_us() - start;
+            continue;
+        }
+        uint8_t *data = NULL;
+        int slot = frame_pool_acquire(pool, FRAME_SIZE, FRAME_ALIGN, &data);
+        if (slot < 0) {
+            break;
+        }
+        work_us(DECODE_US);
+        frame_ref_t *ref = &refs[n % MAX_FRAMES];
+        ref->capture = capture;
+        ref->slot = slot;
+        ref->seq = frame_pool_submit(pool, slot);
+        queue_push(&ref_q, n++);
+    }
+    queue_close(&ref_q);
+    return NULL;
+}
+
+static void *display_thread(void *arg)
+{
+    (void)arg;
+    int64_t i;
+    while (queue_pop(&ref_q, &i)) {
+        frame_ref_t *ref = &refs[i % MAX_FRAMES];
+        // Reclaimed or superseded frame
+        if (frame_pool_lock(pool, ref->slot, ref->seq) == false) {
+            continue;
+        }
+        latency_sum += now_us() - ref->capture;
+        displayed++;
+        work_us(display_us);
+        frame_pool_unlock(pool, ref->slot);
+    }
+    return NULL;
+}
+
+static void run_case(const char *name, model_mode_t m, bool latest)
+{
+    mode = m;
+    stall_total = displayed = latency_sum = 0;
+    queue_init(&in_q);
+    queue_init(&ref_q);
+    pool = (m == MODEL_MODE_POOL) ? frame_pool_create(POOL_NUM, latest) : NULL;
+    start_us = esp_timer_get_time();
+    pthread_t net, dec, disp;
+    pthread_create(&net, NULL, net_thread, NULL);
+    pthread_create(&dec, NULL, decode_thread, NULL);
+    if (pool) {
+        pthread_create(&disp, NULL, display_thread, NULL);
+    }
+    pthread_join(net, NULL);
+    pthread_join(dec, NULL);
+    if (pool) {
+        pthread_join(disp, NULL);
+    }
+    double secs = now_us() / 1e6;
+    frame_pool_stat_t stat = { 0 };
+    if (pool) {
+        // Decoder blocked by display is the wait for a free slot
+        frame_pool_get_stat(pool, &stat, false);
+        stall_total = (int64_t)stat.wait_total;
+        frame_pool_destroy(pool);
+    }
+    int sent = RUN_MS * SOURCE_FPS / 1000 + 1;
+    printf("%-18s stall %6.1f ms/s  displayed %5.1f fps  latency %6.1f ms  dropped %3u/%d  run %.1fs\n", name,
+           stall_total / 1000.0 / secs, displayed / secs, displayed ? latency_sum / 1000.0 / displayed : 0,
+           (unsigned)stat.dropped, sent, secs);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        display_us = atoi(argv[1]) * 1000;
+    }
+    if (argc > 2) {
+        stall_ms = atoi(argv[2]);
+    }
+    printf("decode %dms display %dms %dfps, stall %dms every %dms\n", DECODE_US / 1000, display_us / 1000,
+           SOURCE_FPS, stall_ms, STALL_EVERY_MS);
+    run_case("sync (current)", MODEL_MODE_SYNC, false);
+    run_case("pool fifo N=3", MODEL_MODE_POOL, false);
+    run_case("pool latest N=3", MODEL_MODE_POOL, true);
+    return 0;
+}
@@ -0,0 +1,729 @@
+/*
+ * LCD render co-simulation on host
+ *
+ * Runs `render_impl/lcd_render.c` (included below so that its statics are reachable) in virtual time against
+ * emulated esp_lcd drivers:
+ *   - DPI panel (ESP32-P4): fixed refresh period, dma2d copy of one frame or panel frame buffers which are
+ *     switched at next refresh, a frame buffer handed out while it is scanned out counts as torn
+ *   - SPI panel: 1-line bus with per transaction overhead and queue depth, a draw waits for all queued color
+ *     transactions before its command phase, data outside DMA capable memory is copied by spi_master into a
+ *     temporary buffer for every transaction
+ * Semaphores, sleeps and `esp_timer_get_time` advance the virtual clock and run driver events due meanwhile
+ * Decoder time is modeled by advancing the clock between writes
+ * Reports frames accepted by render, frames shown by the panel, jitter of shown frame interval,
+ * render time blocked per frame and torn frames
+ * `skip` mode writes synthetic doorbell scenes to the SPI panel with and without `skip_unchanged`, keeps a copy of
+ * panel memory and checks it against the source after every frame, reports bus bytes per frame and frame rate
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "video_render.h"
+#include "av_render_default.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_mipi_dsi.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Build with -DLCD_SRC='"old_lcd_render.c"' to run another version, add -DLCD_HAS_IO_HANDLE if it has `io_handle`
+// and -DLCD_HAS_SKIP_UNCHANGED if it has `skip_unchanged`
+#ifndef LCD_SRC
+#define LCD_SRC                "../../render_impl/lcd_render.c"
+#define LCD_HAS_IO_HANDLE      (1)
+#define LCD_HAS_SKIP_UNCHANGED (1)
+#endif
+
+video_render_handle_t video_render_alloc_handle(video_render_cfg_t *cfg)
+{
+    (void)cfg;
+    return NULL;
+}
+
+#include LCD_SRC
+
+#define SIM_MAX_QUEUE   (64)
+#define SIM_MAX_FB      (3)
+#define SIM_MAX_DMA     (4)
+#define SIM_MAX_FRAMES  (4096)
+#define SIM_FRAMES      (600)
+#define SIM_WARM_UP     (10)
+
+typedef struct {
+    int    dpi;            /* 1: DPI panel, 0: SPI panel */
+    int    width;
+    int    height;
+    double refresh_us;     /* DPI refresh period */
+    double copy2d_us;      /* DPI dma2d copy of one frame */
+    double spi_bpus;       /* SPI bytes per us */
+    double cpu_copy_bpus;  /* CPU copy from PSRAM to internal memory, bytes per us */
+    double hash_copy_bpus; /* CPU copy with stripe hash, bytes per us */
+    double trans_ovh_us;   /* Overhead of one SPI transaction */
+    double param_us;       /* One command phase (polling transaction) */
+    double malloc_us;      /* spi_master temporary DMA buffer allocate and free */
+    int    max_trans;      /* Bus max_transfer_sz */
+    int    queue_depth;    /* Panel IO trans_queue_depth */
+} sim_cfg_t;
+
+typedef struct {
+    double end;
+    bool   notify;
+    bool   frame_end;
+} sim_trans_t;
+
+struct sim_sem {
+    int count;
+    int max;
+};
+
+typedef struct {
+    double accepted_fps;
+    double shown_fps;
+    double jitter;
+    double max_interval;
+    double blocked;
+    int    tears;
+    int    shown;
+} result_t;
+
+static sim_cfg_t   sim;
+static double      now_us;
+static bool        in_isr;
+static sim_trans_t spi_q[SIM_MAX_QUEUE];
+static int         spi_q_head;
+static int         spi_q_num;
+static double      spi_last_end;
+static double      dma2d_end = -1;
+static double      next_refresh;
+static int         fb_displayed;
+static int         fb_scheduled = -1;
+static bool        copy_done_since_refresh;
+static void       *fbs[SIM_MAX_FB];
+static int         fb_count;
+static void       *dma_regions[SIM_MAX_DMA];
+static size_t      dma_sizes[SIM_MAX_DMA];
+static int         dma_num;
+static void       *io_ctx;
+static void       *dpi_ctx;
+static double      present[SIM_MAX_FRAMES];
+static int         present_num;
+static bool        recording = true;
+static int         writing_fb = -1;
+static int         tears;
+static bool        tear_marked;
+static unsigned    rnd = 1;
+static void       *copy_sem;
+static double      stripe_copy_us;
+static uint16_t   *panel_mem;
+static double      bus_bytes;
+
+static esp_lcd_panel_io_color_trans_done_cb_t io_done_cb;
+static esp_lcd_dpi_panel_general_cb_t         dpi_done_cb;
+static esp_lcd_dpi_panel_general_cb_t         dpi_refresh_cb;
+
+static void record_present(double t)
+{
+    if (recording && present_num < SIM_MAX_FRAMES) {
+        present[present_num++] = t;
+    }
+}
+
+static double next_event(void)
+{
+    double t = 1e18;
+    if (spi_q_num) {
+        t = spi_q[spi_q_head].end;
+    }
+    if (dma2d_end >= 0 && dma2d_end < t) {
+        t = dma2d_end;
+    }
+    if (sim.dpi && next_refresh < t) {
+        t = next_refresh;
+    }
+    return t;
+}
+
+static void check_tear(void)
+{
+    if (writing_fb >= 0 && writing_fb == fb_displayed && tear_marked == false) {
+        tears++;
+        tear_marked = true;
+    }
+}
+
+static void process_event(void)
+{
+    double t = next_event();
+    now_us = t;
+    in_isr = true;
+    if (spi_q_num && spi_q[spi_q_head].end == t) {
+        sim_trans_t *trans = &spi_q[spi_q_head];
+        spi_q_head = (spi_q_head + 1) % SIM_MAX_QUEUE;
+        spi_q_num--;
+        if (trans->frame_end) {
+            record_present(t);
+        }
+        if (trans->notify && io_done_cb) {
+            io_done_cb(NULL, NULL, io_ctx);
+        }
+    } else if (dma2d_end >= 0 && dma2d_end == t) {
+        dma2d_end = -1;
+        copy_done_since_refresh = true;
+        if (dpi_done_cb) {
+            dpi_done_cb(NULL, NULL, dpi_ctx);
+        }
+    } else {
+        // Refresh: switch to scheduled frame buffer, or show what dma2d copied since last refresh
+        next_refresh += sim.refresh_us;
+        if (fb_scheduled >= 0) {
+            record_present(t);
+            fb_displayed = fb_scheduled;
+            fb_scheduled = -1;
+        } else if (copy_done_since_refresh) {
+            record_present(t);
+            copy_done_since_refresh = false;
+        }
+        check_tear();
+        if (dpi_refresh_cb) {
+            dpi_refresh_cb(NULL, NULL, dpi_ctx);
+        }
+    }
+    in_isr = false;
+}
+
+static void advance_to(double t)
+{
+    while (next_event() <= t) {
+        process_event();
+    }
+    if (t > now_us) {
+        now_us = t;
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(int max, int init)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(struct sim_sem));
+    sem->max = max;
+    sem->count = init;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    double deadline = now_us + ticks * 1000.0;
+    while (sem->count == 0) {
+        double t = next_event();
+        if (t > deadline) {
+            advance_to(deadline);
+            return pdFALSE;
+        }
+        advance_to(t);
+    }
+    sem->count--;
+    // Render fills bounce buffer right after taking its slot
+    if (sem == copy_sem && in_isr == false) {
+        advance_to(now_us + stripe_copy_us);
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem->count < sem->max) {
+        sem->count++;
+        return pdTRUE;
+    }
+    return pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    *woken = pdTRUE;
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+BaseType_t xPortInIsrContext(void)
+{
+    return in_isr;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)now_us;
+}
+
+/* Sleep ends on tick boundary like vTaskDelay with 1 ms tick */
+void media_lib_thread_sleep(int ms)
+{
+    advance_to(floor(now_us / 1000) * 1000 + ms * 1000.0);
+}
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    return calloc(num, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+void *heap_caps_malloc(size_t size, unsigned caps)
+{
+    (void)caps;
+    if (dma_num == SIM_MAX_DMA) {
+        return NULL;
+    }
+    void *ptr = malloc(size);
+    dma_regions[dma_num] = ptr;
+    dma_sizes[dma_num++] = size;
+    return ptr;
+}
+
+void heap_caps_free(void *ptr)
+{
+    for (int i = 0; i < dma_num; i++) {
+        if (dma_regions[i] == ptr) {
+            dma_num--;
+            dma_regions[i] = dma_regions[dma_num];
+            dma_sizes[i] = dma_sizes[dma_num];
+            break;
+        }
+    }
+    free(ptr);
+}
+
+static bool is_dma(const void *ptr)
+{
+    for (int i = 0; i < dma_num; i++) {
+        const uint8_t *start = dma_regions[i];
+        if ((const uint8_t *)ptr >= start && (const uint8_t *)ptr < start + dma_sizes[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io,
+                                                    const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+    (void)io;
+    io_done_cb = cbs->on_color_trans_done;
+    io_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_dpi_panel_register_event_callbacks(esp_lcd_panel_handle_t panel,
+                                                     const esp_lcd_dpi_panel_event_callbacks_t *cbs, void *user_ctx)
+{
+    (void)panel;
+    dpi_done_cb = cbs->on_color_trans_done;
+    dpi_refresh_cb = cbs->on_refresh_done;
+    dpi_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_dpi_panel_get_frame_buffer(esp_lcd_panel_handle_t dpi_panel, uint32_t fb_num, void **fb0, ...)
+{
+    (void)dpi_panel;
+    if ((int)fb_num > fb_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    va_list ap;
+    va_start(ap, fb0);
+    *fb0 = fbs[0];
+    for (uint32_t i = 1; i < fb_num; i++) {
+        *va_arg(ap, void **) = fbs[i];
+    }
+    va_end(ap);
+    return ESP_OK;
+}
+
+static void spi_wait_all(void)
+{
+    while (spi_q_num) {
+        advance_to(spi_q[spi_q_head].end);
+    }
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data)
+{
+    (void)panel;
+    int bytes = (x_end - x_start) * (y_end - y_start) * 2;
+    if (sim.dpi) {
+        for (int i = 0; i < fb_count; i++) {
+            if (color_data == fbs[i]) {
+                fb_scheduled = i;
+                if (dpi_done_cb) {
+                    dpi_done_cb(NULL, NULL, dpi_ctx);
+                }
+                return ESP_OK;
+            }
+        }
+        dma2d_end = now_us + sim.copy2d_us;
+        return ESP_OK;
+    }
+    bus_bytes += bytes;
+    if (panel_mem) {
+        memcpy(panel_mem + y_start * sim.width, color_data, bytes);
+    }
+    // Command phase is polling transaction, waits for all queued color transactions
+    spi_wait_all();
+    advance_to(now_us + 3 * sim.param_us);
+    int left = bytes;
+    while (left > 0) {
+        int n = left > sim.max_trans ? sim.max_trans : left;
+        while (spi_q_num >= sim.queue_depth) {
+            advance_to(spi_q[spi_q_head].end);
+        }
+        if (is_dma(color_data) == false) {
+            advance_to(now_us + sim.malloc_us + n / sim.cpu_copy_bpus);
+        }
+        double start = spi_last_end > now_us ? spi_last_end : now_us;
+        spi_last_end = start + sim.trans_ovh_us + n / sim.spi_bpus;
+        sim_trans_t *trans = &spi_q[(spi_q_head + spi_q_num) % SIM_MAX_QUEUE];
+        left -= n;
+        trans->end = spi_last_end;
+        trans->notify = (left == 0);
+        trans->frame_end = (left == 0 && y_end == sim.height);
+        spi_q_num++;
+    }
+    return ESP_OK;
+}
+
+static double urand(double lo, double hi)
+{
+    rnd = rnd * 1103515245 + 12345;
+    return lo + (hi - lo) * ((rnd >> 8) & 0xffff) / 65535.0;
+}
+
+static void sim_reset(void)
+{
+    spi_q_head = spi_q_num = 0;
+    spi_last_end = 0;
+    dma2d_end = -1;
+    now_us = 0;
+    next_refresh = sim.refresh_us;
+    fb_displayed = 0;
+    fb_scheduled = -1;
+    copy_done_since_refresh = false;
+    present_num = 0;
+    tears = 0;
+    writing_fb = -1;
+    io_done_cb = NULL;
+    dpi_done_cb = dpi_refresh_cb = NULL;
+    rnd = 1;
+    copy_sem = NULL;
+    bus_bytes = 0;
+}
+
+/* Bounce buffer copy is charged when render takes the slot of the buffer */
+static void set_copy_model(lcd_render_t *lcd, double copy_bpus)
+{
+#if LCD_HAS_IO_HANDLE
+    if (lcd->bounce_lines) {
+        copy_sem = lcd->trans_done;
+        stripe_copy_us = sim.width * lcd->bounce_lines * 2 / copy_bpus;
+    }
+#else
+    (void)lcd;
+    (void)copy_bpus;
+#endif
+}
+
+/* Write frames paced at `period_us` (0 for as fast as render accepts) with decode time in [dec_lo, dec_hi] ms */
+static result_t run(double period_us, double dec_lo, double dec_hi, int fb_num, bool use_io)
+{
+    sim_reset();
+    int frame_size = sim.width * sim.height * 2;
+    fb_count = fb_num;
+    for (int i = 0; i < fb_count; i++) {
+        fbs[i] = calloc(1, frame_size);
+    }
+    uint8_t *psram = calloc(1, frame_size);
+    lcd_render_cfg_t cfg = {
+        .lcd_handle = (esp_lcd_panel_handle_t)1,
+        .dsi_panel = sim.dpi,
+        .use_frame_buffer = fb_num > 0,
+    };
+#if LCD_HAS_IO_HANDLE
+    if (use_io) {
+        cfg.io_handle = (esp_lcd_panel_io_handle_t)1;
+    }
+#else
+    (void)use_io;
+#endif
+    lcd_render_t *lcd = (lcd_render_t *)lcd_render_open(&cfg, sizeof(cfg));
+    av_render_video_frame_info_t info = {
+        .width = sim.width,
+        .height = sim.height,
+        .fps = 30,
+        .type = sim.dpi ? AV_RENDER_VIDEO_RAW_TYPE_RGB565 : AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE,
+    };
+    lcd_render_set_frame_info(lcd, &info);
+    set_copy_model(lcd, sim.cpu_copy_bpus);
+    double blocked = 0;
+    for (int n = 0; n < SIM_FRAMES; n++) {
+        if (period_us > 0 && now_us < n * period_us) {
+            advance_to(n * period_us);
+        }
+        av_render_video_frame_t frame = { .size = frame_size, .data = psram };
+        if (fb_num) {
+            double start = now_us;
+            av_render_frame_buffer_t fb = { 0 };
+            lcd_render_get_frame_buffer(lcd, &fb);
+            blocked += now_us - start;
+            frame.data = fb.data;
+            for (int i = 0; i < fb_count; i++) {
+                if (fbs[i] == fb.data) {
+                    writing_fb = i;
+                }
+            }
+            tear_marked = false;
+            check_tear();
+        }
+        // Decoder writes frame
+        advance_to(now_us + urand(dec_lo, dec_hi) * 1000);
+        writing_fb = -1;
+        double start = now_us;
+        lcd_render_write(lcd, &frame);
+        blocked += now_us - start;
+    }
+    double write_end = now_us;
+    advance_to(now_us + 100000);
+    recording = false;
+    lcd_render_close(lcd);
+    recording = true;
+    for (int i = 0; i < fb_count; i++) {
+        free(fbs[i]);
+    }
+    free(psram);
+    result_t r = { 0 };
+    double sum = 0, sq = 0;
+    int k = 0;
+    for (int i = SIM_WARM_UP + 1; i < present_num; i++) {
+        double d = (present[i] - present[i - 1]) / 1000;
+        sum += d;
+        sq += d * d;
+        k++;
+        if (d > r.max_interval) {
+            r.max_interval = d;
+        }
+    }
+    double mean = k ? sum / k : 0;
+    double var = k ? sq / k - mean * mean : 0;
+    r.shown_fps = mean > 0 ? 1000 / mean : 0;
+    r.jitter = var > 1e-9 ? sqrt(var) : 0;
+    r.accepted_fps = SIM_FRAMES / (write_end / 1e6);
+    r.blocked = blocked / SIM_FRAMES / 1000;
+    r.tears = tears;
+    r.shown = present_num;
+    return r;
+}
+
+#if LCD_HAS_SKIP_UNCHANGED && !CONFIG_IDF_TARGET_ESP32P4
+typedef enum {
+    SCENE_STATIC,
+    SCENE_SMALL_OBJECT,
+    SCENE_FULL_HEIGHT,
+    SCENE_NOISE,
+    SCENE_NUM,
+} scene_t;
+
+typedef struct {
+    double fps;
+    double kb;
+    int    mismatch;
+} skip_result_t;
+
+/* Static gradient with a clock overlay changing once per second of 30fps, plus scene specific motion */
+static void gen_frame(scene_t scene, uint16_t *px, int n)
+{
+    int w = sim.width, h = sim.height;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint16_t v = (uint16_t)(((x * 31 / w) << 11) | ((y * 63 / h) << 5) | ((x + y) & 31));
+            if (scene == SCENE_NOISE) {
+                // Intra-coded content is rarely bit-exact between frames
+                rnd = rnd * 1103515245 + 12345;
+                v ^= (rnd >> 16) & 1;
+            }
+            px[y * w + x] = v;
+        }
+    }
+    int sec = n / 30;
+    for (int y = 8; y < 24; y++) {
+        for (int x = 8; x < 88; x++) {
+            px[y * w + x] = (uint16_t)(0xFFFF - sec * 7 - x);
+        }
+    }
+    if (scene == SCENE_SMALL_OBJECT) {
+        int bx = (n * 4) % (w - 48);
+        for (int y = 100; y < 148; y++) {
+            for (int x = bx; x < bx + 48; x++) {
+                px[y * w + x] = 0xF800;
+            }
+        }
+    } else if (scene == SCENE_FULL_HEIGHT) {
+        int bx = (n * 4) % (w - 64);
+        for (int y = 0; y < h; y++) {
+            for (int x = bx; x < bx + 64; x++) {
+                px[y * w + x] = (uint16_t)(0x07E0 + y);
+            }
+        }
+    }
+}
+
+/* Write scene frames unpaced with decode time in [dec_lo, dec_hi] ms, render in decoder thread */
+static skip_result_t run_skip(scene_t scene, double dec_lo, double dec_hi, bool skip)
+{
+    sim_reset();
+    int frame_size = sim.width * sim.height * 2;
+    uint16_t *src = calloc(1, frame_size);
+    panel_mem = calloc(1, frame_size);
+    lcd_render_cfg_t cfg = {
+        .lcd_handle = (esp_lcd_panel_handle_t)1,
+        .io_handle = (esp_lcd_panel_io_handle_t)1,
+        .skip_unchanged = skip,
+    };
+    lcd_render_t *lcd = (lcd_render_t *)lcd_render_open(&cfg, sizeof(cfg));
+    av_render_video_frame_info_t info = {
+        .width = sim.width,
+        .height = sim.height,
+        .fps = 30,
+        .type = AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE,
+    };
+    lcd_render_set_frame_info(lcd, &info);
+    set_copy_model(lcd, skip ? sim.hash_copy_bpus : sim.cpu_copy_bpus);
+    skip_result_t r = { 0 };
+    for (int n = 0; n < SIM_FRAMES; n++) {
+        gen_frame(scene, src, n);
+        advance_to(now_us + urand(dec_lo, dec_hi) * 1000);
+        av_render_video_frame_t frame = { .size = frame_size, .data = (uint8_t *)src };
+        lcd_render_write(lcd, &frame);
+        if (memcmp(panel_mem, src, frame_size)) {
+            r.mismatch++;
+        }
+    }
+    r.fps = SIM_FRAMES / (now_us / 1e6);
+    r.kb = bus_bytes / SIM_FRAMES / 1024;
+    lcd_render_close(lcd);
+    free(panel_mem);
+    panel_mem = NULL;
+    free(src);
+    return r;
+}
+
+static int skip_test(void)
+{
+    static const char *scene_names[SCENE_NUM] = {
+        "static + 1 Hz clock",
+        "48x48 object moving",
+        "full height motion",
+        "+-1 LSB noise everywhere",
+    };
+    int mismatch = 0;
+    printf("SPI 320x240 60MHz 1-line, copy 40MB/s, copy with hash 20MB/s\n");
+    for (int scene = 0; scene < SCENE_NUM; scene++) {
+        for (int d = 0; d < 2; d++) {
+            double lo = d ? 6 : 0, hi = d ? 10 : 0;
+            skip_result_t full = run_skip(scene, lo, hi, false);
+            skip_result_t part = run_skip(scene, lo, hi, true);
+            printf("%-26s decode %-6s  full frame: %6.1f kB %5.1f fps | skip_unchanged: %6.1f kB %5.1f fps  "
+                   "mismatch %d/%d\n",
+                   scene_names[scene], d ? "6-10ms" : "0", full.kb, full.fps, part.kb, part.fps,
+                   full.mismatch + part.mismatch, SIM_FRAMES * 2);
+            mismatch += full.mismatch + part.mismatch;
+        }
+    }
+    return mismatch ? 1 : 0;
+}
+#endif
+
+static void print_result(const char *name, result_t r)
+{
+    printf("%-34s accepted %6.1f fps  shown %5.1f fps  jitter(sd) %5.2f ms  max %6.2f ms  "
+           "blocked %5.2f ms/frame  torn %3d/%d\n",
+           name, r.accepted_fps, r.shown_fps, r.jitter, r.max_interval, r.blocked, r.tears, r.shown);
+}
+
+int main(int argc, char *argv[])
+{
+    bool skip_mode = (argc > 1 && strcmp(argv[1], "skip") == 0);
+    if (argc > 1 && skip_mode == false) {
+        printf("Usage: %s [skip]\n", argv[0]);
+        return 1;
+    }
+#if CONFIG_IDF_TARGET_ESP32P4
+    if (skip_mode) {
+        printf("skip mode needs the SPI build\n");
+        return 1;
+    }
+    sim = (sim_cfg_t) {
+        .dpi = 1,
+        .width = 1024,
+        .height = 600,
+        .refresh_us = 1e6 / 60,
+        .copy2d_us = 5000,
+    };
+    printf("DPI 1024x600 60Hz, dma2d copy 5 ms\n");
+    print_result("copy, decode 0 (fifo full)", run(0, 0, 0, 0, false));
+    print_result("copy, decode 8-12 ms unpaced", run(0, 8, 12, 0, false));
+    print_result("copy, 30fps, decode 20-30 ms", run(1e6 / 30, 20, 30, 0, false));
+    sim.copy2d_us = 12000;
+    print_result("copy 12ms, decode 0 (fifo full)", run(0, 0, 0, 0, false));
+    print_result("copy 12ms, decode 8-12 ms unpaced", run(0, 8, 12, 0, false));
+    sim.copy2d_us = 5000;
+    print_result("fb x2, decode 8-12 ms unpaced", run(0, 8, 12, 2, false));
+    print_result("fb x2, 30fps, decode 20-30 ms", run(1e6 / 30, 20, 30, 2, false));
+    print_result("fb x3, decode 8-12 ms unpaced", run(0, 8, 12, 3, false));
+    print_result("fb x3, 30fps, decode 20-30 ms", run(1e6 / 30, 20, 30, 3, false));
+#else
+    sim = (sim_cfg_t) {
+        .dpi = 0,
+        .width = 320,
+        .height = 240,
+        .spi_bpus = 7.5,
+        .cpu_copy_bpus = 40,
+        .hash_copy_bpus = 20,
+        .trans_ovh_us = 10,
+        .param_us = 15,
+        .malloc_us = 8,
+        .max_trans = 4092,
+        .queue_depth = 10,
+    };
+    if (skip_mode) {
+#if LCD_HAS_SKIP_UNCHANGED && !CONFIG_IDF_TARGET_ESP32P4
+        return skip_test();
+#else
+        printf("skip mode needs a render with skip_unchanged\n");
+        return 1;
+#endif
+    }
+    printf("SPI 320x240 60MHz 1-line, PSRAM copy 40MB/s\n");
+    print_result("decode 0 (fifo full)", run(0, 0, 0, 0, true));
+    print_result("decode 6-10 ms unpaced", run(0, 6, 10, 0, true));
+    print_result("30fps, decode 6-10 ms", run(1e6 / 30, 6, 10, 0, true));
+#endif
+    return 0;
+}
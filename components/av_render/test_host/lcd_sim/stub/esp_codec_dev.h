@@ -0,0 +1,4 @@
+/* Host stub of esp_codec_dev.h, only what av_render.h uses */
+#pragma once
+
+typedef void *esp_codec_dev_handle_t;
@@ -0,0 +1,10 @@
+/* Host stub of esp_heap_caps.h, regions allocated here are treated as DMA capable by the emulated bus */
+#pragma once
+
+#include <stddef.h>
+
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+void *heap_caps_malloc(size_t size, unsigned caps);
+void heap_caps_free(void *ptr);
@@ -0,0 +1,9 @@
+/* Host stub of esp_lcd_panel_ops.h, only what lcd_render.c uses */
+#pragma once
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_lcd_types.h"
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data);
@@ -0,0 +1,7 @@
+/* Host stub of esp_lcd_types.h */
+#pragma once
+
+#include "esp_err.h"
+
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
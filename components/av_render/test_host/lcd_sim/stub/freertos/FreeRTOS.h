@@ -0,0 +1,14 @@
+/* Host stub of FreeRTOS.h, only what lcd_render.c uses */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef int      BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE            (1)
+#define pdFALSE           (0)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+BaseType_t xPortInIsrContext(void);
@@ -0,0 +1,9 @@
+/* Host stub of media_lib_err.h, only what lcd_render.c and av_render_types.h use */
+#pragma once
+
+#define ESP_MEDIA_ERR_OK            (0)
+#define ESP_MEDIA_ERR_FAIL          (-1)
+#define ESP_MEDIA_ERR_NO_MEM        (-2)
+#define ESP_MEDIA_ERR_INVALID_ARG   (-3)
+#define ESP_MEDIA_ERR_WRONG_STATE   (-4)
+#define ESP_MEDIA_ERR_NOT_SUPPORT   (-5)
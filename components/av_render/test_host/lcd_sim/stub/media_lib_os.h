@@ -0,0 +1,16 @@
+/* Host stub of media_lib_os.h, only what lcd_render.c and av_render.h use */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MEDIA_LIB_MAX_LOCK_TIME (0xFFFFFFFF)
+
+typedef void *media_lib_mutex_handle_t;
+typedef void *media_lib_event_grp_handle_t;
+typedef void *media_lib_thread_handle_t;
+
+void *media_lib_malloc(size_t size);
+void *media_lib_calloc(size_t num, size_t size);
+void media_lib_free(void *ptr);
+void media_lib_thread_sleep(int ms);
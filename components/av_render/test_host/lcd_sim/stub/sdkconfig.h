@@ -0,0 +1,4 @@
+/* Host stub of sdkconfig.h, build with -DCONFIG_IDF_TARGET_ESP32P4=1 for the DPI panel path */
+#pragma once
+
+#define SOC_LCD_RGB_SUPPORTED 0
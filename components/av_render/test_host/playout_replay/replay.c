@@ -0,0 +1,201 @@
+/*
+ * Audio playout replay on host
+ *
+ * Generates network jitter traces (exponential jitter, stall bursts, sender clock drift) for 20ms audio packets
+ * and replays them through the audio render fifo, comparing fixed threshold policies used before the adaptive
+ * playout controller (`src/audio_playout.c`) with the controller itself
+ * Reports mean mouth-to-ear latency, playback gaps, gap time per minute and dropped packets
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "audio_playout.h"
+
+#define FRAME_MS      (20)
+#define MAX_PACKETS   (40000)
+#define TRACE_PACKETS (15000) /* 300 seconds */
+#define TRACE_SEEDS   (5)
+#define SIM_STEP_MS   (0.1)
+#define RECHECK_MS    (10)
+#define DROP_DELAY_MS (200)
+
+typedef struct {
+    const char *name;
+    double      base;          /* Base transit (ms) */
+    double      jitter_mean;   /* Mean of exponential jitter (ms) */
+    double      stall_every_s; /* Mean interval between stalls, 0 for none */
+    double      stall_min;     /* Stall length range (ms) */
+    double      stall_max;
+    double      drift_ppm;     /* Sender clock drift */
+} trace_cfg_t;
+
+typedef struct {
+    double   send;
+    uint32_t pts;
+    double   arrive;
+} packet_t;
+
+typedef enum {
+    POLICY_THRESHOLD, /* Start at threshold, rebuffer when fewer than 3 packets, drop above 200ms */
+    POLICY_PLAYOUT,   /* Adaptive playout controller */
+} policy_t;
+
+typedef struct {
+    double lat_sum;
+    int    played;
+    int    dropped;
+    int    gaps;
+    double gap_ms;
+    double target_sum;
+} result_t;
+
+static double urand(void)
+{
+    return (rand() + 0.5) / ((double)RAND_MAX + 1);
+}
+
+static void gen_trace(const trace_cfg_t *c, packet_t *p, int n, unsigned seed)
+{
+    srand(seed);
+    double next_stall = c->stall_every_s ? -log(urand()) * c->stall_every_s * 1000 : 1e18;
+    double stall_end = -1, prev = 0;
+    for (int i = 0; i < n; i++) {
+        p[i].pts = i * FRAME_MS;
+        p[i].send = i * FRAME_MS * (1.0 + c->drift_ppm / 1e6);
+        double a = p[i].send + c->base - log(urand()) * c->jitter_mean;
+        if (p[i].send >= next_stall) {
+            stall_end = p[i].send + c->stall_min + urand() * (c->stall_max - c->stall_min);
+            next_stall = p[i].send - log(urand()) * c->stall_every_s * 1000;
+        }
+        if (p[i].send < stall_end && a < stall_end + c->base) {
+            a = stall_end + c->base;
+        }
+        // Jitter buffer delivers in order
+        if (a < prev) {
+            a = prev;
+        }
+        p[i].arrive = a;
+        prev = a;
+    }
+}
+
+/* Fifo holds packets [head, tail), render consumes one packet per FRAME_MS / speed */
+static void replay(const packet_t *pk, int n, policy_t policy, int threshold_ms, audio_playout_t *po, result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    int head = 0, tail = 0;
+    double busy_until = 0, next_check = 0, silent_start = 0;
+    bool rendered = false, started = false, silent = false;
+    float speed = 1.0f;
+    double end = pk[n - 1].arrive + 2000;
+    for (double t = 0; t < end; t += SIM_STEP_MS) {
+        while (tail < n && pk[tail].arrive <= t) {
+            if (policy == POLICY_PLAYOUT) {
+                audio_playout_on_arrival(po, pk[tail].pts, (uint32_t)pk[tail].arrive);
+            }
+            tail++;
+        }
+        if (t < busy_until) {
+            continue;
+        }
+        bool dry = started && t >= busy_until + 1;
+        while (t >= next_check && head < tail) {
+            int q_num = tail - head;
+            int delay = q_num * FRAME_MS;
+            bool skip = false;
+            if (policy == POLICY_THRESHOLD) {
+                if (threshold_ms) {
+                    if (rendered == false) {
+                        if (delay < threshold_ms) {
+                            next_check = t + RECHECK_MS;
+                            break;
+                        }
+                    } else if (q_num < 3) {
+                        rendered = false;
+                        next_check = t + RECHECK_MS;
+                        break;
+                    }
+                }
+                skip = delay >= DROP_DELAY_MS;
+            } else if (audio_playout_check(po, delay, dry, &skip) == false) {
+                next_check = t + RECHECK_MS;
+                break;
+            }
+            head++;
+            if (skip) {
+                r->dropped++;
+                continue;
+            }
+            if (policy == POLICY_PLAYOUT) {
+                speed = audio_playout_get_speed(po, delay);
+                r->target_sum += po->target;
+            }
+            rendered = true;
+            if (silent) {
+                r->gaps++;
+                r->gap_ms += t - silent_start;
+                silent = false;
+            }
+            if (started && t < busy_until + 1) {
+                t = busy_until;
+            }
+            started = true;
+            r->lat_sum += t - pk[head - 1].send;
+            r->played++;
+            busy_until = t + FRAME_MS / speed;
+            break;
+        }
+        if (started && silent == false && t >= busy_until + 1) {
+            silent = true;
+            silent_start = busy_until;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    static const trace_cfg_t traces[] = {
+        { "clean wifi",          20, 3,  0,  0,   0,   0    },
+        { "busy wifi",           25, 10, 3,  60,  160, 0    },
+        { "stall bursts",        25, 8,  8,  200, 400, 0    },
+        { "rare stall",          20, 3,  60, 150, 250, 0    },
+        { "busy + drift 300ppm", 25, 10, 3,  60,  160, -300 },
+    };
+    static const struct {
+        const char *name;
+        policy_t    policy;
+        int         threshold;
+    } policies[] = {
+        { "threshold 0",      POLICY_THRESHOLD, 0   },
+        { "threshold 100ms",  POLICY_THRESHOLD, 100 },
+        { "threshold 60ms",   POLICY_THRESHOLD, 60  },
+        { "playout default",  POLICY_PLAYOUT,   0   },
+    };
+    static packet_t pk[MAX_PACKETS];
+    double minutes = TRACE_PACKETS * FRAME_MS / 60000.0;
+    printf("%-22s %-18s %8s %7s %9s %7s %7s\n", "trace", "policy", "lat_ms", "gaps", "gap_ms/m", "drops", "target");
+    for (int ti = 0; ti < (int)(sizeof(traces) / sizeof(traces[0])); ti++) {
+        for (int pi = 0; pi < (int)(sizeof(policies) / sizeof(policies[0])); pi++) {
+            double lat = 0, gaps = 0, gap_ms = 0, drops = 0, target = 0;
+            for (int s = 0; s < TRACE_SEEDS; s++) {
+                gen_trace(&traces[ti], pk, TRACE_PACKETS, 1234 + s * 77);
+                audio_playout_t po;
+                audio_playout_init(&po, NULL);
+                result_t r;
+                replay(pk, TRACE_PACKETS, policies[pi].policy, policies[pi].threshold, &po, &r);
+                lat += r.lat_sum / r.played;
+                gaps += r.gaps;
+                gap_ms += r.gap_ms;
+                drops += r.dropped;
+                target += r.played ? r.target_sum / r.played : 0;
+            }
+            printf("%-22s %-18s %8.1f %7.1f %9.1f %7.1f %7.0f\n", traces[ti].name, policies[pi].name,
+                   lat / TRACE_SEEDS, gaps / TRACE_SEEDS, gap_ms / TRACE_SEEDS / minutes, drops / TRACE_SEEDS,
+                   target / TRACE_SEEDS);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,5 @@
+/* Host stub of media_lib_err.h, only what av_render_types.h uses */
+#pragma once
+
+#define ESP_MEDIA_ERR_OK     (0)
+#define ESP_MEDIA_ERR_NO_MEM (-2)
@@ -0,0 +1,276 @@
+/*
+ * Fused resample benchmark and quality check on host
+ *
+ * Compares fused single pass conversion (`src/fused_resample.c`) with the same kernels run as separate passes
+ * (downmix, rate, bit depth, mono to stereo) through intermediate buffers, as the chained path does
+ * Note: chained side reuses fused rate kernel since `esp_audio_effects` is not available on host, so speed only
+ * shows the cost of extra passes, it is not a comparison with `esp_audio_effects` filters
+ *
+ * Checks, exit with failure when any does not hold:
+ *   - Fused and chained outputs are bit-exact
+ *   - THD+N of 1kHz tone at -1dBFS stays below THDN_LIMIT_DB for 16 bits output
+ *   - Output does not depend on input frame size
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "fused_resample.h"
+
+#define BENCH_SECONDS (20)
+#define BENCH_REPEAT  (5)
+#define TONE_HZ       (1000.0)
+#define TONE_AMP      (29204) /* -1 dBFS */
+#define THDN_LIMIT_DB (-80.0)
+#define WORK_BUF_SIZE (1 << 20)
+
+typedef struct {
+    int in_rate;
+    int in_ch;
+    int out_rate;
+    int out_ch;
+    int out_bits;
+} bench_case_t;
+
+typedef struct {
+    bench_case_t            c;
+    fused_resample_handle_t rate; /* Rate only, 16 bits, channel count of filter */
+    int                     filter_ch;
+    int16_t                *mix_buf;
+    int16_t                *rate_buf;
+    uint8_t                *bit_buf;
+} chain_t;
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    return calloc(num, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void chain_open(chain_t *ch, const bench_case_t *c)
+{
+    ch->c = *c;
+    ch->filter_ch = c->out_ch == 1 ? 1 : c->in_ch;
+    av_render_audio_frame_info_t in = { .sample_rate = c->in_rate, .channel = ch->filter_ch, .bits_per_sample = 16 };
+    av_render_audio_frame_info_t out = { .sample_rate = c->out_rate, .channel = ch->filter_ch, .bits_per_sample = 16 };
+    ch->rate = c->in_rate != c->out_rate ? fused_resample_open(&in, &out) : NULL;
+    ch->mix_buf = malloc(WORK_BUF_SIZE);
+    ch->rate_buf = malloc(WORK_BUF_SIZE);
+    ch->bit_buf = malloc(WORK_BUF_SIZE);
+}
+
+static void chain_close(chain_t *ch)
+{
+    if (ch->rate) {
+        fused_resample_close(ch->rate);
+    }
+    free(ch->mix_buf);
+    free(ch->rate_buf);
+    free(ch->bit_buf);
+}
+
+static uint32_t chain_process(chain_t *ch, int16_t *in, uint32_t n, uint8_t *out)
+{
+    bench_case_t *c = &ch->c;
+    int16_t *cur = in;
+    if (c->in_ch == 2 && c->out_ch == 1) {
+        for (uint32_t i = 0; i < n; i++) {
+            ch->mix_buf[i] = (in[2 * i] + in[2 * i + 1]) >> 1;
+        }
+        cur = ch->mix_buf;
+    }
+    if (ch->rate) {
+        n = fused_resample_process(ch->rate, (uint8_t *)cur, n, (uint8_t *)ch->rate_buf);
+        cur = ch->rate_buf;
+    }
+    uint8_t *p = (uint8_t *)cur;
+    int bytes = 2;
+    if (c->out_bits != 16) {
+        int m = n * ch->filter_ch;
+        if (c->out_bits == 32) {
+            int32_t *d = (int32_t *)ch->bit_buf;
+            for (int i = 0; i < m; i++) {
+                d[i] = (int32_t)cur[i] << 16;
+            }
+        } else {
+            for (int i = 0; i < m; i++) {
+                ch->bit_buf[i * 3] = 0;
+                ch->bit_buf[i * 3 + 1] = cur[i];
+                ch->bit_buf[i * 3 + 2] = cur[i] >> 8;
+            }
+        }
+        p = ch->bit_buf;
+        bytes = c->out_bits / 8;
+    }
+    if (ch->filter_ch == 1 && c->out_ch == 2) {
+        for (uint32_t i = 0; i < n; i++) {
+            memcpy(out + i * 2 * bytes, p + i * bytes, bytes);
+            memcpy(out + i * 2 * bytes + bytes, p + i * bytes, bytes);
+        }
+    } else {
+        memcpy(out, p, n * ch->filter_ch * bytes);
+    }
+    return n;
+}
+
+/* THD+N of tone in first channel: residual after least square fit of a * sin + b * cos + d */
+static double thdn_db(const int16_t *o, int n, int stride, int rate, double f0)
+{
+    double s11 = 0, s12 = 0, s13 = 0, s22 = 0, s23 = 0, s33 = 0, y1 = 0, y2 = 0, y3 = 0;
+    for (int i = 0; i < n; i++) {
+        double w = 2 * M_PI * f0 * i / rate, a = sin(w), b = cos(w), y = o[i * stride];
+        s11 += a * a;
+        s12 += a * b;
+        s13 += a;
+        s22 += b * b;
+        s23 += b;
+        s33 += 1;
+        y1 += a * y;
+        y2 += b * y;
+        y3 += y;
+    }
+    double det = s11 * (s22 * s33 - s23 * s23) - s12 * (s12 * s33 - s23 * s13) + s13 * (s12 * s23 - s22 * s13);
+    double A = (y1 * (s22 * s33 - s23 * s23) - s12 * (y2 * s33 - s23 * y3) + s13 * (y2 * s23 - s22 * y3)) / det;
+    double B = (s11 * (y2 * s33 - s23 * y3) - y1 * (s12 * s33 - s23 * s13) + s13 * (s12 * y3 - y2 * s13)) / det;
+    double D = (s11 * (s22 * y3 - y2 * s23) - s12 * (s12 * y3 - y2 * s13) + y1 * (s12 * s23 - s22 * s13)) / det;
+    double sig = 0, res = 0;
+    for (int i = 0; i < n; i++) {
+        double w = 2 * M_PI * f0 * i / rate, fit = A * sin(w) + B * cos(w) + D;
+        sig += (fit - D) * (fit - D);
+        res += (o[i * stride] - fit) * (o[i * stride] - fit);
+    }
+    return 10 * log10(res / sig);
+}
+
+/* Feed random frame sizes of 1-7 samples, output must match 20ms frames */
+static int check_frame_size(void)
+{
+    av_render_audio_frame_info_t in = { .sample_rate = 8000, .channel = 2, .bits_per_sample = 16 };
+    av_render_audio_frame_info_t out = { .sample_rate = 44100, .channel = 1, .bits_per_sample = 24 };
+    int n = 8000;
+    int16_t *x = malloc(n * 4);
+    uint8_t *a = malloc(n * 20), *b = malloc(n * 20);
+    for (int k = 0; k < n * 2; k++) {
+        x[k] = rand() % 65536 - 32768;
+    }
+    fused_resample_handle_t f = fused_resample_open(&in, &out);
+    fused_resample_handle_t g = fused_resample_open(&in, &out);
+    uint32_t na = 0, nb = 0;
+    for (int k = 0; k < n; k += 160) {
+        na += fused_resample_process(f, (uint8_t *)(x + k * 2), 160, a + na * 3);
+    }
+    for (int k = 0; k < n;) {
+        int m = 1 + rand() % 7;
+        if (k + m > n) {
+            m = n - k;
+        }
+        nb += fused_resample_process(g, (uint8_t *)(x + k * 2), m, b + nb * 3);
+        k += m;
+    }
+    int ret = (na == nb && memcmp(a, b, na * 3) == 0) ? 0 : -1;
+    printf("frame size independence: %s (%u / %u samples)\n", ret == 0 ? "ok" : "FAIL", (unsigned)na, (unsigned)nb);
+    fused_resample_close(f);
+    fused_resample_close(g);
+    free(x);
+    free(a);
+    free(b);
+    return ret;
+}
+
+int main(void)
+{
+    static const bench_case_t cases[] = {
+        { 8000,  1, 16000, 2, 16 },
+        { 8000,  1, 48000, 2, 16 },
+        { 16000, 1, 48000, 2, 16 },
+        { 48000, 1, 48000, 2, 16 },
+        { 8000,  1, 44100, 2, 16 },
+        { 16000, 1, 44100, 2, 16 },
+        { 16000, 1, 48000, 2, 32 },
+        { 48000, 2, 48000, 1, 16 },
+    };
+    int fails = 0;
+    printf("%-26s %11s %11s %10s %10s %9s\n", "case", "fused Ms/s", "chain Ms/s", "fused us", "chain us", "THD+N dB");
+    for (int ci = 0; ci < (int)(sizeof(cases) / sizeof(cases[0])); ci++) {
+        const bench_case_t *c = &cases[ci];
+        int frame = c->in_rate / 50;
+        int total = c->in_rate * BENCH_SECONDS;
+        int16_t *in = malloc(total * c->in_ch * 2);
+        for (int i = 0; i < total; i++) {
+            for (int k = 0; k < c->in_ch; k++) {
+                in[i * c->in_ch + k] = (int16_t)lrint(TONE_AMP * sin(2 * M_PI * TONE_HZ * i / c->in_rate));
+            }
+        }
+        int out_bytes = c->out_ch * c->out_bits / 8;
+        size_t out_cap = (size_t)(c->out_rate * (BENCH_SECONDS + 1)) * out_bytes;
+        uint8_t *of = malloc(out_cap), *oc = malloc(out_cap);
+        av_render_audio_frame_info_t ii = { .sample_rate = c->in_rate, .channel = c->in_ch, .bits_per_sample = 16 };
+        av_render_audio_frame_info_t oo = { .sample_rate = c->out_rate, .channel = c->out_ch, .bits_per_sample = c->out_bits };
+        double best_f = 1e9, best_c = 1e9;
+        uint32_t nf = 0, nc = 0;
+        for (int rep = 0; rep < BENCH_REPEAT; rep++) {
+            fused_resample_handle_t f = fused_resample_open(&ii, &oo);
+            chain_t ch;
+            chain_open(&ch, c);
+            double t0 = now_s();
+            nf = 0;
+            for (int i = 0; i + frame <= total; i += frame) {
+                nf += fused_resample_process(f, (uint8_t *)(in + i * c->in_ch), frame, of + (size_t)nf * out_bytes);
+            }
+            double t1 = now_s();
+            nc = 0;
+            for (int i = 0; i + frame <= total; i += frame) {
+                nc += chain_process(&ch, in + i * c->in_ch, frame, oc + (size_t)nc * out_bytes);
+            }
+            double t2 = now_s();
+            best_f = t1 - t0 < best_f ? t1 - t0 : best_f;
+            best_c = t2 - t1 < best_c ? t2 - t1 : best_c;
+            fused_resample_close(f);
+            chain_close(&ch);
+        }
+        int frames = total / frame;
+        char name[64];
+        snprintf(name, sizeof(name), "%d/%dch -> %d/%dch/%db", c->in_rate, c->in_ch, c->out_rate, c->out_ch, c->out_bits);
+        char thdn[16] = "n/a";
+        if (c->out_bits == 16) {
+            int skip = c->out_rate / 10;
+            double db = thdn_db((int16_t *)of + skip * c->out_ch, nf - 2 * skip, c->out_ch, c->out_rate, TONE_HZ);
+            snprintf(thdn, sizeof(thdn), "%.1f", db);
+            if (db > THDN_LIMIT_DB) {
+                printf("  THD+N above %.0f dB\n", THDN_LIMIT_DB);
+                fails++;
+            }
+        }
+        if (nf != nc || memcmp(of, oc, (size_t)nf * out_bytes)) {
+            printf("  fused and chained outputs differ: %u vs %u samples\n", (unsigned)nf, (unsigned)nc);
+            fails++;
+        }
+        printf("%-26s %11.1f %11.1f %10.2f %10.2f %9s\n", name, total / best_f / 1e6, total / best_c / 1e6,
+               best_f / frames * 1e6, best_c / frames * 1e6, thdn);
+        free(in);
+        free(of);
+        free(oc);
+    }
+    if (check_frame_size() != 0) {
+        fails++;
+    }
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+/* Host stub of media_lib_os.h, only what fused_resample.c uses */
+#pragma once
+
+#include <stddef.h>
+
+void *media_lib_malloc(size_t size);
+void *media_lib_calloc(size_t num, size_t size);
+void media_lib_free(void *ptr);
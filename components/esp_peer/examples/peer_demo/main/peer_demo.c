@@ -315,7 +315,13 @@ void app_main()
     // Create SoftAP
     wifi_init_softap();
 
+    // Keep DTLS certificate in NVS so that later boots skip key generation
+    esp_peer_cert_store_t cert_store;
+    esp_peer_get_nvs_cert_store(NULL, &cert_store);
+    esp_peer_set_cert_store(&cert_store);
+    int64_t cert_start = esp_timer_get_time();
     esp_peer_pre_generate_cert();
+    ESP_LOGI(TAG, "Prepare DTLS cert cost %dms", (int)((esp_timer_get_time() - cert_start) / 1000));
 
 
     sys_state_heap_trace(true);
@@ -567,6 +567,34 @@ int esp_peer_send_data(esp_peer_handle_t peer, esp_peer_data_frame_t *frame);
  */
 int esp_peer_main_loop(esp_peer_handle_t peer);
 
+/**
+ * @brief  Wait until peer main loop has work to do
+ *
+ * @note  It blocks until any socket used by peer becomes readable, data or message is sent through peer,
+ *        `esp_peer_wakeup` is called or `timeout_ms` elapsed
+ *        User can call it instead of fixed sleep between `esp_peer_main_loop` to reduce receive latency
+ *        `timeout_ms` should not exceed the timer granularity required by peer (e.g. 10ms)
+ *
+ * @param[in]  peer        Peer handle
+ * @param[in]  timeout_ms  Maximum time to wait in milliseconds
+ *
+ * @return
+ *       - ESP_PEER_ERR_NONE         Woken up by event or timeout
+ *       - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ */
+int esp_peer_wait_event(esp_peer_handle_t peer, uint32_t timeout_ms);
+
+/**
+ * @brief  Wake up `esp_peer_wait_event` immediately
+ *
+ * @param[in]  peer  Peer handle
+ *
+ * @return
+ *       - ESP_PEER_ERR_NONE         On success
+ *       - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ */
+int esp_peer_wakeup(esp_peer_handle_t peer);
+
 /**
  * @brief  Disconnect peer connection
  *
@@ -638,6 +666,10 @@ int esp_peer_close(esp_peer_handle_t peer);
  *       Important considerations:
  *       - Generated materials are stored in internal memory and persist until reset
  *       - Each call overwrites any previously generated materials
+ *       - When persistent store is set through `esp_peer_set_cert_store`, valid stored materials are loaded
+ *         instead of generated, and newly generated ones are saved into the store
+ *       - DTLS configuration (parsed certificate, key, fingerprint, cookie and RNG context) is also prepared here
+ *         and shared by all connections, so later connections only create their own SSL context
  *
  * @return
  *       - ESP_PEER_ERR_NONE  On success
@@ -645,6 +677,68 @@ int esp_peer_close(esp_peer_handle_t peer);
  */
 int esp_peer_pre_generate_cert(void);
 
+/**
+ * @brief  Background certificate generator configuration
+ */
+typedef struct {
+    uint32_t rotate_sessions; /*!< Switch to standby certificate after this many DTLS sessions, 0 to disable */
+    uint32_t rotate_hours;    /*!< Switch to standby certificate after active one used for this many hours, 0 to disable */
+    uint32_t stack_size;      /*!< Generator thread stack size, 0 to use default (8KB) */
+    int      prio;            /*!< Generator thread priority, keep it low so that key generation only takes idle CPU */
+    int      core;            /*!< Generator thread core id */
+} esp_peer_cert_gen_cfg_t;
+
+/**
+ * @brief  Certificate usage statistics
+ */
+typedef struct {
+    uint32_t sessions;     /*!< DTLS sessions which acquired certificate */
+    uint32_t generated;    /*!< Certificates generated (inline or in background) */
+    uint32_t rotated;      /*!< Times standby certificate was switched in */
+    uint32_t waited;       /*!< Sessions which had to wait for certificate generation */
+    uint32_t wait_ms;      /*!< Total wait time in milliseconds */
+    uint32_t max_wait_ms;  /*!< Longest single wait in milliseconds */
+} esp_peer_cert_stats_t;
+
+/**
+ * @brief  Start background certificate generator
+ *
+ * @note  Generator keeps one active and one standby certificate/key pair ready
+ *        New DTLS sessions always take the active one, and switch to the standby one when rotation condition matched
+ *        so that session setup never waits for key generation except on the very first certificate
+ *
+ * @param[in]  cfg  Generator configuration
+ *
+ * @return
+ *       - ESP_PEER_ERR_NONE         On success
+ *       - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_PEER_ERR_NO_MEM       Not enough memory
+ *       - ESP_PEER_ERR_WRONG_STATE  Generator already started
+ *       - ESP_PEER_ERR_FAIL         Fail to create generator thread
+ */
+int esp_peer_start_cert_generator(esp_peer_cert_gen_cfg_t *cfg);
+
+/**
+ * @brief  Stop background certificate generator
+ *
+ * @note  Active certificate is kept, standby one is released
+ *
+ * @return
+ *       - ESP_PEER_ERR_NONE  On success
+ */
+int esp_peer_stop_cert_generator(void);
+
+/**
+ * @brief  Get certificate usage statistics
+ *
+ * @param[out]  stats  Statistics to fill
+ *
+ * @return
+ *       - ESP_PEER_ERR_NONE         On success
+ *       - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ */
+int esp_peer_get_cert_stats(esp_peer_cert_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
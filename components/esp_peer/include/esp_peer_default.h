@@ -112,6 +112,138 @@ typedef enum {
  */
 int esp_peer_set_dtls_cipher_pref(esp_peer_dtls_cipher_pref_t pref);
 
+/**
+ * @brief  Persistent store for DTLS certificate and private key
+ *         Lets `esp_peer_pre_generate_cert` and the first DTLS handshake after boot load the self-signed
+ *         certificate instead of generating a new key pair and signing it again
+ *
+ * @note  Certificate and key are null-terminated PEM strings, both fit into 2048 bytes
+ *        Rotation needs a valid system time (SNTP synced), without it the stored certificate is always reused
+ */
+typedef struct {
+    int (*load)(void *ctx, char *cert_pem, int cert_size, char *key_pem, int key_size); /*!< Load stored PEM data, return 0 on success */
+    int (*save)(void *ctx, const char *cert_pem, const char *key_pem);                 /*!< Save PEM data, return 0 on success */
+    void     *ctx;                                                                      /*!< User context passed to `load` and `save` */
+    uint32_t  rotate_days;                                                              /*!< Regenerate once stored certificate is older than this,
+                                                                                             0 to keep it until it expires */
+} esp_peer_cert_store_t;
+
+/**
+ * @brief  Set persistent store for DTLS certificate
+ *
+ * @note  Call it before `esp_peer_pre_generate_cert` or the first peer connection
+ *        Store is copied, but `ctx` must stay valid while store is in use
+ *
+ * @param[in]  store  Certificate store, set to NULL to keep certificate in RAM only
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  Missing `load` or `save` callback
+ */
+int esp_peer_set_cert_store(const esp_peer_cert_store_t *store);
+
+/**
+ * @brief  Get certificate store backed by NVS
+ *
+ * @note  NVS flash must be initialized by application (`nvs_flash_init`)
+ * @note  DTLS private key is written as PEM string, it is stored in plaintext unless NVS encryption
+ *        (`CONFIG_NVS_ENCRYPTION`, initialized through `nvs_flash_secure_init` or flash encryption) is enabled
+ *        Anyone reading flash can impersonate the device fingerprint otherwise, keep store in RAM when not protected
+ *
+ * @param[in]   name_space  NVS namespace, NULL to use "esp_peer" (string must stay valid)
+ * @param[out]  store       Certificate store to fill
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  Invalid argument
+ */
+int esp_peer_get_nvs_cert_store(const char *name_space, esp_peer_cert_store_t *store);
+
+/**
+ * @brief  Get certificate store backed by file (for Linux host or mounted file system)
+ *
+ * @param[in]   path   File path to keep certificate and key (string must stay valid)
+ * @param[out]  store  Certificate store to fill
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  Invalid argument
+ */
+int esp_peer_get_file_cert_store(const char *path, esp_peer_cert_store_t *store);
+
+/**
+ * @brief  Maximum size classes of packet buffer pool
+ */
+#define ESP_PEER_BUF_POOL_MAX_CLASS (4)
+
+/**
+ * @brief  Packet buffer pool size class configuration
+ */
+typedef struct {
+    uint32_t  block_size;  /*!< Block size of this class (unit Bytes) */
+    uint16_t  block_num;   /*!< Block number of this class, allocated as one slab on first use */
+} esp_peer_buf_pool_class_t;
+
+/**
+ * @brief  Packet buffer pool configuration
+ *
+ * @note  Packet buffer pool serves per-packet allocations of transport (e.g. queued TURN-TLS / ICE-TLS packets)
+ *        Blocks come from long-lived slabs which avoid heap calls per packet, slabs are never returned to heap
+ *        Request is served by smallest class which fits, by heap when that class is exhausted or nothing fits
+ */
+typedef struct {
+    uint8_t                    class_num;                            /*!< Valid class number, classes sorted by block size */
+    esp_peer_buf_pool_class_t  classes[ESP_PEER_BUF_POOL_MAX_CLASS]; /*!< Size classes */
+} esp_peer_buf_pool_cfg_t;
+
+/**
+ * @brief  Packet buffer pool statistics of one size class
+ */
+typedef struct {
+    uint32_t  block_size; /*!< Block size of this class */
+    uint16_t  block_num;  /*!< Block number of this class */
+    uint16_t  used;       /*!< Blocks currently in use */
+    uint16_t  peak;       /*!< Maximum blocks used at same time */
+    uint32_t  allocs;     /*!< Allocations served by this class */
+    uint32_t  fallbacks;  /*!< Allocations fit this class but served by heap since it was exhausted */
+} esp_peer_buf_pool_class_stats_t;
+
+/**
+ * @brief  Packet buffer pool statistics
+ */
+typedef struct {
+    uint8_t                          class_num;                            /*!< Valid class number */
+    esp_peer_buf_pool_class_stats_t  classes[ESP_PEER_BUF_POOL_MAX_CLASS]; /*!< Statistics of each class */
+    uint32_t                         oversize;                             /*!< Allocations larger than biggest class */
+} esp_peer_buf_pool_stats_t;
+
+/**
+ * @brief  Set packet buffer pool configuration
+ *
+ * @note  Must be called before first peer connection, slabs already allocated are not resized
+ *        By default `class_num` is 0 and all packet buffers are served from heap directly
+ *        Slabs stay allocated for the whole run, so size classes only for the TLS send queue depth seen on target
+ *        (e.g. one 1600 bytes class with 8 blocks), `peak` and `fallbacks` in statistics show the depth reached
+ *
+ * @param[in]  cfg  Pool configuration
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  Invalid configuration or pool already in use
+ */
+int esp_peer_set_buf_pool_cfg(const esp_peer_buf_pool_cfg_t *cfg);
+
+/**
+ * @brief  Get packet buffer pool statistics
+ *
+ * @param[out]  stats  Statistics to fill
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  Invalid argument
+ */
+int esp_peer_get_buf_pool_stats(esp_peer_buf_pool_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
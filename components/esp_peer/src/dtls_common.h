@@ -8,7 +8,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/time.h>
 #include <arpa/inet.h>
 #include "mbedtls/ssl.h"
 #include "mbedtls/md.h"
@@ -22,7 +24,6 @@
 /*
  * Shared DTLS-SRTP functions reused by both IDF v5 and v6 implementations.
  */
-#define DTLS_SIGN_ONCE
 #define TAG          "DTLS"
 #define DTLS_MTU_SIZE 1500
 
@@ -31,11 +32,50 @@
         break;             \
     }
 
-#ifdef DTLS_SIGN_ONCE
-static unsigned char s_cached_cert_pem[DTLS_CERT_PEM_BUF_SIZE];
-static unsigned char s_cached_key_pem[DTLS_CERT_PEM_BUF_SIZE];
-static bool s_cached_cert_ready = false;
-#endif
+/* Validity of generated certificate when system time is known */
+#define DTLS_CERT_VALID_DAYS  (365)
+/* System time before this year is treated as not synced */
+#define DTLS_CERT_SANE_YEAR   (2025)
+#define DTLS_SECONDS_PER_DAY  (24 * 3600)
+
+/* Generated certificate and key in PEM, with fingerprint computed once */
+typedef struct {
+    unsigned char cert_pem[DTLS_CERT_PEM_BUF_SIZE];
+    unsigned char key_pem[DTLS_CERT_PEM_BUF_SIZE];
+    char          fingerprint[DTLS_SRTP_FINGERPRINT_LENGTH];
+    uint32_t      id;
+    bool          ready;
+} dtls_cert_slot_t;
+
+/* Background generator stack, P-256 key generation and signing */
+#define DTLS_CERT_GEN_STACK_SIZE (8 * 1024)
+/* Poll step when waiting for first certificate generated by other thread */
+#define DTLS_CERT_WAIT_STEP_MS   (10)
+
+/*
+ * Sessions always use `active` certificate
+ * Background generator keeps `standby` ready so that rotation only needs a copy
+ * Configuration template per role is built once per active certificate and shared by sessions
+ */
+typedef struct {
+    dtls_cert_slot_t          active;
+    dtls_cert_slot_t         *standby;
+    uint32_t                  next_id;
+    dtls_srtp_tpl_t          *tpl[2];
+    bool                      active_persisted;
+    uint32_t                  active_sessions;
+    uint32_t                  active_since;
+    bool                      generating;
+    media_lib_mutex_handle_t  lock;
+    media_lib_sema_handle_t   gen_wake;
+    media_lib_sema_handle_t   gen_exit;
+    bool                      gen_running;
+    uint32_t                  rotate_sessions;
+    uint32_t                  rotate_ms;
+    esp_peer_cert_stats_t     stats;
+} dtls_cert_mgr_t;
+
+static dtls_cert_mgr_t s_cert_mgr;
 
 extern void measure_start(const char *tag);
 extern void measure_stop(const char *tag);
@@ -53,7 +93,10 @@ static int dtls_srtp_entropy_func(void *ctx, unsigned char *buf, size_t len)
     return 0;
 }
 
-/* Pin DTLS stack to 1.2 for stable interop across mbedTLS versions. */
+/*
+ * Pin DTLS stack to 1.2 for stable interop across mbedTLS versions
+ * Applied once when template is built, sessions only read the shared config
+ */
 static void dtls_srtp_conf_force_dtls12(mbedtls_ssl_config *conf)
 {
     mbedtls_ssl_conf_transport(conf, MBEDTLS_SSL_TRANSPORT_DATAGRAM);
@@ -114,6 +157,687 @@ static void dtls_srtp_x509_digest(const mbedtls_x509_crt *crt, char *buf)
     *(--buf) = '\0';
 }
 
+static bool dtls_srtp_time_synced(time_t now)
+{
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    return tm.tm_year + 1900 >= DTLS_CERT_SANE_YEAR;
+}
+
+/*
+ * Validity window for a new certificate in X.509 "YYYYMMDDhhmmss" form
+ * Start one day back to tolerate clock skew of remote peer, fallback to fixed window if time not synced
+ */
+static void dtls_srtp_cert_validity(char *not_before, char *not_after, int size)
+{
+    time_t now = time(NULL);
+    if (dtls_srtp_time_synced(now) == false) {
+        snprintf(not_before, size, "20230101000000");
+        snprintf(not_after, size, "20280101000000");
+        return;
+    }
+    struct tm tm;
+    time_t t = now - DTLS_SECONDS_PER_DAY;
+    gmtime_r(&t, &tm);
+    strftime(not_before, size, "%Y%m%d%H%M%S", &tm);
+    t = now + DTLS_CERT_VALID_DAYS * DTLS_SECONDS_PER_DAY;
+    gmtime_r(&t, &tm);
+    strftime(not_after, size, "%Y%m%d%H%M%S", &tm);
+}
+
+/* Seconds since epoch of X.509 UTC time (newlib lacks timegm) */
+static int64_t dtls_srtp_x509_seconds(const mbedtls_x509_time *t)
+{
+    int y = t->year - (t->mon <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (t->mon + (t->mon > 2 ? -3 : 9)) + 2) / 5 + t->day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = (int64_t)era * 146097 + doe - 719468;
+    return days * DTLS_SECONDS_PER_DAY + t->hour * 3600 + t->min * 60 + t->sec;
+}
+
+static bool dtls_srtp_cert_need_rotate(const mbedtls_x509_crt *crt, uint32_t rotate_days)
+{
+    time_t now = time(NULL);
+    if (dtls_srtp_time_synced(now) == false) {
+        // Can not judge without wall clock, keep using it
+        return false;
+    }
+    // Renew one day before expiry so that ongoing handshakes never see an expired certificate
+    if ((int64_t)now + DTLS_SECONDS_PER_DAY >= dtls_srtp_x509_seconds(&crt->valid_to)) {
+        return true;
+    }
+    if (rotate_days && (int64_t)now - dtls_srtp_x509_seconds(&crt->valid_from) >= (int64_t)rotate_days * DTLS_SECONDS_PER_DAY) {
+        return true;
+    }
+    return false;
+}
+
+static uint32_t dtls_srtp_get_time_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+/*
+ * Implemented by IDF version specific code
+ * Generate new certificate into slot, and create or destroy configuration template from certificate
+ */
+static int dtls_srtp_gen_cert_slot(dtls_cert_slot_t *slot);
+static int dtls_srtp_check_key_pair(const mbedtls_x509_crt *crt, const unsigned char *key_pem);
+static dtls_srtp_tpl_t *dtls_srtp_tpl_create(const dtls_cert_slot_t *slot, dtls_srtp_role_t role);
+static void dtls_srtp_tpl_destroy(dtls_srtp_tpl_t *tpl);
+
+/*
+ * Certificate manager lock is created on first use, sessions may start from several threads at once
+ */
+static media_lib_mutex_handle_t dtls_srtp_cert_lock(void)
+{
+    static atomic_flag lock_creating = ATOMIC_FLAG_INIT;
+    while (atomic_flag_test_and_set(&lock_creating)) {
+        media_lib_thread_sleep(1);
+    }
+    if (s_cert_mgr.lock == NULL) {
+        media_lib_mutex_create(&s_cert_mgr.lock);
+    }
+    atomic_flag_clear(&lock_creating);
+    return s_cert_mgr.lock;
+}
+
+static void dtls_srtp_cert_mgr_lock(void)
+{
+    media_lib_mutex_lock(dtls_srtp_cert_lock(), MEDIA_LIB_MAX_LOCK_TIME);
+}
+
+static void dtls_srtp_cert_mgr_unlock(void)
+{
+    media_lib_mutex_unlock(s_cert_mgr.lock);
+}
+
+static void dtls_srtp_cert_set_active(const dtls_cert_slot_t *slot, bool persisted)
+{
+    if (slot != &s_cert_mgr.active) {
+        memcpy(&s_cert_mgr.active, slot, sizeof(dtls_cert_slot_t));
+    }
+    s_cert_mgr.active.ready = true;
+    s_cert_mgr.active.id = ++s_cert_mgr.next_id;
+    s_cert_mgr.active_persisted = persisted;
+    s_cert_mgr.active_sessions = 0;
+    s_cert_mgr.active_since = dtls_srtp_get_time_ms();
+}
+
+/*
+ * Read certificate and key from persistent store into slot, called without lock for slow flash read and parsing
+ * Fingerprint is computed here once so that later sessions only copy it
+ */
+static int dtls_srtp_read_stored_cert(dtls_cert_slot_t *slot)
+{
+    const esp_peer_cert_store_t *store = peer_get_cert_store();
+    if (store == NULL) {
+        return -1;
+    }
+    mbedtls_x509_crt crt;
+    mbedtls_x509_crt_init(&crt);
+    int ret = -1;
+    do {
+        if (store->load(store->ctx, (char *)slot->cert_pem, DTLS_CERT_PEM_BUF_SIZE,
+                        (char *)slot->key_pem, DTLS_CERT_PEM_BUF_SIZE) != 0) {
+            ESP_LOGI(TAG, "No stored cert");
+            break;
+        }
+        slot->cert_pem[DTLS_CERT_PEM_BUF_SIZE - 1] = '\0';
+        slot->key_pem[DTLS_CERT_PEM_BUF_SIZE - 1] = '\0';
+        if (mbedtls_x509_crt_parse(&crt, slot->cert_pem, strlen((char *)slot->cert_pem) + 1) != 0) {
+            ESP_LOGW(TAG, "Stored cert corrupted, regenerate");
+            break;
+        }
+        if (dtls_srtp_cert_need_rotate(&crt, store->rotate_days)) {
+            ESP_LOGI(TAG, "Stored cert need rotate");
+            break;
+        }
+        // Cert and key are written separately, a torn or tampered store must not be advertised
+        if (dtls_srtp_check_key_pair(&crt, slot->key_pem) != 0) {
+            ESP_LOGW(TAG, "Stored key not match cert, regenerate");
+            break;
+        }
+        dtls_srtp_x509_digest(&crt, slot->fingerprint);
+        ret = 0;
+    } while (0);
+    mbedtls_x509_crt_free(&crt);
+    return ret;
+}
+
+/*
+ * Load stored certificate as active one
+ * Caller must own generation claim (`generating`) or be the only user, lock is only taken to publish
+ */
+static int dtls_srtp_load_stored_cert(void)
+{
+    dtls_cert_slot_t *slot = (dtls_cert_slot_t *)media_lib_calloc(1, sizeof(dtls_cert_slot_t));
+    if (slot == NULL) {
+        return -1;
+    }
+    int ret = dtls_srtp_read_stored_cert(slot);
+    if (ret == 0) {
+        dtls_srtp_cert_mgr_lock();
+        dtls_srtp_cert_set_active(slot, true);
+        dtls_srtp_cert_mgr_unlock();
+    }
+    media_lib_free(slot);
+    return ret;
+}
+
+/* Export newly generated certificate and key into slot */
+static int dtls_srtp_export_cert(dtls_srtp_tpl_t *tpl, const unsigned char *cert_pem, dtls_cert_slot_t *slot)
+{
+    int ret = mbedtls_pk_write_key_pem(&tpl->pkey, slot->key_pem, sizeof(slot->key_pem));
+    if (ret != 0) {
+        ESP_LOGE(TAG, "mbedtls_pk_write_key_pem failed, ret=%d", ret);
+        return ret;
+    }
+    memcpy(slot->cert_pem, cert_pem, sizeof(slot->cert_pem));
+    dtls_srtp_x509_digest(&tpl->cert, slot->fingerprint);
+    slot->ready = true;
+    dtls_srtp_cert_mgr_lock();
+    s_cert_mgr.stats.generated++;
+    dtls_srtp_cert_mgr_unlock();
+    return 0;
+}
+
+/* Save active certificate into persistent store if not yet, done outside lock for slow flash write */
+static void dtls_srtp_persist_active(void)
+{
+    const esp_peer_cert_store_t *store = peer_get_cert_store();
+    if (store == NULL) {
+        return;
+    }
+    dtls_cert_slot_t *slot = (dtls_cert_slot_t *)media_lib_malloc(sizeof(dtls_cert_slot_t));
+    if (slot == NULL) {
+        return;
+    }
+    bool need_save = false;
+    dtls_srtp_cert_mgr_lock();
+    if (s_cert_mgr.active.ready && s_cert_mgr.active_persisted == false) {
+        memcpy(slot, &s_cert_mgr.active, sizeof(dtls_cert_slot_t));
+        // Mark before saving so that failed flash write is not retried on every session
+        s_cert_mgr.active_persisted = true;
+        need_save = true;
+    }
+    dtls_srtp_cert_mgr_unlock();
+    if (need_save && store->save(store->ctx, (const char *)slot->cert_pem, (const char *)slot->key_pem) != 0) {
+        // Still usable for this boot
+        ESP_LOGW(TAG, "Fail to persist cert");
+    }
+    media_lib_free(slot);
+}
+
+/* Publish generated certificate as active one, NULL slot only drops generation claim */
+static void dtls_srtp_publish_cert(const dtls_cert_slot_t *slot, bool claimed)
+{
+    dtls_srtp_cert_mgr_lock();
+    if (slot) {
+        dtls_srtp_cert_set_active(slot, false);
+    }
+    if (claimed) {
+        s_cert_mgr.generating = false;
+    }
+    dtls_srtp_cert_mgr_unlock();
+}
+
+/* Account time spent waiting for certificate, called with lock held */
+static void dtls_srtp_record_wait_locked(uint32_t start)
+{
+    uint32_t wait_ms = dtls_srtp_get_time_ms() - start;
+    s_cert_mgr.stats.waited++;
+    s_cert_mgr.stats.wait_ms += wait_ms;
+    if (wait_ms > s_cert_mgr.stats.max_wait_ms) {
+        s_cert_mgr.stats.max_wait_ms = wait_ms;
+    }
+}
+
+static void dtls_srtp_record_wait(uint32_t start)
+{
+    dtls_srtp_cert_mgr_lock();
+    dtls_srtp_record_wait_locked(start);
+    dtls_srtp_cert_mgr_unlock();
+}
+
+/* Switch to standby certificate when rotation is due, called with lock held */
+static void dtls_srtp_try_rotate_cert(void)
+{
+    if (s_cert_mgr.standby == NULL) {
+        return;
+    }
+    bool due = (s_cert_mgr.rotate_sessions && s_cert_mgr.active_sessions >= s_cert_mgr.rotate_sessions) ||
+               (s_cert_mgr.rotate_ms && dtls_srtp_get_time_ms() - s_cert_mgr.active_since >= s_cert_mgr.rotate_ms);
+    if (due == false) {
+        return;
+    }
+    if (s_cert_mgr.standby->ready) {
+        dtls_srtp_cert_set_active(s_cert_mgr.standby, false);
+        s_cert_mgr.standby->ready = false;
+        s_cert_mgr.stats.rotated++;
+        ESP_LOGI(TAG, "Rotate to standby cert");
+    }
+    // Let generator persist new active one and refill standby, never block session here
+    media_lib_sema_unlock(s_cert_mgr.gen_wake);
+}
+
+/*
+ * Acquire active certificate for new session
+ * Return active slot with lock held (release by `dtls_srtp_release_cert`)
+ * Return NULL when no certificate exists and caller is claimed to generate it
+ * If other thread is already generating the first one, wait for it instead of generating twice
+ */
+static dtls_cert_slot_t *dtls_srtp_acquire_cert(bool *claimed)
+{
+    uint32_t start = dtls_srtp_get_time_ms();
+    bool waited = false;
+    *claimed = false;
+    bool load_tried = false;
+    dtls_srtp_cert_mgr_lock();
+    while (true) {
+        if (s_cert_mgr.active.ready == false && s_cert_mgr.generating == false && load_tried == false) {
+            // Claim so that others wait instead of reading store in parallel, read it without lock
+            s_cert_mgr.generating = true;
+            dtls_srtp_cert_mgr_unlock();
+            dtls_srtp_load_stored_cert();
+            load_tried = true;
+            dtls_srtp_cert_mgr_lock();
+            s_cert_mgr.generating = false;
+        }
+        if (s_cert_mgr.active.ready) {
+            dtls_srtp_try_rotate_cert();
+            s_cert_mgr.active_sessions++;
+            s_cert_mgr.stats.sessions++;
+            if (waited) {
+                dtls_srtp_record_wait_locked(start);
+            }
+            return &s_cert_mgr.active;
+        }
+        if (s_cert_mgr.generating == false) {
+            s_cert_mgr.generating = true;
+            *claimed = true;
+            dtls_srtp_cert_mgr_unlock();
+            return NULL;
+        }
+        waited = true;
+        dtls_srtp_cert_mgr_unlock();
+        media_lib_thread_sleep(DTLS_CERT_WAIT_STEP_MS);
+        dtls_srtp_cert_mgr_lock();
+    }
+}
+
+static void dtls_srtp_release_cert(void)
+{
+    dtls_srtp_cert_mgr_unlock();
+}
+
+/* Generate first certificate from session path after claimed by `dtls_srtp_acquire_cert` */
+static int dtls_srtp_gen_first_cert(bool claimed, uint32_t wait_start)
+{
+    dtls_cert_slot_t *slot = (dtls_cert_slot_t *)media_lib_malloc(sizeof(dtls_cert_slot_t));
+    int ret = slot ? dtls_srtp_gen_cert_slot(slot) : -1;
+    dtls_srtp_publish_cert(ret == 0 ? slot : NULL, claimed);
+    if (ret == 0) {
+        dtls_srtp_persist_active();
+    }
+    if (claimed) {
+        dtls_srtp_record_wait(wait_start);
+    }
+    media_lib_free(slot);
+    return ret;
+}
+
+/* Drop one reference, called with lock held, return true when caller must destroy it after unlock */
+static bool dtls_srtp_tpl_put_locked(dtls_srtp_tpl_t *tpl)
+{
+    return --tpl->ref == 0;
+}
+
+static void dtls_srtp_tpl_unref(dtls_srtp_tpl_t *tpl)
+{
+    dtls_srtp_cert_mgr_lock();
+    bool last = dtls_srtp_tpl_put_locked(tpl);
+    dtls_srtp_cert_mgr_unlock();
+    if (last) {
+        dtls_srtp_tpl_destroy(tpl);
+    }
+}
+
+static bool dtls_srtp_tpl_fresh(const dtls_srtp_tpl_t *tpl, uint32_t cert_id)
+{
+    return tpl && tpl->cert_id == cert_id && tpl->cipher_pref == peer_get_dtls_cipher_pref();
+}
+
+/*
+ * Get configuration template for role with reference held, release by `dtls_srtp_tpl_unref`
+ * Template is created once for each certificate and role, the cached one keeps a reference
+ * So sessions skip config defaults, DRBG seeding, cookie setup, certificate parsing and digest
+ * Template is built from a copy of active certificate without lock, then swapped in under lock
+ */
+static dtls_srtp_tpl_t *dtls_srtp_tpl_acquire(dtls_srtp_role_t role)
+{
+    uint32_t start = dtls_srtp_get_time_ms();
+    dtls_cert_slot_t *copy = NULL;
+    dtls_srtp_tpl_t *tpl = NULL;
+    int fail = 0;
+    while (fail < 2) {
+        bool claimed = false;
+        dtls_cert_slot_t *cert = dtls_srtp_acquire_cert(&claimed);
+        if (cert == NULL) {
+            if (dtls_srtp_gen_first_cert(claimed, start) != 0) {
+                break;
+            }
+            continue;
+        }
+        // Rebuild when certificate rotated or cipher preference changed since template is built
+        if (dtls_srtp_tpl_fresh(s_cert_mgr.tpl[role], cert->id)) {
+            tpl = s_cert_mgr.tpl[role];
+            tpl->ref++;
+            dtls_srtp_release_cert();
+            break;
+        }
+        if (copy == NULL) {
+            copy = (dtls_cert_slot_t *)media_lib_malloc(sizeof(dtls_cert_slot_t));
+            if (copy == NULL) {
+                dtls_srtp_release_cert();
+                break;
+            }
+        }
+        memcpy(copy, cert, sizeof(dtls_cert_slot_t));
+        dtls_srtp_release_cert();
+
+        tpl = dtls_srtp_tpl_create(copy, role);
+        dtls_srtp_tpl_t *drop = NULL;
+        dtls_srtp_cert_mgr_lock();
+        if (tpl == NULL) {
+            // Drop unusable certificate so that it gets regenerated, unless already rotated meanwhile
+            ESP_LOGE(TAG, "Use cached cert/key failed, fallback to regenerate");
+            if (s_cert_mgr.active.id == copy->id) {
+                s_cert_mgr.active.ready = false;
+            }
+            dtls_srtp_cert_mgr_unlock();
+            fail++;
+            continue;
+        }
+        tpl->cert_id = copy->id;
+        if (dtls_srtp_tpl_fresh(s_cert_mgr.tpl[role], s_cert_mgr.active.id)) {
+            // Other session built it meanwhile, use cached one
+            drop = tpl;
+            tpl = s_cert_mgr.tpl[role];
+            tpl->ref++;
+        } else {
+            // One reference for cache and one for caller
+            tpl->ref = 2;
+            if (s_cert_mgr.tpl[role] && dtls_srtp_tpl_put_locked(s_cert_mgr.tpl[role])) {
+                drop = s_cert_mgr.tpl[role];
+            }
+            s_cert_mgr.tpl[role] = tpl;
+        }
+        dtls_srtp_cert_mgr_unlock();
+        if (drop) {
+            dtls_srtp_tpl_destroy(drop);
+        }
+        break;
+    }
+    media_lib_free(copy);
+    return tpl;
+}
+
+static void dtls_srtp_cert_gen_thread(void *arg)
+{
+    dtls_cert_slot_t *slot = (dtls_cert_slot_t *)media_lib_malloc(sizeof(dtls_cert_slot_t));
+    ESP_LOGI(TAG, "Cert generator started");
+    while (slot) {
+        media_lib_sema_lock(s_cert_mgr.gen_wake, MEDIA_LIB_MAX_LOCK_TIME);
+        if (s_cert_mgr.gen_running == false) {
+            break;
+        }
+        dtls_srtp_persist_active();
+        bool need_active = false, need_standby = false;
+        dtls_srtp_cert_mgr_lock();
+        if (s_cert_mgr.active.ready == false && s_cert_mgr.generating == false) {
+            s_cert_mgr.generating = true;
+            need_active = true;
+        }
+        if (need_active == false && s_cert_mgr.standby && s_cert_mgr.standby->ready == false) {
+            need_standby = true;
+        }
+        dtls_srtp_cert_mgr_unlock();
+        if (need_active && dtls_srtp_read_stored_cert(slot) == 0) {
+            // Stored one still usable, publish it and let next round refill standby
+            dtls_srtp_cert_mgr_lock();
+            dtls_srtp_cert_set_active(slot, true);
+            s_cert_mgr.generating = false;
+            dtls_srtp_cert_mgr_unlock();
+            media_lib_sema_unlock(s_cert_mgr.gen_wake);
+            continue;
+        }
+        if (need_active == false && need_standby == false) {
+            continue;
+        }
+        int ret = dtls_srtp_gen_cert_slot(slot);
+        if (need_active) {
+            dtls_srtp_publish_cert(ret == 0 ? slot : NULL, true);
+        } else if (ret == 0) {
+            dtls_srtp_cert_mgr_lock();
+            if (s_cert_mgr.standby) {
+                memcpy(s_cert_mgr.standby, slot, sizeof(dtls_cert_slot_t));
+            }
+            dtls_srtp_cert_mgr_unlock();
+        }
+        if (ret != 0) {
+            ESP_LOGE(TAG, "Fail to generate cert in background ret=%d", ret);
+            media_lib_thread_sleep(1000);
+        }
+        // Check again for persist and the other slot
+        media_lib_sema_unlock(s_cert_mgr.gen_wake);
+    }
+    media_lib_free(slot);
+    ESP_LOGI(TAG, "Cert generator exited");
+    media_lib_sema_unlock(s_cert_mgr.gen_exit);
+    media_lib_thread_destroy(NULL);
+}
+
+static void dtls_srtp_cert_gen_release(void)
+{
+    if (s_cert_mgr.standby) {
+        media_lib_free(s_cert_mgr.standby);
+        s_cert_mgr.standby = NULL;
+    }
+    if (s_cert_mgr.gen_wake) {
+        media_lib_sema_destroy(s_cert_mgr.gen_wake);
+        s_cert_mgr.gen_wake = NULL;
+    }
+    if (s_cert_mgr.gen_exit) {
+        media_lib_sema_destroy(s_cert_mgr.gen_exit);
+        s_cert_mgr.gen_exit = NULL;
+    }
+}
+
+int dtls_srtp_start_cert_gen(esp_peer_cert_gen_cfg_t *cfg)
+{
+    if (dtls_srtp_cert_lock() == NULL) {
+        return ESP_PEER_ERR_NO_MEM;
+    }
+    dtls_srtp_cert_mgr_lock();
+    if (s_cert_mgr.gen_running) {
+        dtls_srtp_cert_mgr_unlock();
+        return ESP_PEER_ERR_WRONG_STATE;
+    }
+    s_cert_mgr.standby = (dtls_cert_slot_t *)media_lib_calloc(1, sizeof(dtls_cert_slot_t));
+    media_lib_sema_create(&s_cert_mgr.gen_wake);
+    media_lib_sema_create(&s_cert_mgr.gen_exit);
+    if (s_cert_mgr.standby == NULL || s_cert_mgr.gen_wake == NULL || s_cert_mgr.gen_exit == NULL) {
+        dtls_srtp_cert_gen_release();
+        dtls_srtp_cert_mgr_unlock();
+        return ESP_PEER_ERR_NO_MEM;
+    }
+    s_cert_mgr.rotate_sessions = cfg->rotate_sessions;
+    s_cert_mgr.rotate_ms = cfg->rotate_hours * 3600 * 1000;
+    s_cert_mgr.gen_running = true;
+    int ret = media_lib_thread_create(NULL, "dtls_cert", dtls_srtp_cert_gen_thread, NULL,
+                                      cfg->stack_size ? cfg->stack_size : DTLS_CERT_GEN_STACK_SIZE, cfg->prio, cfg->core);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Fail to create cert generator");
+        s_cert_mgr.gen_running = false;
+        dtls_srtp_cert_gen_release();
+        dtls_srtp_cert_mgr_unlock();
+        return ESP_PEER_ERR_FAIL;
+    }
+    // Fill both slots right away
+    media_lib_sema_unlock(s_cert_mgr.gen_wake);
+    dtls_srtp_cert_mgr_unlock();
+    return ESP_PEER_ERR_NONE;
+}
+
+void dtls_srtp_stop_cert_gen(void)
+{
+    dtls_srtp_cert_mgr_lock();
+    if (s_cert_mgr.gen_running == false) {
+        dtls_srtp_cert_mgr_unlock();
+        return;
+    }
+    s_cert_mgr.gen_running = false;
+    media_lib_sema_unlock(s_cert_mgr.gen_wake);
+    dtls_srtp_cert_mgr_unlock();
+    // Generator may be in middle of key generation, wait for it to finish
+    media_lib_sema_lock(s_cert_mgr.gen_exit, MEDIA_LIB_MAX_LOCK_TIME);
+    dtls_srtp_cert_mgr_lock();
+    dtls_srtp_cert_gen_release();
+    dtls_srtp_cert_mgr_unlock();
+}
+
+void dtls_srtp_get_cert_stats(esp_peer_cert_stats_t *stats)
+{
+    dtls_srtp_cert_mgr_lock();
+    memcpy(stats, &s_cert_mgr.stats, sizeof(esp_peer_cert_stats_t));
+    dtls_srtp_cert_mgr_unlock();
+}
+
+/*
+ * Cookie context is shared through template, serialize it for concurrent handshakes
+ */
+static int dtls_srtp_tpl_cookie_write(void *ctx, unsigned char **p, unsigned char *end,
+                                      const unsigned char *cli_id, size_t cli_id_len)
+{
+    dtls_srtp_tpl_t *tpl = (dtls_srtp_tpl_t *)ctx;
+    media_lib_mutex_lock(tpl->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = mbedtls_ssl_cookie_write(&tpl->cookie_ctx, p, end, cli_id, cli_id_len);
+    media_lib_mutex_unlock(tpl->lock);
+    return ret;
+}
+
+static int dtls_srtp_tpl_cookie_check(void *ctx, const unsigned char *cookie, size_t cookie_len,
+                                      const unsigned char *cli_id, size_t cli_id_len)
+{
+    dtls_srtp_tpl_t *tpl = (dtls_srtp_tpl_t *)ctx;
+    media_lib_mutex_lock(tpl->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = mbedtls_ssl_cookie_check(&tpl->cookie_ctx, cookie, cookie_len, cli_id, cli_id_len);
+    media_lib_mutex_unlock(tpl->lock);
+    return ret;
+}
+
+/* Configuration shared by IDF versions, applied after crypto part of template is ready */
+static int dtls_srtp_tpl_conf(dtls_srtp_tpl_t *tpl)
+{
+    mbedtls_ssl_config *conf = &tpl->conf;
+    dtls_srtp_conf_force_dtls12(conf);
+    tpl->cipher_pref = peer_get_dtls_cipher_pref();
+    dtls_srtp_conf_cipher_pref(conf);
+    if (tpl->role == DTLS_SRTP_ROLE_SERVER) {
+        mbedtls_ssl_conf_dtls_cookies(conf, dtls_srtp_tpl_cookie_write, dtls_srtp_tpl_cookie_check, tpl);
+    } else {
+        mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
+    }
+    mbedtls_ssl_conf_ca_chain(conf, &tpl->cert, NULL);
+    int ret = mbedtls_ssl_conf_own_cert(conf, &tpl->cert, &tpl->pkey);
+    if (ret != 0) {
+        return ret;
+    }
+    mbedtls_ssl_conf_read_timeout(conf, 1000);
+    mbedtls_ssl_conf_handshake_timeout(conf, 1000, 6000);
+    mbedtls_ssl_conf_dtls_anti_replay(conf, MBEDTLS_SSL_ANTI_REPLAY_DISABLED);
+    ret = mbedtls_ssl_conf_dtls_srtp_protection_profiles(conf, default_profiles);
+    if (ret != 0) {
+        return ret;
+    }
+    mbedtls_ssl_conf_srtp_mki_value_supported(conf, MBEDTLS_SSL_DTLS_SRTP_MKI_UNSUPPORTED);
+    return 0;
+}
+
+/* Attach session to shared template of role, replacing previous one */
+static int dtls_srtp_use_tpl(dtls_srtp_t *dtls_srtp, dtls_srtp_role_t role)
+{
+    dtls_srtp_tpl_t *tpl = dtls_srtp_tpl_acquire(role);
+    if (tpl == NULL) {
+        return -1;
+    }
+    mbedtls_ssl_free(&dtls_srtp->ssl);
+    mbedtls_ssl_init(&dtls_srtp->ssl);
+    if (dtls_srtp->tpl) {
+        dtls_srtp_tpl_unref(dtls_srtp->tpl);
+    }
+    dtls_srtp->tpl = tpl;
+    dtls_srtp->role = role;
+    memcpy(dtls_srtp->local_fingerprint, tpl->fingerprint, sizeof(dtls_srtp->local_fingerprint));
+    int ret = mbedtls_ssl_setup(&dtls_srtp->ssl, &tpl->conf);
+    if (ret != 0) {
+        return ret;
+    }
+    mbedtls_ssl_set_mtu(&dtls_srtp->ssl, DTLS_MTU_SIZE);
+    return 0;
+}
+
+/*
+ * SRTP sessions are published per direction and used without lock on the RTP path
+ * Users are counted around each use, a replaced session is freed once its users drain
+ */
+static srtp_t dtls_srtp_get_session(dtls_srtp_t *dtls_srtp, bool inbound)
+{
+    atomic_fetch_add(inbound ? &dtls_srtp->srtp_in_users : &dtls_srtp->srtp_out_users, 1);
+    return atomic_load(inbound ? &dtls_srtp->srtp_in : &dtls_srtp->srtp_out);
+}
+
+static void dtls_srtp_put_session(dtls_srtp_t *dtls_srtp, bool inbound)
+{
+    atomic_fetch_sub(inbound ? &dtls_srtp->srtp_in_users : &dtls_srtp->srtp_out_users, 1);
+}
+
+static void dtls_srtp_set_session(dtls_srtp_t *dtls_srtp, bool inbound, srtp_t session)
+{
+    srtp_t old = atomic_exchange(inbound ? &dtls_srtp->srtp_in : &dtls_srtp->srtp_out, session);
+    if (old == NULL) {
+        return;
+    }
+    // Users who got the old session are still counted, new users only see new session
+    atomic_int *users = inbound ? &dtls_srtp->srtp_in_users : &dtls_srtp->srtp_out_users;
+    while (atomic_load(users)) {
+        media_lib_thread_sleep(1);
+    }
+    srtp_dealloc(old);
+}
+
+static int dtls_srtp_create_lock(dtls_srtp_t *dtls_srtp)
+{
+    media_lib_mutex_create(&dtls_srtp->lock);
+    if (dtls_srtp->lock == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+static void dtls_srtp_destroy_lock(dtls_srtp_t *dtls_srtp)
+{
+    if (dtls_srtp->lock) {
+        media_lib_mutex_destroy(dtls_srtp->lock);
+        dtls_srtp->lock = NULL;
+    }
+}
+
 static int check_srtp(bool init)
 {
     static int init_count = 0;
@@ -183,8 +907,8 @@ static void dtls_srtp_key_derivation(void *context, mbedtls_ssl_key_export_type
     dtls_srtp->remote_policy.ssrc.type = ssrc_any_inbound;
     dtls_srtp->remote_policy.key = dtls_srtp->remote_policy_key;
     dtls_srtp->remote_policy.next = NULL;
-    srtp_t *send_session = (dtls_srtp->role == DTLS_SRTP_ROLE_SERVER) ? &dtls_srtp->srtp_in : &dtls_srtp->srtp_out;
-    ret = srtp_create(send_session, &dtls_srtp->remote_policy);
+    srtp_t remote_session = NULL;
+    ret = srtp_create(&remote_session, &dtls_srtp->remote_policy);
     if (ret != srtp_err_status_ok) {
         ESP_LOGE(TAG, "Fail to create in SRTP session ret %d", ret);
         return;
@@ -202,12 +926,17 @@ static void dtls_srtp_key_derivation(void *context, mbedtls_ssl_key_export_type
     dtls_srtp->local_policy.ssrc.type = ssrc_any_outbound;
     dtls_srtp->local_policy.key = dtls_srtp->local_policy_key;
     dtls_srtp->local_policy.next = NULL;
-    srtp_t *recv_session = (dtls_srtp->role == DTLS_SRTP_ROLE_SERVER) ? &dtls_srtp->srtp_out : &dtls_srtp->srtp_in;
-    ret = srtp_create(recv_session, &dtls_srtp->local_policy);
+    srtp_t local_session = NULL;
+    ret = srtp_create(&local_session, &dtls_srtp->local_policy);
     if (ret != srtp_err_status_ok) {
         ESP_LOGE(TAG, "Fail to create out SRTP session ret %d", ret);
+        srtp_dealloc(remote_session);
         return;
     }
+    /* Publish sessions only after both are ready, sender and receiver pick them up independently */
+    bool is_server = (dtls_srtp->role == DTLS_SRTP_ROLE_SERVER);
+    dtls_srtp_set_session(dtls_srtp, is_server, remote_session);
+    dtls_srtp_set_session(dtls_srtp, !is_server, local_session);
     ESP_LOGI(TAG, "SRTP connected OK");
     dtls_srtp->state = DTLS_SRTP_STATE_CONNECTED;
 }
@@ -536,8 +1265,6 @@ static int dtls_srtp_do_handshake(dtls_srtp_t *dtls_srtp)
 #if defined(DTLS_USE_CH_REASM_BIO)
     int want_read_loops = 0;
 #endif
-    /* Re-pin before every attempt; -0x6e00 is consistent with STREAM mapping of fefd. */
-    dtls_srtp_conf_force_dtls12(&dtls_srtp->conf);
     /* Clear any leftover delay from a previous session on this instance. */
     mbedtls_timing_set_delay(&dtls_srtp->timer, 0, 0);
     mbedtls_ssl_set_timer_cb(&dtls_srtp->ssl, &dtls_srtp->timer, mbedtls_timing_set_delay,
@@ -579,7 +1306,6 @@ static int dtls_srtp_handshake_server(dtls_srtp_t *dtls_srtp)
     ESP_LOGI(TAG, "Start to do server handshake");
     while (1) {
         unsigned char client_ip[] = "test";
-        dtls_srtp_conf_force_dtls12(&dtls_srtp->conf);
         mbedtls_ssl_session_reset(&dtls_srtp->ssl);
         mbedtls_ssl_set_client_transport_id(&dtls_srtp->ssl, client_ip, sizeof(client_ip));
 #if defined(DTLS_USE_CH_REASM_BIO)
@@ -729,7 +1455,12 @@ bool dtls_srtp_probe(uint8_t *buf)
 int dtls_srtp_decrypt_rtp_packet(dtls_srtp_t *dtls_srtp, uint8_t *packet, int *bytes)
 {
     size_t size = *bytes;
-    int ret = srtp_unprotect(dtls_srtp->srtp_in, packet, size, packet, &size);
+    int ret = -1;
+    srtp_t session = dtls_srtp_get_session(dtls_srtp, true);
+    if (session) {
+        ret = srtp_unprotect(session, packet, size, packet, &size);
+    }
+    dtls_srtp_put_session(dtls_srtp, true);
     *bytes = size;
     return ret;
 }
@@ -737,7 +1468,12 @@ int dtls_srtp_decrypt_rtp_packet(dtls_srtp_t *dtls_srtp, uint8_t *packet, int *b
 int dtls_srtp_decrypt_rtcp_packet(dtls_srtp_t *dtls_srtp, uint8_t *packet, int *bytes)
 {
     size_t size = *bytes;
-    int ret = srtp_unprotect_rtcp(dtls_srtp->srtp_in, packet, size, packet, &size);
+    int ret = -1;
+    srtp_t session = dtls_srtp_get_session(dtls_srtp, true);
+    if (session) {
+        ret = srtp_unprotect_rtcp(session, packet, size, packet, &size);
+    }
+    dtls_srtp_put_session(dtls_srtp, true);
     *bytes = size;
     return ret;
 }
@@ -745,13 +1481,21 @@ int dtls_srtp_decrypt_rtcp_packet(dtls_srtp_t *dtls_srtp, uint8_t *packet, int *
 void dtls_srtp_encrypt_rtp_packet(dtls_srtp_t *dtls_srtp, uint8_t *packet, int buf_size, int *bytes)
 {
     size_t size = buf_size;
-    srtp_protect(dtls_srtp->srtp_out, packet, *bytes, packet, &size, 0);
+    srtp_t session = dtls_srtp_get_session(dtls_srtp, false);
+    if (session == NULL || srtp_protect(session, packet, *bytes, packet, &size, 0) != srtp_err_status_ok) {
+        size = 0;
+    }
+    dtls_srtp_put_session(dtls_srtp, false);
     *bytes = size;
 }
 
 void dtls_srtp_encrypt_rctp_packet(dtls_srtp_t *dtls_srtp, uint8_t *packet, int buf_size, int *bytes)
 {
     size_t size = buf_size;
-    srtp_protect_rtcp(dtls_srtp->srtp_out, packet, *bytes, packet, &size, 0);
+    srtp_t session = dtls_srtp_get_session(dtls_srtp, false);
+    if (session == NULL || srtp_protect_rtcp(session, packet, *bytes, packet, &size, 0) != srtp_err_status_ok) {
+        size = 0;
+    }
+    dtls_srtp_put_session(dtls_srtp, false);
     *bytes = size;
 }
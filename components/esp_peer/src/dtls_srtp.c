@@ -9,7 +9,7 @@
 #include "dtls_common.h"
 #include "mbedtls/ecp.h"
 
-static int dtls_srtp_selfsign_cert(dtls_srtp_t *dtls_srtp, bool export_for_cache)
+static int dtls_srtp_selfsign_cert(dtls_srtp_tpl_t *tpl, dtls_cert_slot_t *export_slot)
 {
     int ret;
     mbedtls_x509write_cert crt;
@@ -20,19 +20,19 @@ static int dtls_srtp_selfsign_cert(dtls_srtp_t *dtls_srtp, bool export_for_cache
     const char *pers = "dtls_srtp";
 
     mbedtls_x509write_crt_init(&crt);
-    ret = mbedtls_ctr_drbg_seed(&dtls_srtp->ctr_drbg, dtls_srtp_entropy_func, NULL, (const unsigned char *)pers,
+    ret = mbedtls_ctr_drbg_seed(&tpl->ctr_drbg, dtls_srtp_entropy_func, NULL, (const unsigned char *)pers,
                                 strlen(pers));
     if (ret != 0) {
         ESP_LOGE(TAG, "mbedtls_ctr_drbg_seed failed, ret=%d", ret);
         goto _exit;
     }
-    ret = mbedtls_pk_setup(&dtls_srtp->pkey, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY));
+    ret = mbedtls_pk_setup(&tpl->pkey, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY));
     if (ret != 0) {
         ESP_LOGE(TAG, "mbedtls_pk_setup(ECKEY) failed, ret=%d", ret);
         goto _exit;
     }
-    ret = mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec(dtls_srtp->pkey),
-                              mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
+    ret = mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec(tpl->pkey),
+                              mbedtls_ctr_drbg_random, &tpl->ctr_drbg);
     if (ret != 0) {
         ESP_LOGE(TAG, "mbedtls_ecp_gen_key failed, ret=%d", ret);
         goto _exit;
@@ -53,35 +53,32 @@ static int dtls_srtp_selfsign_cert(dtls_srtp_t *dtls_srtp, bool export_for_cache
 #else
     mbedtls_mpi serial;
     mbedtls_mpi_init(&serial);
-    mbedtls_mpi_fill_random(&serial, 16, mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
+    mbedtls_mpi_fill_random(&serial, 16, mbedtls_ctr_drbg_random, &tpl->ctr_drbg);
     mbedtls_x509write_crt_set_serial(&crt, &serial);
     mbedtls_mpi_free(&serial);
 #endif
 
-    mbedtls_x509write_crt_set_validity(&crt, "20230101000000", "20280101000000");
-    mbedtls_x509write_crt_set_subject_key(&crt, &dtls_srtp->pkey);
-    mbedtls_x509write_crt_set_issuer_key(&crt, &dtls_srtp->pkey);
+    char not_before[16], not_after[16];
+    dtls_srtp_cert_validity(not_before, not_after, sizeof(not_before));
+    mbedtls_x509write_crt_set_validity(&crt, not_before, not_after);
+    mbedtls_x509write_crt_set_subject_key(&crt, &tpl->pkey);
+    mbedtls_x509write_crt_set_issuer_key(&crt, &tpl->pkey);
     ret = mbedtls_x509write_crt_pem(&crt, cert_buf, DTLS_CERT_PEM_BUF_SIZE, mbedtls_ctr_drbg_random,
-                                    &dtls_srtp->ctr_drbg);
+                                    &tpl->ctr_drbg);
     if (ret < 0) {
         ESP_LOGE(TAG, "mbedtls_x509write_crt_pem failed");
         goto _exit;
     }
-    ret = mbedtls_x509_crt_parse(&dtls_srtp->cert, cert_buf, DTLS_CERT_PEM_BUF_SIZE);
+    ret = mbedtls_x509_crt_parse(&tpl->cert, cert_buf, DTLS_CERT_PEM_BUF_SIZE);
     if (ret != 0) {
         ESP_LOGE(TAG, "mbedtls_x509_crt_parse failed, ret=%d", ret);
         goto _exit;
     }
-    if (export_for_cache) {
-#ifdef DTLS_SIGN_ONCE
-        ret = mbedtls_pk_write_key_pem(&dtls_srtp->pkey, s_cached_key_pem, sizeof(s_cached_key_pem));
+    if (export_slot) {
+        ret = dtls_srtp_export_cert(tpl, cert_buf, export_slot);
         if (ret != 0) {
-            ESP_LOGE(TAG, "mbedtls_pk_write_key_pem failed, ret=%d", ret);
             goto _exit;
         }
-        memcpy(s_cached_cert_pem, cert_buf, sizeof(s_cached_cert_pem));
-        s_cached_cert_ready = true;
-#endif
     }
     ret = 0;
 _exit:
@@ -90,58 +87,129 @@ _exit:
     return ret;
 }
 
-static int dtls_srtp_try_gen_cert(dtls_srtp_t *dtls_srtp)
+static int dtls_srtp_gen_cert_slot(dtls_cert_slot_t *slot)
 {
-    int ret = 0;
-    mbedtls_x509_crt_init(&dtls_srtp->cert);
-    mbedtls_pk_init(&dtls_srtp->pkey);
-    mbedtls_ctr_drbg_init(&dtls_srtp->ctr_drbg);
-    const char *pers = "dtls_srtp";
-    ret = mbedtls_ctr_drbg_seed(&dtls_srtp->ctr_drbg, dtls_srtp_entropy_func, NULL, (const unsigned char *)pers,
-                                strlen(pers));
-    if (ret != 0) {
-        ESP_LOGE(TAG, "mbedtls_ctr_drbg_seed failed, ret=%d", ret);
-        return ret;
+    dtls_srtp_tpl_t *tpl = (dtls_srtp_tpl_t *) media_lib_calloc(1, sizeof(dtls_srtp_tpl_t));
+    if (tpl == NULL) {
+        return -1;
     }
-#ifdef DTLS_SIGN_ONCE
-    if (s_cached_cert_ready) {
-        size_t cert_pem_len = strlen((const char *)s_cached_cert_pem) + 1;
-        size_t key_pem_len = strlen((const char *)s_cached_key_pem) + 1;
-        ret = mbedtls_x509_crt_parse(&dtls_srtp->cert, s_cached_cert_pem, cert_pem_len);
-        if (ret == 0) {
-            ret = mbedtls_pk_parse_key(&dtls_srtp->pkey, s_cached_key_pem, key_pem_len, NULL, 0,
-                                       mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
-        }
-        if (ret == 0) {
-            return 0;
-        }
-        ESP_LOGE(TAG, "Use cached cert/key failed, fallback to regenerate, ret=%d", ret);
+    mbedtls_x509_crt_init(&tpl->cert);
+    mbedtls_pk_init(&tpl->pkey);
+    mbedtls_ctr_drbg_init(&tpl->ctr_drbg);
+    int ret = dtls_srtp_selfsign_cert(tpl, slot);
+    mbedtls_x509_crt_free(&tpl->cert);
+    mbedtls_pk_free(&tpl->pkey);
+    mbedtls_ctr_drbg_free(&tpl->ctr_drbg);
+    media_lib_free(tpl);
+    return ret;
+}
+
+/* DRBG is shared by sessions through template, serialize it for concurrent handshakes */
+static int dtls_srtp_tpl_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    dtls_srtp_tpl_t *tpl = (dtls_srtp_tpl_t *)ctx;
+    media_lib_mutex_lock(tpl->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = mbedtls_ctr_drbg_random(&tpl->ctr_drbg, buf, len);
+    media_lib_mutex_unlock(tpl->lock);
+    return ret;
+}
+
+static int dtls_srtp_check_key_pair(const mbedtls_x509_crt *crt, const unsigned char *key_pem)
+{
+    mbedtls_pk_context pkey;
+    mbedtls_pk_init(&pkey);
+    int ret = mbedtls_pk_parse_key(&pkey, key_pem, strlen((const char *)key_pem) + 1, NULL, 0,
+                                   dtls_srtp_entropy_func, NULL);
+    if (ret == 0) {
+        ret = mbedtls_pk_check_pair(&crt->pk, &pkey, dtls_srtp_entropy_func, NULL);
     }
-#endif
-    ret = dtls_srtp_selfsign_cert(dtls_srtp, true);
-    if (ret != 0) {
-        return ret;
+    mbedtls_pk_free(&pkey);
+    return ret;
+}
+
+static void dtls_srtp_tpl_destroy(dtls_srtp_tpl_t *tpl)
+{
+    mbedtls_ssl_config_free(&tpl->conf);
+    mbedtls_ssl_cookie_free(&tpl->cookie_ctx);
+    mbedtls_x509_crt_free(&tpl->cert);
+    mbedtls_pk_free(&tpl->pkey);
+    mbedtls_ctr_drbg_free(&tpl->ctr_drbg);
+    if (tpl->lock) {
+        media_lib_mutex_destroy(tpl->lock);
     }
-    return 0;
+    media_lib_free(tpl);
+}
+
+static dtls_srtp_tpl_t *dtls_srtp_tpl_create(const dtls_cert_slot_t *slot, dtls_srtp_role_t role)
+{
+    dtls_srtp_tpl_t *tpl = (dtls_srtp_tpl_t *) media_lib_calloc(1, sizeof(dtls_srtp_tpl_t));
+    if (tpl == NULL) {
+        return NULL;
+    }
+    tpl->role = role;
+    mbedtls_ssl_config_init(&tpl->conf);
+    mbedtls_ssl_cookie_init(&tpl->cookie_ctx);
+    mbedtls_x509_crt_init(&tpl->cert);
+    mbedtls_pk_init(&tpl->pkey);
+    mbedtls_ctr_drbg_init(&tpl->ctr_drbg);
+    int ret = media_lib_mutex_create(&tpl->lock);
+    do {
+        BREAK_ON_FAIL(ret);
+        const char *pers = "dtls_srtp";
+        ret = mbedtls_ctr_drbg_seed(&tpl->ctr_drbg, dtls_srtp_entropy_func, NULL, (const unsigned char *)pers,
+                                    strlen(pers));
+        BREAK_ON_FAIL(ret);
+        ret = mbedtls_x509_crt_parse(&tpl->cert, slot->cert_pem, strlen((const char *)slot->cert_pem) + 1);
+        BREAK_ON_FAIL(ret);
+        ret = mbedtls_pk_parse_key(&tpl->pkey, slot->key_pem, strlen((const char *)slot->key_pem) + 1, NULL, 0,
+                                   dtls_srtp_tpl_rng, tpl);
+        BREAK_ON_FAIL(ret);
+        ret = mbedtls_ssl_config_defaults(&tpl->conf,
+                                          role == DTLS_SRTP_ROLE_SERVER ? MBEDTLS_SSL_IS_SERVER : MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_DATAGRAM, MBEDTLS_SSL_PRESET_DEFAULT);
+        BREAK_ON_FAIL(ret);
+        if (role == DTLS_SRTP_ROLE_SERVER) {
+            ret = mbedtls_ssl_cookie_setup(&tpl->cookie_ctx, dtls_srtp_tpl_rng, tpl);
+            BREAK_ON_FAIL(ret);
+        }
+        mbedtls_ssl_conf_rng(&tpl->conf, dtls_srtp_tpl_rng, tpl);
+        ret = dtls_srtp_tpl_conf(tpl);
+        BREAK_ON_FAIL(ret);
+        memcpy(tpl->fingerprint, slot->fingerprint, sizeof(tpl->fingerprint));
+        return tpl;
+    } while (0);
+    ESP_LOGE(TAG, "Fail to create DTLS template ret=%d", ret);
+    dtls_srtp_tpl_destroy(tpl);
+    return NULL;
 }
 
 int dtls_srtp_gen_cert(void)
 {
-#ifdef DTLS_SIGN_ONCE
-    dtls_srtp_t *dtls_srtp = (dtls_srtp_t *) media_lib_calloc(1, sizeof(dtls_srtp_t));
-    if (dtls_srtp == NULL) {
-        return -1;
+    // Reuse persisted certificate when still valid and matching its key
+    int ret = dtls_srtp_load_stored_cert();
+    if (ret != 0) {
+        dtls_cert_slot_t *slot = (dtls_cert_slot_t *)media_lib_malloc(sizeof(dtls_cert_slot_t));
+        if (slot == NULL) {
+            return -1;
+        }
+        ret = dtls_srtp_gen_cert_slot(slot);
+        if (ret == 0) {
+            dtls_srtp_publish_cert(slot, false);
+            dtls_srtp_persist_active();
+        }
+        media_lib_free(slot);
+        if (ret != 0) {
+            return ret;
+        }
     }
-    mbedtls_x509_crt_init(&dtls_srtp->cert);
-    mbedtls_pk_init(&dtls_srtp->pkey);
-    mbedtls_ctr_drbg_init(&dtls_srtp->ctr_drbg);
-    int ret = dtls_srtp_selfsign_cert(dtls_srtp, true);
-    dtls_srtp_deinit(dtls_srtp);
-    media_lib_free(dtls_srtp);
-    return ret;
-#else
-    return -1;
-#endif
+    // Build both role templates now so that first connection only runs `mbedtls_ssl_setup`
+    for (int role = DTLS_SRTP_ROLE_CLIENT; role <= DTLS_SRTP_ROLE_SERVER; role++) {
+        dtls_srtp_tpl_t *tpl = dtls_srtp_tpl_acquire((dtls_srtp_role_t)role);
+        if (tpl) {
+            dtls_srtp_tpl_unref(tpl);
+        }
+    }
+    return 0;
 }
 
 dtls_srtp_t *dtls_srtp_init(dtls_srtp_cfg_t *cfg)
@@ -153,52 +221,17 @@ dtls_srtp_t *dtls_srtp_init(dtls_srtp_cfg_t *cfg)
     int ret = check_srtp(true);
     do {
         BREAK_ON_FAIL(ret);
-        media_lib_mutex_create(&dtls_srtp->lock);
-        dtls_srtp->role = cfg->role;
         dtls_srtp->state = DTLS_SRTP_STATE_INIT;
         dtls_srtp->ctx = cfg->ctx;
         dtls_srtp->udp_send = cfg->udp_send;
         dtls_srtp->udp_recv = cfg->udp_recv;
-
-        mbedtls_ssl_config_init(&dtls_srtp->conf);
-        mbedtls_ssl_init(&dtls_srtp->ssl);
-        ret = dtls_srtp_try_gen_cert(dtls_srtp);
-        BREAK_ON_FAIL(ret);
-
-        if (dtls_srtp->role == DTLS_SRTP_ROLE_SERVER) {
-            ret = mbedtls_ssl_config_defaults(&dtls_srtp->conf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
-                                              MBEDTLS_SSL_PRESET_DEFAULT);
-            mbedtls_ssl_cookie_init(&dtls_srtp->cookie_ctx);
-            mbedtls_ssl_cookie_setup(&dtls_srtp->cookie_ctx, mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
-            mbedtls_ssl_conf_dtls_cookies(&dtls_srtp->conf, mbedtls_ssl_cookie_write, mbedtls_ssl_cookie_check,
-                                          &dtls_srtp->cookie_ctx);
-        } else {
-            ret = mbedtls_ssl_config_defaults(&dtls_srtp->conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
-                                              MBEDTLS_SSL_PRESET_DEFAULT);
-        }
-        BREAK_ON_FAIL(ret);
-
-        dtls_srtp_conf_force_dtls12(&dtls_srtp->conf);
-        dtls_srtp_conf_cipher_pref(&dtls_srtp->conf);
-        mbedtls_ssl_conf_ca_chain(&dtls_srtp->conf, &dtls_srtp->cert, NULL);
-        ret = mbedtls_ssl_conf_own_cert(&dtls_srtp->conf, &dtls_srtp->cert, &dtls_srtp->pkey);
+        ret = dtls_srtp_create_lock(dtls_srtp);
         BREAK_ON_FAIL(ret);
-        mbedtls_ssl_conf_rng(&dtls_srtp->conf, mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
-        if (dtls_srtp->role == DTLS_SRTP_ROLE_CLIENT) {
-            mbedtls_ssl_conf_authmode(&dtls_srtp->conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
-        }
-        mbedtls_ssl_conf_read_timeout(&dtls_srtp->conf, 1000);
-        mbedtls_ssl_conf_handshake_timeout(&dtls_srtp->conf, 1000, 6000);
-        mbedtls_ssl_conf_dtls_anti_replay(&dtls_srtp->conf, MBEDTLS_SSL_ANTI_REPLAY_DISABLED);
 
-        dtls_srtp_x509_digest(&dtls_srtp->cert, dtls_srtp->local_fingerprint);
-        ret = mbedtls_ssl_conf_dtls_srtp_protection_profiles(&dtls_srtp->conf, default_profiles);
-        BREAK_ON_FAIL(ret);
-
-        mbedtls_ssl_conf_srtp_mki_value_supported(&dtls_srtp->conf, MBEDTLS_SSL_DTLS_SRTP_MKI_UNSUPPORTED);
-        ret = mbedtls_ssl_setup(&dtls_srtp->ssl, &dtls_srtp->conf);
+        mbedtls_ssl_init(&dtls_srtp->ssl);
+        // Config, certificate and key are shared, session only owns SSL context
+        ret = dtls_srtp_use_tpl(dtls_srtp, cfg->role);
         BREAK_ON_FAIL(ret);
-        mbedtls_ssl_set_mtu(&dtls_srtp->ssl, DTLS_MTU_SIZE);
         return dtls_srtp;
     } while (0);
     dtls_srtp_deinit(dtls_srtp);
@@ -211,29 +244,16 @@ void dtls_srtp_deinit(dtls_srtp_t *dtls_srtp)
         return;
     }
     mbedtls_ssl_free(&dtls_srtp->ssl);
-    mbedtls_ssl_config_free(&dtls_srtp->conf);
-
-    mbedtls_x509_crt_free(&dtls_srtp->cert);
-    mbedtls_pk_free(&dtls_srtp->pkey);
-    mbedtls_ctr_drbg_free(&dtls_srtp->ctr_drbg);
-
-    if (dtls_srtp->role == DTLS_SRTP_ROLE_SERVER) {
-        mbedtls_ssl_cookie_free(&dtls_srtp->cookie_ctx);
+    if (dtls_srtp->tpl) {
+        dtls_srtp_tpl_unref(dtls_srtp->tpl);
+        dtls_srtp->tpl = NULL;
     }
 #if defined(DTLS_USE_CH_REASM_BIO)
     dtls_srtp_ch_reasm_free(dtls_srtp);
 #endif
-    if (dtls_srtp->srtp_in) {
-        srtp_dealloc(dtls_srtp->srtp_in);
-        dtls_srtp->srtp_in = NULL;
-    }
-    if (dtls_srtp->srtp_out) {
-        srtp_dealloc(dtls_srtp->srtp_out);
-        dtls_srtp->srtp_out = NULL;
-    }
-    if (dtls_srtp->lock) {
-        media_lib_mutex_destroy(dtls_srtp->lock);
-    }
+    dtls_srtp_set_session(dtls_srtp, true, NULL);
+    dtls_srtp_set_session(dtls_srtp, false, NULL);
+    dtls_srtp_destroy_lock(dtls_srtp);
     check_srtp(false);
     dtls_srtp->state = DTLS_SRTP_STATE_NONE;
     media_lib_free(dtls_srtp);
@@ -242,50 +262,20 @@ void dtls_srtp_deinit(dtls_srtp_t *dtls_srtp)
 void dtls_srtp_reset_session(dtls_srtp_t *dtls_srtp, dtls_srtp_role_t role)
 {
     if (dtls_srtp->state == DTLS_SRTP_STATE_CONNECTED) {
-        srtp_dealloc(dtls_srtp->srtp_in);
-        dtls_srtp->srtp_in = NULL;
-        srtp_dealloc(dtls_srtp->srtp_out);
-        dtls_srtp->srtp_out = NULL;
+        dtls_srtp_set_session(dtls_srtp, true, NULL);
+        dtls_srtp_set_session(dtls_srtp, false, NULL);
     }
+    /* Always reset SSL so a prior failed handshake cannot poison the next one. */
     mbedtls_ssl_session_reset(&dtls_srtp->ssl);
     mbedtls_timing_set_delay(&dtls_srtp->timer, 0, 0);
 #if defined(DTLS_USE_CH_REASM_BIO)
     dtls_srtp_ch_reasm_free(dtls_srtp);
 #endif
     if (role != dtls_srtp->role) {
-        if (dtls_srtp->role == DTLS_SRTP_ROLE_SERVER) {
-            mbedtls_ssl_cookie_free(&dtls_srtp->cookie_ctx);
+        // Switch to template of new role, SSL context is recreated so old in/out buffers are freed
+        if (dtls_srtp_use_tpl(dtls_srtp, role) != 0) {
+            ESP_LOGE(TAG, "Fail to switch DTLS role");
         }
-        if (role == DTLS_SRTP_ROLE_SERVER) {
-            mbedtls_ssl_config_defaults(&dtls_srtp->conf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
-                                        MBEDTLS_SSL_PRESET_DEFAULT);
-            dtls_srtp_conf_force_dtls12(&dtls_srtp->conf);
-            dtls_srtp_conf_cipher_pref(&dtls_srtp->conf);
-
-            mbedtls_ssl_cookie_init(&dtls_srtp->cookie_ctx);
-            mbedtls_ssl_cookie_setup(&dtls_srtp->cookie_ctx, mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
-            mbedtls_ssl_conf_dtls_cookies(&dtls_srtp->conf, mbedtls_ssl_cookie_write, mbedtls_ssl_cookie_check,
-                                          &dtls_srtp->cookie_ctx);
-        } else {
-            mbedtls_ssl_config_defaults(&dtls_srtp->conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
-                                        MBEDTLS_SSL_PRESET_DEFAULT);
-            dtls_srtp_conf_force_dtls12(&dtls_srtp->conf);
-            dtls_srtp_conf_cipher_pref(&dtls_srtp->conf);
-            mbedtls_ssl_conf_authmode(&dtls_srtp->conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
-        }
-        mbedtls_ssl_conf_ca_chain(&dtls_srtp->conf, &dtls_srtp->cert, NULL);
-        mbedtls_ssl_conf_own_cert(&dtls_srtp->conf, &dtls_srtp->cert, &dtls_srtp->pkey);
-        mbedtls_ssl_conf_rng(&dtls_srtp->conf, mbedtls_ctr_drbg_random, &dtls_srtp->ctr_drbg);
-        mbedtls_ssl_conf_read_timeout(&dtls_srtp->conf, 1000);
-        mbedtls_ssl_conf_handshake_timeout(&dtls_srtp->conf, 1000, 6000);
-        mbedtls_ssl_conf_dtls_srtp_protection_profiles(&dtls_srtp->conf, default_profiles);
-        mbedtls_ssl_conf_srtp_mki_value_supported(&dtls_srtp->conf, MBEDTLS_SSL_DTLS_SRTP_MKI_UNSUPPORTED);
-        mbedtls_ssl_conf_dtls_anti_replay(&dtls_srtp->conf, MBEDTLS_SSL_ANTI_REPLAY_DISABLED);
-        mbedtls_ssl_free(&dtls_srtp->ssl);
-        mbedtls_ssl_init(&dtls_srtp->ssl);
-        mbedtls_ssl_setup(&dtls_srtp->ssl, &dtls_srtp->conf);
-        mbedtls_ssl_set_mtu(&dtls_srtp->ssl, DTLS_MTU_SIZE);
-        dtls_srtp->role = role;
     }
     dtls_srtp->state = DTLS_SRTP_STATE_INIT;
 }
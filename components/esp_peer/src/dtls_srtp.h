@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include "esp_idf_version.h"
 #if MBEDTLS_MAJOR_VERSION >= 4
 #include <mbedtls/private/ctr_drbg.h>
@@ -40,6 +41,8 @@
 #include <mbedtls/timing.h>
 #include <srtp.h>
 #include "media_lib_os.h"
+#include "esp_peer.h"
+#include "esp_peer_default.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -80,31 +83,48 @@ typedef enum {
     DTLS_SRTP_STATE_CONNECTED
 } dtls_srtp_state_t;
 
+/**
+ * @brief  DTLS configuration template shared by all sessions of same role and certificate
+ *
+ * @note  Immutable after setup except `ref`, sessions only reference it through `conf`
+ */
+typedef struct {
+    mbedtls_ssl_config          conf;
+    mbedtls_ssl_cookie_ctx      cookie_ctx;
+    mbedtls_x509_crt            cert;
+    mbedtls_pk_context          pkey;
+#if ESP_IDF_VERSION_MAJOR >= 6
+    mbedtls_svc_key_id_t        psa_key_id;
+#endif
+    mbedtls_ctr_drbg_context    ctr_drbg;
+    media_lib_mutex_handle_t    lock;        /* serialize shared DRBG and cookie between sessions */
+    dtls_srtp_role_t            role;
+    uint32_t                    cert_id;     /* certificate generation it is built from */
+    esp_peer_dtls_cipher_pref_t cipher_pref; /* cipher preference applied to `conf` */
+    int                         ref;
+    char                        fingerprint[DTLS_SRTP_FINGERPRINT_LENGTH];
+} dtls_srtp_tpl_t;
+
 /**
  * @brief  Struct for DTLS SRTP
  */
 typedef struct {
     void                    *ctx;
     mbedtls_ssl_context      ssl;
-    mbedtls_ssl_config       conf;
-    mbedtls_ssl_cookie_ctx   cookie_ctx;
-    mbedtls_x509_crt         cert;
-    mbedtls_pk_context       pkey;
-#if ESP_IDF_VERSION_MAJOR >= 6
-    mbedtls_svc_key_id_t     psa_key_id;
-#endif
-    mbedtls_ctr_drbg_context ctr_drbg;
+    dtls_srtp_tpl_t         *tpl;
     dtls_srtp_role_t         role;
     dtls_srtp_state_t        state;
     srtp_policy_t            remote_policy;
     srtp_policy_t            local_policy;
-    srtp_t                   srtp_in;
-    srtp_t                   srtp_out;
+    _Atomic(srtp_t)          srtp_in;        /* published inbound session, read lock-free by receiver */
+    _Atomic(srtp_t)          srtp_out;       /* published outbound session, read lock-free by sender */
     unsigned char            remote_policy_key[SRTP_MASTER_KEY_LENGTH + SRTP_MASTER_SALT_LENGTH];
     unsigned char            local_policy_key[SRTP_MASTER_KEY_LENGTH + SRTP_MASTER_SALT_LENGTH];
     char                     local_fingerprint[DTLS_SRTP_FINGERPRINT_LENGTH];
     char                     remote_fingerprint[DTLS_SRTP_FINGERPRINT_LENGTH];
-    media_lib_mutex_handle_t lock;
+    media_lib_mutex_handle_t lock;           /* serialize DTLS application data (SCTP) only */
+    atomic_int               srtp_in_users;  /* threads using inbound session, old one freed when drained */
+    atomic_int               srtp_out_users; /* threads using outbound session, old one freed when drained */
     int                      (*udp_send)(void *ctx, const unsigned char *buf, size_t len);
     int                      (*udp_recv)(void *ctx, unsigned char *buf, size_t len);
     mbedtls_timing_delay_context timer; /* per-session DTLS timer (avoid static reuse) */
@@ -139,7 +159,8 @@ typedef struct {
 /**
  * @brief  Generate certification data for DTLS
  *
- * @note  Each time call will re-generate a new one
+ * @note  When persistent certificate store is set, load stored one if still valid
+ *        Otherwise each time call will re-generate a new one and save it into store
  *
  * @return
  *       - 0       On success
@@ -147,6 +168,29 @@ typedef struct {
  */
 int dtls_srtp_gen_cert(void);
 
+/**
+ * @brief  Start background thread keeping standby certificate ready for rotation
+ *
+ * @param[in]  cfg  Generator configuration
+ *
+ * @return
+ *       - ESP_PEER_ERR_NONE  On success
+ *       - Others             Failed to start
+ */
+int dtls_srtp_start_cert_gen(esp_peer_cert_gen_cfg_t *cfg);
+
+/**
+ * @brief  Stop background certificate generator and wait for its exit
+ */
+void dtls_srtp_stop_cert_gen(void);
+
+/**
+ * @brief  Get certificate usage statistics
+ *
+ * @param[out]  stats  Statistics to fill
+ */
+void dtls_srtp_get_cert_stats(esp_peer_cert_stats_t *stats);
+
 /**
  * @brief  Initialize for DTSP SRTP
  *
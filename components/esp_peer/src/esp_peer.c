@@ -9,12 +9,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include "dtls_srtp.h"
+#include "transport/transport_wait.h"
 
 #define WEAK __attribute__((weak))
 
 typedef struct {
-    esp_peer_ops_t    ops;
-    esp_peer_handle_t handle;
+    esp_peer_ops_t          ops;
+    esp_peer_handle_t       handle;
+    transport_wait_handle_t wait;
 } peer_wrapper_t;
 
 int esp_peer_open(esp_peer_cfg_t *cfg, const esp_peer_ops_t *ops, esp_peer_handle_t *handle)
@@ -27,8 +29,17 @@ int esp_peer_open(esp_peer_cfg_t *cfg, const esp_peer_ops_t *ops, esp_peer_handl
         return ESP_PEER_ERR_NO_MEM;
     }
     memcpy(&peer->ops, ops, sizeof(esp_peer_ops_t));
+    // Transports created by this peer register into its own wait context
+    peer->wait = transport_wait_create();
+    if (peer->wait == NULL) {
+        free(peer);
+        return ESP_PEER_ERR_NO_MEM;
+    }
+    transport_wait_handle_t prev = transport_wait_bind(peer->wait);
     int ret = ops->open(cfg, &peer->handle);
+    transport_wait_bind(prev);
     if (ret != ESP_PEER_ERR_NONE) {
+        transport_wait_destroy(peer->wait);
         free(peer);
         return ret;
     }
@@ -43,7 +54,10 @@ int esp_peer_new_connection(esp_peer_handle_t handle)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.new_connection) {
-        return peer->ops.new_connection(peer->handle);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.new_connection(peer->handle);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -55,7 +69,10 @@ int esp_peer_create_data_channel(esp_peer_handle_t handle, esp_peer_data_channel
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.create_data_channel) {
-        return peer->ops.create_data_channel(peer->handle, ch_cfg);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.create_data_channel(peer->handle, ch_cfg);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -67,7 +84,10 @@ int esp_peer_close_data_channel(esp_peer_handle_t handle, const char *label)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.close_data_channel) {
-        return peer->ops.close_data_channel(peer->handle, label);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.close_data_channel(peer->handle, label);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -79,7 +99,10 @@ int esp_peer_update_ice_info(esp_peer_handle_t handle, esp_peer_role_t role, esp
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.update_ice_info) {
-        return peer->ops.update_ice_info(peer->handle, role, server, server_num);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.update_ice_info(peer->handle, role, server, server_num);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -91,7 +114,12 @@ int esp_peer_send_msg(esp_peer_handle_t handle, esp_peer_msg_t *msg)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.send_msg) {
-        return peer->ops.send_msg(peer->handle, msg);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.send_msg(peer->handle, msg);
+        transport_wait_bind(prev);
+        // Let main loop handle queued data without waiting for timeout
+        transport_wakeup(peer->wait);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -103,7 +131,11 @@ int esp_peer_send_video(esp_peer_handle_t handle, esp_peer_video_frame_t *info)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.send_video) {
-        return peer->ops.send_video(peer->handle, info);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.send_video(peer->handle, info);
+        transport_wait_bind(prev);
+        transport_wakeup(peer->wait);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -115,7 +147,11 @@ int esp_peer_send_audio(esp_peer_handle_t handle, esp_peer_audio_frame_t *info)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.send_audio) {
-        return peer->ops.send_audio(peer->handle, info);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.send_audio(peer->handle, info);
+        transport_wait_bind(prev);
+        transport_wakeup(peer->wait);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -127,7 +163,11 @@ int esp_peer_send_data(esp_peer_handle_t handle, esp_peer_data_frame_t *info)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.send_data) {
-        return peer->ops.send_data(peer->handle, info);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.send_data(peer->handle, info);
+        transport_wait_bind(prev);
+        transport_wakeup(peer->wait);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -140,7 +180,10 @@ int esp_peer_set_rtp_transformer(esp_peer_handle_t handle, esp_peer_rtp_transfor
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.set_rtp_transformer) {
-        return peer->ops.set_rtp_transformer(peer->handle, role, transform_cb, ctx);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.set_rtp_transformer(peer->handle, role, transform_cb, ctx);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -152,11 +195,34 @@ int esp_peer_main_loop(esp_peer_handle_t handle)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.main_loop) {
-        return peer->ops.main_loop(peer->handle);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.main_loop(peer->handle);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
 
+int esp_peer_wait_event(esp_peer_handle_t handle, uint32_t timeout_ms)
+{
+    if (handle == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    peer_wrapper_t *peer = (peer_wrapper_t *)handle;
+    transport_wait(peer->wait, timeout_ms);
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_wakeup(esp_peer_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    peer_wrapper_t *peer = (peer_wrapper_t *)handle;
+    transport_wakeup(peer->wait);
+    return ESP_PEER_ERR_NONE;
+}
+
 int esp_peer_disconnect(esp_peer_handle_t handle)
 {
     if (handle == NULL) {
@@ -164,7 +230,10 @@ int esp_peer_disconnect(esp_peer_handle_t handle)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.disconnect) {
-        return peer->ops.disconnect(peer->handle);
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
+        int ret = peer->ops.disconnect(peer->handle);
+        transport_wait_bind(prev);
+        return ret;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
 }
@@ -176,7 +245,9 @@ int esp_peer_query(esp_peer_handle_t handle)
     }
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     if (peer->ops.query) {
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
         peer->ops.query(peer->handle);
+        transport_wait_bind(prev);
         return ESP_PEER_ERR_NONE;
     }
     return ESP_PEER_ERR_NOT_SUPPORT;
@@ -190,8 +261,11 @@ int esp_peer_close(esp_peer_handle_t handle)
     peer_wrapper_t *peer = (peer_wrapper_t *)handle;
     int ret = ESP_PEER_ERR_NOT_SUPPORT;
     if (peer->ops.close) {
+        transport_wait_handle_t prev = transport_wait_bind(peer->wait);
         ret = peer->ops.close(peer->handle);
+        transport_wait_bind(prev);
     }
+    transport_wait_destroy(peer->wait);
     free(peer);
     return ret;
 }
@@ -220,3 +294,26 @@ int esp_peer_pre_generate_cert(void)
     return ret == 0 ? ESP_PEER_ERR_NONE : ESP_PEER_ERR_FAIL;
 }
 
+int esp_peer_start_cert_generator(esp_peer_cert_gen_cfg_t *cfg)
+{
+    if (cfg == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    return dtls_srtp_start_cert_gen(cfg);
+}
+
+int esp_peer_stop_cert_generator(void)
+{
+    dtls_srtp_stop_cert_gen();
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_get_cert_stats(esp_peer_cert_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    dtls_srtp_get_cert_stats(stats);
+    return ESP_PEER_ERR_NONE;
+}
+
@@ -20,6 +20,8 @@ extern "C" {
 #define MEDIA_LIB_MAX_LOCK_TIME 0xFFFFFFFF
 
 typedef void* media_lib_mutex_handle_t;
+typedef void* media_lib_sema_handle_t;
+typedef void* media_lib_thread_handle_t;
 
 void* media_lib_malloc(size_t size);
 
@@ -37,6 +39,19 @@ int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex);
 
 void media_lib_thread_sleep(int ms);
 
+int media_lib_sema_create(media_lib_sema_handle_t *sema);
+
+int media_lib_sema_lock(media_lib_sema_handle_t sema, uint32_t timeout);
+
+int media_lib_sema_unlock(media_lib_sema_handle_t sema);
+
+int media_lib_sema_destroy(media_lib_sema_handle_t sema);
+
+int media_lib_thread_create(media_lib_thread_handle_t *handle, const char *name,
+                            void (*body)(void *arg), void *arg, uint32_t stack_size, int prio, int core);
+
+void media_lib_thread_destroy(media_lib_thread_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
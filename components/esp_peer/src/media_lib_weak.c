@@ -8,6 +8,7 @@
 #include "media_lib_os.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 
 /**
  * @brief  This file provide weak realization of MOCK media_lib API
@@ -77,3 +78,59 @@ void WEAK media_lib_thread_sleep(int ms)
 {
    vTaskDelay(pdMS_TO_TICKS(ms));
 }
+
+int WEAK media_lib_sema_create(media_lib_sema_handle_t *sema)
+{
+    if (sema == NULL) {
+        return -1;
+    }
+    *sema = (media_lib_sema_handle_t)xSemaphoreCreateCounting(1, 0);
+    return (*sema ? 0 : -1);
+}
+
+int WEAK media_lib_sema_lock(media_lib_sema_handle_t sema, uint32_t timeout)
+{
+    if (sema == NULL) {
+        return -1;
+    }
+    if (timeout != 0xFFFFFFFF) {
+        timeout = pdMS_TO_TICKS(timeout);
+    }
+    return xSemaphoreTake((QueueHandle_t)sema, timeout) == pdTRUE ? 0 : -1;
+}
+
+int WEAK media_lib_sema_unlock(media_lib_sema_handle_t sema)
+{
+    if (sema == NULL) {
+        return -1;
+    }
+    xSemaphoreGive((QueueHandle_t)sema);
+    return 0;
+}
+
+int WEAK media_lib_sema_destroy(media_lib_sema_handle_t sema)
+{
+    if (sema == NULL) {
+        return -1;
+    }
+    vSemaphoreDelete((QueueHandle_t)sema);
+    return 0;
+}
+
+int WEAK media_lib_thread_create(media_lib_thread_handle_t *handle, const char *name,
+                                 void (*body)(void *arg), void *arg, uint32_t stack_size, int prio, int core)
+{
+    TaskHandle_t task = NULL;
+    if (xTaskCreatePinnedToCore(body, name, stack_size, arg, prio, &task, core) != pdPASS) {
+        return -1;
+    }
+    if (handle) {
+        *handle = (media_lib_thread_handle_t)task;
+    }
+    return 0;
+}
+
+void WEAK media_lib_thread_destroy(media_lib_thread_handle_t handle)
+{
+    vTaskDelete((TaskHandle_t)handle);
+}
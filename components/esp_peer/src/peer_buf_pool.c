@@ -0,0 +1,199 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_peer_default.h"
+#include "media_lib_os.h"
+#include "peer_buf_pool.h"
+
+#define TAG "PEER_BUF_POOL"
+
+#define BUF_POOL_ALIGN           (8)
+#define BUF_POOL_ALIGN_UP(size)  (((size) + BUF_POOL_ALIGN - 1) & ~(BUF_POOL_ALIGN - 1))
+
+/*
+ * Default is no class: packet buffers come from heap directly and nothing is pinned
+ * test_host/buf_pool_soak shows slabs keep largest free heap block no better than heap does (about 115KB of
+ * slabs cut it from 135904 to 70752 bytes), so pool is opt-in through `esp_peer_set_buf_pool_cfg`
+ */
+#ifndef PEER_BUF_POOL_DEFAULT_CFG
+#define PEER_BUF_POOL_DEFAULT_CFG { \
+    .class_num = 0,                 \
+}
+#endif
+
+typedef struct {
+    uint32_t                         block_size;
+    uint16_t                         block_num;
+    uint8_t                         *slab;
+    uint8_t                         *slab_end;
+    void                            *free_list; /* Free blocks linked through their first word */
+    bool                             slab_failed;
+    esp_peer_buf_pool_class_stats_t  stats;
+} buf_pool_class_t;
+
+typedef struct {
+    pthread_mutex_t   lock;
+    bool              inited;
+    uint8_t           class_num;
+    buf_pool_class_t  classes[ESP_PEER_BUF_POOL_MAX_CLASS];
+    uint32_t          oversize;
+} buf_pool_t;
+
+static esp_peer_buf_pool_cfg_t s_pool_cfg = PEER_BUF_POOL_DEFAULT_CFG;
+static buf_pool_t s_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* Apply configuration on first use, called with lock held */
+static void buf_pool_init(void)
+{
+    if (s_pool.inited) {
+        return;
+    }
+    s_pool.class_num = s_pool_cfg.class_num;
+    for (int i = 0; i < s_pool.class_num; i++) {
+        buf_pool_class_t *c = &s_pool.classes[i];
+        c->block_size = BUF_POOL_ALIGN_UP(s_pool_cfg.classes[i].block_size);
+        c->block_num = s_pool_cfg.classes[i].block_num;
+        c->stats.block_size = c->block_size;
+        c->stats.block_num = c->block_num;
+    }
+    s_pool.inited = true;
+}
+
+static void buf_pool_class_prepare(buf_pool_class_t *c)
+{
+    c->slab = (uint8_t *)media_lib_malloc((size_t)c->block_size * c->block_num);
+    if (c->slab == NULL) {
+        // Do not retry on every packet, heap serves this class from now on
+        ESP_LOGW(TAG, "Fail to allocate slab %dx%d", (int)c->block_size, c->block_num);
+        c->slab_failed = true;
+        return;
+    }
+    c->slab_end = c->slab + (size_t)c->block_size * c->block_num;
+    for (int i = c->block_num - 1; i >= 0; i--) {
+        void **block = (void **)(c->slab + (size_t)i * c->block_size);
+        *block = c->free_list;
+        c->free_list = block;
+    }
+}
+
+void *peer_buf_pool_alloc(size_t size)
+{
+    pthread_mutex_lock(&s_pool.lock);
+    buf_pool_init();
+    buf_pool_class_t *c = NULL;
+    for (int i = 0; i < s_pool.class_num; i++) {
+        if (size <= s_pool.classes[i].block_size) {
+            c = &s_pool.classes[i];
+            break;
+        }
+    }
+    if (c == NULL) {
+        s_pool.oversize++;
+    } else {
+        if (c->slab == NULL && c->slab_failed == false) {
+            buf_pool_class_prepare(c);
+        }
+        void **block = (void **)c->free_list;
+        if (block) {
+            c->free_list = *block;
+            c->stats.allocs++;
+            c->stats.used++;
+            if (c->stats.used > c->stats.peak) {
+                c->stats.peak = c->stats.used;
+            }
+            pthread_mutex_unlock(&s_pool.lock);
+            return block;
+        }
+        c->stats.fallbacks++;
+    }
+    pthread_mutex_unlock(&s_pool.lock);
+    return media_lib_malloc(size);
+}
+
+void *peer_buf_pool_calloc(size_t size)
+{
+    void *ptr = peer_buf_pool_alloc(size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void peer_buf_pool_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    uint8_t *p = (uint8_t *)ptr;
+    pthread_mutex_lock(&s_pool.lock);
+    for (int i = 0; i < s_pool.class_num; i++) {
+        buf_pool_class_t *c = &s_pool.classes[i];
+        if (p >= c->slab && p < c->slab_end) {
+            *(void **)p = c->free_list;
+            c->free_list = p;
+            c->stats.used--;
+            pthread_mutex_unlock(&s_pool.lock);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&s_pool.lock);
+    media_lib_free(ptr);
+}
+
+int esp_peer_set_buf_pool_cfg(const esp_peer_buf_pool_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->class_num > ESP_PEER_BUF_POOL_MAX_CLASS) {
+        return -1;
+    }
+    for (int i = 0; i < cfg->class_num; i++) {
+        if (cfg->classes[i].block_size < sizeof(void *) || cfg->classes[i].block_num == 0 ||
+            (i > 0 && cfg->classes[i].block_size <= cfg->classes[i - 1].block_size)) {
+            return -1;
+        }
+    }
+    pthread_mutex_lock(&s_pool.lock);
+    if (s_pool.inited) {
+        pthread_mutex_unlock(&s_pool.lock);
+        ESP_LOGE(TAG, "Pool already in use");
+        return -1;
+    }
+    s_pool_cfg = *cfg;
+    pthread_mutex_unlock(&s_pool.lock);
+    return 0;
+}
+
+int esp_peer_get_buf_pool_stats(esp_peer_buf_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return -1;
+    }
+    memset(stats, 0, sizeof(esp_peer_buf_pool_stats_t));
+    pthread_mutex_lock(&s_pool.lock);
+    if (s_pool.inited == false) {
+        // Not used yet, report configured classes only so that configuration is still changeable
+        stats->class_num = s_pool_cfg.class_num;
+        for (int i = 0; i < s_pool_cfg.class_num; i++) {
+            stats->classes[i].block_size = BUF_POOL_ALIGN_UP(s_pool_cfg.classes[i].block_size);
+            stats->classes[i].block_num = s_pool_cfg.classes[i].block_num;
+        }
+    } else {
+        stats->class_num = s_pool.class_num;
+        for (int i = 0; i < s_pool.class_num; i++) {
+            stats->classes[i] = s_pool.classes[i].stats;
+        }
+        stats->oversize = s_pool.oversize;
+    }
+    pthread_mutex_unlock(&s_pool.lock);
+    return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Allocate packet buffer from size class pool, fallback to heap when no class can serve it
+ *
+ * @param[in]  size  Buffer size
+ *
+ * @return
+ *       - NULL    Not enough memory
+ *       - Others  Buffer, must be freed by `peer_buf_pool_free`
+ */
+void *peer_buf_pool_alloc(size_t size);
+
+/**
+ * @brief  Allocate zero-filled packet buffer from size class pool
+ */
+void *peer_buf_pool_calloc(size_t size);
+
+/**
+ * @brief  Free buffer allocated by `peer_buf_pool_alloc` or `peer_buf_pool_calloc`
+ */
+void peer_buf_pool_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "nvs.h"
+#include "esp_log.h"
+#include "esp_peer_default.h"
+#include "media_lib_os.h"
+
+#define TAG "PEER_CERT_STORE"
+
+#define CERT_STORE_NVS_NAMESPACE "esp_peer"
+#define CERT_STORE_NVS_CERT_KEY  "dtls_cert"
+#define CERT_STORE_NVS_KEY_KEY   "dtls_key"
+#define CERT_STORE_PEM_END       "-----END CERTIFICATE-----"
+
+static int nvs_cert_load(void *ctx, char *cert_pem, int cert_size, char *key_pem, int key_size)
+{
+    nvs_handle_t handle;
+    if (nvs_open((const char *)ctx, NVS_READONLY, &handle) != ESP_OK) {
+        // Namespace not created yet, nothing stored
+        return -1;
+    }
+    size_t len = cert_size;
+    esp_err_t err = nvs_get_str(handle, CERT_STORE_NVS_CERT_KEY, cert_pem, &len);
+    if (err == ESP_OK) {
+        len = key_size;
+        err = nvs_get_str(handle, CERT_STORE_NVS_KEY_KEY, key_pem, &len);
+    }
+    nvs_close(handle);
+    return err == ESP_OK ? 0 : -1;
+}
+
+static int nvs_cert_save(void *ctx, const char *cert_pem, const char *key_pem)
+{
+#ifndef CONFIG_NVS_ENCRYPTION
+    // Private key lands in flash as plaintext PEM, see `esp_peer_get_nvs_cert_store`
+    ESP_LOGW(TAG, "NVS encryption disabled, DTLS key stored in plaintext");
+#endif
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open((const char *)ctx, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Fail to open nvs err:%d", err);
+        return -1;
+    }
+    err = nvs_set_str(handle, CERT_STORE_NVS_CERT_KEY, cert_pem);
+    if (err == ESP_OK) {
+        err = nvs_set_str(handle, CERT_STORE_NVS_KEY_KEY, key_pem);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Fail to save cert to nvs err:%d", err);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * File layout is certificate PEM directly followed by key PEM
+ */
+static int file_cert_load(void *ctx, char *cert_pem, int cert_size, char *key_pem, int key_size)
+{
+    FILE *fp = fopen((const char *)ctx, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+    int size = cert_size + key_size;
+    char *buf = (char *)media_lib_malloc(size);
+    if (buf == NULL) {
+        fclose(fp);
+        return -1;
+    }
+    int ret = -1;
+    int len = fread(buf, 1, size - 1, fp);
+    fclose(fp);
+    buf[len] = '\0';
+    do {
+        char *end = strstr(buf, CERT_STORE_PEM_END);
+        if (end == NULL) {
+            break;
+        }
+        end += strlen(CERT_STORE_PEM_END);
+        while (*end == '\r' || *end == '\n') {
+            end++;
+        }
+        int cert_len = end - buf;
+        int key_len = strlen(end);
+        if (cert_len >= cert_size || key_len == 0 || key_len >= key_size) {
+            break;
+        }
+        memcpy(cert_pem, buf, cert_len);
+        cert_pem[cert_len] = '\0';
+        memcpy(key_pem, end, key_len + 1);
+        ret = 0;
+    } while (0);
+    media_lib_free(buf);
+    return ret;
+}
+
+static int file_cert_save(void *ctx, const char *cert_pem, const char *key_pem)
+{
+    const char *path = (const char *)ctx;
+    char tmp_path[128];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        ESP_LOGE(TAG, "Fail to open %s", tmp_path);
+        return -1;
+    }
+    int cert_len = strlen(cert_pem);
+    int key_len = strlen(key_pem);
+    bool ok = (fwrite(cert_pem, 1, cert_len, fp) == cert_len) && (fwrite(key_pem, 1, key_len, fp) == key_len);
+    ok = (fclose(fp) == 0) && ok;
+    // Write to temporary file then rename so that power loss never leaves half written certificate
+    if (ok && rename(tmp_path, path) != 0) {
+        remove(path);
+        ok = (rename(tmp_path, path) == 0);
+    }
+    if (ok == false) {
+        ESP_LOGE(TAG, "Fail to save cert to %s", path);
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int esp_peer_get_nvs_cert_store(const char *name_space, esp_peer_cert_store_t *store)
+{
+    if (store == NULL) {
+        return -1;
+    }
+    memset(store, 0, sizeof(esp_peer_cert_store_t));
+    store->load = nvs_cert_load;
+    store->save = nvs_cert_save;
+    store->ctx = (void *)(name_space ? name_space : CERT_STORE_NVS_NAMESPACE);
+    return 0;
+}
+
+int esp_peer_get_file_cert_store(const char *path, esp_peer_cert_store_t *store)
+{
+    if (path == NULL || store == NULL) {
+        return -1;
+    }
+    memset(store, 0, sizeof(esp_peer_cert_store_t));
+    store->load = file_cert_load;
+    store->save = file_cert_save;
+    store->ctx = (void *)path;
+    return 0;
+}
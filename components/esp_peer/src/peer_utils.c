@@ -22,9 +22,12 @@
  *
  */
 
+#include <stddef.h>
 #include "peer_utils.h"
 
 static esp_peer_dtls_cipher_pref_t s_dtls_cipher_pref = ESP_PEER_DTLS_CIPHER_AUTO;
+static esp_peer_cert_store_t s_cert_store;
+static bool s_cert_store_set = false;
 
 void peer_atomic_inc(atomic_int *v)
 {
@@ -54,3 +57,22 @@ int esp_peer_set_dtls_cipher_pref(esp_peer_dtls_cipher_pref_t pref)
     s_dtls_cipher_pref = pref;
     return 0;
 }
+
+const esp_peer_cert_store_t *peer_get_cert_store(void)
+{
+    return s_cert_store_set ? &s_cert_store : NULL;
+}
+
+int esp_peer_set_cert_store(const esp_peer_cert_store_t *store)
+{
+    if (store == NULL) {
+        s_cert_store_set = false;
+        return 0;
+    }
+    if (store->load == NULL || store->save == NULL) {
+        return -1;
+    }
+    s_cert_store = *store;
+    s_cert_store_set = true;
+    return 0;
+}
@@ -38,6 +38,9 @@ int peer_atomic_dec(atomic_int *v);
 /* Internal: read current DTLS cipher preference for handshake config. */
 esp_peer_dtls_cipher_pref_t peer_get_dtls_cipher_pref(void);
 
+/* Internal: get persistent DTLS certificate store, NULL if not set. */
+const esp_peer_cert_store_t *peer_get_cert_store(void);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
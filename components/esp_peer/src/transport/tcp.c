@@ -9,6 +9,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -17,12 +18,14 @@
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "esp_log.h"
 #include "media_lib_os.h"
 #include "peer_utils.h"
 #include "tcp.h"
+#include "transport_wait.h"
 
 #define TAG "TCP"
 #define WEAK __attribute__((weak))
@@ -32,6 +35,54 @@
 #define TCP_DEFAULT_SEND_TIMEOUT_MS    (1000)
 #define TCP_DEFAULT_RECV_TIMEOUT_MS    (150)
 #define TCP_WORKER_SLEEP_MS            (10)
+#define TCP_WORKER_IDLE_MS             (1000)
+/* Listen socket is left alone for this long when accept fails for lack of resource (e.g. EMFILE) */
+#define TCP_ACCEPT_BACKOFF_MS           (500)
+/* Send priority rings of each connection, `prio` of `tcp_connections_send_to` selects ring:
+ * 0 is lowest, values >= TCP_SEND_PRIO_NUM - 1 share the highest ring. Rings are drained from
+ * highest to lowest (same order as the sorted send queue used before) and FIFO inside one ring */
+#define TCP_SEND_PRIO_NUM              (3)
+
+/* Per-priority send ring size of each connection, must be power of 2 */
+#ifndef TCP_SEND_RING_SIZE
+#define TCP_SEND_RING_SIZE (16 * 1024)
+#endif
+
+/* Bytes each connection may queue beyond its rings (e.g. keyframe burst).
+ * Once reached, sender drains the connection itself so no frame is dropped */
+#ifndef TCP_SEND_OVERFLOW_SIZE
+#define TCP_SEND_OVERFLOW_SIZE (128 * 1024)
+#endif
+
+/* Overflow is allocated in chunks of this size, so one burst costs a few allocations only */
+#ifndef TCP_SEND_OVERFLOW_CHUNK
+#define TCP_SEND_OVERFLOW_CHUNK (8 * 1024)
+#endif
+
+/* Receive buffer size of each connection, frames are sliced out of it without further syscalls */
+#ifndef TCP_RECV_BUF_SIZE
+#define TCP_RECV_BUF_SIZE (4096)
+#endif
+
+/* Whole framed packets which did not fit into send ring, `pos` to `len` are still queued */
+typedef struct tcp_send_chunk_t {
+    struct tcp_send_chunk_t *next;
+    uint32_t                 size;
+    uint32_t                 len;
+    uint32_t                 pos;
+    uint8_t                  data[];
+} tcp_send_chunk_t;
+
+/* Byte ring holding RFC 4571 framed packets exactly as they go on the wire.
+ * head/tail are free running, buffer is allocated on first use and kept until close.
+ * Bytes in overflow chunks follow ring content and move into ring as it drains. */
+typedef struct {
+    uint8_t          *buf;
+    uint32_t          head;
+    uint32_t          tail;
+    tcp_send_chunk_t *overflow_head;
+    tcp_send_chunk_t *overflow_tail;
+} tcp_send_ring_t;
 
 typedef struct {
     int             fd;
@@ -40,26 +91,33 @@ typedef struct {
     bool            connecting;
     uint32_t        connect_start_ms;
     pthread_mutex_t io_lock;
+    pthread_mutex_t send_lock; /* Protect send_ring, lock order: manager -> io_lock -> send_lock */
+    tcp_send_ring_t send_ring[TCP_SEND_PRIO_NUM];
+    uint32_t        overflow_size; /* Queued overflow bytes of all rings, protected by send_lock */
+    uint8_t        *rx_buf; /* Buffered stream data, protected by io_lock */
+    uint32_t        rx_pos;
+    uint32_t        rx_len;
 } tcp_connection_t;
 
-typedef struct tcp_send_item_t {
-    struct tcp_send_item_t *next;
-    esp_peer_addr_t         addr;
-    uint8_t                 prio;
-    int                     len;
-    uint8_t                 data[];
-} tcp_send_item_t;
-
 struct tcp_connections_t {
     tcp_connections_cfg_t cfg;
     tcp_socket_t          listen_sock;
     tcp_connection_t     *connections;
     uint8_t               connection_num;
-    tcp_send_item_t      *send_head;
+    uint8_t               rr_next;  /* Connection served first on next receive, for fairness */
+    struct pollfd        *poll_fds; /* One entry per connection slot, guarded by poll_lock */
+    pthread_mutex_t       poll_lock;
     pthread_mutex_t       lock;
     pthread_t             worker;
+    struct pollfd        *worker_fds; /* Wakeup, listen and connecting sockets watched by worker */
+    int                   wake_fd;
+    struct sockaddr_in    wake_addr;
+    atomic_int            wake_pending;
+    atomic_int            worker_waiting;
     bool                  worker_started;
     bool                  server_started;
+    bool                  accept_paused;      /* Accept backoff state, only used by worker */
+    uint32_t              accept_pause_start;
     bool                  closing;
     atomic_int            users;
 };
@@ -201,7 +259,10 @@ int WEAK tcp_socket_accept(tcp_socket_t *tcp_socket, tcp_socket_t *client, esp_p
     int fd = accept(tcp_socket->fd, (struct sockaddr *)&storage, &addr_len);
     if (fd < 0) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            ESP_LOGE(TAG, "Failed to accept: %s", strerror(errno));
+            int err = errno;
+            ESP_LOGE(TAG, "Failed to accept: %s", strerror(err));
+            // Keep errno for caller to tell resource failure from no pending connection
+            errno = err;
         }
         return -1;
     }
@@ -354,20 +415,41 @@ static void tcp_connection_wake(tcp_connection_t *conn)
     }
 }
 
+static void tcp_socket_release(void *arg)
+{
+    close((int)(intptr_t)arg);
+}
+
 /* Close the socket / free the slot. Takes io_lock so it waits for any in-flight I/O on
- * this connection to finish before closing the fd (no recycled-fd read). Callers hold
+ * this connection to finish before closing the fd (no recycled-fd read). The fd itself is
+ * kept until a select() of transport_wait() already watching it returns. Callers hold
  * the manager lock; lock order is always manager -> io_lock. Idempotent. */
-static void tcp_connection_close(tcp_connection_t *conn)
+static void tcp_connection_close(tcp_connections_handle_t tcp, tcp_connection_t *conn)
 {
     pthread_mutex_lock(&conn->io_lock);
     if (conn->fd >= 0) {
         int fd = conn->fd;
         conn->fd = -1;
         shutdown(fd, SHUT_RDWR);
-        close(fd);
+        transport_wait_release(tcp, tcp_socket_release, (void *)(intptr_t)fd);
     }
     conn->connected = false;
     conn->connecting = false;
+    conn->rx_pos = conn->rx_len = 0;
+    /* Drop queued data, it belongs to the closed stream */
+    pthread_mutex_lock(&conn->send_lock);
+    for (int i = 0; i < TCP_SEND_PRIO_NUM; i++) {
+        tcp_send_ring_t *ring = &conn->send_ring[i];
+        ring->head = ring->tail = 0;
+        while (ring->overflow_head) {
+            tcp_send_chunk_t *chunk = ring->overflow_head;
+            ring->overflow_head = chunk->next;
+            free(chunk);
+        }
+        ring->overflow_tail = NULL;
+    }
+    conn->overflow_size = 0;
+    pthread_mutex_unlock(&conn->send_lock);
     pthread_mutex_unlock(&conn->io_lock);
 }
 
@@ -381,10 +463,27 @@ static int tcp_connection_send(tcp_connection_t *conn, uint8_t *data, int len, u
     return tcp_socket_send(&sock, data, len);
 }
 
+/* Read exactly `len` bytes, served from the receive buffer first. The buffer is refilled
+ * with one large recv so back-to-back frames need no extra syscalls; reads larger than
+ * the buffer go straight into the destination. */
 static int tcp_connection_recv_exact(tcp_connection_t *conn, uint8_t *data, int len, uint32_t timeout_ms)
 {
     int received = 0;
+    if (conn->rx_buf == NULL) {
+        conn->rx_buf = malloc(TCP_RECV_BUF_SIZE);
+        if (conn->rx_buf == NULL) {
+            return -1;
+        }
+    }
     while (received < len) {
+        int avail = conn->rx_len - conn->rx_pos;
+        if (avail > 0) {
+            int n = avail < len - received ? avail : len - received;
+            memcpy(data + received, conn->rx_buf + conn->rx_pos, n);
+            conn->rx_pos += n;
+            received += n;
+            continue;
+        }
         fd_set read_set;
         FD_ZERO(&read_set);
         FD_SET(conn->fd, &read_set);
@@ -396,31 +495,59 @@ static int tcp_connection_recv_exact(tcp_connection_t *conn, uint8_t *data, int
         if (ret <= 0) {
             return received > 0 ? -1 : ret;
         }
-        ret = recv(conn->fd, data + received, len - received, 0);
+        if (len - received >= TCP_RECV_BUF_SIZE) {
+            ret = recv(conn->fd, data + received, len - received, 0);
+            if (ret <= 0) {
+                return -1;
+            }
+            received += ret;
+            continue;
+        }
+        ret = recv(conn->fd, conn->rx_buf, TCP_RECV_BUF_SIZE, 0);
         if (ret <= 0) {
             return -1;
         }
-        received += ret;
+        conn->rx_pos = 0;
+        conn->rx_len = ret;
     }
     return received;
 }
 
+/* Remaining time the listen socket is not served after a failed accept, 0 when not paused */
+static uint32_t tcp_accept_pause_left(tcp_connections_handle_t tcp)
+{
+    if (tcp->accept_paused == false) {
+        return 0;
+    }
+    uint32_t elapsed = tcp_get_time_ms() - tcp->accept_pause_start;
+    if (elapsed >= TCP_ACCEPT_BACKOFF_MS) {
+        tcp->accept_paused = false;
+        return 0;
+    }
+    return TCP_ACCEPT_BACKOFF_MS - elapsed;
+}
+
 static void tcp_connections_accept_all(tcp_connections_handle_t tcp)
 {
-    if (tcp->server_started == false) {
+    if (tcp->server_started == false || tcp_accept_pause_left(tcp) > 0) {
         return;
     }
     while (tcp->listen_sock.fd >= 0) {
         tcp_socket_t client;
         esp_peer_addr_t addr;
         if (tcp_socket_accept(&tcp->listen_sock, &client, &addr) != 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                /* Pending connection stays readable, stop polling it for a while to avoid busy loop */
+                tcp->accept_paused = true;
+                tcp->accept_pause_start = tcp_get_time_ms();
+            }
             break;
         }
         tcp_set_nonblock(client.fd, true);
         pthread_mutex_lock(&tcp->lock);
         tcp_connection_t *old = tcp_connections_find(tcp, &addr);
         if (old) {
-            tcp_connection_close(old);
+            tcp_connection_close(tcp, old);
         }
         tcp_connection_t *conn = old ? old : tcp_connections_alloc(tcp);
         if (conn == NULL) {
@@ -446,7 +573,7 @@ static void tcp_connections_check_connecting(tcp_connections_handle_t tcp)
             continue;
         }
         if (now - conn->connect_start_ms > tcp->cfg.connect_timeout_ms) {
-            tcp_connection_close(conn);
+            tcp_connection_close(tcp, conn);
             continue;
         }
         fd_set write_set;
@@ -461,7 +588,7 @@ static void tcp_connections_check_connecting(tcp_connections_handle_t tcp)
         socklen_t err_len = sizeof(err);
         if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0 || err != 0) {
             ESP_LOGW(TAG, "Async TCP connect failed: %s", strerror(err ? err : errno));
-            tcp_connection_close(conn);
+            tcp_connection_close(tcp, conn);
         } else {
             conn->connecting = false;
             conn->connected = true;
@@ -470,54 +597,272 @@ static void tcp_connections_check_connecting(tcp_connections_handle_t tcp)
     pthread_mutex_unlock(&tcp->lock);
 }
 
-static tcp_send_item_t *tcp_connections_pop_send(tcp_connections_handle_t tcp, tcp_connection_t **conn)
+/* Append data into send ring, caller holds send_lock and has checked free space */
+static void tcp_send_ring_write(tcp_send_ring_t *ring, const uint8_t *data, uint32_t len)
 {
-    tcp_send_item_t *prev = NULL;
-    tcp_send_item_t *cur = tcp->send_head;
-    while (cur) {
-        *conn = tcp_connections_find(tcp, &cur->addr);
-        if (*conn && (*conn)->connected) {
-            if (prev) {
-                prev->next = cur->next;
-            } else {
-                tcp->send_head = cur->next;
+    uint32_t pos = ring->head & (TCP_SEND_RING_SIZE - 1);
+    uint32_t first = TCP_SEND_RING_SIZE - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(ring->buf + pos, data, first);
+    if (len > first) {
+        memcpy(ring->buf, data + first, len - first);
+    }
+    ring->head += len;
+}
+
+/* Move overflow frames into rings as far as they fit, caller holds send_lock.
+ * Only whole frames are moved: all rings go out in one writev, so a ring must never end inside a frame. */
+static void tcp_send_ring_refill(tcp_connection_t *conn)
+{
+    for (int i = 0; i < TCP_SEND_PRIO_NUM; i++) {
+        tcp_send_ring_t *ring = &conn->send_ring[i];
+        while (ring->overflow_head) {
+            tcp_send_chunk_t *chunk = ring->overflow_head;
+            uint32_t room = TCP_SEND_RING_SIZE - (ring->head - ring->tail);
+            uint32_t n = 0;
+            while (chunk->pos + n < chunk->len) {
+                uint8_t *frame = chunk->data + chunk->pos + n;
+                uint32_t frame_len = 2 + ((frame[0] << 8) | frame[1]);
+                if (n + frame_len > room) {
+                    break;
+                }
+                n += frame_len;
+            }
+            tcp_send_ring_write(ring, chunk->data + chunk->pos, n);
+            chunk->pos += n;
+            conn->overflow_size -= n;
+            if (chunk->pos < chunk->len) {
+                break;
             }
-            cur->next = NULL;
-            return cur;
+            ring->overflow_head = chunk->next;
+            if (ring->overflow_head == NULL) {
+                ring->overflow_tail = NULL;
+            }
+            free(chunk);
         }
-        prev = cur;
-        cur = cur->next;
     }
-    *conn = NULL;
-    return NULL;
 }
 
-static void tcp_connections_process_send(tcp_connections_handle_t tcp)
+/* Map queued bytes of all rings into iovecs, highest priority first. Caller holds send_lock.
+ * Only producers touch head, so the mapped region stays valid until tail is advanced. */
+static int tcp_send_ring_fill_iov(tcp_connection_t *conn, struct iovec *iov, uint32_t *pending)
 {
-    while (true) {
-        pthread_mutex_lock(&tcp->lock);
-        tcp_connection_t *conn = NULL;
-        tcp_send_item_t *item = tcp_connections_pop_send(tcp, &conn);
-        if (item == NULL) {
-            pthread_mutex_unlock(&tcp->lock);
-            break;
+    int iov_num = 0;
+    for (int i = TCP_SEND_PRIO_NUM - 1; i >= 0; i--) {
+        tcp_send_ring_t *ring = &conn->send_ring[i];
+        uint32_t used = ring->head - ring->tail;
+        pending[i] = used;
+        if (used == 0) {
+            continue;
+        }
+        uint32_t pos = ring->tail & (TCP_SEND_RING_SIZE - 1);
+        uint32_t first = TCP_SEND_RING_SIZE - pos;
+        if (first > used) {
+            first = used;
+        }
+        iov[iov_num].iov_base = ring->buf + pos;
+        iov[iov_num++].iov_len = first;
+        if (used > first) {
+            iov[iov_num].iov_base = ring->buf;
+            iov[iov_num++].iov_len = used - first;
+        }
+    }
+    return iov_num;
+}
+
+/* Write all iovecs, coalescing queued frames into as few syscalls as possible */
+static int tcp_connection_writev(tcp_connection_t *conn, struct iovec *iov, int iov_num, uint32_t timeout_ms)
+{
+    while (iov_num > 0) {
+        fd_set write_set;
+        FD_ZERO(&write_set);
+        FD_SET(conn->fd, &write_set);
+        struct timeval tv = {
+            .tv_sec = timeout_ms / 1000,
+            .tv_usec = (timeout_ms % 1000) * 1000,
+        };
+        int ret = select(conn->fd + 1, NULL, &write_set, NULL, &tv);
+        if (ret <= 0) {
+            return -1;
         }
-        /* Grab io_lock while still holding the manager lock so the connection cannot
-         * be closed between popping and sending, then drop the manager lock so other
-         * API calls (e.g. recv) are not blocked while this send is in progress. */
-        pthread_mutex_lock(&conn->io_lock);
+        ssize_t sent = writev(conn->fd, iov, iov_num);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            ESP_LOGE(TAG, "Failed to send: %s", strerror(errno));
+            return -1;
+        }
+        while (iov_num > 0 && sent >= (ssize_t)iov->iov_len) {
+            sent -= iov->iov_len;
+            iov++;
+            iov_num--;
+        }
+        if (iov_num > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
+    }
+    return 0;
+}
+
+/* Drain send rings of one connection, return bytes sent or -1 on failure */
+static int tcp_connection_flush(tcp_connections_handle_t tcp, tcp_connection_t *conn)
+{
+    pthread_mutex_lock(&tcp->lock);
+    if (conn->fd < 0 || conn->connected == false) {
         pthread_mutex_unlock(&tcp->lock);
-        int sret = tcp_connection_send(conn, item->data, item->len, tcp->cfg.send_timeout_ms);
+        return 0;
+    }
+    /* Grab io_lock while still holding the manager lock so the connection cannot
+     * be closed while sending, then drop the manager lock so other API calls
+     * (e.g. recv) are not blocked while this send is in progress. */
+    pthread_mutex_lock(&conn->io_lock);
+    pthread_mutex_unlock(&tcp->lock);
+
+    struct iovec iov[TCP_SEND_PRIO_NUM * 2];
+    uint32_t pending[TCP_SEND_PRIO_NUM];
+    pthread_mutex_lock(&conn->send_lock);
+    int iov_num = tcp_send_ring_fill_iov(conn, iov, pending);
+    pthread_mutex_unlock(&conn->send_lock);
+    if (iov_num == 0) {
         pthread_mutex_unlock(&conn->io_lock);
-        if (sret != item->len) {
-            pthread_mutex_lock(&tcp->lock);
-            tcp_connection_close(conn);
-            pthread_mutex_unlock(&tcp->lock);
+        return 0;
+    }
+    int ret = tcp_connection_writev(conn, iov, iov_num, tcp->cfg.send_timeout_ms);
+    int sent = 0;
+    if (ret == 0) {
+        /* Release space before io_lock so a concurrent close cannot reset rings in between */
+        pthread_mutex_lock(&conn->send_lock);
+        for (int i = 0; i < TCP_SEND_PRIO_NUM; i++) {
+            conn->send_ring[i].tail += pending[i];
+            sent += pending[i];
+        }
+        tcp_send_ring_refill(conn);
+        pthread_mutex_unlock(&conn->send_lock);
+    }
+    pthread_mutex_unlock(&conn->io_lock);
+    if (ret != 0) {
+        pthread_mutex_lock(&tcp->lock);
+        tcp_connection_close(tcp, conn);
+        pthread_mutex_unlock(&tcp->lock);
+        return -1;
+    }
+    return sent;
+}
+
+static void tcp_connections_process_send(tcp_connections_handle_t tcp)
+{
+    bool sent = true;
+    while (sent && tcp->closing == false) {
+        sent = false;
+        for (int i = 0; i < tcp->connection_num; i++) {
+            if (tcp_connection_flush(tcp, &tcp->connections[i]) > 0) {
+                sent = true;
+            }
         }
-        free(item);
     }
 }
 
+/* Add connected sockets into read set of transport_wait(), report already buffered data */
+static bool tcp_connections_wait_fill(void *ctx, fd_set *read_set, int *max_fd)
+{
+    tcp_connections_handle_t tcp = (tcp_connections_handle_t)ctx;
+    bool buffered = false;
+    pthread_mutex_lock(&tcp->lock);
+    for (int i = 0; i < tcp->connection_num; i++) {
+        tcp_connection_t *conn = &tcp->connections[i];
+        if (conn->fd >= 0 && conn->connected) {
+            if (conn->rx_len > conn->rx_pos) {
+                buffered = true;
+            }
+            FD_SET(conn->fd, read_set);
+            if (conn->fd > *max_fd) {
+                *max_fd = conn->fd;
+            }
+        }
+    }
+    pthread_mutex_unlock(&tcp->lock);
+    return buffered;
+}
+
+/* Loopback datagram socket used to wake the worker, select()/poll() on lwIP only accept sockets */
+static int tcp_wake_fd_create(struct sockaddr_in *addr)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        ESP_LOGW(TAG, "Failed to create wakeup socket, fallback to polling");
+        return -1;
+    }
+    struct sockaddr_in sin = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t len = sizeof(sin);
+    if (bind(fd, (struct sockaddr *)&sin, len) < 0 || getsockname(fd, (struct sockaddr *)&sin, &len) < 0) {
+        ESP_LOGW(TAG, "Failed to bind wakeup socket, fallback to polling");
+        close(fd);
+        return -1;
+    }
+    tcp_set_nonblock(fd, true);
+    *addr = sin;
+    return fd;
+}
+
+/* Wake the worker, datagram is only sent when it is blocked so busy senders cost no syscall */
+static void tcp_connections_wakeup(tcp_connections_handle_t tcp)
+{
+    atomic_store(&tcp->wake_pending, 1);
+    if (atomic_load(&tcp->worker_waiting) && tcp->wake_fd >= 0) {
+        uint8_t v = 0;
+        sendto(tcp->wake_fd, &v, 1, MSG_DONTWAIT, (struct sockaddr *)&tcp->wake_addr, sizeof(tcp->wake_addr));
+    }
+}
+
+/* Block until new connection, connect result, queued send data or idle timeout */
+static void tcp_connections_worker_wait(tcp_connections_handle_t tcp)
+{
+    struct pollfd *fds = tcp->worker_fds;
+    int num = 0;
+    if (tcp->wake_fd >= 0) {
+        fds[num].fd = tcp->wake_fd;
+        fds[num++].events = POLLIN;
+    }
+    uint32_t timeout_ms = tcp->wake_fd >= 0 ? TCP_WORKER_IDLE_MS : TCP_WORKER_SLEEP_MS;
+    if (tcp->server_started && tcp->listen_sock.fd >= 0) {
+        uint32_t pause_ms = tcp_accept_pause_left(tcp);
+        if (pause_ms == 0) {
+            fds[num].fd = tcp->listen_sock.fd;
+            fds[num++].events = POLLIN;
+        } else if (pause_ms < timeout_ms) {
+            timeout_ms = pause_ms;
+        }
+    }
+    pthread_mutex_lock(&tcp->lock);
+    for (int i = 0; i < tcp->connection_num; i++) {
+        tcp_connection_t *conn = &tcp->connections[i];
+        if (conn->fd >= 0 && conn->connecting) {
+            fds[num].fd = conn->fd;
+            fds[num++].events = POLLOUT;
+        }
+    }
+    pthread_mutex_unlock(&tcp->lock);
+    atomic_store(&tcp->worker_waiting, 1);
+    // Recheck after publishing waiting state so that wakeup in between is not lost
+    if (atomic_exchange(&tcp->wake_pending, 0) == 0 && tcp->closing == false) {
+        if (num == 0) {
+            media_lib_thread_sleep(timeout_ms);
+        } else if (poll(fds, num, timeout_ms) > 0 && tcp->wake_fd >= 0 && (fds[0].revents & POLLIN)) {
+            uint8_t v[8];
+            while (recv(tcp->wake_fd, v, sizeof(v), MSG_DONTWAIT) > 0);
+        }
+    }
+    atomic_store(&tcp->worker_waiting, 0);
+    atomic_store(&tcp->wake_pending, 0);
+}
+
 static void *tcp_connections_worker(void *arg)
 {
     tcp_connections_handle_t tcp = (tcp_connections_handle_t)arg;
@@ -525,11 +870,31 @@ static void *tcp_connections_worker(void *arg)
         tcp_connections_accept_all(tcp);
         tcp_connections_check_connecting(tcp);
         tcp_connections_process_send(tcp);
-        media_lib_thread_sleep(TCP_WORKER_SLEEP_MS);
+        tcp_connections_worker_wait(tcp);
     }
     return NULL;
 }
 
+/* Destroy connection locks of the first `num` slots, free connection buffers and the manager */
+static void tcp_connections_destroy_locks(tcp_connections_handle_t tcp, int num)
+{
+    for (int i = 0; i < num; i++) {
+        pthread_mutex_destroy(&tcp->connections[i].io_lock);
+        pthread_mutex_destroy(&tcp->connections[i].send_lock);
+        for (int j = 0; j < TCP_SEND_PRIO_NUM; j++) {
+            free(tcp->connections[i].send_ring[j].buf);
+        }
+        free(tcp->connections[i].rx_buf);
+    }
+    if (tcp->wake_fd >= 0) {
+        close(tcp->wake_fd);
+    }
+    free(tcp->worker_fds);
+    free(tcp->poll_fds);
+    free(tcp->connections);
+    free(tcp);
+}
+
 tcp_connections_handle_t WEAK tcp_connections_open(tcp_connections_cfg_t *cfg)
 {
     tcp_connections_handle_t tcp = calloc(1, sizeof(struct tcp_connections_t));
@@ -550,42 +915,51 @@ tcp_connections_handle_t WEAK tcp_connections_open(tcp_connections_cfg_t *cfg)
         tcp->cfg.recv_timeout_ms = TCP_DEFAULT_RECV_TIMEOUT_MS;
     }
     tcp->listen_sock.fd = -1;
+    tcp->wake_fd = -1;
     tcp->connections = calloc(tcp->cfg.max_connections, sizeof(tcp_connection_t));
     if (tcp->connections == NULL) {
         free(tcp);
         return NULL;
     }
     tcp->connection_num = tcp->cfg.max_connections;
+    tcp->poll_fds = calloc(tcp->connection_num, sizeof(struct pollfd));
+    /* Wakeup socket, listen socket and one per connection */
+    tcp->worker_fds = calloc(tcp->connection_num + 2, sizeof(struct pollfd));
+    if (tcp->poll_fds == NULL || tcp->worker_fds == NULL) {
+        tcp_connections_destroy_locks(tcp, 0);
+        return NULL;
+    }
     for (int i = 0; i < tcp->connection_num; i++) {
         tcp->connections[i].fd = -1;
         if (pthread_mutex_init(&tcp->connections[i].io_lock, NULL) != 0) {
-            for (int j = 0; j < i; j++) {
-                pthread_mutex_destroy(&tcp->connections[j].io_lock);
-            }
-            free(tcp->connections);
-            free(tcp);
+            tcp_connections_destroy_locks(tcp, i);
             return NULL;
         }
-    }
-    if (pthread_mutex_init(&tcp->lock, NULL) != 0) {
-        for (int i = 0; i < tcp->connection_num; i++) {
+        if (pthread_mutex_init(&tcp->connections[i].send_lock, NULL) != 0) {
             pthread_mutex_destroy(&tcp->connections[i].io_lock);
+            tcp_connections_destroy_locks(tcp, i);
+            return NULL;
         }
-        free(tcp->connections);
-        free(tcp);
+    }
+    if (pthread_mutex_init(&tcp->lock, NULL) != 0) {
+        tcp_connections_destroy_locks(tcp, tcp->connection_num);
         return NULL;
     }
+    if (pthread_mutex_init(&tcp->poll_lock, NULL) != 0) {
+        pthread_mutex_destroy(&tcp->lock);
+        tcp_connections_destroy_locks(tcp, tcp->connection_num);
+        return NULL;
+    }
+    tcp->wake_fd = tcp_wake_fd_create(&tcp->wake_addr);
     if (pthread_create(&tcp->worker, NULL, tcp_connections_worker, tcp) == 0) {
         tcp->worker_started = true;
     } else {
+        pthread_mutex_destroy(&tcp->poll_lock);
         pthread_mutex_destroy(&tcp->lock);
-        for (int i = 0; i < tcp->connection_num; i++) {
-            pthread_mutex_destroy(&tcp->connections[i].io_lock);
-        }
-        free(tcp->connections);
-        free(tcp);
+        tcp_connections_destroy_locks(tcp, tcp->connection_num);
         return NULL;
     }
+    transport_wait_register(tcp, tcp_connections_wait_fill);
     return tcp;
 }
 
@@ -624,6 +998,8 @@ int WEAK tcp_connections_start_server(tcp_connections_handle_t tcp)
     int ret = tcp_set_nonblock(tcp->listen_sock.fd, true);
     if (ret == 0) {
         tcp->server_started = true;
+        /* Let worker watch the listen socket */
+        tcp_connections_wakeup(tcp);
     }
     return ret;
 }
@@ -672,6 +1048,9 @@ int WEAK tcp_connections_connect(tcp_connections_handle_t tcp, esp_peer_addr_t *
     conn->connecting = ret != 0;
     conn->connect_start_ms = tcp_get_time_ms();
     pthread_mutex_unlock(&tcp->lock);
+    if (conn->connecting) {
+        tcp_connections_wakeup(tcp);
+    }
     return 0;
 }
 
@@ -687,6 +1066,68 @@ bool WEAK tcp_connections_is_connected(tcp_connections_handle_t tcp, esp_peer_ad
     return connected;
 }
 
+/* Queue one RFC 4571 frame into the connection send ring, or its overflow list when ring is full
+ * Return 0 on success, 1 when overflow limit is reached, -1 on error */
+static int tcp_connection_enqueue(tcp_connections_handle_t tcp, esp_peer_addr_t *addr, const uint8_t *buf, int len,
+                                  uint8_t prio, tcp_connection_t **out)
+{
+    pthread_mutex_lock(&tcp->lock);
+    tcp_connection_t *conn = tcp_connections_find(tcp, addr);
+    if (conn == NULL) {
+        pthread_mutex_unlock(&tcp->lock);
+        return -1;
+    }
+    /* Take send_lock under the manager lock so the connection cannot be closed in between */
+    pthread_mutex_lock(&conn->send_lock);
+    pthread_mutex_unlock(&tcp->lock);
+    *out = conn;
+    tcp_send_ring_t *ring = &conn->send_ring[prio < TCP_SEND_PRIO_NUM ? prio : TCP_SEND_PRIO_NUM - 1];
+    if (ring->buf == NULL) {
+        ring->buf = malloc(TCP_SEND_RING_SIZE);
+        if (ring->buf == NULL) {
+            pthread_mutex_unlock(&conn->send_lock);
+            return -1;
+        }
+    }
+    uint16_t net_len = htons((uint16_t)len);
+    if (ring->overflow_head == NULL && TCP_SEND_RING_SIZE - (ring->head - ring->tail) >= (uint32_t)len + 2) {
+        tcp_send_ring_write(ring, (uint8_t *)&net_len, sizeof(net_len));
+        tcp_send_ring_write(ring, buf, len);
+        pthread_mutex_unlock(&conn->send_lock);
+        return 0;
+    }
+    /* Keep FIFO order: once overflow is used, later frames of this ring go after it */
+    if (conn->overflow_size + len + 2 > TCP_SEND_OVERFLOW_SIZE) {
+        pthread_mutex_unlock(&conn->send_lock);
+        return 1;
+    }
+    /* Frame never spans chunks so that refill can move whole frames */
+    tcp_send_chunk_t *chunk = ring->overflow_tail;
+    if (chunk == NULL || chunk->size - chunk->len < (uint32_t)len + 2) {
+        uint32_t size = len + 2 > TCP_SEND_OVERFLOW_CHUNK ? len + 2 : TCP_SEND_OVERFLOW_CHUNK;
+        chunk = malloc(sizeof(tcp_send_chunk_t) + size);
+        if (chunk == NULL) {
+            pthread_mutex_unlock(&conn->send_lock);
+            return -1;
+        }
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->len = chunk->pos = 0;
+        if (ring->overflow_tail) {
+            ring->overflow_tail->next = chunk;
+        } else {
+            ring->overflow_head = chunk;
+        }
+        ring->overflow_tail = chunk;
+    }
+    memcpy(chunk->data + chunk->len, &net_len, sizeof(net_len));
+    memcpy(chunk->data + chunk->len + 2, buf, len);
+    chunk->len += len + 2;
+    conn->overflow_size += len + 2;
+    pthread_mutex_unlock(&conn->send_lock);
+    return 0;
+}
+
 int WEAK tcp_connections_send_to(tcp_connections_handle_t tcp, esp_peer_addr_t *addr, const uint8_t *buf, int len, uint8_t prio)
 {
     if (tcp == NULL || addr == NULL || buf == NULL || len <= 0) {
@@ -698,25 +1139,28 @@ int WEAK tcp_connections_send_to(tcp_connections_handle_t tcp, esp_peer_addr_t *
     if (tcp->closing) {
         return -1;
     }
-    tcp_send_item_t *item = calloc(1, sizeof(tcp_send_item_t) + len + 2);
-    if (item == NULL) {
+    if (len + 2 > TCP_SEND_RING_SIZE) {
         return -1;
     }
-    item->addr = *addr;
-    item->prio = prio;
-    item->len = len + 2;
-    uint16_t net_len = htons((uint16_t)len);
-    memcpy(item->data, &net_len, sizeof(net_len));
-    memcpy(item->data + 2, buf, len);
-
-    pthread_mutex_lock(&tcp->lock);
-    tcp_send_item_t **cur = &tcp->send_head;
-    while (*cur && (*cur)->prio >= prio) {
-        cur = &(*cur)->next;
+    tcp_connection_t *conn = NULL;
+    int ret = tcp_connection_enqueue(tcp, addr, buf, len, prio, &conn);
+    while (ret > 0) {
+        /* Ring and overflow full: peer is slower than we send for long, drain it from caller
+         * so memory stays bounded without dropping. Nothing can move while still connecting */
+        int sent = tcp_connection_flush(tcp, conn);
+        if (sent < 0) {
+            return -1;
+        }
+        if (sent == 0) {
+            tcp_connections_wakeup(tcp);
+            return -200;
+        }
+        ret = tcp_connection_enqueue(tcp, addr, buf, len, prio, &conn);
     }
-    item->next = *cur;
-    *cur = item;
-    pthread_mutex_unlock(&tcp->lock);
+    if (ret != 0) {
+        return -1;
+    }
+    tcp_connections_wakeup(tcp);
     return len;
 }
 
@@ -747,7 +1191,7 @@ int WEAK tcp_connections_send_raw_to(tcp_connections_handle_t tcp, esp_peer_addr
     pthread_mutex_unlock(&conn->io_lock);
     if (ret != len) {
         pthread_mutex_lock(&tcp->lock);
-        tcp_connection_close(conn);
+        tcp_connection_close(tcp, conn);
         pthread_mutex_unlock(&tcp->lock);
     }
     rc = ret;
@@ -756,37 +1200,58 @@ done:
     return rc;
 }
 
-/* Build the read fd_set over all connected connections (short manager-lock section).
- * Returns the max fd or -1 if none/closing. */
-static int tcp_build_read_set(tcp_connections_handle_t tcp, fd_set *read_set)
+/* Fill poll set with connected sockets, one entry per slot (short manager-lock section).
+ * Caller holds poll_lock. Returns number of sockets to poll, `buffered` tells whether any
+ * connection has buffered data and `next_buffered` whether the next one in round-robin does. */
+static int tcp_build_poll_set(tcp_connections_handle_t tcp, bool *buffered, bool *next_buffered)
 {
-    int max_fd = -1;
-    FD_ZERO(read_set);
+    int num = 0;
+    *buffered = *next_buffered = false;
     pthread_mutex_lock(&tcp->lock);
-    for (int i = 0; i < tcp->connection_num; i++) {
+    for (int n = 0; n < tcp->connection_num; n++) {
+        int i = (tcp->rr_next + n) % tcp->connection_num;
         tcp_connection_t *conn = &tcp->connections[i];
-        if (conn->fd >= 0 && conn->connected) {
-            FD_SET(conn->fd, read_set);
-            if (conn->fd > max_fd) {
-                max_fd = conn->fd;
+        struct pollfd *pfd = &tcp->poll_fds[i];
+        /* Negative fd is ignored by poll() */
+        pfd->fd = (conn->fd >= 0 && conn->connected) ? conn->fd : -1;
+        pfd->events = POLLIN;
+        pfd->revents = 0;
+        if (pfd->fd < 0) {
+            continue;
+        }
+        if (conn->rx_len > conn->rx_pos) {
+            *buffered = true;
+            if (num == 0) {
+                *next_buffered = true;
             }
         }
+        num++;
     }
     pthread_mutex_unlock(&tcp->lock);
-    return max_fd;
+    return num;
 }
 
-/* After select() reports readiness, pick the first ready connection and return it with
- * its io_lock held (taken under the manager lock so it cannot be closed in between). The
- * caller does the blocking record read without holding the manager lock. NULL if none. */
-static tcp_connection_t *tcp_acquire_ready(tcp_connections_handle_t tcp, fd_set *read_set)
+/* Pick a readable connection round-robin starting after the last served one and return it
+ * with its io_lock held (taken under the manager lock so it cannot be closed in between).
+ * Readable means buffered data or poll() readiness when `poll_fds` is given.
+ * The caller does the blocking record read without holding the manager lock. NULL if none. */
+static tcp_connection_t *tcp_acquire_ready(tcp_connections_handle_t tcp, struct pollfd *poll_fds)
 {
     tcp_connection_t *ready = NULL;
     pthread_mutex_lock(&tcp->lock);
-    for (int i = 0; i < tcp->connection_num; i++) {
+    for (int n = 0; n < tcp->connection_num; n++) {
+        int i = (tcp->rr_next + n) % tcp->connection_num;
         tcp_connection_t *conn = &tcp->connections[i];
-        if (conn->fd >= 0 && conn->connected && FD_ISSET(conn->fd, read_set)) {
+        if (conn->fd < 0 || conn->connected == false) {
+            continue;
+        }
+        bool has_data = conn->rx_len > conn->rx_pos;
+        if (has_data == false && poll_fds) {
+            has_data = poll_fds[i].fd == conn->fd && (poll_fds[i].revents & (POLLIN | POLLERR | POLLHUP));
+        }
+        if (has_data) {
             ready = conn;
+            tcp->rr_next = (i + 1) % tcp->connection_num;
             pthread_mutex_lock(&ready->io_lock);
             break;
         }
@@ -795,6 +1260,36 @@ static tcp_connection_t *tcp_acquire_ready(tcp_connections_handle_t tcp, fd_set
     return ready;
 }
 
+/* Acquire a connection with data to read, serving connections round-robin.
+ * When the next connection already has buffered data it is returned without any syscall,
+ * otherwise poll() (non-blocking if something is buffered) decides who is ready so a
+ * connection with a busy buffer cannot starve the others.
+ * Set `rc` to poll() result when nothing is ready. */
+static tcp_connection_t *tcp_wait_ready(tcp_connections_handle_t tcp, bool nowait, int *rc)
+{
+    bool buffered, next_buffered;
+    tcp_connection_t *conn = NULL;
+    pthread_mutex_lock(&tcp->poll_lock);
+    if (tcp_build_poll_set(tcp, &buffered, &next_buffered) == 0) {
+        pthread_mutex_unlock(&tcp->poll_lock);
+        *rc = -1;
+        return NULL;
+    }
+    *rc = 0;
+    if (next_buffered) {
+        conn = tcp_acquire_ready(tcp, NULL);
+    } else {
+        int ret = poll(tcp->poll_fds, tcp->connection_num, (nowait || buffered) ? 0 : (int)tcp->cfg.recv_timeout_ms);
+        if (ret < 0 || (ret == 0 && buffered == false)) {
+            *rc = ret;
+        } else {
+            conn = tcp_acquire_ready(tcp, tcp->poll_fds);
+        }
+    }
+    pthread_mutex_unlock(&tcp->poll_lock);
+    return conn;
+}
+
 /* Release a connection acquired by tcp_acquire_ready(); close it (under the manager
  * lock) when the read failed. */
 static void tcp_release_ready(tcp_connections_handle_t tcp, tcp_connection_t *conn, bool failed)
@@ -802,7 +1297,7 @@ static void tcp_release_ready(tcp_connections_handle_t tcp, tcp_connection_t *co
     pthread_mutex_unlock(&conn->io_lock);
     if (failed) {
         pthread_mutex_lock(&tcp->lock);
-        tcp_connection_close(conn);
+        tcp_connection_close(tcp, conn);
         pthread_mutex_unlock(&tcp->lock);
     }
 }
@@ -813,29 +1308,14 @@ int WEAK tcp_connections_recv_from(tcp_connections_handle_t tcp, esp_peer_addr_t
         return -1;
     }
     int rc = -1;
-    fd_set read_set;
+    int ret;
     tcp_connection_t *conn = NULL;
     peer_atomic_inc(&tcp->users);
     if (tcp->closing) {
         goto done;
     }
-    int max_fd = tcp_build_read_set(tcp, &read_set);
-    if (max_fd < 0) {
-        goto done;
-    }
-    struct timeval tv = { 0 };
-    if (nowait == false) {
-        tv.tv_sec = tcp->cfg.recv_timeout_ms / 1000;
-        tv.tv_usec = (tcp->cfg.recv_timeout_ms % 1000) * 1000;
-    }
-    int ret = select(max_fd + 1, &read_set, NULL, NULL, &tv);
-    if (ret <= 0) {
-        rc = ret;
-        goto done;
-    }
-    conn = tcp_acquire_ready(tcp, &read_set);
+    conn = tcp_wait_ready(tcp, nowait, &rc);
     if (conn == NULL) {
-        rc = 0;
         goto done;
     }
     uint16_t net_len = 0;
@@ -872,29 +1352,14 @@ int WEAK tcp_connections_recv_raw_from(tcp_connections_handle_t tcp, esp_peer_ad
         return -1;
     }
     int rc = -1;
-    fd_set read_set;
+    int ret;
     tcp_connection_t *conn = NULL;
     peer_atomic_inc(&tcp->users);
     if (tcp->closing) {
         goto done;
     }
-    int max_fd = tcp_build_read_set(tcp, &read_set);
-    if (max_fd < 0) {
-        goto done;
-    }
-    struct timeval tv = { 0 };
-    if (nowait == false) {
-        tv.tv_sec = tcp->cfg.recv_timeout_ms / 1000;
-        tv.tv_usec = (tcp->cfg.recv_timeout_ms % 1000) * 1000;
-    }
-    int ret = select(max_fd + 1, &read_set, NULL, NULL, &tv);
-    if (ret <= 0) {
-        rc = ret;
-        goto done;
-    }
-    conn = tcp_acquire_ready(tcp, &read_set);
+    conn = tcp_wait_ready(tcp, nowait, &rc);
     if (conn == NULL) {
-        rc = 0;
         goto done;
     }
     if (len < 4) {
@@ -970,7 +1435,9 @@ void WEAK tcp_connections_close(tcp_connections_handle_t tcp)
     if (tcp == NULL) {
         return;
     }
+    transport_wait_unregister(tcp);
     tcp->closing = true;
+    tcp_connections_wakeup(tcp);
     /* Follow udp_socket_close(): close/shutdown the sockets FIRST, BEFORE joining the
      * worker, so a worker blocked in connect()/send() or any in-flight recv/send blocked
      * in select()/recv()/send() returns immediately and close aborts the connection
@@ -989,20 +1456,11 @@ void WEAK tcp_connections_close(tcp_connections_handle_t tcp)
     }
     pthread_mutex_lock(&tcp->lock);
     for (int i = 0; i < tcp->connection_num; i++) {
-        tcp_connection_close(&tcp->connections[i]);
-    }
-    tcp_send_item_t *item = tcp->send_head;
-    while (item) {
-        tcp_send_item_t *next = item->next;
-        free(item);
-        item = next;
+        tcp_connection_close(tcp, &tcp->connections[i]);
     }
     pthread_mutex_unlock(&tcp->lock);
-    for (int i = 0; i < tcp->connection_num; i++) {
-        pthread_mutex_destroy(&tcp->connections[i].io_lock);
-    }
+    pthread_mutex_destroy(&tcp->poll_lock);
     pthread_mutex_destroy(&tcp->lock);
-    free(tcp->connections);
-    free(tcp);
+    tcp_connections_destroy_locks(tcp, tcp->connection_num);
 }
 
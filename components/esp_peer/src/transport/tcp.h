@@ -67,6 +67,21 @@ int tcp_connections_connect(tcp_connections_handle_t tcp, esp_peer_addr_t *addr)
 
 bool tcp_connections_is_connected(tcp_connections_handle_t tcp, esp_peer_addr_t *addr);
 
+/**
+ * @brief  Queue one frame to send to connection of `addr`, sent by worker later
+ *
+ * @note  `prio` selects send ring: 0 is lowest, 2 and above share the highest ring
+ *        Higher priority rings are sent first, frames in one ring keep their order
+ * @note  Frames not fitting into ring are kept in a per-connection overflow list (TCP_SEND_OVERFLOW_SIZE bytes),
+ *        when it is also full the connection is drained from caller so that no frame is dropped
+ * @note  Connection slot for `addr` must exist (connected, connecting or accepted). Frames are no longer
+ *        kept for addresses without connection, they would only be freed when connections are closed
+ *
+ * @return
+ *       - len   Frame queued
+ *       - -200  Rings and overflow full while still connecting, frame not queued, can retry later
+ *       - -1    No connection for `addr`, frame too large for ring, or connection closed while draining
+ */
 int tcp_connections_send_to(tcp_connections_handle_t tcp, esp_peer_addr_t *addr, const uint8_t *buf, int len, uint8_t prio);
 
 int tcp_connections_recv_from(tcp_connections_handle_t tcp, esp_peer_addr_t *addr, uint8_t *buf, int len, bool nowait);
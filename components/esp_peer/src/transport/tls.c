@@ -8,6 +8,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -20,10 +21,12 @@
 
 #include "esp_log.h"
 #include "media_lib_os.h"
+#include "peer_buf_pool.h"
 #include "peer_tls.h"
 #include "peer_utils.h"
 #include "tcp.h"
 #include "tls.h"
+#include "transport_wait.h"
 
 #define TAG "TLS"
 #define WEAK __attribute__((weak))
@@ -32,6 +35,14 @@
 #define TLS_DEFAULT_SEND_TIMEOUT_MS    (1000)
 #define TLS_DEFAULT_RECV_TIMEOUT_MS    (150)
 #define TLS_WORKER_SLEEP_MS            (10)
+#define TLS_WORKER_IDLE_MS             (1000)
+/* Listen socket is left alone for this long when accept fails for lack of resource (e.g. EMFILE) */
+#define TLS_ACCEPT_BACKOFF_MS           (500)
+
+/* Receive buffer size of each connection, frames are sliced out of it without further reads */
+#ifndef TLS_RECV_BUF_SIZE
+#define TLS_RECV_BUF_SIZE (4096)
+#endif
 
 typedef struct {
     int                     fd;
@@ -41,6 +52,9 @@ typedef struct {
     uint32_t                connect_start_ms;
     peer_tls_handle_t       sess;
     pthread_mutex_t         io_lock;
+    uint8_t                *rx_buf; /* Buffered (decrypted) stream data, protected by io_lock */
+    uint32_t                rx_pos;
+    uint32_t                rx_len;
 } tls_connection_t;
 
 typedef struct tls_send_item_t {
@@ -56,11 +70,21 @@ struct tls_connections_t {
     tcp_socket_t          listen_sock;
     tls_connection_t     *connections;
     uint8_t               connection_num;
+    uint8_t               rr_next;  /* Connection served first on next receive, for fairness */
+    struct pollfd        *poll_fds; /* One entry per connection slot, guarded by poll_lock */
+    pthread_mutex_t       poll_lock;
     tls_send_item_t      *send_head;
     pthread_mutex_t       lock;
     pthread_t             worker;
+    struct pollfd        *worker_fds; /* Wakeup, listen and connecting sockets watched by worker */
+    int                   wake_fd;
+    struct sockaddr_in    wake_addr;
+    atomic_int            wake_pending;
+    atomic_int            worker_waiting;
     bool                  worker_started;
     bool                  server_started;
+    bool                  accept_paused;      /* Accept backoff state, only used by worker */
+    uint32_t              accept_pause_start;
     bool                  closing;
     atomic_int            users;
 };
@@ -172,24 +196,41 @@ static void tls_connection_wake(tls_connection_t *conn)
     }
 }
 
+static void tls_session_release(void *arg)
+{
+    peer_tls_free((peer_tls_handle_t)arg);
+}
+
+static void tls_socket_release(void *arg)
+{
+    close((int)(intptr_t)arg);
+}
+
 /* Tear down the session/socket. Takes io_lock so it waits for any in-flight I/O on
- * this connection to finish before freeing the session (no use-after-free). Callers
- * hold the manager lock; lock order is always manager -> io_lock. Idempotent. */
-static void tls_connection_close(tls_connection_t *conn)
+ * this connection to finish before freeing the session (no use-after-free). The session
+ * and its socket are kept until a select() of transport_wait() already watching it
+ * returns. Callers hold the manager lock; lock order is always manager -> io_lock.
+ * Idempotent. */
+static void tls_connection_close(tls_connections_handle_t tls, tls_connection_t *conn)
 {
     pthread_mutex_lock(&conn->io_lock);
     if (conn->sess) {
-        peer_tls_free(conn->sess);
+        peer_tls_handle_t sess = conn->sess;
         conn->sess = NULL;
+        if (conn->fd >= 0) {
+            shutdown(conn->fd, SHUT_RDWR);
+        }
         conn->fd = -1;
+        transport_wait_release(tls, tls_session_release, sess);
     } else if (conn->fd >= 0) {
         int fd = conn->fd;
         conn->fd = -1;
         shutdown(fd, SHUT_RDWR);
-        close(fd);
+        transport_wait_release(tls, tls_socket_release, (void *)(intptr_t)fd);
     }
     conn->connected = false;
     conn->connecting = false;
+    conn->rx_pos = conn->rx_len = 0;
     pthread_mutex_unlock(&conn->io_lock);
 }
 
@@ -233,11 +274,30 @@ static int tls_connection_send(tls_connection_t *conn, uint8_t *data, int len, u
     return tcp_socket_send(&sock, data, len);
 }
 
+/* Read exactly `len` bytes, served from the receive buffer first. The buffer is refilled
+ * with one large read so back-to-back frames need no extra reads; reads larger than the
+ * buffer go straight into the destination. */
 static int tls_connection_recv_exact(tls_connection_t *conn, uint8_t *data, int len, uint32_t timeout_ms)
 {
     int received = 0;
+    if (conn->rx_buf == NULL) {
+        conn->rx_buf = malloc(TLS_RECV_BUF_SIZE);
+        if (conn->rx_buf == NULL) {
+            return -1;
+        }
+    }
+    /* Set when TLS layer wants more data, need wait for socket even if records are pending */
+    bool want_read = false;
     while (received < len) {
-        bool skip_select = conn->sess != NULL && peer_tls_pending(conn->sess) > 0;
+        int avail = conn->rx_len - conn->rx_pos;
+        if (avail > 0) {
+            int n = avail < len - received ? avail : len - received;
+            memcpy(data + received, conn->rx_buf + conn->rx_pos, n);
+            conn->rx_pos += n;
+            received += n;
+            continue;
+        }
+        bool skip_select = !want_read && conn->sess != NULL && peer_tls_pending(conn->sess) > 0;
         if (!skip_select) {
             fd_set read_set;
             FD_ZERO(&read_set);
@@ -250,36 +310,66 @@ static int tls_connection_recv_exact(tls_connection_t *conn, uint8_t *data, int
             if (ret <= 0) {
                 return received > 0 ? -1 : ret;
             }
+            want_read = false;
         }
+        bool direct = (len - received >= TLS_RECV_BUF_SIZE);
+        uint8_t *dst = direct ? data + received : conn->rx_buf;
+        int want = direct ? len - received : TLS_RECV_BUF_SIZE;
         int ret;
         if (conn->sess) {
-            ret = peer_tls_read(conn->sess, data + received, len - received);
+            ret = peer_tls_read(conn->sess, dst, want);
             if (ret < 0) {
                 return -1;
             }
             if (ret == 0) {
+                // Partial record only, block on socket readiness instead of reading again
+                want_read = true;
                 continue;
             }
         } else {
-            ret = recv(conn->fd, data + received, len - received, 0);
+            ret = recv(conn->fd, dst, want, 0);
             if (ret <= 0) {
                 return -1;
             }
         }
-        received += ret;
+        if (direct) {
+            received += ret;
+        } else {
+            conn->rx_pos = 0;
+            conn->rx_len = ret;
+        }
     }
     return received;
 }
 
+/* Remaining time the listen socket is not served after a failed accept, 0 when not paused */
+static uint32_t tls_accept_pause_left(tls_connections_handle_t tls)
+{
+    if (tls->accept_paused == false) {
+        return 0;
+    }
+    uint32_t elapsed = tls_get_time_ms() - tls->accept_pause_start;
+    if (elapsed >= TLS_ACCEPT_BACKOFF_MS) {
+        tls->accept_paused = false;
+        return 0;
+    }
+    return TLS_ACCEPT_BACKOFF_MS - elapsed;
+}
+
 static void tls_connections_accept_all(tls_connections_handle_t tls)
 {
-    if (tls->server_started == false) {
+    if (tls->server_started == false || tls_accept_pause_left(tls) > 0) {
         return;
     }
     while (tls->listen_sock.fd >= 0) {
         tcp_socket_t client;
         esp_peer_addr_t addr;
         if (tcp_socket_accept(&tls->listen_sock, &client, &addr) != 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                /* Pending connection stays readable, stop polling it for a while to avoid busy loop */
+                tls->accept_paused = true;
+                tls->accept_pause_start = tls_get_time_ms();
+            }
             break;
         }
         tls_set_nonblock(client.fd, true);
@@ -300,7 +390,7 @@ static void tls_connections_accept_all(tls_connections_handle_t tls)
         pthread_mutex_lock(&tls->lock);
         tls_connection_t *old = tls_connections_find(tls, &addr);
         if (old) {
-            tls_connection_close(old);
+            tls_connection_close(tls, old);
         }
         tls_connection_t *conn = old ? old : tls_connections_alloc(tls);
         if (conn == NULL) {
@@ -327,7 +417,7 @@ static void tls_connections_check_connecting(tls_connections_handle_t tls)
             continue;
         }
         if (now - conn->connect_start_ms > tls->cfg.connect_timeout_ms) {
-            tls_connection_close(conn);
+            tls_connection_close(tls, conn);
             continue;
         }
         fd_set write_set;
@@ -342,7 +432,7 @@ static void tls_connections_check_connecting(tls_connections_handle_t tls)
         socklen_t err_len = sizeof(err);
         if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0 || err != 0) {
             ESP_LOGW(TAG, "Async TCP connect failed: %s", strerror(err ? err : errno));
-            tls_connection_close(conn);
+            tls_connection_close(tls, conn);
             continue;
         }
         /* TCP is up; run the (blocking) TLS handshake WITHOUT holding the manager
@@ -367,7 +457,7 @@ static void tls_connections_check_connecting(tls_connections_handle_t tls)
             ESP_LOGE(TAG, "TLS client handshake failed");
             /* peer_tls_new_client already closed conn_fd on failure */
             conn->fd = -1;
-            tls_connection_close(conn);
+            tls_connection_close(tls, conn);
             continue;
         }
         conn->sess = sess;
@@ -419,11 +509,108 @@ static void tls_connections_process_send(tls_connections_handle_t tls)
         pthread_mutex_unlock(&conn->io_lock);
         if (sret != item->len) {
             pthread_mutex_lock(&tls->lock);
-            tls_connection_close(conn);
+            tls_connection_close(tls, conn);
             pthread_mutex_unlock(&tls->lock);
         }
-        free(item);
+        peer_buf_pool_free(item);
+    }
+}
+
+/* Add connected sockets into read set of transport_wait(), report already decrypted data */
+static bool tls_connections_wait_fill(void *ctx, fd_set *read_set, int *max_fd)
+{
+    tls_connections_handle_t tls = (tls_connections_handle_t)ctx;
+    bool buffered = false;
+    pthread_mutex_lock(&tls->lock);
+    for (int i = 0; i < tls->connection_num; i++) {
+        tls_connection_t *conn = &tls->connections[i];
+        if (conn->fd >= 0 && conn->connected) {
+            if (conn->rx_len > conn->rx_pos || (conn->sess && peer_tls_pending(conn->sess) > 0)) {
+                buffered = true;
+            }
+            FD_SET(conn->fd, read_set);
+            if (conn->fd > *max_fd) {
+                *max_fd = conn->fd;
+            }
+        }
     }
+    pthread_mutex_unlock(&tls->lock);
+    return buffered;
+}
+
+/* Loopback datagram socket used to wake the worker, select()/poll() on lwIP only accept sockets */
+static int tls_wake_fd_create(struct sockaddr_in *addr)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        ESP_LOGW(TAG, "Failed to create wakeup socket, fallback to polling");
+        return -1;
+    }
+    struct sockaddr_in sin = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t len = sizeof(sin);
+    if (bind(fd, (struct sockaddr *)&sin, len) < 0 || getsockname(fd, (struct sockaddr *)&sin, &len) < 0) {
+        ESP_LOGW(TAG, "Failed to bind wakeup socket, fallback to polling");
+        close(fd);
+        return -1;
+    }
+    tls_set_nonblock(fd, true);
+    *addr = sin;
+    return fd;
+}
+
+/* Wake the worker, datagram is only sent when it is blocked so busy senders cost no syscall */
+static void tls_connections_wakeup(tls_connections_handle_t tls)
+{
+    atomic_store(&tls->wake_pending, 1);
+    if (atomic_load(&tls->worker_waiting) && tls->wake_fd >= 0) {
+        uint8_t v = 0;
+        sendto(tls->wake_fd, &v, 1, MSG_DONTWAIT, (struct sockaddr *)&tls->wake_addr, sizeof(tls->wake_addr));
+    }
+}
+
+/* Block until new connection, connect result, queued send data or idle timeout */
+static void tls_connections_worker_wait(tls_connections_handle_t tls)
+{
+    struct pollfd *fds = tls->worker_fds;
+    int num = 0;
+    if (tls->wake_fd >= 0) {
+        fds[num].fd = tls->wake_fd;
+        fds[num++].events = POLLIN;
+    }
+    uint32_t timeout_ms = tls->wake_fd >= 0 ? TLS_WORKER_IDLE_MS : TLS_WORKER_SLEEP_MS;
+    if (tls->server_started && tls->listen_sock.fd >= 0) {
+        uint32_t pause_ms = tls_accept_pause_left(tls);
+        if (pause_ms == 0) {
+            fds[num].fd = tls->listen_sock.fd;
+            fds[num++].events = POLLIN;
+        } else if (pause_ms < timeout_ms) {
+            timeout_ms = pause_ms;
+        }
+    }
+    pthread_mutex_lock(&tls->lock);
+    for (int i = 0; i < tls->connection_num; i++) {
+        tls_connection_t *conn = &tls->connections[i];
+        if (conn->fd >= 0 && conn->connecting) {
+            fds[num].fd = conn->fd;
+            fds[num++].events = POLLOUT;
+        }
+    }
+    pthread_mutex_unlock(&tls->lock);
+    atomic_store(&tls->worker_waiting, 1);
+    // Recheck after publishing waiting state so that wakeup in between is not lost
+    if (atomic_exchange(&tls->wake_pending, 0) == 0 && tls->closing == false) {
+        if (num == 0) {
+            media_lib_thread_sleep(timeout_ms);
+        } else if (poll(fds, num, timeout_ms) > 0 && tls->wake_fd >= 0 && (fds[0].revents & POLLIN)) {
+            uint8_t v[8];
+            while (recv(tls->wake_fd, v, sizeof(v), MSG_DONTWAIT) > 0);
+        }
+    }
+    atomic_store(&tls->worker_waiting, 0);
+    atomic_store(&tls->wake_pending, 0);
 }
 
 static void *tls_connections_worker(void *arg)
@@ -433,11 +620,27 @@ static void *tls_connections_worker(void *arg)
         tls_connections_accept_all(tls);
         tls_connections_check_connecting(tls);
         tls_connections_process_send(tls);
-        media_lib_thread_sleep(TLS_WORKER_SLEEP_MS);
+        tls_connections_worker_wait(tls);
     }
     return NULL;
 }
 
+/* Destroy connection locks of the first `num` slots, free connection buffers and the manager */
+static void tls_connections_destroy_locks(tls_connections_handle_t tls, int num)
+{
+    for (int i = 0; i < num; i++) {
+        pthread_mutex_destroy(&tls->connections[i].io_lock);
+        free(tls->connections[i].rx_buf);
+    }
+    if (tls->wake_fd >= 0) {
+        close(tls->wake_fd);
+    }
+    free(tls->worker_fds);
+    free(tls->poll_fds);
+    free(tls->connections);
+    free(tls);
+}
+
 tls_connections_handle_t WEAK tls_connections_open(tls_connections_cfg_t *cfg)
 {
     tls_connections_handle_t tls = calloc(1, sizeof(struct tls_connections_t));
@@ -458,42 +661,46 @@ tls_connections_handle_t WEAK tls_connections_open(tls_connections_cfg_t *cfg)
         tls->cfg.recv_timeout_ms = TLS_DEFAULT_RECV_TIMEOUT_MS;
     }
     tls->listen_sock.fd = -1;
+    tls->wake_fd = -1;
     tls->connections = calloc(tls->cfg.max_connections, sizeof(tls_connection_t));
     if (tls->connections == NULL) {
         free(tls);
         return NULL;
     }
     tls->connection_num = tls->cfg.max_connections;
+    tls->poll_fds = calloc(tls->connection_num, sizeof(struct pollfd));
+    /* Wakeup socket, listen socket and one per connection */
+    tls->worker_fds = calloc(tls->connection_num + 2, sizeof(struct pollfd));
+    if (tls->poll_fds == NULL || tls->worker_fds == NULL) {
+        tls_connections_destroy_locks(tls, 0);
+        return NULL;
+    }
     for (int i = 0; i < tls->connection_num; i++) {
         tls->connections[i].fd = -1;
         if (pthread_mutex_init(&tls->connections[i].io_lock, NULL) != 0) {
-            for (int j = 0; j < i; j++) {
-                pthread_mutex_destroy(&tls->connections[j].io_lock);
-            }
-            free(tls->connections);
-            free(tls);
+            tls_connections_destroy_locks(tls, i);
             return NULL;
         }
     }
     if (pthread_mutex_init(&tls->lock, NULL) != 0) {
-        for (int i = 0; i < tls->connection_num; i++) {
-            pthread_mutex_destroy(&tls->connections[i].io_lock);
-        }
-        free(tls->connections);
-        free(tls);
+        tls_connections_destroy_locks(tls, tls->connection_num);
         return NULL;
     }
+    if (pthread_mutex_init(&tls->poll_lock, NULL) != 0) {
+        pthread_mutex_destroy(&tls->lock);
+        tls_connections_destroy_locks(tls, tls->connection_num);
+        return NULL;
+    }
+    tls->wake_fd = tls_wake_fd_create(&tls->wake_addr);
     if (pthread_create(&tls->worker, NULL, tls_connections_worker, tls) == 0) {
         tls->worker_started = true;
     } else {
+        pthread_mutex_destroy(&tls->poll_lock);
         pthread_mutex_destroy(&tls->lock);
-        for (int i = 0; i < tls->connection_num; i++) {
-            pthread_mutex_destroy(&tls->connections[i].io_lock);
-        }
-        free(tls->connections);
-        free(tls);
+        tls_connections_destroy_locks(tls, tls->connection_num);
         return NULL;
     }
+    transport_wait_register(tls, tls_connections_wait_fill);
     return tls;
 }
 
@@ -532,6 +739,8 @@ int WEAK tls_connections_start_server(tls_connections_handle_t tls)
     int ret = tls_set_nonblock(tls->listen_sock.fd, true);
     if (ret == 0) {
         tls->server_started = true;
+        /* Let worker watch the listen socket */
+        tls_connections_wakeup(tls);
     }
     return ret;
 }
@@ -582,6 +791,7 @@ int WEAK tls_connections_connect(tls_connections_handle_t tls, esp_peer_addr_t *
     conn->connecting = true;
     conn->connect_start_ms = tls_get_time_ms();
     pthread_mutex_unlock(&tls->lock);
+    tls_connections_wakeup(tls);
     return 0;
 }
 
@@ -612,7 +822,8 @@ int WEAK tls_connections_send_to(tls_connections_handle_t tls, esp_peer_addr_t *
     if (tls->closing) {
         return -1;
     }
-    tls_send_item_t *item = calloc(1, sizeof(tls_send_item_t) + len + 2);
+    // Queued per packet, take it from packet buffer pool to keep heap unfragmented
+    tls_send_item_t *item = peer_buf_pool_calloc(sizeof(tls_send_item_t) + len + 2);
     if (item == NULL) {
         return -1;
     }
@@ -631,6 +842,7 @@ int WEAK tls_connections_send_to(tls_connections_handle_t tls, esp_peer_addr_t *
     item->next = *cur;
     *cur = item;
     pthread_mutex_unlock(&tls->lock);
+    tls_connections_wakeup(tls);
     return len;
 }
 
@@ -681,7 +893,7 @@ int WEAK tls_connections_send_raw_to(tls_connections_handle_t tls, esp_peer_addr
     pthread_mutex_unlock(&conn->io_lock);
     if (failed) {
         pthread_mutex_lock(&tls->lock);
-        tls_connection_close(conn);
+        tls_connection_close(tls, conn);
         pthread_mutex_unlock(&tls->lock);
         rc = -1;
     } else {
@@ -692,46 +904,73 @@ done:
     return rc;
 }
 
-/* Build the read fd_set over all connected connections (short manager-lock sections),
- * waiting up to recv_timeout for at least one connection to appear. Returns the max fd
- * or -1 if none/closing. */
-static int tls_build_read_set(tls_connections_handle_t tls, fd_set *read_set, bool nowait)
+/* Connection has data which can be read without waiting on the socket */
+static inline bool tls_connection_buffered(tls_connection_t *conn)
+{
+    return conn->rx_len > conn->rx_pos || (conn->sess && peer_tls_pending(conn->sess) > 0);
+}
+
+/* Fill poll set with connected sockets, one entry per slot (short manager-lock sections),
+ * waiting up to recv_timeout for at least one connection to appear. Caller holds poll_lock.
+ * Returns number of sockets to poll, `buffered` tells whether any connection has buffered
+ * data and `next_buffered` whether the next one in round-robin does. */
+static int tls_build_poll_set(tls_connections_handle_t tls, bool nowait, bool *buffered, bool *next_buffered)
 {
-    int max_fd = -1;
+    int num = 0;
     uint32_t wait_deadline = tls_get_time_ms() + tls->cfg.recv_timeout_ms;
     do {
-        FD_ZERO(read_set);
-        max_fd = -1;
+        num = 0;
+        *buffered = *next_buffered = false;
         pthread_mutex_lock(&tls->lock);
-        for (int i = 0; i < tls->connection_num; i++) {
+        for (int n = 0; n < tls->connection_num; n++) {
+            int i = (tls->rr_next + n) % tls->connection_num;
             tls_connection_t *conn = &tls->connections[i];
-            if (conn->fd >= 0 && conn->connected) {
-                FD_SET(conn->fd, read_set);
-                if (conn->fd > max_fd) {
-                    max_fd = conn->fd;
+            struct pollfd *pfd = &tls->poll_fds[i];
+            /* Negative fd is ignored by poll() */
+            pfd->fd = (conn->fd >= 0 && conn->connected) ? conn->fd : -1;
+            pfd->events = POLLIN;
+            pfd->revents = 0;
+            if (pfd->fd < 0) {
+                continue;
+            }
+            if (tls_connection_buffered(conn)) {
+                *buffered = true;
+                if (num == 0) {
+                    *next_buffered = true;
                 }
             }
+            num++;
         }
         pthread_mutex_unlock(&tls->lock);
-        if (max_fd >= 0 || nowait || tls->closing) {
+        if (num || nowait || tls->closing) {
             break;
         }
         media_lib_thread_sleep(TLS_WORKER_SLEEP_MS);
     } while (tls_get_time_ms() < wait_deadline);
-    return max_fd;
+    return num;
 }
 
-/* After select() reports readiness, pick the first ready connection and return it with
- * its io_lock held (taken under the manager lock so it cannot be closed in between). The
- * caller does the blocking record read without holding the manager lock. NULL if none. */
-static tls_connection_t *tls_acquire_ready(tls_connections_handle_t tls, fd_set *read_set)
+/* Pick a readable connection round-robin starting after the last served one and return it
+ * with its io_lock held (taken under the manager lock so it cannot be closed in between).
+ * Readable means buffered or decrypted data, or poll() readiness when `poll_fds` is given.
+ * The caller does the blocking record read without holding the manager lock. NULL if none. */
+static tls_connection_t *tls_acquire_ready(tls_connections_handle_t tls, struct pollfd *poll_fds)
 {
     tls_connection_t *ready = NULL;
     pthread_mutex_lock(&tls->lock);
-    for (int i = 0; i < tls->connection_num; i++) {
+    for (int n = 0; n < tls->connection_num; n++) {
+        int i = (tls->rr_next + n) % tls->connection_num;
         tls_connection_t *conn = &tls->connections[i];
-        if (conn->fd >= 0 && conn->connected && FD_ISSET(conn->fd, read_set)) {
+        if (conn->fd < 0 || conn->connected == false) {
+            continue;
+        }
+        bool has_data = tls_connection_buffered(conn);
+        if (has_data == false && poll_fds) {
+            has_data = poll_fds[i].fd == conn->fd && (poll_fds[i].revents & (POLLIN | POLLERR | POLLHUP));
+        }
+        if (has_data) {
             ready = conn;
+            tls->rr_next = (i + 1) % tls->connection_num;
             pthread_mutex_lock(&ready->io_lock);
             break;
         }
@@ -740,6 +979,36 @@ static tls_connection_t *tls_acquire_ready(tls_connections_handle_t tls, fd_set
     return ready;
 }
 
+/* Acquire a connection with data to read, serving connections round-robin.
+ * When the next connection already has buffered data it is returned without any syscall,
+ * otherwise poll() (non-blocking if something is buffered) decides who is ready so a
+ * connection with a busy buffer cannot starve the others.
+ * Set `rc` to poll() result when nothing is ready. */
+static tls_connection_t *tls_wait_ready(tls_connections_handle_t tls, bool nowait, int *rc)
+{
+    bool buffered, next_buffered;
+    tls_connection_t *conn = NULL;
+    pthread_mutex_lock(&tls->poll_lock);
+    if (tls_build_poll_set(tls, nowait, &buffered, &next_buffered) == 0) {
+        pthread_mutex_unlock(&tls->poll_lock);
+        *rc = -1;
+        return NULL;
+    }
+    *rc = 0;
+    if (next_buffered) {
+        conn = tls_acquire_ready(tls, NULL);
+    } else {
+        int ret = poll(tls->poll_fds, tls->connection_num, (nowait || buffered) ? 0 : (int)tls->cfg.recv_timeout_ms);
+        if (ret < 0 || (ret == 0 && buffered == false)) {
+            *rc = ret;
+        } else {
+            conn = tls_acquire_ready(tls, tls->poll_fds);
+        }
+    }
+    pthread_mutex_unlock(&tls->poll_lock);
+    return conn;
+}
+
 /* Release a connection acquired by tls_acquire_ready(); close it (under the manager
  * lock) when the read failed. */
 static void tls_release_ready(tls_connections_handle_t tls, tls_connection_t *conn, bool failed)
@@ -747,7 +1016,7 @@ static void tls_release_ready(tls_connections_handle_t tls, tls_connection_t *co
     pthread_mutex_unlock(&conn->io_lock);
     if (failed) {
         pthread_mutex_lock(&tls->lock);
-        tls_connection_close(conn);
+        tls_connection_close(tls, conn);
         pthread_mutex_unlock(&tls->lock);
     }
 }
@@ -759,29 +1028,14 @@ int WEAK tls_connections_recv_from(tls_connections_handle_t tls, esp_peer_addr_t
         return -1;
     }
     int rc = -1;
-    fd_set read_set;
+    int ret;
     tls_connection_t *conn = NULL;
     peer_atomic_inc(&tls->users);
     if (tls->closing) {
         goto done;
     }
-    int max_fd = tls_build_read_set(tls, &read_set, nowait);
-    if (max_fd < 0) {
-        goto done;
-    }
-    struct timeval tv = { 0 };
-    if (nowait == false) {
-        tv.tv_sec = tls->cfg.recv_timeout_ms / 1000;
-        tv.tv_usec = (tls->cfg.recv_timeout_ms % 1000) * 1000;
-    }
-    int ret = select(max_fd + 1, &read_set, NULL, NULL, &tv);
-    if (ret <= 0) {
-        rc = ret;
-        goto done;
-    }
-    conn = tls_acquire_ready(tls, &read_set);
+    conn = tls_wait_ready(tls, nowait, &rc);
     if (conn == NULL) {
-        rc = 0;
         goto done;
     }
     uint16_t net_len = 0;
@@ -819,29 +1073,14 @@ int WEAK tls_connections_recv_raw_from(tls_connections_handle_t tls, esp_peer_ad
         return -1;
     }
     int rc = -1;
-    fd_set read_set;
+    int ret;
     tls_connection_t *conn = NULL;
     peer_atomic_inc(&tls->users);
     if (tls->closing) {
         goto done;
     }
-    int max_fd = tls_build_read_set(tls, &read_set, nowait);
-    if (max_fd < 0) {
-        goto done;
-    }
-    struct timeval tv = { 0 };
-    if (nowait == false) {
-        tv.tv_sec = tls->cfg.recv_timeout_ms / 1000;
-        tv.tv_usec = (tls->cfg.recv_timeout_ms % 1000) * 1000;
-    }
-    int ret = select(max_fd + 1, &read_set, NULL, NULL, &tv);
-    if (ret <= 0) {
-        rc = ret;
-        goto done;
-    }
-    conn = tls_acquire_ready(tls, &read_set);
+    conn = tls_wait_ready(tls, nowait, &rc);
     if (conn == NULL) {
-        rc = 0;
         goto done;
     }
     if (len < 4) {
@@ -917,7 +1156,9 @@ void WEAK tls_connections_close(tls_connections_handle_t tls)
     if (tls == NULL) {
         return;
     }
+    transport_wait_unregister(tls);
     tls->closing = true;
+    tls_connections_wakeup(tls);
     /* Follow udp_socket_close(): close/shutdown the sockets FIRST, BEFORE joining the
      * worker. The worker can be blocked in a TLS handshake (esp_tls_conn_new_sync may
      * block up to connect_timeout) or any in-flight recv/send can be blocked in
@@ -937,19 +1178,16 @@ void WEAK tls_connections_close(tls_connections_handle_t tls)
     }
     pthread_mutex_lock(&tls->lock);
     for (int i = 0; i < tls->connection_num; i++) {
-        tls_connection_close(&tls->connections[i]);
+        tls_connection_close(tls, &tls->connections[i]);
     }
     tls_send_item_t *item = tls->send_head;
     while (item) {
         tls_send_item_t *next = item->next;
-        free(item);
+        peer_buf_pool_free(item);
         item = next;
     }
     pthread_mutex_unlock(&tls->lock);
-    for (int i = 0; i < tls->connection_num; i++) {
-        pthread_mutex_destroy(&tls->connections[i].io_lock);
-    }
+    pthread_mutex_destroy(&tls->poll_lock);
     pthread_mutex_destroy(&tls->lock);
-    free(tls->connections);
-    free(tls);
+    tls_connections_destroy_locks(tls, tls->connection_num);
 }
@@ -0,0 +1,345 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "media_lib_os.h"
+#include "transport_wait.h"
+
+#define TAG "WAIT"
+
+#define TRANSPORT_WAIT_SOURCE_STEP (4)
+
+typedef struct {
+    void                      *ctx;
+    transport_wait_fill_cb_t fill;
+} transport_wait_source_t;
+
+typedef struct {
+    transport_wait_release_cb_t release;
+    void                      *arg;
+} transport_wait_deferred_t;
+
+struct transport_wait_t {
+    pthread_mutex_t            lock;
+    pthread_cond_t             cond;
+    transport_wait_source_t   *sources;
+    int                        source_num;
+    int                        source_cap;
+    /* Copy of sources used by the waiter, fill callbacks run on it without holding lock */
+    transport_wait_source_t   *scan;
+    int                        scan_cap;
+    /* Resources released while selecting, released by the waiter once select returns */
+    transport_wait_deferred_t *deferred;
+    int                        deferred_num;
+    int                        deferred_cap;
+    bool                       selecting;
+    uint32_t                   select_gen;
+    int                        wake_fd;
+    struct sockaddr_in         wake_addr;
+    atomic_int                 wake_pending;
+    atomic_int                 waiting;
+    struct transport_wait_t   *next;
+};
+
+static pthread_mutex_t                  s_list_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct transport_wait_t         *s_list;
+static __thread transport_wait_handle_t s_bound;
+
+/* Loopback datagram socket used as wakeup source, select() on lwIP only accepts sockets */
+static int transport_wake_fd_create(struct sockaddr_in *addr)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "Failed to create wakeup socket");
+        return -1;
+    }
+    struct sockaddr_in sin = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t len = sizeof(sin);
+    if (bind(fd, (struct sockaddr *)&sin, len) < 0 || getsockname(fd, (struct sockaddr *)&sin, &len) < 0) {
+        ESP_LOGE(TAG, "Failed to bind wakeup socket");
+        close(fd);
+        return -1;
+    }
+    *addr = sin;
+    return fd;
+}
+
+static int grow_array(void **array, int *cap, int need, size_t elem_size)
+{
+    if (need <= *cap) {
+        return 0;
+    }
+    int new_cap = need + TRANSPORT_WAIT_SOURCE_STEP;
+    void *p = realloc(*array, new_cap * elem_size);
+    if (p == NULL) {
+        return -1;
+    }
+    *array = p;
+    *cap = new_cap;
+    return 0;
+}
+
+/* Find context which holds the source, called with list lock held */
+static struct transport_wait_t *find_context(void *ctx, int *index)
+{
+    for (struct transport_wait_t *wait = s_list; wait; wait = wait->next) {
+        pthread_mutex_lock(&wait->lock);
+        for (int i = 0; i < wait->source_num; i++) {
+            if (wait->sources[i].ctx == ctx) {
+                // Return with context lock held
+                *index = i;
+                return wait;
+            }
+        }
+        pthread_mutex_unlock(&wait->lock);
+    }
+    return NULL;
+}
+
+transport_wait_handle_t transport_wait_create(void)
+{
+    struct transport_wait_t *wait = calloc(1, sizeof(struct transport_wait_t));
+    if (wait == NULL) {
+        return NULL;
+    }
+    wait->wake_fd = transport_wake_fd_create(&wait->wake_addr);
+    pthread_mutex_init(&wait->lock, NULL);
+    pthread_cond_init(&wait->cond, NULL);
+    pthread_mutex_lock(&s_list_lock);
+    wait->next = s_list;
+    s_list = wait;
+    pthread_mutex_unlock(&s_list_lock);
+    return wait;
+}
+
+void transport_wait_destroy(transport_wait_handle_t wait)
+{
+    if (wait == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&s_list_lock);
+    for (struct transport_wait_t **p = &s_list; *p; p = &(*p)->next) {
+        if (*p == wait) {
+            *p = wait->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_list_lock);
+    if (wait->source_num) {
+        ESP_LOGW(TAG, "Destroy with %d transports still registered", wait->source_num);
+    }
+    for (int i = 0; i < wait->deferred_num; i++) {
+        wait->deferred[i].release(wait->deferred[i].arg);
+    }
+    if (wait->wake_fd >= 0) {
+        close(wait->wake_fd);
+    }
+    pthread_cond_destroy(&wait->cond);
+    pthread_mutex_destroy(&wait->lock);
+    free(wait->deferred);
+    free(wait->scan);
+    free(wait->sources);
+    free(wait);
+}
+
+transport_wait_handle_t transport_wait_bind(transport_wait_handle_t wait)
+{
+    transport_wait_handle_t prev = s_bound;
+    s_bound = wait;
+    return prev;
+}
+
+int transport_wait_register(void *ctx, transport_wait_fill_cb_t fill)
+{
+    transport_wait_handle_t wait = s_bound;
+    if (wait == NULL) {
+        ESP_LOGW(TAG, "No wait context bound, %p will not wake up waiter", ctx);
+        return -1;
+    }
+    int ret = -1;
+    pthread_mutex_lock(&wait->lock);
+    if (grow_array((void **)&wait->sources, &wait->source_cap, wait->source_num + 1,
+                   sizeof(transport_wait_source_t)) == 0) {
+        wait->sources[wait->source_num].ctx = ctx;
+        wait->sources[wait->source_num].fill = fill;
+        wait->source_num++;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&wait->lock);
+    if (ret == 0) {
+        // Let waiter pick up new sockets
+        transport_wakeup(wait);
+    } else {
+        ESP_LOGE(TAG, "No memory to register %p", ctx);
+    }
+    return ret;
+}
+
+void transport_wait_unregister(void *ctx)
+{
+    int index = 0;
+    pthread_mutex_lock(&s_list_lock);
+    struct transport_wait_t *wait = find_context(ctx, &index);
+    pthread_mutex_unlock(&s_list_lock);
+    if (wait == NULL) {
+        return;
+    }
+    // Still hold context lock here
+    wait->source_num--;
+    memmove(&wait->sources[index], &wait->sources[index + 1],
+            (wait->source_num - index) * sizeof(transport_wait_source_t));
+    if (wait->selecting) {
+        // Selecting set already built from this source, wait until select returns
+        uint32_t gen = wait->select_gen;
+        transport_wakeup(wait);
+        while (wait->selecting && wait->select_gen == gen) {
+            pthread_cond_wait(&wait->cond, &wait->lock);
+        }
+    }
+    pthread_mutex_unlock(&wait->lock);
+}
+
+void transport_wait_release(void *ctx, transport_wait_release_cb_t release, void *arg)
+{
+    int index = 0;
+    pthread_mutex_lock(&s_list_lock);
+    struct transport_wait_t *wait = find_context(ctx, &index);
+    pthread_mutex_unlock(&s_list_lock);
+    if (wait) {
+        if (wait->selecting &&
+            grow_array((void **)&wait->deferred, &wait->deferred_cap, wait->deferred_num + 1,
+                       sizeof(transport_wait_deferred_t)) == 0) {
+            // Keep socket number reserved until select returns, shutdown already makes it readable
+            wait->deferred[wait->deferred_num].release = release;
+            wait->deferred[wait->deferred_num].arg = arg;
+            wait->deferred_num++;
+            release = NULL;
+        }
+        pthread_mutex_unlock(&wait->lock);
+    }
+    if (release) {
+        release(arg);
+    }
+}
+
+void transport_wakeup(transport_wait_handle_t wait)
+{
+    if (wait == NULL) {
+        return;
+    }
+    atomic_store(&wait->wake_pending, 1);
+    if (atomic_load(&wait->waiting) && wait->wake_fd >= 0) {
+        uint8_t v = 0;
+        sendto(wait->wake_fd, &v, 1, MSG_DONTWAIT, (struct sockaddr *)&wait->wake_addr, sizeof(wait->wake_addr));
+    }
+}
+
+/* Leave selecting state, release resources deferred during select and notify unregister */
+static void transport_wait_leave(transport_wait_handle_t wait)
+{
+    pthread_mutex_lock(&wait->lock);
+    wait->selecting = false;
+    wait->select_gen++;
+    transport_wait_deferred_t *deferred = wait->deferred;
+    int deferred_num = wait->deferred_num;
+    wait->deferred = NULL;
+    wait->deferred_num = wait->deferred_cap = 0;
+    pthread_cond_broadcast(&wait->cond);
+    pthread_mutex_unlock(&wait->lock);
+    // Release may take transport locks, call it without context lock
+    for (int i = 0; i < deferred_num; i++) {
+        deferred[i].release(deferred[i].arg);
+    }
+    free(deferred);
+}
+
+int transport_wait(transport_wait_handle_t wait, uint32_t timeout_ms)
+{
+    if (wait == NULL) {
+        media_lib_thread_sleep(timeout_ms);
+        return 0;
+    }
+    if (atomic_exchange(&wait->wake_pending, 0)) {
+        return 1;
+    }
+    fd_set read_set;
+    int max_fd = -1;
+    bool buffered = false;
+    int scan_num = 0;
+    FD_ZERO(&read_set);
+    pthread_mutex_lock(&wait->lock);
+    if (wait->wake_fd >= 0) {
+        FD_SET(wait->wake_fd, &read_set);
+        max_fd = wait->wake_fd;
+    }
+    if (grow_array((void **)&wait->scan, &wait->scan_cap, wait->source_num, sizeof(transport_wait_source_t)) == 0) {
+        scan_num = wait->source_num;
+        memcpy(wait->scan, wait->sources, scan_num * sizeof(transport_wait_source_t));
+    }
+    // Sources can not be unregistered (and their sockets closed) until selecting is cleared
+    wait->selecting = true;
+    pthread_mutex_unlock(&wait->lock);
+
+    // Fill callbacks take transport locks, call them without context lock to keep lock order
+    for (int i = 0; i < scan_num; i++) {
+        if (wait->scan[i].fill(wait->scan[i].ctx, &read_set, &max_fd)) {
+            buffered = true;
+        }
+    }
+    if (buffered) {
+        transport_wait_leave(wait);
+        return 1;
+    }
+    if (max_fd < 0) {
+        transport_wait_leave(wait);
+        media_lib_thread_sleep(timeout_ms);
+        return 0;
+    }
+    atomic_store(&wait->waiting, 1);
+    // Recheck after publishing waiting state so that wakeup in between is not lost
+    if (atomic_exchange(&wait->wake_pending, 0)) {
+        atomic_store(&wait->waiting, 0);
+        transport_wait_leave(wait);
+        return 1;
+    }
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    int ret = select(max_fd + 1, &read_set, NULL, NULL, &tv);
+    atomic_store(&wait->waiting, 0);
+    if (ret < 0) {
+        // Persistent failure (e.g. EBADF) would return at once, keep timeout pace to avoid busy loop
+        ESP_LOGW(TAG, "Failed to select %d", errno);
+        transport_wait_leave(wait);
+        media_lib_thread_sleep(timeout_ms);
+        return 0;
+    }
+    bool woken = false;
+    if (ret > 0 && wait->wake_fd >= 0 && FD_ISSET(wait->wake_fd, &read_set)) {
+        uint8_t v[8];
+        while (recv(wait->wake_fd, v, sizeof(v), MSG_DONTWAIT) > 0);
+        atomic_store(&wait->wake_pending, 0);
+        woken = true;
+        ret--;
+    }
+    transport_wait_leave(wait);
+    return (ret > 0 || woken) ? 1 : 0;
+}
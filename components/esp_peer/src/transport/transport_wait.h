@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/select.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Wait context, one for each peer connection
+ */
+typedef struct transport_wait_t *transport_wait_handle_t;
+
+/**
+ * @brief  Callback to add readable sockets of one transport into read set
+ *
+ * @param[in]      ctx       Transport instance
+ * @param[in,out]  read_set  Read set to add sockets into
+ * @param[in,out]  max_fd    Maximum socket number in read set
+ *
+ * @return
+ *       - true   Data already buffered inside transport, no need to wait
+ *       - false  Need wait for socket readiness
+ */
+typedef bool (*transport_wait_fill_cb_t)(void *ctx, fd_set *read_set, int *max_fd);
+
+/**
+ * @brief  Create wait context
+ *
+ * @return
+ *       - NULL    No memory
+ *       - Others  Wait context
+ */
+transport_wait_handle_t transport_wait_create(void);
+
+/**
+ * @brief  Destroy wait context, sources still registered are dropped
+ */
+void transport_wait_destroy(transport_wait_handle_t wait);
+
+/**
+ * @brief  Bind wait context to calling thread
+ *
+ * @note  Transports registered by this thread are added into the bound context
+ *        Peer binds its context around every call into peer implementation, which creates the transports
+ *
+ * @return  Context bound before, to be restored after the call
+ */
+transport_wait_handle_t transport_wait_bind(transport_wait_handle_t wait);
+
+/**
+ * @brief  Register transport into wait context bound to calling thread
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  No context bound or no memory, transport sockets are not watched
+ */
+int transport_wait_register(void *ctx, transport_wait_fill_cb_t fill);
+
+/**
+ * @brief  Unregister transport, must be called before transport sockets are closed
+ *
+ * @note  Blocks until `transport_wait` which already selects on the transport sockets returns
+ */
+void transport_wait_unregister(void *ctx);
+
+/**
+ * @brief  Callback to release resource owning sockets of one transport (close socket, free session etc)
+ */
+typedef void (*transport_wait_release_cb_t)(void *arg);
+
+/**
+ * @brief  Release resource owning a socket of registered transport
+ *
+ * @note  If `transport_wait` is selecting on the socket, release is deferred until select returns,
+ *        so the socket number can not be reused while still in the read set
+ *        Caller should shutdown the socket first so that select returns promptly
+ */
+void transport_wait_release(void *ctx, transport_wait_release_cb_t release, void *arg);
+
+/**
+ * @brief  Wait until any registered socket is readable, `transport_wakeup` is called or timeout
+ *
+ * @note  Only one thread should wait on one context
+ *
+ * @return
+ *       - 1   Woken by socket readiness or wakeup
+ *       - 0   Timeout
+ */
+int transport_wait(transport_wait_handle_t wait, uint32_t timeout_ms);
+
+/**
+ * @brief  Wake up `transport_wait`, the wakeup is kept if nobody is waiting
+ */
+void transport_wakeup(transport_wait_handle_t wait);
+
+#ifdef __cplusplus
+}
+#endif
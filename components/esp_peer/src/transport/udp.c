@@ -23,6 +23,7 @@
 #include "udp.h"
 #include "media_lib_os.h"
 #include "peer_utils.h"
+#include "transport_wait.h"
 
 #define TAG "UDP"
 
@@ -41,6 +42,22 @@ static void udp_dec_user(udp_socket_t *udp_socket)
     peer_atomic_dec(&udp_socket->user_count);
 }
 
+/* Add opened sockets into read set of transport_wait() */
+static bool udp_wait_fill(void *ctx, fd_set *read_set, int *max_fd)
+{
+    udp_socket_t *udp_socket = (udp_socket_t *)ctx;
+    int fds[2] = { udp_socket->fd, udp_socket->ipv6_fd };
+    for (int i = 0; i < 2; i++) {
+        if (fds[i] >= 0) {
+            FD_SET(fds[i], read_set);
+            if (fds[i] > *max_fd) {
+                *max_fd = fds[i];
+            }
+        }
+    }
+    return false;
+}
+
 void WEAK udp_blocking_timeout(udp_socket_t *udp_socket, long long int ms)
 {
     udp_socket->timeout_sec = ms / 1000;
@@ -78,6 +95,7 @@ int WEAK udp_socket_open(udp_socket_t *udp_socket, bool ipv6_support)
     }
 
     udp_blocking_timeout(udp_socket, 5);
+    transport_wait_register(udp_socket, udp_wait_fill);
     return 0;
 }
 
@@ -126,6 +144,7 @@ int WEAK udp_socket_bind(udp_socket_t *udp_socket, esp_peer_addr_t *addr)
 
 void WEAK udp_socket_close(udp_socket_t *udp_socket)
 {
+    transport_wait_unregister(udp_socket);
     if (udp_socket->fd > 0 || udp_socket->ipv6_fd > 0) {
         int fd = udp_socket->fd;
         int ipv6_fd = udp_socket->ipv6_fd;
@@ -0,0 +1,261 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+/*
+ * Packet buffer pool soak on host
+ * Replays 24 hours of send traffic (350 packets per second) against a 256KB first-fit coalescing heap
+ * which models the device heap, together with long-lived allocations of other subsystems
+ * Reports largest free heap block first (what a later large allocation can get), then fragmentation,
+ * allocation latency and per-class pool statistics
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "esp_peer_default.h"
+#include "peer_buf_pool.h"
+
+#define HEAP_SIZE       (256 * 1024)
+#define SOAK_SECONDS    (24 * 3600)
+#define PACKETS_PER_SEC (350)
+#define SEND_ITEM_HEAD  (48)
+#define QUEUE_DEPTH     (64)
+#define LONG_LIVED_NUM  (32)
+#define FRAME_BUF_SIZE  (24 * 1024)
+#define LAT_SAMPLES     (1 << 20)
+#define LAT_SAMPLE_STEP (37)
+
+typedef struct blk {
+    size_t      size;
+    int         free;
+    struct blk *next;
+    struct blk *prev;
+} blk_t;
+
+typedef enum {
+    SOAK_MODE_HEAP,
+    SOAK_MODE_POOL,
+} soak_mode_t;
+
+static uint8_t     heap[HEAP_SIZE] __attribute__((aligned(16)));
+static blk_t      *heap_head;
+static soak_mode_t mode;
+static uint32_t    lat[LAT_SAMPLES];
+
+static void heap_init(void)
+{
+    heap_head = (blk_t *)heap;
+    heap_head->size = HEAP_SIZE - sizeof(blk_t);
+    heap_head->free = 1;
+    heap_head->next = heap_head->prev = NULL;
+}
+
+static void *heap_alloc(size_t n)
+{
+    n = (n + 15) & ~15;
+    for (blk_t *b = heap_head; b; b = b->next) {
+        if (b->free == 0 || b->size < n) {
+            continue;
+        }
+        if (b->size >= n + sizeof(blk_t) + 16) {
+            blk_t *s = (blk_t *)((uint8_t *)(b + 1) + n);
+            s->size = b->size - n - sizeof(blk_t);
+            s->free = 1;
+            s->next = b->next;
+            s->prev = b;
+            if (b->next) {
+                b->next->prev = s;
+            }
+            b->next = s;
+            b->size = n;
+        }
+        b->free = 0;
+        return b + 1;
+    }
+    return NULL;
+}
+
+static void heap_free(void *p)
+{
+    if (p == NULL) {
+        return;
+    }
+    blk_t *b = (blk_t *)p - 1;
+    b->free = 1;
+    if (b->next && b->next->free) {
+        b->size += b->next->size + sizeof(blk_t);
+        b->next = b->next->next;
+        if (b->next) {
+            b->next->prev = b;
+        }
+    }
+    if (b->prev && b->prev->free) {
+        b->prev->size += b->size + sizeof(blk_t);
+        b->prev->next = b->next;
+        if (b->next) {
+            b->next->prev = b->prev;
+        }
+    }
+}
+
+static void heap_stat(size_t *free_size, size_t *largest)
+{
+    *free_size = *largest = 0;
+    for (blk_t *b = heap_head; b; b = b->next) {
+        if (b->free) {
+            *free_size += b->size;
+            if (b->size > *largest) {
+                *largest = b->size;
+            }
+        }
+    }
+}
+
+/* Pool slabs and heap fallbacks come from modeled heap */
+void *media_lib_malloc(size_t size)
+{
+    return heap_alloc(size);
+}
+
+void media_lib_free(void *ptr)
+{
+    heap_free(ptr);
+}
+
+static void *packet_alloc(size_t n)
+{
+    return mode == SOAK_MODE_HEAP ? heap_alloc(n) : peer_buf_pool_alloc(n);
+}
+
+static void packet_free(void *p)
+{
+    if (mode == SOAK_MODE_HEAP) {
+        heap_free(p);
+    } else {
+        peer_buf_pool_free(p);
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Video RTP 1100-1250, audio 120-200, RTCP/STUN 60-120, some data channel frames 2-4KB */
+static size_t packet_size(void)
+{
+    int r = rand() % 100;
+    size_t n = r < 60 ? 1100 + rand() % 150 : r < 85 ? 120 + rand() % 80 : r < 97 ? 60 + rand() % 60 : 2000 + rand() % 2000;
+    return n + SEND_ITEM_HEAD;
+}
+
+static void queue_pop(void **q, int *qn)
+{
+    packet_free(q[0]);
+    memmove(q, q + 1, sizeof(void *) * (*qn - 1));
+    (*qn)--;
+}
+
+int main(int argc, char **argv)
+{
+    // Pool sizings compared with heap, `pool` keeps default configuration
+    static const struct {
+        const char             *name;
+        esp_peer_buf_pool_cfg_t cfg;
+    } sizings[] = {
+        { "tls",   { 1, { { 1600, 8 } } } },
+        { "small", { 3, { { 256, 16 }, { 1600, 16 }, { 4096, 4 } } } },
+        { "large", { 3, { { 256, 32 }, { 1600, 48 }, { 4096, 8 } } } },
+    };
+    if (argc < 2) {
+        printf("Usage: %s heap|pool|tls|small|large\n", argv[0]);
+        return 1;
+    }
+    mode = strcmp(argv[1], "heap") == 0 ? SOAK_MODE_HEAP : SOAK_MODE_POOL;
+    for (int i = 0; i < (int)(sizeof(sizings) / sizeof(sizings[0])); i++) {
+        if (strcmp(argv[1], sizings[i].name) == 0) {
+            esp_peer_set_buf_pool_cfg(&sizings[i].cfg);
+        }
+    }
+    heap_init();
+    srand(1);
+    void *q[QUEUE_DEPTH];
+    void *long_lived[LONG_LIVED_NUM] = { 0 };
+    int qn = 0, lat_num = 0;
+    uint64_t ops = 0, fails = 0, frame_fail = 0, frame_try = 0;
+    for (long s = 0; s < SOAK_SECONDS; s++) {
+        for (int i = 0; i < PACKETS_PER_SEC; i++) {
+            size_t n = packet_size();
+            uint64_t start = now_ns();
+            void *p = packet_alloc(n);
+            uint64_t cost = now_ns() - start;
+            if (lat_num < LAT_SAMPLES && (ops % LAT_SAMPLE_STEP) == 0) {
+                lat[lat_num++] = (uint32_t)cost;
+            }
+            ops++;
+            if (p == NULL) {
+                fails++;
+                continue;
+            }
+            if (qn == QUEUE_DEPTH) {
+                queue_pop(q, &qn);
+            }
+            q[qn++] = p;
+            // Sender drains with variable depth
+            int drain = rand() % 3;
+            while (drain-- && qn) {
+                queue_pop(q, &qn);
+            }
+        }
+        // Other subsystems keep random sized allocations (signaling, sessions)
+        if (s % 60 == 0) {
+            int k = rand() % LONG_LIVED_NUM;
+            heap_free(long_lived[k]);
+            long_lived[k] = heap_alloc(200 + rand() % 3000);
+        }
+        // Large frame buffer once a minute (decoder reconfiguration)
+        if (s % 60 == 30) {
+            frame_try++;
+            void *f = heap_alloc(FRAME_BUF_SIZE);
+            if (f == NULL) {
+                frame_fail++;
+            }
+            heap_free(f);
+        }
+    }
+    while (qn) {
+        packet_free(q[--qn]);
+    }
+    size_t free_size, largest;
+    heap_stat(&free_size, &largest);
+    qsort(lat, lat_num, sizeof(uint32_t), cmp_u32);
+    printf("%s: largest=%zu free=%zu ops=%llu alloc_fail=%llu frag=%.1f%% frame24k_fail=%llu/%llu\n",
+           argv[1], largest, free_size, (unsigned long long)ops, (unsigned long long)fails,
+           100.0 * (1.0 - (double)largest / free_size), (unsigned long long)frame_fail, (unsigned long long)frame_try);
+    printf("  lat_ns p50=%u p99=%u p99.9=%u max=%u\n", lat[lat_num / 2], lat[lat_num * 99 / 100],
+           lat[lat_num * 999 / 1000], lat[lat_num - 1]);
+    if (mode != SOAK_MODE_HEAP) {
+        esp_peer_buf_pool_stats_t st;
+        esp_peer_get_buf_pool_stats(&st);
+        for (int i = 0; i < st.class_num; i++) {
+            printf("  class %ux%u: allocs=%u fallbacks=%u peak=%u used=%u\n", (unsigned)st.classes[i].block_size,
+                   st.classes[i].block_num, (unsigned)st.classes[i].allocs, (unsigned)st.classes[i].fallbacks,
+                   st.classes[i].peak, st.classes[i].used);
+        }
+        printf("  oversize=%u\n", (unsigned)st.oversize);
+    }
+    return 0;
+}
@@ -0,0 +1,436 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+/*
+ * SRTP contention on host
+ * Audio sender, video sender, receiver and data channel threads share one DTLS SRTP session like a call,
+ * while another thread keeps replacing SRTP sessions (like handshake and reset) to check session lifetime
+ * Packet path is the real one of `src/dtls_common.h`, libsrtp and mbedtls are replaced by stubs which spend
+ * time in proportion to data size
+ * `shared` mode takes DTLS lock around each SRTP call, to compare with sharing one lock for SRTP and data channel
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+// Source under test only builds clean with -Wall of the device build
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "dtls_srtp.c"
+#pragma GCC diagnostic pop
+
+#define RUN_SECONDS        (10)
+#define CRYPTO_NS_PER_BYTE (50)
+#define CRYPTO_NS_FIXED    (2000)
+#define SRTP_TAG_SIZE      (10)
+#define AUDIO_PACKET_SIZE  (172)
+#define AUDIO_INTERVAL_MS  (20)
+#define VIDEO_PACKET_SIZE  (1200)
+#define VIDEO_BURST        (15)
+#define VIDEO_INTERVAL_MS  (33)
+#define DC_WRITE_SIZE      (1024)
+#define DC_BURST           (16)
+#define DC_INTERVAL_MS     (10)
+#define REKEY_INTERVAL_MS  (500)
+#define LAT_MAX            (1 << 20)
+#define SESSION_LIVE       (0x5E55)
+#define SESSION_DEAD       (0xDEAD)
+
+struct srtp_ctx_t_ {
+    uint32_t            magic;
+    uint32_t            key;
+    struct srtp_ctx_t_ *next_dead;
+};
+
+typedef struct {
+    const char *name;
+    uint32_t   *lat;
+    int         num;
+} lat_stat_t;
+
+static dtls_srtp_t      dtls;
+static bool             shared_mode;
+static volatile bool    running = true;
+static atomic_int       use_after_free;
+static atomic_int       no_session;
+static pthread_mutex_t  dead_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct srtp_ctx_t_ *dead_list;
+static int              rekey_num;
+static lat_stat_t       stats[] = {
+    {"audio send", NULL, 0},
+    {"video send", NULL, 0},
+    {"receive", NULL, 0},
+    {"dc write", NULL, 0},
+};
+
+enum {
+    STAT_AUDIO,
+    STAT_VIDEO,
+    STAT_RECV,
+    STAT_DC,
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/* Busy work standing for cipher and authentication of `size` bytes */
+static void crypto_cost(uint8_t *data, size_t size, uint32_t key)
+{
+    uint64_t end = now_ns() + CRYPTO_NS_FIXED + size * CRYPTO_NS_PER_BYTE;
+    uint32_t x = key | 1;
+    size_t i = 0;
+    while (now_ns() < end) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        if (size) {
+            data[i] ^= (uint8_t)x;
+            data[i] ^= (uint8_t)x;
+            i = (i + 1) % size;
+        }
+    }
+}
+
+static srtp_err_status_t session_work(srtp_t ctx, uint8_t *data, size_t size)
+{
+    if (ctx->magic != SESSION_LIVE) {
+        atomic_fetch_add(&use_after_free, 1);
+        return srtp_err_status_fail;
+    }
+    crypto_cost(data, size, ctx->key);
+    // Session must stay alive for whole call
+    if (ctx->magic != SESSION_LIVE) {
+        atomic_fetch_add(&use_after_free, 1);
+        return srtp_err_status_fail;
+    }
+    return srtp_err_status_ok;
+}
+
+srtp_err_status_t srtp_create(srtp_t *session, const srtp_policy_t *policy)
+{
+    (void)policy;
+    srtp_t s = calloc(1, sizeof(struct srtp_ctx_t_));
+    s->magic = SESSION_LIVE;
+    s->key = (uint32_t)rand();
+    *session = s;
+    return srtp_err_status_ok;
+}
+
+/* Keep freed sessions poisoned instead of freeing so late users are caught */
+srtp_err_status_t srtp_dealloc(srtp_t session)
+{
+    session->magic = SESSION_DEAD;
+    pthread_mutex_lock(&dead_lock);
+    session->next_dead = dead_list;
+    dead_list = session;
+    pthread_mutex_unlock(&dead_lock);
+    return srtp_err_status_ok;
+}
+
+srtp_err_status_t srtp_protect(srtp_t ctx, const uint8_t *rtp, size_t rtp_len, uint8_t *srtp, size_t *srtp_len,
+                               size_t mki_index)
+{
+    (void)rtp;
+    (void)mki_index;
+    if (*srtp_len < rtp_len + SRTP_TAG_SIZE) {
+        return srtp_err_status_fail;
+    }
+    *srtp_len = rtp_len + SRTP_TAG_SIZE;
+    return session_work(ctx, srtp, rtp_len);
+}
+
+srtp_err_status_t srtp_unprotect(srtp_t ctx, const uint8_t *srtp, size_t srtp_len, uint8_t *rtp, size_t *rtp_len)
+{
+    (void)srtp;
+    *rtp_len = srtp_len - SRTP_TAG_SIZE;
+    return session_work(ctx, rtp, *rtp_len);
+}
+
+srtp_err_status_t srtp_protect_rtcp(srtp_t ctx, const uint8_t *rtcp, size_t rtcp_len, uint8_t *srtcp,
+                                    size_t *srtcp_len, size_t mki_index)
+{
+    return srtp_protect(ctx, rtcp, rtcp_len, srtcp, srtcp_len, mki_index);
+}
+
+srtp_err_status_t srtp_unprotect_rtcp(srtp_t ctx, const uint8_t *srtcp, size_t srtcp_len, uint8_t *rtcp,
+                                      size_t *rtcp_len)
+{
+    return srtp_unprotect(ctx, srtcp, srtcp_len, rtcp, rtcp_len);
+}
+
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len)
+{
+    (void)ssl;
+    (void)buf;
+    uint8_t record[DC_WRITE_SIZE];
+    crypto_cost(record, len < sizeof(record) ? len : sizeof(record), 1);
+    return (int)len;
+}
+
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len)
+{
+    (void)ssl;
+    (void)buf;
+    (void)len;
+    return MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+void measure_start(const char *tag)
+{
+    (void)tag;
+}
+
+void measure_stop(const char *tag)
+{
+    (void)tag;
+}
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t nmemb, size_t size)
+{
+    return calloc(nmemb, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+int media_lib_mutex_create(media_lib_mutex_handle_t *mutex)
+{
+    pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(m, NULL);
+    *mutex = m;
+    return 0;
+}
+
+int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+    return 0;
+}
+
+int media_lib_mutex_lock(media_lib_mutex_handle_t mutex, uint32_t timeout)
+{
+    (void)timeout;
+    return pthread_mutex_lock(mutex);
+}
+
+int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex)
+{
+    return pthread_mutex_unlock(mutex);
+}
+
+void media_lib_thread_sleep(int ms)
+{
+    usleep(ms * 1000);
+}
+
+static void sleep_until(uint64_t *next, int interval_ms)
+{
+    *next += interval_ms * 1000000ULL;
+    uint64_t now = now_ns();
+    if (*next > now) {
+        struct timespec t = {(time_t)((*next - now) / 1000000000ULL), (long)((*next - now) % 1000000000ULL)};
+        nanosleep(&t, NULL);
+    } else {
+        *next = now;
+    }
+}
+
+static void add_lat(int idx, uint64_t start)
+{
+    lat_stat_t *s = &stats[idx];
+    if (s->num < LAT_MAX) {
+        s->lat[s->num++] = (uint32_t)((now_ns() - start) / 1000);
+    }
+}
+
+static void srtp_call(int idx, bool inbound, uint8_t *packet, int size)
+{
+    int bytes = size;
+    uint64_t start = now_ns();
+    if (shared_mode) {
+        media_lib_mutex_lock(dtls.lock, MEDIA_LIB_MAX_LOCK_TIME);
+    }
+    if (inbound) {
+        bytes += SRTP_TAG_SIZE;
+        if (dtls_srtp_decrypt_rtp_packet(&dtls, packet, &bytes) != 0) {
+            atomic_fetch_add(&no_session, 1);
+        }
+    } else {
+        dtls_srtp_encrypt_rtp_packet(&dtls, packet, size + SRTP_TAG_SIZE, &bytes);
+        if (bytes == 0) {
+            atomic_fetch_add(&no_session, 1);
+        }
+    }
+    if (shared_mode) {
+        media_lib_mutex_unlock(dtls.lock);
+    }
+    add_lat(idx, start);
+}
+
+static void *audio_thread(void *arg)
+{
+    (void)arg;
+    uint8_t packet[AUDIO_PACKET_SIZE + SRTP_TAG_SIZE] = {0};
+    uint64_t next = now_ns();
+    while (running) {
+        srtp_call(STAT_AUDIO, false, packet, AUDIO_PACKET_SIZE);
+        sleep_until(&next, AUDIO_INTERVAL_MS);
+    }
+    return NULL;
+}
+
+static void *video_thread(void *arg)
+{
+    (void)arg;
+    uint8_t packet[VIDEO_PACKET_SIZE + SRTP_TAG_SIZE] = {0};
+    uint64_t next = now_ns();
+    while (running) {
+        for (int i = 0; i < VIDEO_BURST; i++) {
+            srtp_call(STAT_VIDEO, false, packet, VIDEO_PACKET_SIZE);
+        }
+        sleep_until(&next, VIDEO_INTERVAL_MS);
+    }
+    return NULL;
+}
+
+/* Receive audio and video of remote side with same rate as sending */
+static void *recv_thread(void *arg)
+{
+    (void)arg;
+    uint8_t packet[VIDEO_PACKET_SIZE + SRTP_TAG_SIZE] = {0};
+    uint64_t next = now_ns();
+    int tick = 0;
+    while (running) {
+        srtp_call(STAT_RECV, true, packet, AUDIO_PACKET_SIZE);
+        if (tick++ % 2 == 0) {
+            for (int i = 0; i < VIDEO_BURST * 2 / 3; i++) {
+                srtp_call(STAT_RECV, true, packet, VIDEO_PACKET_SIZE);
+            }
+        }
+        sleep_until(&next, AUDIO_INTERVAL_MS);
+    }
+    return NULL;
+}
+
+/* Data channel file transfer, each write goes through DTLS lock */
+static void *dc_thread(void *arg)
+{
+    (void)arg;
+    unsigned char data[DC_WRITE_SIZE] = {0};
+    uint64_t next = now_ns();
+    while (running) {
+        for (int i = 0; i < DC_BURST; i++) {
+            uint64_t start = now_ns();
+            dtls_srtp_write(&dtls, data, sizeof(data));
+            add_lat(STAT_DC, start);
+        }
+        sleep_until(&next, DC_INTERVAL_MS);
+    }
+    return NULL;
+}
+
+static void publish_sessions(void)
+{
+    srtp_t in = NULL, out = NULL;
+    srtp_create(&in, NULL);
+    srtp_create(&out, NULL);
+    dtls_srtp_set_session(&dtls, true, in);
+    dtls_srtp_set_session(&dtls, false, out);
+}
+
+/* Replace sessions like a new handshake, old sessions are freed once users drain */
+static void *rekey_thread(void *arg)
+{
+    (void)arg;
+    uint64_t next = now_ns();
+    while (running) {
+        sleep_until(&next, REKEY_INTERVAL_MS);
+        publish_sessions();
+        rekey_num++;
+    }
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void print_stat(lat_stat_t *s)
+{
+    if (s->num == 0) {
+        printf("%-12s %8d\n", s->name, 0);
+        return;
+    }
+    qsort(s->lat, s->num, sizeof(uint32_t), cmp_u32);
+    double total = 0;
+    for (int i = 0; i < s->num; i++) {
+        total += s->lat[i];
+    }
+    printf("%-12s %8d %10.1f %8u %8u %8u\n", s->name, s->num, total / s->num, s->lat[s->num / 2],
+           s->lat[(int)(s->num * 0.99)], s->lat[s->num - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || (strcmp(argv[1], "lockfree") && strcmp(argv[1], "shared"))) {
+        printf("Usage: %s lockfree|shared [seconds]\n", argv[0]);
+        return 1;
+    }
+    shared_mode = strcmp(argv[1], "shared") == 0;
+    int seconds = argc > 2 ? atoi(argv[2]) : RUN_SECONDS;
+    srand(1);
+    for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); i++) {
+        stats[i].lat = malloc(sizeof(uint32_t) * LAT_MAX);
+    }
+    dtls_srtp_create_lock(&dtls);
+    publish_sessions();
+    pthread_t th[5];
+    pthread_create(&th[0], NULL, audio_thread, NULL);
+    pthread_create(&th[1], NULL, video_thread, NULL);
+    pthread_create(&th[2], NULL, recv_thread, NULL);
+    pthread_create(&th[3], NULL, dc_thread, NULL);
+    pthread_create(&th[4], NULL, rekey_thread, NULL);
+    sleep(seconds);
+    running = false;
+    for (int i = 0; i < 5; i++) {
+        pthread_join(th[i], NULL);
+    }
+    dtls_srtp_set_session(&dtls, true, NULL);
+    dtls_srtp_set_session(&dtls, false, NULL);
+    printf("%s: %d s, %d session replacements, %d use after free, %d calls without session\n", argv[1], seconds,
+           rekey_num, atomic_load(&use_after_free), atomic_load(&no_session));
+    printf("%-12s %8s %10s %8s %8s %8s\n", "stream", "calls", "avg us", "p50 us", "p99 us", "max us");
+    for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); i++) {
+        print_stat(&stats[i]);
+        free(stats[i].lat);
+    }
+    while (dead_list) {
+        struct srtp_ctx_t_ *next = dead_list->next_dead;
+        free(dead_list);
+        dead_list = next;
+    }
+    return (atomic_load(&use_after_free) || atomic_load(&no_session)) ? 1 : 0;
+}
@@ -0,0 +1,3 @@
+/* Host stub of esp_idf_version.h */
+#pragma once
+#define ESP_IDF_VERSION_MAJOR 5
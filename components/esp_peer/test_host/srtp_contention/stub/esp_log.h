@@ -0,0 +1,10 @@
+/* Host stub of esp_log.h, DTLS logs are not needed for the packet path */
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOG_NONE(fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGE(tag, fmt, ...) ESP_LOG_NONE(fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) ESP_LOG_NONE(fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) ESP_LOG_NONE(fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOG_NONE(fmt, ##__VA_ARGS__)
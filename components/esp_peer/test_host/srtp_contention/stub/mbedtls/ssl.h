@@ -0,0 +1,3 @@
+/* Host stub, see mbedtls_stub.h */
+#pragma once
+#include "mbedtls_stub.h"
@@ -0,0 +1,154 @@
+/*
+ * Host stub of mbedtls types and functions used by dtls_common.h
+ * Only the SRTP packet path runs on host, handshake functions are declared without prototype and never called
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_VERSION_MAJOR 3
+#define MBEDTLS_VERSION_MINOR 6
+#define MBEDTLS_VERSION_NUMBER 0x03060000
+#define MBEDTLS_X509_REMOVE_INFO
+
+#define MBEDTLS_ERR_SSL_BAD_PROTOCOL_VERSION    (-0x6E00)
+#define MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL        (-0x6A00)
+#define MBEDTLS_ERR_SSL_CLIENT_RECONNECT        (-0x6B80)
+#define MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED   (-0x6A80)
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY       (-0x7880)
+#define MBEDTLS_ERR_SSL_TIMEOUT                 (-0x6800)
+#define MBEDTLS_ERR_SSL_WANT_READ               (-0x6900)
+#define MBEDTLS_ERR_SSL_WANT_WRITE              (-0x6880)
+
+#define MBEDTLS_ECP_DP_SECP256R1                (3)
+#define MBEDTLS_MD_SHA256                       (9)
+#define MBEDTLS_PK_ECKEY                        (2)
+#define MBEDTLS_SSL_ANTI_REPLAY_DISABLED        (0)
+#define MBEDTLS_SSL_DTLS_SRTP_MKI_UNSUPPORTED   (0)
+#define MBEDTLS_SSL_IS_CLIENT                   (0)
+#define MBEDTLS_SSL_IS_SERVER                   (1)
+#define MBEDTLS_SSL_PRESET_DEFAULT              (0)
+#define MBEDTLS_SSL_TRANSPORT_DATAGRAM          (1)
+#define MBEDTLS_SSL_VERIFY_OPTIONAL             (1)
+#define MBEDTLS_SSL_VERSION_TLS1_2              (0x0303)
+#define MBEDTLS_X509_CRT_VERSION_3              (2)
+
+#define MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256       (0xC02B)
+#define MBEDTLS_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256 (0xCCA9)
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256         (0xC02F)
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256   (0xCCA8)
+
+#define MBEDTLS_TLS_SRTP_UNSET                  (0)
+#define MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_80 (1)
+#define MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_32 (2)
+#define MBEDTLS_TLS_SRTP_NULL_HMAC_SHA1_80      (5)
+#define MBEDTLS_TLS_SRTP_NULL_HMAC_SHA1_32      (6)
+
+typedef struct { int dummy; } mbedtls_ssl_context;
+typedef struct { int dummy; } mbedtls_ssl_config;
+typedef struct { int dummy; } mbedtls_ssl_cookie_ctx;
+typedef struct { int dummy; } mbedtls_pk_context;
+typedef struct { int dummy; } mbedtls_ctr_drbg_context;
+typedef struct { int dummy; } mbedtls_timing_delay_context;
+typedef struct { int dummy; } mbedtls_mpi;
+typedef struct { int dummy; } mbedtls_x509write_cert;
+typedef struct { int dummy; } mbedtls_md_info_t;
+typedef struct {
+    int year, mon, day, hour, min, sec;
+} mbedtls_x509_time;
+typedef struct {
+    struct {
+        unsigned char *p;
+        size_t         len;
+    } raw;
+    mbedtls_x509_time  valid_from;
+    mbedtls_x509_time  valid_to;
+    mbedtls_pk_context pk;
+} mbedtls_x509_crt;
+typedef struct {
+    int    chosen_dtls_srtp_profile;
+    size_t mki_len;
+} mbedtls_dtls_srtp_info;
+typedef uint16_t mbedtls_ssl_srtp_profile;
+typedef int mbedtls_ssl_key_export_type;
+typedef int mbedtls_tls_prf_types;
+typedef int mbedtls_svc_key_id_t;
+
+/* Declared without prototype, none of them is called on host */
+int mbedtls_ctr_drbg_free();
+int mbedtls_ctr_drbg_init();
+int mbedtls_ctr_drbg_random();
+int mbedtls_ctr_drbg_seed();
+int mbedtls_ecp_gen_key();
+int mbedtls_md();
+const mbedtls_md_info_t *mbedtls_md_info_from_type();
+int mbedtls_mpi_fill_random();
+int mbedtls_mpi_free();
+int mbedtls_mpi_init();
+int mbedtls_pk_check_pair();
+void *mbedtls_pk_ec();
+int mbedtls_pk_free();
+const void *mbedtls_pk_info_from_type();
+int mbedtls_pk_init();
+int mbedtls_pk_parse_key();
+int mbedtls_pk_setup();
+int mbedtls_pk_write_key_pem();
+int mbedtls_ssl_conf_authmode();
+int mbedtls_ssl_conf_ca_chain();
+int mbedtls_ssl_conf_ciphersuites();
+int mbedtls_ssl_conf_dtls_anti_replay();
+int mbedtls_ssl_conf_dtls_cookies();
+int mbedtls_ssl_conf_dtls_srtp_protection_profiles();
+int mbedtls_ssl_conf_handshake_timeout();
+int mbedtls_ssl_conf_max_tls_version();
+int mbedtls_ssl_conf_min_tls_version();
+int mbedtls_ssl_conf_own_cert();
+int mbedtls_ssl_conf_read_timeout();
+int mbedtls_ssl_conf_rng();
+int mbedtls_ssl_conf_srtp_mki_value_supported();
+int mbedtls_ssl_conf_transport();
+int mbedtls_ssl_config_defaults();
+int mbedtls_ssl_config_free();
+int mbedtls_ssl_config_init();
+int mbedtls_ssl_cookie_check();
+int mbedtls_ssl_cookie_free();
+int mbedtls_ssl_cookie_init();
+int mbedtls_ssl_cookie_setup();
+int mbedtls_ssl_cookie_write();
+int mbedtls_ssl_free();
+const char *mbedtls_ssl_get_ciphersuite();
+int mbedtls_ssl_get_dtls_srtp_negotiation_result();
+uint32_t mbedtls_ssl_get_verify_result();
+int mbedtls_ssl_handshake();
+int mbedtls_ssl_init();
+int mbedtls_ssl_session_reset();
+int mbedtls_ssl_set_bio();
+int mbedtls_ssl_set_client_transport_id();
+int mbedtls_ssl_set_export_keys_cb();
+int mbedtls_ssl_set_mtu();
+int mbedtls_ssl_set_timer_cb();
+int mbedtls_ssl_setup();
+int mbedtls_ssl_tls_prf();
+int mbedtls_timing_get_delay();
+int mbedtls_timing_set_delay();
+int mbedtls_x509_crt_free();
+int mbedtls_x509_crt_init();
+int mbedtls_x509_crt_parse();
+int mbedtls_x509_crt_verify_info();
+int mbedtls_x509write_crt_free();
+int mbedtls_x509write_crt_init();
+int mbedtls_x509write_crt_pem();
+int mbedtls_x509write_crt_set_issuer_key();
+int mbedtls_x509write_crt_set_issuer_name();
+int mbedtls_x509write_crt_set_md_alg();
+int mbedtls_x509write_crt_set_serial();
+int mbedtls_x509write_crt_set_serial_raw();
+int mbedtls_x509write_crt_set_subject_key();
+int mbedtls_x509write_crt_set_subject_name();
+int mbedtls_x509write_crt_set_validity();
+int mbedtls_x509write_crt_set_version();
+
+/* Application data path, implemented by harness to model data channel traffic */
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len);
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
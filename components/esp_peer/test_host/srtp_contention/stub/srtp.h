@@ -0,0 +1,45 @@
+/* Host stub of libsrtp, sessions are implemented by harness to check lifetime and model crypto cost */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    srtp_err_status_ok = 0,
+    srtp_err_status_fail = 1,
+} srtp_err_status_t;
+
+typedef struct srtp_ctx_t_ *srtp_t;
+
+typedef enum {
+    ssrc_undefined = 0,
+    ssrc_specific = 1,
+    ssrc_any_inbound = 2,
+    ssrc_any_outbound = 3,
+} srtp_ssrc_type_t;
+
+typedef struct {
+    struct {
+        srtp_ssrc_type_t type;
+        uint32_t         value;
+    } ssrc;
+    unsigned char *key;
+    struct {
+        int dummy;
+    } rtp, rtcp;
+    void          *next;
+} srtp_policy_t;
+
+srtp_err_status_t srtp_init(void);
+srtp_err_status_t srtp_shutdown(void);
+srtp_err_status_t srtp_create(srtp_t *session, const srtp_policy_t *policy);
+srtp_err_status_t srtp_dealloc(srtp_t session);
+srtp_err_status_t srtp_protect(srtp_t ctx, const uint8_t *rtp, size_t rtp_len, uint8_t *srtp, size_t *srtp_len,
+                               size_t mki_index);
+srtp_err_status_t srtp_unprotect(srtp_t ctx, const uint8_t *srtp, size_t srtp_len, uint8_t *rtp, size_t *rtp_len);
+srtp_err_status_t srtp_protect_rtcp(srtp_t ctx, const uint8_t *rtcp, size_t rtcp_len, uint8_t *srtcp,
+                                    size_t *srtcp_len, size_t mki_index);
+srtp_err_status_t srtp_unprotect_rtcp(srtp_t ctx, const uint8_t *srtcp, size_t srtcp_len, uint8_t *rtcp,
+                                      size_t *rtcp_len);
+void srtp_crypto_policy_set_rtp_default(void *p);
+void srtp_crypto_policy_set_rtcp_default(void *p);
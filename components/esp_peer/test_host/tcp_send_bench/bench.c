@@ -0,0 +1,296 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+/*
+ * ICE-TCP send throughput on host
+ * One sender queues RFC 4571 frames to 4 loopback connections through `tcp_connections_send_to`:
+ * audio (160 bytes, prio 2), video (1200 bytes, prio 1) with a 120KB keyframe burst every 300 frames,
+ * and data channel (1000 bytes, prio 0). One reader per connection checks every frame arrives in order.
+ * Allocator calls made during the run are counted by wrapping malloc/calloc/realloc/free,
+ * slowest `tcp_connections_send_to` call shows how long sender can be blocked by a full connection.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "media_lib_os.h"
+#include "tcp.h"
+
+#define CONN_NUM        (4)
+#define PRIO_NUM        (3)
+#define FRAME_HEAD      (6)
+#define KEYFRAME_EVERY  (300)
+#define KEYFRAME_FRAMES (100)
+#define DRAIN_WAIT_MS   (10000)
+
+static atomic_uint alloc_calls;
+static atomic_uint free_calls;
+static atomic_bool counting;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void  __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+    if (atomic_load(&counting)) {
+        atomic_fetch_add(&alloc_calls, 1);
+    }
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size)
+{
+    if (atomic_load(&counting)) {
+        atomic_fetch_add(&alloc_calls, 1);
+    }
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (atomic_load(&counting)) {
+        atomic_fetch_add(&alloc_calls, 1);
+    }
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr && atomic_load(&counting)) {
+        atomic_fetch_add(&free_calls, 1);
+    }
+    __real_free(ptr);
+}
+
+void media_lib_thread_sleep(int ms)
+{
+    usleep(ms * 1000);
+}
+
+typedef struct {
+    int             listen_fd;
+    esp_peer_addr_t addr;
+    atomic_uint     sent[PRIO_NUM];
+    uint32_t        recv[PRIO_NUM];
+    uint64_t        recv_bytes;
+    int             bad;
+    pthread_t       reader;
+} bench_conn_t;
+
+static bench_conn_t conns[CONN_NUM];
+static atomic_bool  send_done;
+
+static uint64_t now_us(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000ull + t.tv_nsec / 1000;
+}
+
+static void fill_frame(uint8_t *b, int conn, int prio, uint32_t seq, int len)
+{
+    b[0] = (uint8_t)conn;
+    b[1] = (uint8_t)prio;
+    memcpy(b + 2, &seq, 4);
+    for (int i = FRAME_HEAD; i < len; i++) {
+        b[i] = (uint8_t)(seq * 7 + i);
+    }
+}
+
+static bool all_received(bench_conn_t *c)
+{
+    for (int i = 0; i < PRIO_NUM; i++) {
+        if (c->recv[i] != atomic_load(&c->sent[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Read stream, slice RFC 4571 frames and check per priority sequence has no gap */
+static void *reader_thread(void *arg)
+{
+    bench_conn_t *c = arg;
+    int idx = (int)(c - conns);
+    int fd = accept(c->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        c->bad++;
+        return NULL;
+    }
+    static __thread uint8_t buf[128 * 1024];
+    int fill = 0;
+    uint64_t idle_start = 0;
+    while (1) {
+        if (atomic_load(&send_done) && all_received(c)) {
+            break;
+        }
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        if (poll(&p, 1, 100) <= 0) {
+            if (atomic_load(&send_done)) {
+                if (idle_start == 0) {
+                    idle_start = now_us();
+                } else if (now_us() - idle_start > DRAIN_WAIT_MS * 1000ull) {
+                    break;
+                }
+            }
+            continue;
+        }
+        idle_start = 0;
+        int n = recv(fd, buf + fill, sizeof(buf) - fill, 0);
+        if (n <= 0) {
+            break;
+        }
+        fill += n;
+        int pos = 0;
+        while (fill - pos >= 2) {
+            int len = (buf[pos] << 8) | buf[pos + 1];
+            if (fill - pos < 2 + len) {
+                break;
+            }
+            uint8_t *f = buf + pos + 2;
+            uint32_t seq;
+            memcpy(&seq, f + 2, 4);
+            int prio = f[1];
+            bool bad = len < FRAME_HEAD || f[0] != idx || prio >= PRIO_NUM || seq != c->recv[prio];
+            for (int i = FRAME_HEAD; bad == false && i < len; i++) {
+                bad = f[i] != (uint8_t)(seq * 7 + i);
+            }
+            if (bad) {
+                c->bad++;
+            } else {
+                c->recv[prio]++;
+                c->recv_bytes += len;
+            }
+            pos += 2 + len;
+        }
+        memmove(buf, buf + pos, fill - pos);
+        fill -= pos;
+    }
+    close(fd);
+    return NULL;
+}
+
+static int open_listen(esp_peer_addr_t *addr)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sin = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof(sin);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&sin, len) < 0 || listen(fd, 1) < 0) {
+        return -1;
+    }
+    getsockname(fd, (struct sockaddr *)&sin, &len);
+    memset(addr, 0, sizeof(*addr));
+    addr->family = AF_INET;
+    addr->port = ntohs(sin.sin_port);
+    memcpy(addr->ipv4, &sin.sin_addr.s_addr, 4);
+    return fd;
+}
+
+int main(int argc, char *argv[])
+{
+    int frame_num = argc > 1 ? atoi(argv[1]) : 40000;
+    tcp_connections_cfg_t cfg = {
+        .max_connections = CONN_NUM,
+    };
+    tcp_connections_handle_t tcp = tcp_connections_open(&cfg);
+    if (tcp == NULL) {
+        printf("Fail to open connections\n");
+        return 1;
+    }
+    for (int i = 0; i < CONN_NUM; i++) {
+        conns[i].listen_fd = open_listen(&conns[i].addr);
+        if (conns[i].listen_fd < 0) {
+            printf("Fail to listen\n");
+            return 1;
+        }
+        pthread_create(&conns[i].reader, NULL, reader_thread, &conns[i]);
+        tcp_connections_connect(tcp, &conns[i].addr);
+    }
+    for (int i = 0; i < CONN_NUM; i++) {
+        uint64_t start = now_us();
+        while (tcp_connections_is_connected(tcp, &conns[i].addr) == false) {
+            if (now_us() - start > 5000000) {
+                printf("Fail to connect\n");
+                return 1;
+            }
+            usleep(1000);
+        }
+    }
+    srand(1);
+    uint8_t frame[1200];
+    uint32_t retry = 0, fail = 0;
+    uint64_t sent_bytes = 0, call_max_us = 0;
+    atomic_store(&counting, true);
+    uint64_t start = now_us();
+    for (int n = 0; n < frame_num; n++) {
+        int idx = n % CONN_NUM;
+        bench_conn_t *c = &conns[idx];
+        int r = rand() % 100;
+        int prio = r < 30 ? 2 : r < 95 ? 1 : 0;
+        int burst = (n / CONN_NUM) % KEYFRAME_EVERY == 0 ? KEYFRAME_FRAMES : 1;
+        if (burst > 1) {
+            prio = 1;
+        }
+        for (int k = 0; k < burst; k++) {
+            int len = prio == 2 ? 160 : prio == 1 ? 1200 : 1000;
+            uint32_t seq = atomic_load(&c->sent[prio]);
+            fill_frame(frame, idx, prio, seq, len);
+            uint64_t call_start = now_us();
+            int ret = tcp_connections_send_to(tcp, &c->addr, frame, len, prio);
+            uint64_t call_us = now_us() - call_start;
+            if (call_us > call_max_us) {
+                call_max_us = call_us;
+            }
+            if (ret == len) {
+                atomic_store(&c->sent[prio], seq + 1);
+                sent_bytes += len;
+            } else if (ret == -200) {
+                retry++;
+            } else {
+                fail++;
+            }
+        }
+    }
+    uint64_t queued = now_us();
+    atomic_store(&send_done, true);
+    for (int i = 0; i < CONN_NUM; i++) {
+        pthread_join(conns[i].reader, NULL);
+    }
+    uint64_t end = now_us();
+    atomic_store(&counting, false);
+    tcp_connections_close(tcp);
+    uint64_t recv_bytes = 0;
+    int bad = 0;
+    bool lost = false;
+    for (int i = 0; i < CONN_NUM; i++) {
+        recv_bytes += conns[i].recv_bytes;
+        bad += conns[i].bad;
+        lost |= !all_received(&conns[i]);
+        close(conns[i].listen_fd);
+    }
+    unsigned allocs = atomic_load(&alloc_calls);
+    printf("conn=%d sent=%llu B dropped(-200)=%u failed=%u received=%llu B bad=%d\n", CONN_NUM,
+           (unsigned long long)sent_bytes, (unsigned)retry, (unsigned)fail, (unsigned long long)recv_bytes, bad);
+    printf("  queue %.1f ms (slowest send_to %.2f ms), delivered %.1f ms, %.1f Mbit/s, alloc calls %u (%.3f per frame)"
+           " free calls %u, %s\n",
+           (queued - start) / 1000.0, call_max_us / 1000.0, (end - start) / 1000.0, recv_bytes * 8.0 / (end - start), allocs,
+           (double)allocs / frame_num, (unsigned)atomic_load(&free_calls),
+           (bad || lost || retry || fail) ? "FAIL" : "PASS");
+    return (bad || lost || retry || fail) ? 1 : 0;
+}
@@ -0,0 +1,7 @@
+/* Host stub, transport logs are not needed for the send path */
+#pragma once
+
+#define ESP_LOGE(tag, ...) do {} while (0)
+#define ESP_LOGW(tag, ...) do {} while (0)
+#define ESP_LOGI(tag, ...) do {} while (0)
+#define ESP_LOGD(tag, ...) do {} while (0)
@@ -68,6 +68,10 @@ typedef struct {
                                                                In room related WebRTC application, connection build up with peer
                                                                If peer leaves, it will auto re-enter same room (send new SDP) after clear up
                                                                Disable reconnect will do nothing after clear up until call `esp_webrtc_enable_peer_connection` */
+    bool                         reuse_session;           /*!< Keep peer connection across `esp_webrtc_stop` and `esp_webrtc_start`
+                                                               Jitter buffers, send pool and data channel caches reserved by first session are reused
+                                                               by later ones instead of freed and allocated again, released in `esp_webrtc_close`
+                                                               Pair with `mem_arena` of `av_render` so render buffers are kept as well */
     void                        *extra_cfg;               /*!< Extra configuration for peer connection */
     int                          extra_size;              /*!< Size of extra configuration */
     void                        *ctx;                     /*!< User context */
@@ -158,6 +162,26 @@ typedef struct {
     av_render_handle_t   player;  /*!< Player handle */
 } esp_webrtc_media_provider_t;
 
+/**
+ * @brief  Glass-to-wire latency of one sent stream
+ *
+ * @note  Latency is measured from capture pts to the time frame handed to peer connection
+ */
+typedef struct {
+    uint32_t frames;  /*!< Frames sent since last reset */
+    uint32_t avg_ms;  /*!< Average latency in milliseconds */
+    uint32_t max_ms;  /*!< Maximum latency in milliseconds */
+    uint32_t last_ms; /*!< Latency of last sent frame in milliseconds */
+} esp_webrtc_frame_latency_t;
+
+/**
+ * @brief  WebRTC send latency statistics
+ */
+typedef struct {
+    esp_webrtc_frame_latency_t audio; /*!< Audio send latency */
+    esp_webrtc_frame_latency_t video; /*!< Video send latency */
+} esp_webrtc_send_latency_t;
+
 /**
  * @brief  WebRTC event handler
  *
@@ -308,6 +332,19 @@ int esp_webrtc_get_peer_connection(esp_webrtc_handle_t rtc_handle, esp_peer_hand
  */
 int esp_webrtc_query(esp_webrtc_handle_t rtc_handle);
 
+/**
+ * @brief  Get glass-to-wire latency of sent audio and video frames
+ *
+ * @param[in]   rtc_handle  WebRTC handle
+ * @param[out]  latency     Latency statistics
+ * @param[in]   reset       Whether to reset statistics after read
+ *
+ * @return
+ *      - ESP_PEER_ERR_NONE         On success
+ *      - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ */
+int esp_webrtc_get_send_latency(esp_webrtc_handle_t rtc_handle, esp_webrtc_send_latency_t *latency, bool reset);
+
 /**
  * @brief  Stop WebRTC
  *
@@ -331,6 +368,91 @@ int esp_webrtc_stop(esp_webrtc_handle_t rtc_handle);
  */
 int esp_webrtc_close(esp_webrtc_handle_t rtc_handle);
 
+/**
+ * @brief  Maximum WebRTC sessions attached to one broadcast
+ */
+#define ESP_WEBRTC_BROADCAST_MAX_SUBSCRIBER (4)
+
+/**
+ * @brief  WebRTC broadcast handle
+ *
+ * @note  Broadcast lets several WebRTC sessions (e.g. one doorbell watched by several phones) share one capture sink
+ *        Audio and video are captured and encoded once, each frame is then sent to every connected session
+ *        Sessions keep their own peer connection, signaling and player
+ */
+typedef void *esp_webrtc_broadcast_handle_t;
+
+/**
+ * @brief  WebRTC broadcast configuration
+ */
+typedef struct {
+    esp_capture_handle_t         capture;           /*!< Capture system handle */
+    esp_peer_audio_stream_info_t audio_info;        /*!< Audio stream information for send, codec NONE to not send audio */
+    esp_peer_video_stream_info_t video_info;        /*!< Video stream information for send, codec NONE to not send video */
+    uint16_t                     keyframe_interval; /*!< Minimum interval between key frame requests (unit ms)
+                                                         Encoder is shared, so PLI from one lossy viewer is rate limited
+                                                         Default 1000 if set to 0 */
+} esp_webrtc_broadcast_cfg_t;
+
+/**
+ * @brief  Create broadcast and set up shared capture sink
+ *
+ * @param[in]   cfg     Broadcast configuration
+ * @param[out]  handle  Broadcast handle
+ *
+ * @return
+ *      - ESP_PEER_ERR_NONE         On success
+ *      - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ *      - ESP_PEER_ERR_NO_MEM       Not enough memory
+ */
+int esp_webrtc_broadcast_create(esp_webrtc_broadcast_cfg_t *cfg, esp_webrtc_broadcast_handle_t *handle);
+
+/**
+ * @brief  Attach WebRTC session to broadcast
+ *
+ * @note  Call it after `esp_webrtc_set_media_provider` and before `esp_webrtc_start`
+ *        Session does not set up own capture sink, it joins broadcast when peer connected and leaves when disconnected
+ *        Newly joined session skips video until next key frame, key frame is requested on its behalf
+ *        Stream information for send in `esp_webrtc_peer_cfg_t` should match broadcast configuration
+ *
+ * @param[in]  handle      Broadcast handle
+ * @param[in]  rtc_handle  WebRTC handle
+ *
+ * @return
+ *      - ESP_PEER_ERR_NONE         On success
+ *      - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ *      - ESP_PEER_ERR_WRONG_STATE  Session already started or attached
+ *      - ESP_PEER_ERR_NO_MEM       Reach `ESP_WEBRTC_BROADCAST_MAX_SUBSCRIBER`
+ */
+int esp_webrtc_broadcast_add(esp_webrtc_broadcast_handle_t handle, esp_webrtc_handle_t rtc_handle);
+
+/**
+ * @brief  Detach WebRTC session from broadcast
+ *
+ * @note  Call it after `esp_webrtc_stop`, `esp_webrtc_close` detaches automatically
+ *
+ * @param[in]  handle      Broadcast handle
+ * @param[in]  rtc_handle  WebRTC handle
+ *
+ * @return
+ *      - ESP_PEER_ERR_NONE         On success
+ *      - ESP_PEER_ERR_INVALID_ARG  Invalid argument or session not attached
+ *      - ESP_PEER_ERR_WRONG_STATE  Session still running
+ */
+int esp_webrtc_broadcast_remove(esp_webrtc_broadcast_handle_t handle, esp_webrtc_handle_t rtc_handle);
+
+/**
+ * @brief  Destroy broadcast
+ *
+ * @param[in]  handle  Broadcast handle
+ *
+ * @return
+ *      - ESP_PEER_ERR_NONE         On success
+ *      - ESP_PEER_ERR_INVALID_ARG  Invalid argument
+ *      - ESP_PEER_ERR_WRONG_STATE  Sessions still attached
+ */
+int esp_webrtc_broadcast_destroy(esp_webrtc_broadcast_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
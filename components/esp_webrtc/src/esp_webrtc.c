@@ -39,6 +39,10 @@
 #include "esp_capture_advance.h"
 
 #define AUDIO_FRAME_INTERVAL (20)
+#define PC_LOOP_INTERVAL     (10)
+#define SEND_POLL_INTERVAL   (5)
+/* Senders normally quit on next frame, after this capture is stopped to wake blocked acquire */
+#define SEND_QUIT_WAIT_MS    (200)
 #define VIDEO_DC_CHUNK_HDR_SIZE  (5)
 #define VIDEO_DC_CHUNK_END       (1 << 7)
 #define VIDEO_DC_CHUNK_SEQ_MASK  (0x7F)
@@ -54,10 +58,20 @@
     free(ptr);                      \
     ptr = NULL;                     \
 }
-#define PC_EXIT_BIT      (1 << 0)
-#define PC_PAUSED_BIT    (1 << 1)
-#define PC_RESUME_BIT    (1 << 2)
-#define PC_SEND_QUIT_BIT (1 << 3)
+#define PC_EXIT_BIT       (1 << 0)
+#define PC_PAUSED_BIT     (1 << 1)
+#define PC_RESUME_BIT     (1 << 2)
+#define PC_SEND_QUIT_BIT  (1 << 3)
+#define PC_VSEND_QUIT_BIT (1 << 4)
+
+#define BROADCAST_DEFAULT_KEY_INTERVAL (1000)
+/* When fan-out of one frame overruns frame interval, slowest subscriber is skipped for a while
+ * then resumes from next key frame. Interval comes from video fps, this one is used when fps not set */
+#define BROADCAST_DEFAULT_FRAME_MS     (100)
+#define BROADCAST_SLOW_SKIP_MS         (1000)
+#define H264_NAL_TYPE_SLICE            (1)
+#define H264_NAL_TYPE_IDR              (5)
+#define H264_NAL_TYPE_SPS              (7)
 
 #define SET_WAIT_BITS(bit) media_lib_event_group_set_bits(rtc->wait_event, bit)
 #define WAIT_FOR_BITS(bit)                                                          \
@@ -76,6 +90,15 @@ typedef struct {
     uint16_t preset_mask;
 } webrtc_pre_setting_t;
 
+typedef struct {
+    uint32_t frames;
+    uint32_t sum_ms;
+    uint32_t max_ms;
+    uint32_t last_ms;
+} webrtc_latency_stat_t;
+
+struct webrtc_broadcast_t;
+
 typedef struct {
     esp_webrtc_cfg_t             rtc_cfg;
     esp_peer_handle_t            pc;
@@ -91,6 +114,11 @@ typedef struct {
 
     esp_timer_handle_t            send_timer;
     bool                          send_going;
+    uint8_t                       send_quit_bits;
+    media_lib_mutex_handle_t      send_lock;
+    int64_t                       send_start_ms;
+    webrtc_latency_stat_t         aud_send_latency;
+    webrtc_latency_stat_t         vid_send_latency;
     esp_webrtc_media_provider_t   media_provider;
     esp_capture_sink_handle_t     capture_path;
     esp_codec_dev_handle_t        play_handle;
@@ -112,9 +140,19 @@ typedef struct {
     uint32_t vid_dc_reasm_cap;
     uint8_t  vid_dc_reasm_next_seq;
     bool     vid_dc_reasm_active;
+    uint8_t *vid_dc_direct;
+    uint32_t vid_dc_direct_cap;
+    uint32_t vid_dc_frame_size;
     // Reusable video-over-DC send chunk; avoids malloc/free for every JPEG.
     uint8_t *vid_dc_send_buf;
     uint32_t vid_dc_send_buf_cap;
+    // Broadcast subscriber, frames come from shared capture sink of broadcast
+    struct webrtc_broadcast_t *broadcast;
+    bool     bc_active;
+    bool     bc_wait_key;
+    uint8_t  bc_sending;    // Fan-out sends in flight, session must not close until drained
+    int64_t  bc_skip_until; // Skip slow subscriber until this time (unit ms)
+    uint32_t bc_send_cost[2]; // Smoothed send time of audio and video frame (unit 1/8 ms)
     // For debug only
     uint32_t vid_send_pts;
     uint32_t aud_send_pts;
@@ -134,6 +172,8 @@ static const char *TAG = "webrtc";
 bool webrtc_tracing = false;
 
 static void convert_dec_vid_info(esp_peer_video_stream_info_t *info, av_render_video_info_t *dec_info);
+static int broadcast_set_active(webrtc_t *rtc, bool active);
+static void broadcast_request_key_frame(struct webrtc_broadcast_t *bc);
 
 static uint16_t get_video_dc_chunk_size(webrtc_t *rtc)
 {
@@ -143,6 +183,12 @@ static uint16_t get_video_dc_chunk_size(webrtc_t *rtc)
 
 static void reset_video_dc_reasm(webrtc_t *rtc)
 {
+    // Cancel buffer reserved in render fifo so that decoder does not wait for it
+    if (rtc->vid_dc_direct) {
+        av_render_commit_video_buffer(rtc->play_handle, NULL);
+        rtc->vid_dc_direct = NULL;
+        rtc->vid_dc_direct_cap = 0;
+    }
     rtc->vid_dc_reasm_size = 0;
     rtc->vid_dc_reasm_next_seq = 0;
     rtc->vid_dc_reasm_active = false;
@@ -238,6 +284,56 @@ static int feed_video_dc_frame(webrtc_t *rtc, uint8_t *data, int size)
     return av_render_add_video_data(rtc->play_handle, &video_data);
 }
 
+/* Reserve render fifo buffer for whole frame so chunks are reassembled in place */
+static void reserve_video_dc_direct(webrtc_t *rtc)
+{
+    // Need stream added and size estimate from previous frame
+    if (rtc->play_handle == NULL || rtc->recv_vid_info.codec == ESP_PEER_VIDEO_CODEC_NONE ||
+        rtc->vid_dc_frame_size == 0) {
+        return;
+    }
+    uint32_t cap = rtc->vid_dc_frame_size + rtc->vid_dc_frame_size / 2;
+    if (cap > VIDEO_DC_REASM_MAX) {
+        cap = VIDEO_DC_REASM_MAX;
+    }
+    if (av_render_get_video_buffer(rtc->play_handle, cap, &rtc->vid_dc_direct) != 0) {
+        rtc->vid_dc_direct = NULL;
+        return;
+    }
+    rtc->vid_dc_direct_cap = cap;
+}
+
+/* Move data in reserved fifo buffer to reassemble buffer when frame is bigger than estimated */
+static int fallback_video_dc_direct(webrtc_t *rtc, uint32_t need)
+{
+    uint32_t filled = rtc->vid_dc_reasm_size;
+    if (need > rtc->vid_dc_reasm_cap) {
+        uint8_t *buf = realloc(rtc->vid_dc_reasm, need);
+        if (buf == NULL) {
+            return ESP_PEER_ERR_NO_MEM;
+        }
+        rtc->vid_dc_reasm = buf;
+        rtc->vid_dc_reasm_cap = need;
+    }
+    memcpy(rtc->vid_dc_reasm, rtc->vid_dc_direct, filled);
+    av_render_commit_video_buffer(rtc->play_handle, NULL);
+    rtc->vid_dc_direct = NULL;
+    rtc->vid_dc_direct_cap = 0;
+    return ESP_PEER_ERR_NONE;
+}
+
+static int feed_video_dc_direct(webrtc_t *rtc)
+{
+    av_render_video_data_t video_data = {
+        .size = rtc->vid_dc_reasm_size,
+    };
+    rtc->vid_recv_num++;
+    rtc->vid_recv_size += video_data.size;
+    rtc->vid_dc_direct = NULL;
+    rtc->vid_dc_direct_cap = 0;
+    return av_render_commit_video_buffer(rtc->play_handle, &video_data);
+}
+
 static int handle_chunked_video_dc(webrtc_t *rtc, uint8_t *data, int size)
 {
     if (size < VIDEO_DC_CHUNK_HDR_SIZE) {
@@ -261,6 +357,7 @@ static int handle_chunked_video_dc(webrtc_t *rtc, uint8_t *data, int size)
         reset_video_dc_reasm(rtc);
         rtc->vid_dc_reasm_active = true;
         rtc->vid_dc_reasm_next_seq = 1;
+        reserve_video_dc_direct(rtc);
     } else if (rtc->vid_dc_reasm_active == false) {
         ESP_LOGW(TAG, "Drop video DC chunk seq %u without BOS", seq);
         return 0;
@@ -279,6 +376,22 @@ static int handle_chunked_video_dc(webrtc_t *rtc, uint8_t *data, int size)
         reset_video_dc_reasm(rtc);
         return 0;
     }
+    if (rtc->vid_dc_direct) {
+        if (need <= rtc->vid_dc_direct_cap) {
+            memcpy(rtc->vid_dc_direct + rtc->vid_dc_reasm_size, payload, payload_len);
+            rtc->vid_dc_reasm_size += payload_len;
+            if (is_end) {
+                rtc->vid_dc_frame_size = rtc->vid_dc_reasm_size;
+                feed_video_dc_direct(rtc);
+                reset_video_dc_reasm(rtc);
+            }
+            return 0;
+        }
+        if (fallback_video_dc_direct(rtc, need) != ESP_PEER_ERR_NONE) {
+            reset_video_dc_reasm(rtc);
+            return ESP_PEER_ERR_NO_MEM;
+        }
+    }
     if (need > rtc->vid_dc_reasm_cap) {
         uint32_t new_cap = rtc->vid_dc_reasm_cap ? rtc->vid_dc_reasm_cap * 2 : VIDEO_DC_DEFAULT_CHUNK * 2;
         while (new_cap < need) {
@@ -302,86 +415,136 @@ static int handle_chunked_video_dc(webrtc_t *rtc, uint8_t *data, int size)
 
     if (is_end) {
         /* Continuous seq from 0..E is enough to treat the frame as complete. */
+        rtc->vid_dc_frame_size = rtc->vid_dc_reasm_size;
         feed_video_dc_frame(rtc, rtc->vid_dc_reasm, (int)rtc->vid_dc_reasm_size);
         reset_video_dc_reasm(rtc);
     }
     return 0;
 }
 
-static void _media_send(void *ctx)
+/* Glass-to-wire latency: capture pts is in ms since capture start */
+static void update_send_latency(webrtc_t *rtc, webrtc_latency_stat_t *stat, uint32_t pts)
 {
-    webrtc_t *rtc = (webrtc_t *)ctx;
-    if (rtc->rtc_cfg.peer_cfg.audio_info.codec) {
-        esp_capture_stream_frame_t audio_frame = {
-            .stream_type = ESP_CAPTURE_STREAM_TYPE_AUDIO,
+    int64_t cost = esp_timer_get_time() / 1000 - rtc->send_start_ms - pts;
+    uint32_t latency = cost > 0 ? (uint32_t)cost : 0;
+    stat->frames++;
+    stat->sum_ms += latency;
+    stat->last_ms = latency;
+    if (latency > stat->max_ms) {
+        stat->max_ms = latency;
+    }
+}
+
+static void _media_send_audio(webrtc_t *rtc, esp_capture_stream_frame_t *audio_frame)
+{
+    esp_peer_audio_frame_t audio_send_frame = {
+        .pts = audio_frame->pts,
+        .data = audio_frame->data,
+        .size = audio_frame->size,
+    };
+    media_lib_mutex_lock(rtc->send_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    esp_peer_send_audio(rtc->pc, &audio_send_frame);
+    media_lib_mutex_unlock(rtc->send_lock);
+    update_send_latency(rtc, &rtc->aud_send_latency, audio_frame->pts);
+    rtc->aud_send_pts = audio_frame->pts;
+    rtc->aud_send_num++;
+    rtc->aud_send_size += audio_frame->size;
+    if (webrtc_tracing) {
+        printf("A\n");
+    }
+}
+
+static void _media_send_video(webrtc_t *rtc, esp_capture_stream_frame_t *video_frame)
+{
+    media_lib_mutex_lock(rtc->send_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (rtc->rtc_cfg.peer_cfg.enable_data_channel && rtc->rtc_cfg.peer_cfg.video_over_data_channel) {
+        send_video_over_data_channel(rtc, video_frame->data, video_frame->size);
+    } else {
+        esp_peer_video_frame_t video_send_frame = {
+            .pts = video_frame->pts,
+            .data = video_frame->data,
+            .size = video_frame->size,
         };
-        // Get and send all audio frame without wait
-        while (esp_capture_sink_acquire_frame(rtc->capture_path, &audio_frame, true) == ESP_CAPTURE_ERR_OK) {
-            esp_peer_audio_frame_t audio_send_frame = {
-                .pts = audio_frame.pts,
-                .data = audio_frame.data,
-                .size = audio_frame.size,
-            };
-            esp_peer_send_audio(rtc->pc, &audio_send_frame);
-            esp_capture_sink_release_frame(rtc->capture_path, &audio_frame);
-            rtc->aud_send_pts = audio_frame.pts;
-            rtc->aud_send_num++;
-            rtc->aud_send_size += audio_frame.size;
-            if (webrtc_tracing) {
-                printf("A\n");
+        // Call the video send callback if provided (for SEI injection, etc.)
+        bool should_send = true;
+        if (rtc->rtc_cfg.peer_cfg.on_video_send) {
+            int ret = rtc->rtc_cfg.peer_cfg.on_video_send(&video_send_frame, rtc->rtc_cfg.peer_cfg.ctx);
+            if (ret != ESP_CAPTURE_ERR_OK) {
+                should_send = false;
             }
         }
+        if (should_send) {
+            esp_peer_send_video(rtc->pc, &video_send_frame);
+        }
     }
-    if (rtc->rtc_cfg.peer_cfg.video_info.codec) {
-        esp_capture_stream_frame_t video_frame = {
-            .stream_type = ESP_CAPTURE_STREAM_TYPE_VIDEO,
-        };
-        int ret = esp_capture_sink_acquire_frame(rtc->capture_path, &video_frame, true);
-        if (ret == ESP_CAPTURE_ERR_OK) {
-            if (rtc->rtc_cfg.peer_cfg.enable_data_channel && rtc->rtc_cfg.peer_cfg.video_over_data_channel) {
-                send_video_over_data_channel(rtc, video_frame.data, video_frame.size);
-            } else {
-                esp_peer_video_frame_t video_send_frame = {
-                    .pts = video_frame.pts,
-                    .data = video_frame.data,
-                    .size = video_frame.size,
-                };
-                // Call the video send callback if provided (for SEI injection, etc.)
-                bool should_send = true;
-                if (rtc->rtc_cfg.peer_cfg.on_video_send) {
-                    ret = rtc->rtc_cfg.peer_cfg.on_video_send(&video_send_frame, rtc->rtc_cfg.peer_cfg.ctx);
-                    if (ret != ESP_CAPTURE_ERR_OK) {
-                        should_send = false;
-                    }
-                }
-                if (should_send) {
-                    esp_peer_send_video(rtc->pc, &video_send_frame);
-                }
+    media_lib_mutex_unlock(rtc->send_lock);
+    update_send_latency(rtc, &rtc->vid_send_latency, video_frame->pts);
+    rtc->vid_send_pts = video_frame->pts;
+    rtc->vid_send_num++;
+    rtc->vid_send_size += video_frame->size;
+    if (webrtc_tracing) {
+        printf("V\n");
+    }
+}
+
+static void media_send_loop(webrtc_t *rtc, esp_capture_stream_type_t stream_type)
+{
+    esp_capture_stream_frame_t frame = {
+        .stream_type = stream_type,
+    };
+    while (rtc->send_going) {
+        // Block until frame arrives, stop wakes it by next frame or by capture stop
+        if (esp_capture_sink_acquire_frame(rtc->capture_path, &frame, false) != ESP_CAPTURE_ERR_OK) {
+            if (rtc->send_going) {
+                // Capture not running, avoid spinning on failed acquire
+                media_lib_thread_sleep(AUDIO_FRAME_INTERVAL);
             }
-            esp_capture_sink_release_frame(rtc->capture_path, &video_frame);
-            rtc->vid_send_pts = video_frame.pts;
-            rtc->vid_send_num++;
-            rtc->vid_send_size += video_frame.size;
-            if (webrtc_tracing) {
-                printf("V\n");
+            continue;
+        }
+        if (rtc->send_going) {
+            if (stream_type == ESP_CAPTURE_STREAM_TYPE_AUDIO) {
+                _media_send_audio(rtc, &frame);
+            } else {
+                _media_send_video(rtc, &frame);
             }
         }
+        esp_capture_sink_release_frame(rtc->capture_path, &frame);
     }
 }
 
-void media_send_task(void *arg)
+/* Wait for sender quit bits, return bits of senders not quit yet */
+static uint8_t wait_send_quit(media_lib_event_grp_handle_t wait_event, uint8_t bits, uint32_t timeout)
 {
-    webrtc_t *rtc = (webrtc_t *)arg;
-    while (rtc->send_going) {
-        _media_send(arg);
-        media_lib_thread_sleep(AUDIO_FRAME_INTERVAL);
+    if (bits == 0) {
+        return 0;
     }
+    uint32_t quit = media_lib_event_group_wait_bits(wait_event, bits, timeout) & bits;
+    media_lib_event_group_clr_bits(wait_event, quit);
+    return bits & ~quit;
+}
+
+static void media_send_task(void *arg)
+{
+    webrtc_t *rtc = (webrtc_t *)arg;
+    media_send_loop(rtc, ESP_CAPTURE_STREAM_TYPE_AUDIO);
     SET_WAIT_BITS(PC_SEND_QUIT_BIT);
     media_lib_thread_destroy(NULL);
 }
 
+static void media_send_video_task(void *arg)
+{
+    webrtc_t *rtc = (webrtc_t *)arg;
+    media_send_loop(rtc, ESP_CAPTURE_STREAM_TYPE_VIDEO);
+    SET_WAIT_BITS(PC_VSEND_QUIT_BIT);
+    media_lib_thread_destroy(NULL);
+}
+
 static int start_stream(webrtc_t *rtc)
 {
+    if (rtc->broadcast) {
+        return broadcast_set_active(rtc, true);
+    }
+    rtc->send_start_ms = esp_timer_get_time() / 1000;
     int ret = esp_capture_start(rtc->media_provider.capture);
     if (rtc->no_auto_capture) {
         esp_capture_sink_enable(rtc->capture_path, ESP_CAPTURE_RUN_MODE_ALWAYS);
@@ -389,7 +552,20 @@ static int start_stream(webrtc_t *rtc)
     if (ret == ESP_CAPTURE_ERR_OK) {
         media_lib_thread_handle_t handle = NULL;
         rtc->send_going = true;
-        ret = media_lib_thread_create_from_scheduler(&handle, "pc_send", media_send_task, rtc);
+        rtc->send_quit_bits = 0;
+        // Each stream has its own sender so that one stream never waits for the other's frame
+        if (rtc->rtc_cfg.peer_cfg.audio_info.codec) {
+            ret = media_lib_thread_create_from_scheduler(&handle, "pc_send", media_send_task, rtc);
+            if (ret == 0) {
+                rtc->send_quit_bits |= PC_SEND_QUIT_BIT;
+            }
+        }
+        if (rtc->rtc_cfg.peer_cfg.video_info.codec && ret == 0) {
+            ret = media_lib_thread_create_from_scheduler(&handle, "pc_send", media_send_video_task, rtc);
+            if (ret == 0) {
+                rtc->send_quit_bits |= PC_VSEND_QUIT_BIT;
+            }
+        }
         if (ret != 0) {
             rtc->send_going = false;
         }
@@ -401,15 +577,22 @@ static int start_stream(webrtc_t *rtc)
 
 static int stop_stream(webrtc_t *rtc)
 {
-    if (rtc->send_going) {
-        rtc->send_going = false;
-        WAIT_FOR_BITS(PC_SEND_QUIT_BIT);
+    if (rtc->broadcast) {
+        broadcast_set_active(rtc, false);
+        av_render_reset(rtc->play_handle);
+        return 0;
     }
+    rtc->send_going = false;
+    // Let senders release their frames and quit on next frame before capture stops
+    uint8_t pending = wait_send_quit(rtc->wait_event, rtc->send_quit_bits, SEND_QUIT_WAIT_MS);
     if (rtc->no_auto_capture == false) {
         esp_capture_stop(rtc->media_provider.capture);
     } else {
         esp_capture_sink_enable(rtc->capture_path, ESP_CAPTURE_RUN_MODE_DISABLE);
     }
+    // Stream got no frame meanwhile, its sender holds nothing and is woken by the stop
+    wait_send_quit(rtc->wait_event, pending, MEDIA_LIB_MAX_LOCK_TIME);
+    rtc->send_quit_bits = 0;
     av_render_reset(rtc->play_handle);
     return 0;
 }
@@ -426,6 +609,18 @@ static void pc_notify_app(webrtc_t *rtc, esp_webrtc_event_type_t event_type)
 
 esp_gmf_err_t esp_gmf_video_enc_set_gop(esp_gmf_element_handle_t handle, uint32_t gop);
 
+static void force_key_frame(esp_capture_sink_handle_t capture_path, uint8_t default_gop, uint8_t *last_gop)
+{
+    // Workaround to toggle GOP, will replace set force IDR later
+    esp_gmf_element_handle_t vid_enc = NULL;
+    esp_capture_sink_get_element_by_tag(capture_path, ESP_CAPTURE_STREAM_TYPE_VIDEO, "vid_enc", &vid_enc);
+    if (vid_enc) {
+        uint8_t new_gop = (*last_gop == default_gop) ? default_gop - 1: default_gop;
+        esp_gmf_video_enc_set_gop(vid_enc, new_gop);
+        *last_gop = new_gop;
+    }
+}
+
 static int pc_on_state(esp_peer_state_t state, void *ctx)
 {
     webrtc_t *rtc = (webrtc_t *)ctx;
@@ -443,6 +638,8 @@ static int pc_on_state(esp_peer_state_t state, void *ctx)
     } else if (state == ESP_PEER_STATE_PAIRED) {
         pc_notify_app(rtc, ESP_WEBRTC_EVENT_PAIRED);
     } else if (state == ESP_PEER_STATE_DISCONNECTED) {
+        // Run in mainloop task, drop partial frame before reset render
+        reset_video_dc_reasm(rtc);
         stop_stream(rtc);
         pc_notify_app(rtc, ESP_WEBRTC_EVENT_DISCONNECTED);
     } else if (state == ESP_PEER_STATE_CONNECT_FAILED) {
@@ -457,14 +654,10 @@ static int pc_on_state(esp_peer_state_t state, void *ctx)
     } else if (state == ESP_PEER_STATE_DATA_CHANNEL_CLOSED) {
         pc_notify_app(rtc, ESP_WEBRTC_EVENT_DATA_CHANNEL_CLOSED);
     } else if (state == ESP_PEER_STATE_VIDEO_PLI_RECEIVED) {
-        // Workaround to toggle GOP, will replace set force IDR later
-        uint8_t default_gop = rtc->rtc_cfg.peer_cfg.video_info.fps * 2;
-        esp_gmf_element_handle_t vid_enc = NULL;
-        esp_capture_sink_get_element_by_tag(rtc->capture_path, ESP_CAPTURE_STREAM_TYPE_VIDEO, "vid_enc", &vid_enc);
-        if (vid_enc) {
-            uint8_t new_gop = (rtc->last_gop == default_gop) ? default_gop - 1: default_gop;
-            esp_gmf_video_enc_set_gop(vid_enc, new_gop);
-            rtc->last_gop = new_gop;
+        if (rtc->broadcast) {
+            broadcast_request_key_frame(rtc->broadcast);
+        } else {
+            force_key_frame(rtc->capture_path, rtc->rtc_cfg.peer_cfg.video_info.fps * 2, &rtc->last_gop);
         }
     }
     return 0;
@@ -483,13 +676,16 @@ static void pc_task(void *arg)
     ESP_LOGI(TAG, "peer_connection_task started");
     while (rtc->running) {
         if (rtc->pause) {
+            reset_video_dc_reasm(rtc);
             SET_WAIT_BITS(PC_PAUSED_BIT);
             WAIT_FOR_BITS(PC_RESUME_BIT);
             continue;
         }
         esp_peer_main_loop(rtc->pc);
-        media_lib_thread_sleep(10);
+        // Wake on socket data or application send, timeout keeps timer granularity of peer
+        esp_peer_wait_event(rtc->pc, PC_LOOP_INTERVAL);
     }
+    reset_video_dc_reasm(rtc);
     SET_WAIT_BITS(PC_EXIT_BIT);
     media_lib_thread_destroy(NULL);
 }
@@ -692,20 +888,40 @@ static esp_capture_format_id_t get_capture_video_codec(esp_peer_audio_codec_t vi
     }
 }
 
+/* Pause main loop so that no render fifo buffer is kept reserved by it */
+static void pc_pause(webrtc_t *rtc)
+{
+    if (rtc->pc && rtc->running && rtc->pause == false) {
+        rtc->pause = true;
+        esp_peer_wakeup(rtc->pc);
+        WAIT_FOR_BITS(PC_PAUSED_BIT);
+    }
+}
+
+/* Disconnect and quit main loop but keep peer connection so that next session reuses its buffers */
+static void pc_park(webrtc_t *rtc)
+{
+    if (rtc->pc == NULL) {
+        return;
+    }
+    esp_peer_disconnect(rtc->pc);
+    bool still_running = rtc->running;
+    // Wait for PC task quit
+    if (rtc->pause) {
+        rtc->pause = false;
+        SET_WAIT_BITS(PC_RESUME_BIT);
+    }
+    rtc->running = false;
+    esp_peer_wakeup(rtc->pc);
+    if (still_running) {
+        WAIT_FOR_BITS(PC_EXIT_BIT);
+    }
+}
+
 static int pc_close(webrtc_t *rtc)
 {
     if (rtc->pc) {
-        esp_peer_disconnect(rtc->pc);
-        bool still_running = rtc->running;
-        // Wait for PC task quit
-        if (rtc->pause) {
-            rtc->pause = false;
-            SET_WAIT_BITS(PC_RESUME_BIT);
-        }
-        rtc->running = false;
-        if (still_running) {
-            WAIT_FOR_BITS(PC_EXIT_BIT);
-        }
+        pc_park(rtc);
         esp_peer_close(rtc->pc);
         rtc->pc = NULL;
     }
@@ -713,6 +929,10 @@ static int pc_close(webrtc_t *rtc)
         media_lib_event_group_destroy(rtc->wait_event);
         rtc->wait_event = NULL;
     }
+    if (rtc->send_lock) {
+        media_lib_mutex_destroy(rtc->send_lock);
+        rtc->send_lock = NULL;
+    }
     return ESP_PEER_ERR_NONE;
 }
 
@@ -752,9 +972,25 @@ static int pc_apply_capture_pre_setting(webrtc_t *rtc, uint16_t set_mask)
 
 static int pc_start(webrtc_t *rtc, esp_peer_ice_server_cfg_t *server_info, int server_num)
 {
-    if (rtc->pc) {
+    if (rtc->pc && rtc->running) {
         return esp_peer_update_ice_info(rtc->pc, rtc->ice_role, server_info, server_num);
     }
+    if (rtc->pc) {
+        // Peer connection parked by `esp_webrtc_stop`, restart main loop on it
+        int ret = esp_peer_update_ice_info(rtc->pc, rtc->ice_role, server_info, server_num);
+        if (ret != ESP_PEER_ERR_NONE) {
+            ESP_LOGE(TAG, "Fail to update ice info ret %d", ret);
+            return ret;
+        }
+        rtc->running = true;
+        media_lib_thread_handle_t thread;
+        media_lib_thread_create_from_scheduler(&thread, "pc_task", pc_task, rtc);
+        pc_apply_capture_pre_setting(rtc, WEBRTC_PRE_SETTING_MASK_ALL);
+        if (rtc->no_auto_capture == false && rtc->broadcast == NULL) {
+            esp_capture_sink_enable(rtc->capture_path, ESP_CAPTURE_RUN_MODE_ALWAYS);
+        }
+        return ret;
+    }
     esp_peer_cfg_t peer_cfg = {
         .server_lists = server_info,
         .server_num = server_num,
@@ -788,7 +1024,8 @@ static int pc_start(webrtc_t *rtc, esp_peer_ice_server_cfg_t *server_info, int s
         return ret;
     }
     media_lib_event_group_create(&rtc->wait_event);
-    if (rtc->wait_event == NULL) {
+    media_lib_mutex_create(&rtc->send_lock);
+    if (rtc->wait_event == NULL || rtc->send_lock == NULL) {
         return ESP_PEER_ERR_NO_MEM;
     }
     // Set running flag
@@ -818,6 +1055,10 @@ static int pc_start(webrtc_t *rtc, esp_peer_ice_server_cfg_t *server_info, int s
     if (peer_cfg.video_dir == ESP_PEER_MEDIA_DIR_RECV_ONLY) {
         sink_cfg.video_info.format_id = ESP_CAPTURE_FMT_ID_NONE;
     }
+    if (rtc->broadcast) {
+        // Capture sink is owned by broadcast
+        return ret;
+    }
     esp_capture_sink_setup(rtc->media_provider.capture, 0, &sink_cfg, &rtc->capture_path);
     pc_apply_capture_pre_setting(rtc, WEBRTC_PRE_SETTING_MASK_ALL);
     if (rtc->no_auto_capture == false) {
@@ -858,7 +1099,7 @@ static int signal_connected(void *ctx)
         printf("Signaling connected, pending for use not enable\n");
         return 0;
     }
-    if (rtc->pc) {
+    if (rtc->pc && rtc->running) {
         // Create offer so that fetch ice candidate
         esp_peer_new_connection(rtc->pc);
     }
@@ -875,6 +1116,7 @@ static int signal_new_msg(esp_peer_signaling_msg_t *msg, void *ctx)
             // Wait for main loop paused
             if (rtc->pause == false) {
                 rtc->pause = true;
+                esp_peer_wakeup(rtc->pc);
                 WAIT_FOR_BITS(PC_PAUSED_BIT);
             }
             esp_peer_disconnect(rtc->pc);
@@ -966,8 +1208,8 @@ int esp_webrtc_enable_peer_connection(esp_webrtc_handle_t handle, bool enable)
     rtc->pending_connect = !enable;
     int ret = ESP_PEER_ERR_NONE;
     if (rtc->pending_connect == false) {
-        if (rtc->pc == NULL) {
-            // Create peer connection firstly
+        if (rtc->pc == NULL || rtc->running == false) {
+            // Create peer connection firstly (or restart parked one)
             if (rtc->ice_info_loaded == false) {
                 // Wait for ice info loaded
                 ESP_LOGE(TAG, "ICE info not fetched yet");
@@ -991,6 +1233,7 @@ int esp_webrtc_enable_peer_connection(esp_webrtc_handle_t handle, bool enable)
     } else {
         // Close connection better than reconnect?
         rtc->recv_vid_info.codec = ESP_PEER_VIDEO_CODEC_NONE;
+        pc_pause(rtc);
         stop_stream(rtc);
         pc_close(rtc);
     }
@@ -1150,6 +1393,13 @@ int esp_webrtc_query(esp_webrtc_handle_t handle)
                 (int)rtc->aud_recv_pts, (int)rtc->aud_recv_num, (int)rtc->aud_recv_size,
                 (int)rtc->vid_recv_num, (int)rtc->vid_recv_size);
     }
+    if (rtc->aud_send_latency.frames || rtc->vid_send_latency.frames) {
+        esp_webrtc_send_latency_t latency;
+        esp_webrtc_get_send_latency(handle, &latency, true);
+        ESP_LOGI(TAG, "Send latency A:[avg %d max %d] V:[avg %d max %d]",
+                 (int)latency.audio.avg_ms, (int)latency.audio.max_ms,
+                 (int)latency.video.avg_ms, (int)latency.video.max_ms);
+    }
     esp_peer_query(rtc->pc);
     printf("\n");
     // Clear send and receive info
@@ -1164,6 +1414,28 @@ int esp_webrtc_query(esp_webrtc_handle_t handle)
     return ESP_PEER_ERR_NONE;
 }
 
+static void get_frame_latency(webrtc_latency_stat_t *stat, esp_webrtc_frame_latency_t *latency, bool reset)
+{
+    latency->frames = stat->frames;
+    latency->avg_ms = stat->frames ? stat->sum_ms / stat->frames : 0;
+    latency->max_ms = stat->max_ms;
+    latency->last_ms = stat->last_ms;
+    if (reset) {
+        memset(stat, 0, sizeof(webrtc_latency_stat_t));
+    }
+}
+
+int esp_webrtc_get_send_latency(esp_webrtc_handle_t handle, esp_webrtc_send_latency_t *latency, bool reset)
+{
+    if (handle == NULL || latency == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    webrtc_t *rtc = (webrtc_t *)handle;
+    get_frame_latency(&rtc->aud_send_latency, &latency->audio, reset);
+    get_frame_latency(&rtc->vid_send_latency, &latency->video, reset);
+    return ESP_PEER_ERR_NONE;
+}
+
 int esp_webrtc_stop(esp_webrtc_handle_t handle)
 {
     if (handle == NULL) {
@@ -1171,18 +1443,24 @@ int esp_webrtc_stop(esp_webrtc_handle_t handle)
     }
     webrtc_t *rtc = (webrtc_t *)handle;
     int ret = 0;
+    pc_pause(rtc);
     stop_stream(rtc);
-    // TODO stop agent
-    pc_close(rtc);
+    if (rtc->rtc_cfg.peer_cfg.reuse_session) {
+        pc_park(rtc);
+    } else {
+        pc_close(rtc);
+    }
     if (rtc->signaling) {
         esp_peer_signaling_stop(rtc->signaling);
         rtc->signaling = NULL;
     }
-    // Release reusable DC buffers at stop; they are allocated lazily on restart.
-    SAFE_FREE(rtc->vid_dc_send_buf);
-    rtc->vid_dc_send_buf_cap = 0;
-    SAFE_FREE(rtc->vid_dc_reasm);
-    rtc->vid_dc_reasm_cap = 0;
+    if (rtc->rtc_cfg.peer_cfg.reuse_session == false) {
+        // Release reusable DC buffers at stop; they are allocated lazily on restart.
+        SAFE_FREE(rtc->vid_dc_send_buf);
+        rtc->vid_dc_send_buf_cap = 0;
+        SAFE_FREE(rtc->vid_dc_reasm);
+        rtc->vid_dc_reasm_cap = 0;
+    }
     reset_video_dc_reasm(rtc);
     return ret;
 }
@@ -1194,6 +1472,11 @@ int esp_webrtc_close(esp_webrtc_handle_t handle)
     }
     webrtc_t *rtc = (webrtc_t *)handle;
     esp_webrtc_stop(handle);
+    // Release parked peer connection when session reused
+    pc_close(rtc);
+    if (rtc->broadcast) {
+        esp_webrtc_broadcast_remove(rtc->broadcast, handle);
+    }
     free_server_cfg(rtc);
     SAFE_FREE(rtc->rtc_cfg.peer_cfg.extra_cfg);
     SAFE_FREE(rtc->rtc_cfg.signaling_cfg.extra_cfg);
@@ -1203,3 +1486,385 @@ int esp_webrtc_close(esp_webrtc_handle_t handle)
     free(rtc);
     return ESP_PEER_ERR_NONE;
 }
+
+typedef struct webrtc_broadcast_t {
+    esp_webrtc_broadcast_cfg_t   cfg;
+    esp_capture_sink_handle_t    capture_path;
+    media_lib_mutex_handle_t     lock;      // Protect subscriber list and per-subscriber broadcast state, not held while sending
+    media_lib_mutex_handle_t     ctrl_lock; // Serialize stream start, stop and key frame request
+    media_lib_event_grp_handle_t wait_event;
+    webrtc_t                    *subscribers[ESP_WEBRTC_BROADCAST_MAX_SUBSCRIBER];
+    uint8_t                      subscriber_num;
+    uint8_t                      active_num;
+    bool                         send_going;
+    uint8_t                      send_quit_bits;
+    int64_t                      send_start_ms;
+    int64_t                      key_request_ms;
+    uint8_t                      last_gop;
+} webrtc_broadcast_t;
+
+/* Decoder can start from IDR or SPS, stop scan at first slice so that large frame is not scanned fully */
+static bool is_video_key_frame(esp_peer_video_codec_t codec, uint8_t *data, int size)
+{
+    if (codec != ESP_PEER_VIDEO_CODEC_H264) {
+        return true;
+    }
+    for (int i = 0; i + 3 < size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            uint8_t nal_type = data[i + 3] & 0x1F;
+            if (nal_type == H264_NAL_TYPE_IDR || nal_type == H264_NAL_TYPE_SPS) {
+                return true;
+            }
+            if (nal_type == H264_NAL_TYPE_SLICE) {
+                return false;
+            }
+            i += 2;
+        }
+    }
+    return false;
+}
+
+/* Pick subscribers for this frame and pin them, called with lock held */
+static int broadcast_snapshot(webrtc_broadcast_t *bc, esp_capture_stream_type_t stream_type, bool key_frame,
+                              int64_t now, webrtc_t **targets)
+{
+    int num = 0;
+    for (int i = 0; i < bc->subscriber_num; i++) {
+        webrtc_t *rtc = bc->subscribers[i];
+        if (rtc->bc_active == false || now < rtc->bc_skip_until) {
+            continue;
+        }
+        if (stream_type == ESP_CAPTURE_STREAM_TYPE_VIDEO && rtc->bc_wait_key) {
+            if (key_frame == false) {
+                continue;
+            }
+            rtc->bc_wait_key = false;
+        }
+        rtc->bc_sending++;
+        targets[num++] = rtc;
+    }
+    return num;
+}
+
+/* Fan-out budget of one frame. Audio uses video frame interval too: audio send of a subscriber waits for its
+ * video send, so a 20ms audio budget would skip subscribers which still keep up with video */
+static int broadcast_frame_interval(webrtc_broadcast_t *bc)
+{
+    return bc->cfg.video_info.fps ? 1000 / bc->cfg.video_info.fps : BROADCAST_DEFAULT_FRAME_MS;
+}
+
+/* Fan-out overran frame interval, skip slowest subscriber if it takes more than its share, called with lock held */
+static void broadcast_skip_slowest(webrtc_t **targets, int num, int cost_idx, int interval, int64_t now)
+{
+    webrtc_t *slowest = targets[0];
+    for (int i = 1; i < num; i++) {
+        if (targets[i]->bc_send_cost[cost_idx] > slowest->bc_send_cost[cost_idx]) {
+            slowest = targets[i];
+        }
+    }
+    int cost_ms = slowest->bc_send_cost[cost_idx] / 8;
+    if (cost_ms <= interval / num) {
+        return;
+    }
+    // Drop frames for this subscriber so that others keep real time
+    ESP_LOGW(TAG, "Broadcast subscriber %p send takes %dms of %dms frame interval, skip it", slowest, cost_ms, interval);
+    slowest->bc_skip_until = now + BROADCAST_SLOW_SKIP_MS;
+    slowest->bc_wait_key = true;
+    slowest->bc_send_cost[0] = slowest->bc_send_cost[1] = 0;
+}
+
+static void broadcast_send_loop(webrtc_broadcast_t *bc, esp_capture_stream_type_t stream_type)
+{
+    esp_capture_stream_frame_t frame = {
+        .stream_type = stream_type,
+    };
+    webrtc_t *targets[ESP_WEBRTC_BROADCAST_MAX_SUBSCRIBER];
+    int cost_idx = stream_type == ESP_CAPTURE_STREAM_TYPE_VIDEO;
+    int interval = broadcast_frame_interval(bc);
+    while (bc->send_going) {
+        if (esp_capture_sink_acquire_frame(bc->capture_path, &frame, false) != ESP_CAPTURE_ERR_OK) {
+            if (bc->send_going) {
+                media_lib_thread_sleep(AUDIO_FRAME_INTERVAL);
+            }
+            continue;
+        }
+        if (bc->send_going) {
+            bool key_frame = (stream_type == ESP_CAPTURE_STREAM_TYPE_VIDEO) &&
+                             is_video_key_frame(bc->cfg.video_info.codec, frame.data, frame.size);
+            // Snapshot under lock so that slow subscriber never blocks add, remove or activation
+            media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+            int num = broadcast_snapshot(bc, stream_type, key_frame, esp_timer_get_time() / 1000, targets);
+            media_lib_mutex_unlock(bc->lock);
+            // Frame is encoded once, only packetized and protected per subscriber
+            int64_t frame_start = esp_timer_get_time() / 1000;
+            int64_t end = frame_start;
+            for (int i = 0; i < num; i++) {
+                webrtc_t *rtc = targets[i];
+                int64_t start = end;
+                if (stream_type == ESP_CAPTURE_STREAM_TYPE_AUDIO) {
+                    _media_send_audio(rtc, &frame);
+                } else {
+                    _media_send_video(rtc, &frame);
+                }
+                end = esp_timer_get_time() / 1000;
+                // Only this loop touches cost of its stream, smoothed so that one large key frame does not count as slow
+                int64_t cost = end - start < BROADCAST_SLOW_SKIP_MS ? end - start : BROADCAST_SLOW_SKIP_MS;
+                rtc->bc_send_cost[cost_idx] += (uint32_t)cost - rtc->bc_send_cost[cost_idx] / 8;
+            }
+            // Subscribers stay pinned until here so that skip never touches a removed one
+            media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+            if (num && end - frame_start > interval) {
+                broadcast_skip_slowest(targets, num, cost_idx, interval, end);
+            }
+            for (int i = 0; i < num; i++) {
+                targets[i]->bc_sending--;
+            }
+            media_lib_mutex_unlock(bc->lock);
+        }
+        esp_capture_sink_release_frame(bc->capture_path, &frame);
+    }
+}
+
+/* Wait for fan-out sends to subscriber to finish after it is deactivated */
+static void broadcast_wait_send_done(webrtc_broadcast_t *bc, webrtc_t *rtc)
+{
+    media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    while (rtc->bc_sending) {
+        media_lib_mutex_unlock(bc->lock);
+        media_lib_thread_sleep(SEND_POLL_INTERVAL);
+        media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    }
+    media_lib_mutex_unlock(bc->lock);
+}
+
+static void broadcast_send_task(void *arg)
+{
+    webrtc_broadcast_t *bc = (webrtc_broadcast_t *)arg;
+    broadcast_send_loop(bc, ESP_CAPTURE_STREAM_TYPE_AUDIO);
+    media_lib_event_group_set_bits(bc->wait_event, PC_SEND_QUIT_BIT);
+    media_lib_thread_destroy(NULL);
+}
+
+static void broadcast_send_video_task(void *arg)
+{
+    webrtc_broadcast_t *bc = (webrtc_broadcast_t *)arg;
+    broadcast_send_loop(bc, ESP_CAPTURE_STREAM_TYPE_VIDEO);
+    media_lib_event_group_set_bits(bc->wait_event, PC_VSEND_QUIT_BIT);
+    media_lib_thread_destroy(NULL);
+}
+
+static int broadcast_start_stream(webrtc_broadcast_t *bc)
+{
+    bc->send_start_ms = esp_timer_get_time() / 1000;
+    int ret = esp_capture_start(bc->cfg.capture);
+    if (ret != ESP_CAPTURE_ERR_OK) {
+        ESP_LOGE(TAG, "Fail to start broadcast capture ret:%d", ret);
+        return ret;
+    }
+    media_lib_thread_handle_t handle = NULL;
+    bc->send_going = true;
+    bc->send_quit_bits = 0;
+    if (bc->cfg.audio_info.codec) {
+        ret = media_lib_thread_create_from_scheduler(&handle, "pc_send", broadcast_send_task, bc);
+        if (ret == 0) {
+            bc->send_quit_bits |= PC_SEND_QUIT_BIT;
+        }
+    }
+    if (bc->cfg.video_info.codec && ret == 0) {
+        ret = media_lib_thread_create_from_scheduler(&handle, "pc_send", broadcast_send_video_task, bc);
+        if (ret == 0) {
+            bc->send_quit_bits |= PC_VSEND_QUIT_BIT;
+        }
+    }
+    if (ret != 0) {
+        bc->send_going = false;
+    }
+    return ret;
+}
+
+static void broadcast_stop_stream(webrtc_broadcast_t *bc)
+{
+    bc->send_going = false;
+    uint8_t pending = wait_send_quit(bc->wait_event, bc->send_quit_bits, SEND_QUIT_WAIT_MS);
+    esp_capture_stop(bc->cfg.capture);
+    wait_send_quit(bc->wait_event, pending, MEDIA_LIB_MAX_LOCK_TIME);
+    bc->send_quit_bits = 0;
+}
+
+static void _broadcast_request_key_frame(webrtc_broadcast_t *bc)
+{
+    int64_t now = esp_timer_get_time() / 1000;
+    uint16_t interval = bc->cfg.keyframe_interval ? bc->cfg.keyframe_interval : BROADCAST_DEFAULT_KEY_INTERVAL;
+    // Encoder is shared, limit request rate so that one lossy viewer does not raise bitrate for all
+    if (bc->key_request_ms && now - bc->key_request_ms < interval) {
+        return;
+    }
+    bc->key_request_ms = now;
+    force_key_frame(bc->capture_path, bc->cfg.video_info.fps * 2, &bc->last_gop);
+}
+
+static void broadcast_request_key_frame(webrtc_broadcast_t *bc)
+{
+    media_lib_mutex_lock(bc->ctrl_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    _broadcast_request_key_frame(bc);
+    media_lib_mutex_unlock(bc->ctrl_lock);
+}
+
+static int broadcast_set_active(webrtc_t *rtc, bool active)
+{
+    webrtc_broadcast_t *bc = rtc->broadcast;
+    int ret = ESP_PEER_ERR_NONE;
+    media_lib_mutex_lock(bc->ctrl_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    // Capture starts with key frame, late joiner need request one
+    bool need_key = false;
+    if (active && rtc->bc_active == false) {
+        if (bc->send_going == false) {
+            ret = broadcast_start_stream(bc);
+        } else {
+            need_key = true;
+        }
+    }
+    media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (rtc->bc_active != active && ret == ESP_PEER_ERR_NONE) {
+        rtc->bc_active = active;
+        rtc->bc_wait_key = active;
+        rtc->bc_skip_until = 0;
+        rtc->bc_send_cost[0] = rtc->bc_send_cost[1] = 0;
+        rtc->send_start_ms = bc->send_start_ms;
+        bc->active_num += active ? 1 : -1;
+    }
+    media_lib_mutex_unlock(bc->lock);
+    if (active == false) {
+        // Peer may be closed right after, senders must be done with it
+        broadcast_wait_send_done(bc, rtc);
+    }
+    if (need_key) {
+        _broadcast_request_key_frame(bc);
+    } else if (bc->active_num == 0 && bc->send_going) {
+        broadcast_stop_stream(bc);
+    }
+    media_lib_mutex_unlock(bc->ctrl_lock);
+    return ret;
+}
+
+int esp_webrtc_broadcast_create(esp_webrtc_broadcast_cfg_t *cfg, esp_webrtc_broadcast_handle_t *handle)
+{
+    if (cfg == NULL || cfg->capture == NULL || handle == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    webrtc_broadcast_t *bc = (webrtc_broadcast_t *)calloc(1, sizeof(webrtc_broadcast_t));
+    if (bc == NULL) {
+        return ESP_PEER_ERR_NO_MEM;
+    }
+    bc->cfg = *cfg;
+    media_lib_mutex_create(&bc->lock);
+    media_lib_mutex_create(&bc->ctrl_lock);
+    media_lib_event_group_create(&bc->wait_event);
+    if (bc->lock == NULL || bc->ctrl_lock == NULL || bc->wait_event == NULL) {
+        esp_webrtc_broadcast_destroy(bc);
+        return ESP_PEER_ERR_NO_MEM;
+    }
+    esp_capture_sink_cfg_t sink_cfg = {
+        .audio_info = {
+            .format_id = get_capture_audio_codec(cfg->audio_info.codec),
+            .sample_rate = cfg->audio_info.sample_rate ? cfg->audio_info.sample_rate : 8000,
+            .channel = cfg->audio_info.channel ? cfg->audio_info.channel : 1,
+            .bits_per_sample = 16,
+        },
+        .video_info = {
+            .format_id = get_capture_video_codec(cfg->video_info.codec),
+            .width = cfg->video_info.width,
+            .height = cfg->video_info.height,
+            .fps = cfg->video_info.fps,
+        },
+    };
+    int ret = esp_capture_sink_setup(cfg->capture, 0, &sink_cfg, &bc->capture_path);
+    if (ret != ESP_CAPTURE_ERR_OK || bc->capture_path == NULL) {
+        ESP_LOGE(TAG, "Fail to setup broadcast capture sink ret:%d", ret);
+        esp_webrtc_broadcast_destroy(bc);
+        return ESP_PEER_ERR_FAIL;
+    }
+    esp_capture_sink_enable(bc->capture_path, ESP_CAPTURE_RUN_MODE_ALWAYS);
+    *handle = bc;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_webrtc_broadcast_add(esp_webrtc_broadcast_handle_t handle, esp_webrtc_handle_t rtc_handle)
+{
+    if (handle == NULL || rtc_handle == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    webrtc_broadcast_t *bc = (webrtc_broadcast_t *)handle;
+    webrtc_t *rtc = (webrtc_t *)rtc_handle;
+    if (rtc->broadcast || rtc->capture_path || rtc->pc) {
+        return ESP_PEER_ERR_WRONG_STATE;
+    }
+    int ret = ESP_PEER_ERR_NONE;
+    media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (bc->subscriber_num < ESP_WEBRTC_BROADCAST_MAX_SUBSCRIBER) {
+        bc->subscribers[bc->subscriber_num++] = rtc;
+        rtc->broadcast = bc;
+        rtc->bc_active = false;
+    } else {
+        ret = ESP_PEER_ERR_NO_MEM;
+    }
+    media_lib_mutex_unlock(bc->lock);
+    return ret;
+}
+
+int esp_webrtc_broadcast_remove(esp_webrtc_broadcast_handle_t handle, esp_webrtc_handle_t rtc_handle)
+{
+    if (handle == NULL || rtc_handle == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    webrtc_broadcast_t *bc = (webrtc_broadcast_t *)handle;
+    webrtc_t *rtc = (webrtc_t *)rtc_handle;
+    if (rtc->broadcast != bc) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    if (rtc->running) {
+        return ESP_PEER_ERR_WRONG_STATE;
+    }
+    // Stopped session is already inactive, keep it for safety
+    broadcast_set_active(rtc, false);
+    media_lib_mutex_lock(bc->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    for (int i = 0; i < bc->subscriber_num; i++) {
+        if (bc->subscribers[i] == rtc) {
+            bc->subscriber_num--;
+            bc->subscribers[i] = bc->subscribers[bc->subscriber_num];
+            bc->subscribers[bc->subscriber_num] = NULL;
+            break;
+        }
+    }
+    rtc->broadcast = NULL;
+    media_lib_mutex_unlock(bc->lock);
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_webrtc_broadcast_destroy(esp_webrtc_broadcast_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_PEER_ERR_INVALID_ARG;
+    }
+    webrtc_broadcast_t *bc = (webrtc_broadcast_t *)handle;
+    if (bc->subscriber_num) {
+        return ESP_PEER_ERR_WRONG_STATE;
+    }
+    if (bc->send_going) {
+        broadcast_stop_stream(bc);
+    }
+    if (bc->capture_path) {
+        esp_capture_sink_enable(bc->capture_path, ESP_CAPTURE_RUN_MODE_DISABLE);
+    }
+    if (bc->wait_event) {
+        media_lib_event_group_destroy(bc->wait_event);
+    }
+    if (bc->ctrl_lock) {
+        media_lib_mutex_destroy(bc->ctrl_lock);
+    }
+    if (bc->lock) {
+        media_lib_mutex_destroy(bc->lock);
+    }
+    free(bc);
+    return ESP_PEER_ERR_NONE;
+}
@@ -0,0 +1,600 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO., LTD
+ * SPDX-License-Identifier: LicenseRef-Espressif-Modified-MIT
+ *
+ * See LICENSE file for details.
+ */
+
+/*
+ * Broadcast fan-out on host
+ * Several viewers subscribe to one broadcast (`src/esp_webrtc.c` as is), capture paces H264 frames at 15fps
+ * (40KB key frame every 2 seconds, 12KB otherwise) and Opus frames every 20ms.
+ * Peer, signaling and capture are mocked: each video send is split into 1188 bytes packets which are copied and
+ * hashed as a stand-in for packetize and SRTP, first viewer can be made slow by sleeping in every video send.
+ * Reports frames taken from capture, then for each viewer video frames received and delay from capture to start
+ * of its send (time spent waiting behind other viewers).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "media_lib_os.h"
+#include "esp_timer.h"
+#include "esp_webrtc.h"
+
+#define VIDEO_FPS       (15)
+#define KEY_FRAME_SIZE  (40000)
+#define FRAME_SIZE      (12000)
+#define PACKET_PAYLOAD  (1188)
+#define AUDIO_SIZE      (80)
+#define MAX_VIEWER      (ESP_WEBRTC_BROADCAST_MAX_SUBSCRIBER)
+
+typedef struct {
+    esp_peer_cfg_t cfg;
+    volatile int   pending;
+    bool           slow;
+    long           video_frames;
+    int64_t        delay_sum;
+    int64_t        delay_max;
+    uint32_t       hash;
+    uint8_t        pkt[1500];
+} mock_peer_t;
+
+typedef struct {
+    int64_t  next_us[2];
+    int      gop_left;
+    bool     force_key;
+    uint8_t *vbuf;
+    uint8_t  abuf[AUDIO_SIZE];
+} mock_sink_t;
+
+typedef struct {
+    void (*body)(void *);
+    void *arg;
+} thread_arg_t;
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint32_t        bits;
+} event_t;
+
+static volatile bool cap_running;
+static int           slow_ms;
+static int           open_num;
+static int           encoded_frames;
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000ll + t.tv_nsec / 1000;
+}
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    return calloc(num, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+int media_lib_mutex_create(media_lib_mutex_handle_t *mutex)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(m, &attr);
+    *mutex = m;
+    return 0;
+}
+
+int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+    return 0;
+}
+
+int media_lib_mutex_lock(media_lib_mutex_handle_t mutex, uint32_t timeout)
+{
+    (void)timeout;
+    return pthread_mutex_lock(mutex);
+}
+
+int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex)
+{
+    return pthread_mutex_unlock(mutex);
+}
+
+int media_lib_event_group_create(media_lib_event_grp_handle_t *group)
+{
+    event_t *e = calloc(1, sizeof(event_t));
+    pthread_mutex_init(&e->m, NULL);
+    pthread_cond_init(&e->c, NULL);
+    *group = e;
+    return 0;
+}
+
+int media_lib_event_group_destroy(media_lib_event_grp_handle_t group)
+{
+    free(group);
+    return 0;
+}
+
+uint32_t media_lib_event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits |= bits;
+    pthread_cond_broadcast(&e->c);
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits &= ~bits;
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_wait_bits(media_lib_event_grp_handle_t group, uint32_t bits, uint32_t timeout)
+{
+    (void)timeout;
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    while ((e->bits & bits) == 0) {
+        pthread_cond_wait(&e->c, &e->m);
+    }
+    uint32_t r = e->bits;
+    pthread_mutex_unlock(&e->m);
+    return r;
+}
+
+static void *thread_run(void *arg)
+{
+    thread_arg_t t = *(thread_arg_t *)arg;
+    free(arg);
+    t.body(t.arg);
+    return NULL;
+}
+
+int media_lib_thread_create_from_scheduler(media_lib_thread_handle_t *handle, const char *name,
+                                           void (*body)(void *), void *arg)
+{
+    (void)handle;
+    (void)name;
+    pthread_t t;
+    thread_arg_t *a = malloc(sizeof(thread_arg_t));
+    a->body = body;
+    a->arg = arg;
+    pthread_create(&t, NULL, thread_run, a);
+    pthread_detach(t);
+    return 0;
+}
+
+void media_lib_thread_destroy(media_lib_thread_handle_t handle)
+{
+    (void)handle;
+    pthread_exit(NULL);
+}
+
+void media_lib_thread_sleep(int ms)
+{
+    usleep(ms * 1000);
+}
+
+/* Capture: paces frames like an encoder, key frame on start, on request and every 2 seconds */
+esp_capture_err_t esp_capture_start(esp_capture_handle_t capture)
+{
+    (void)capture;
+    cap_running = true;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_stop(esp_capture_handle_t capture)
+{
+    (void)capture;
+    cap_running = false;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_sink_setup(esp_capture_handle_t capture, int idx, esp_capture_sink_cfg_t *cfg,
+                                         esp_capture_sink_handle_t *sink)
+{
+    (void)capture;
+    (void)idx;
+    (void)cfg;
+    mock_sink_t *s = calloc(1, sizeof(mock_sink_t));
+    s->vbuf = malloc(KEY_FRAME_SIZE);
+    s->force_key = true;
+    *sink = s;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_sink_enable(esp_capture_sink_handle_t sink, esp_capture_run_mode_t mode)
+{
+    (void)sink;
+    (void)mode;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_sink_acquire_frame(esp_capture_sink_handle_t sink, esp_capture_stream_frame_t *frame,
+                                                 bool no_wait)
+{
+    (void)no_wait;
+    mock_sink_t *s = sink;
+    if (cap_running == false) {
+        return -1;
+    }
+    int audio = frame->stream_type == ESP_CAPTURE_STREAM_TYPE_AUDIO;
+    int64_t interval = audio ? 20000 : 1000000 / VIDEO_FPS;
+    int64_t now = esp_timer_get_time();
+    if (s->next_us[audio] == 0) {
+        s->next_us[audio] = now;
+    }
+    if (s->next_us[audio] > now) {
+        usleep(s->next_us[audio] - now);
+    }
+    s->next_us[audio] += interval;
+    if (cap_running == false) {
+        return -1;
+    }
+    frame->pts = (uint32_t)(esp_timer_get_time() / 1000);
+    if (audio) {
+        frame->data = s->abuf;
+        frame->size = AUDIO_SIZE;
+        return ESP_CAPTURE_ERR_OK;
+    }
+    __sync_fetch_and_add(&encoded_frames, 1);
+    bool key = s->force_key || s->gop_left <= 0;
+    s->force_key = false;
+    s->gop_left = key ? VIDEO_FPS * 2 : s->gop_left - 1;
+    int size = key ? KEY_FRAME_SIZE : FRAME_SIZE;
+    memset(s->vbuf, 0x55, size);
+    // Start code followed by SPS for key frame, non-IDR slice otherwise
+    s->vbuf[0] = 0;
+    s->vbuf[1] = 0;
+    s->vbuf[2] = 1;
+    s->vbuf[3] = key ? 0x67 : 0x41;
+    frame->data = s->vbuf;
+    frame->size = size;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_sink_release_frame(esp_capture_sink_handle_t sink, esp_capture_stream_frame_t *frame)
+{
+    (void)sink;
+    (void)frame;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_sink_set_bitrate(esp_capture_sink_handle_t sink, esp_capture_stream_type_t type,
+                                               uint32_t bitrate)
+{
+    (void)sink;
+    (void)type;
+    (void)bitrate;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_capture_err_t esp_capture_sink_get_element_by_tag(esp_capture_sink_handle_t sink, esp_capture_stream_type_t type,
+                                                      const char *tag, esp_gmf_element_handle_t *element)
+{
+    (void)type;
+    (void)tag;
+    *element = sink;
+    return ESP_CAPTURE_ERR_OK;
+}
+
+esp_gmf_err_t esp_gmf_video_enc_set_gop(esp_gmf_element_handle_t element, uint32_t gop)
+{
+    (void)gop;
+    ((mock_sink_t *)element)->force_key = true;
+    return 0;
+}
+
+/* Player is not used by send only viewers */
+int av_render_add_audio_data(av_render_handle_t render, av_render_audio_data_t *data)
+{
+    (void)render;
+    (void)data;
+    return 0;
+}
+
+int av_render_add_audio_stream(av_render_handle_t render, av_render_audio_info_t *info)
+{
+    (void)render;
+    (void)info;
+    return 0;
+}
+
+int av_render_add_video_data(av_render_handle_t render, av_render_video_data_t *data)
+{
+    (void)render;
+    (void)data;
+    return 0;
+}
+
+int av_render_add_video_stream(av_render_handle_t render, av_render_video_info_t *info)
+{
+    (void)render;
+    (void)info;
+    return 0;
+}
+
+int av_render_get_video_buffer(av_render_handle_t render, uint32_t size, uint8_t **buffer)
+{
+    (void)render;
+    (void)size;
+    (void)buffer;
+    return -1;
+}
+
+int av_render_commit_video_buffer(av_render_handle_t render, av_render_video_data_t *buffer)
+{
+    (void)render;
+    (void)buffer;
+    return 0;
+}
+
+int av_render_reset(av_render_handle_t render)
+{
+    (void)render;
+    return 0;
+}
+
+/* Peer: connects on first main loop, copies and hashes every packet as stand-in for packetize and SRTP */
+static void mock_protect(mock_peer_t *p, const uint8_t *data, int len)
+{
+    memcpy(p->pkt + 12, data, len);
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < len + 12; i++) {
+        h = (h ^ p->pkt[i]) * 16777619u;
+    }
+    p->hash ^= h;
+}
+
+int esp_peer_open(esp_peer_cfg_t *cfg, const esp_peer_ops_t *ops, esp_peer_handle_t *peer)
+{
+    (void)ops;
+    mock_peer_t *p = calloc(1, sizeof(mock_peer_t));
+    p->cfg = *cfg;
+    p->slow = open_num++ == 0 && slow_ms > 0;
+    *peer = p;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_new_connection(esp_peer_handle_t peer)
+{
+    ((mock_peer_t *)peer)->pending = 1;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_update_ice_info(esp_peer_handle_t peer, esp_peer_role_t role, esp_peer_ice_server_cfg_t *server, int num)
+{
+    (void)peer;
+    (void)role;
+    (void)server;
+    (void)num;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_main_loop(esp_peer_handle_t peer)
+{
+    mock_peer_t *p = peer;
+    if (p->pending) {
+        p->pending = 0;
+        p->cfg.on_state(ESP_PEER_STATE_CONNECTED, p->cfg.ctx);
+    }
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_wait_event(esp_peer_handle_t peer, uint32_t timeout_ms)
+{
+    (void)peer;
+    usleep(timeout_ms * 1000);
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_wakeup(esp_peer_handle_t peer)
+{
+    (void)peer;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_disconnect(esp_peer_handle_t peer)
+{
+    (void)peer;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_close(esp_peer_handle_t peer)
+{
+    free(peer);
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_query(esp_peer_handle_t peer)
+{
+    (void)peer;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_send_msg(esp_peer_handle_t peer, esp_peer_msg_t *msg)
+{
+    (void)peer;
+    (void)msg;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_send_data(esp_peer_handle_t peer, esp_peer_data_frame_t *frame)
+{
+    (void)peer;
+    (void)frame;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_send_audio(esp_peer_handle_t peer, esp_peer_audio_frame_t *frame)
+{
+    mock_protect(peer, frame->data, frame->size);
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_send_video(esp_peer_handle_t peer, esp_peer_video_frame_t *frame)
+{
+    mock_peer_t *p = peer;
+    int64_t delay = esp_timer_get_time() / 1000 - frame->pts;
+    p->delay_sum += delay;
+    if (delay > p->delay_max) {
+        p->delay_max = delay;
+    }
+    if (p->slow) {
+        usleep(slow_ms * 1000);
+    }
+    p->video_frames++;
+    for (int pos = 0; pos < frame->size; pos += PACKET_PAYLOAD) {
+        int len = frame->size - pos < PACKET_PAYLOAD ? frame->size - pos : PACKET_PAYLOAD;
+        mock_protect(p, frame->data + pos, len);
+    }
+    return ESP_PEER_ERR_NONE;
+}
+
+const esp_peer_ops_t *esp_peer_get_default_impl(void)
+{
+    static esp_peer_ops_t ops;
+    return &ops;
+}
+
+/* Signaling: reports ICE info and connected at once */
+int esp_peer_signaling_start(esp_peer_signaling_cfg_t *cfg, const esp_peer_signaling_impl_t *impl,
+                             esp_peer_signaling_handle_t *sig)
+{
+    (void)impl;
+    esp_peer_signaling_ice_info_t info = {
+        .is_initiator = true,
+    };
+    cfg->on_ice_info(&info, cfg->ctx);
+    cfg->on_connected(cfg->ctx);
+    *sig = (esp_peer_signaling_handle_t)1;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_signaling_send_msg(esp_peer_signaling_handle_t sig, esp_peer_signaling_msg_t *msg)
+{
+    (void)sig;
+    (void)msg;
+    return ESP_PEER_ERR_NONE;
+}
+
+int esp_peer_signaling_stop(esp_peer_signaling_handle_t sig)
+{
+    (void)sig;
+    return ESP_PEER_ERR_NONE;
+}
+
+static esp_webrtc_handle_t open_viewer(void)
+{
+    static esp_peer_signaling_impl_t sig_impl;
+    static esp_peer_ops_t peer_ops;
+    esp_webrtc_cfg_t cfg = {
+        .peer_cfg = {
+            .audio_info = {
+                .codec = ESP_PEER_AUDIO_CODEC_OPUS,
+                .sample_rate = 16000,
+                .channel = 1,
+            },
+            .video_info = {
+                .codec = ESP_PEER_VIDEO_CODEC_H264,
+                .width = 640,
+                .height = 480,
+                .fps = VIDEO_FPS,
+            },
+            .audio_dir = ESP_PEER_MEDIA_DIR_SEND_RECV,
+            .video_dir = ESP_PEER_MEDIA_DIR_SEND_ONLY,
+        },
+        .signaling_impl = &sig_impl,
+        .peer_impl = &peer_ops,
+    };
+    esp_webrtc_handle_t rtc = NULL;
+    esp_webrtc_open(&cfg, &rtc);
+    esp_webrtc_media_provider_t provider = {
+        .capture = (esp_capture_handle_t)1,
+        .player = (av_render_handle_t)2,
+    };
+    esp_webrtc_set_media_provider(rtc, &provider);
+    return rtc;
+}
+
+int main(int argc, char *argv[])
+{
+    int viewer_num = argc > 1 ? atoi(argv[1]) : 4;
+    slow_ms = argc > 2 ? atoi(argv[2]) : 0;
+    int seconds = argc > 3 ? atoi(argv[3]) : 4;
+    if (viewer_num < 1 || viewer_num > MAX_VIEWER) {
+        printf("Usage: %s [viewers 1-%d] [slow_ms] [seconds]\n", argv[0], MAX_VIEWER);
+        return 1;
+    }
+    esp_webrtc_broadcast_cfg_t bc_cfg = {
+        .capture = (esp_capture_handle_t)1,
+        .audio_info = {
+            .codec = ESP_PEER_AUDIO_CODEC_OPUS,
+            .sample_rate = 16000,
+            .channel = 1,
+        },
+        .video_info = {
+            .codec = ESP_PEER_VIDEO_CODEC_H264,
+            .width = 640,
+            .height = 480,
+            .fps = VIDEO_FPS,
+        },
+    };
+    esp_webrtc_broadcast_handle_t bc = NULL;
+    if (esp_webrtc_broadcast_create(&bc_cfg, &bc) != ESP_PEER_ERR_NONE) {
+        printf("Fail to create broadcast\n");
+        return 1;
+    }
+    esp_webrtc_handle_t viewers[MAX_VIEWER];
+    for (int i = 0; i < viewer_num; i++) {
+        viewers[i] = open_viewer();
+        esp_webrtc_broadcast_add(bc, viewers[i]);
+        esp_webrtc_start(viewers[i]);
+    }
+    usleep(500000);
+    int start_frames = encoded_frames;
+    mock_peer_t *peers[MAX_VIEWER];
+    for (int i = 0; i < viewer_num; i++) {
+        esp_peer_handle_t peer = NULL;
+        esp_webrtc_get_peer_connection(viewers[i], &peer);
+        peers[i] = peer;
+        peers[i]->video_frames = 0;
+        peers[i]->delay_sum = peers[i]->delay_max = 0;
+    }
+    usleep(seconds * 1000000);
+    printf("viewers=%d slow_ms=%d fps=%d seconds=%d: captured %d of %d video frames\n",
+           viewer_num, slow_ms, VIDEO_FPS, seconds, encoded_frames - start_frames, VIDEO_FPS * seconds);
+    for (int i = 0; i < viewer_num; i++) {
+        mock_peer_t *p = peers[i];
+        printf("  viewer %d%s: frames=%ld delay avg=%.1f ms max=%d ms\n", i, p->slow ? " (slow)" : "", p->video_frames,
+               p->video_frames ? (double)p->delay_sum / p->video_frames : 0, (int)p->delay_max);
+    }
+    for (int i = 0; i < viewer_num; i++) {
+        esp_webrtc_close(viewers[i]);
+    }
+    return esp_webrtc_broadcast_destroy(bc) == ESP_PEER_ERR_NONE ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+/* Host stub of esp_capture, only what esp_webrtc uses */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef void *esp_capture_handle_t;
+typedef void *esp_capture_sink_handle_t;
+typedef void *esp_gmf_element_handle_t;
+typedef int   esp_gmf_err_t;
+
+typedef enum {
+    ESP_CAPTURE_ERR_OK = 0,
+} esp_capture_err_t;
+
+typedef enum {
+    ESP_CAPTURE_FMT_ID_NONE,
+    ESP_CAPTURE_FMT_ID_G711A,
+    ESP_CAPTURE_FMT_ID_G711U,
+    ESP_CAPTURE_FMT_ID_OPUS,
+    ESP_CAPTURE_FMT_ID_H264,
+    ESP_CAPTURE_FMT_ID_MJPEG,
+} esp_capture_format_id_t;
+
+typedef enum {
+    ESP_CAPTURE_RUN_MODE_DISABLE,
+    ESP_CAPTURE_RUN_MODE_ALWAYS,
+} esp_capture_run_mode_t;
+
+typedef enum {
+    ESP_CAPTURE_STREAM_TYPE_AUDIO,
+    ESP_CAPTURE_STREAM_TYPE_VIDEO,
+} esp_capture_stream_type_t;
+
+typedef struct {
+    esp_capture_stream_type_t stream_type;
+    uint32_t                  pts;
+    uint8_t                  *data;
+    int                       size;
+} esp_capture_stream_frame_t;
+
+typedef struct {
+    struct {
+        esp_capture_format_id_t format_id;
+        uint32_t                sample_rate;
+        uint8_t                 channel;
+        uint8_t                 bits_per_sample;
+    } audio_info;
+    struct {
+        esp_capture_format_id_t format_id;
+        uint16_t                width;
+        uint16_t                height;
+        uint8_t                 fps;
+    } video_info;
+} esp_capture_sink_cfg_t;
+
+esp_capture_err_t esp_capture_start(esp_capture_handle_t capture);
+esp_capture_err_t esp_capture_stop(esp_capture_handle_t capture);
+esp_capture_err_t esp_capture_sink_setup(esp_capture_handle_t capture, int idx, esp_capture_sink_cfg_t *cfg,
+                                         esp_capture_sink_handle_t *sink);
+esp_capture_err_t esp_capture_sink_enable(esp_capture_sink_handle_t sink, esp_capture_run_mode_t mode);
+esp_capture_err_t esp_capture_sink_acquire_frame(esp_capture_sink_handle_t sink, esp_capture_stream_frame_t *frame,
+                                                 bool no_wait);
+esp_capture_err_t esp_capture_sink_release_frame(esp_capture_sink_handle_t sink, esp_capture_stream_frame_t *frame);
+esp_capture_err_t esp_capture_sink_set_bitrate(esp_capture_sink_handle_t sink, esp_capture_stream_type_t type,
+                                               uint32_t bitrate);
+esp_capture_err_t esp_capture_sink_get_element_by_tag(esp_capture_sink_handle_t sink, esp_capture_stream_type_t type,
+                                                      const char *tag, esp_gmf_element_handle_t *element);
@@ -0,0 +1,4 @@
+/* Host stub, sink API is declared in esp_capture.h */
+#pragma once
+
+#include "esp_capture.h"
@@ -0,0 +1,4 @@
+/* Host stub of esp_codec_dev.h, handle type only */
+#pragma once
+
+typedef void *esp_codec_dev_handle_t;
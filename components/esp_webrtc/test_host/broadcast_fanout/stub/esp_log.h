@@ -0,0 +1,9 @@
+/* Host stub of esp_log.h, warnings are kept to see skipped subscribers */
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) printf("E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) printf("W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) do {} while (0)
+#define ESP_LOGD(tag, fmt, ...) do {} while (0)
@@ -0,0 +1,8 @@
+/* Host stub of esp_timer.h */
+#pragma once
+
+#include <stdint.h>
+
+typedef void *esp_timer_handle_t;
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,28 @@
+/* Host stub of media_lib_os.h, only what esp_webrtc uses */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MEDIA_LIB_MAX_LOCK_TIME 0xFFFFFFFF
+
+typedef void *media_lib_mutex_handle_t;
+typedef void *media_lib_event_grp_handle_t;
+typedef void *media_lib_thread_handle_t;
+
+void *media_lib_malloc(size_t size);
+void *media_lib_calloc(size_t num, size_t size);
+void media_lib_free(void *ptr);
+int media_lib_mutex_create(media_lib_mutex_handle_t *mutex);
+int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex);
+int media_lib_mutex_lock(media_lib_mutex_handle_t mutex, uint32_t timeout);
+int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex);
+int media_lib_event_group_create(media_lib_event_grp_handle_t *group);
+int media_lib_event_group_destroy(media_lib_event_grp_handle_t group);
+uint32_t media_lib_event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits);
+uint32_t media_lib_event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits);
+uint32_t media_lib_event_group_wait_bits(media_lib_event_grp_handle_t group, uint32_t bits, uint32_t timeout);
+int media_lib_thread_create_from_scheduler(media_lib_thread_handle_t *handle, const char *name,
+                                           void (*body)(void *), void *arg);
+void media_lib_thread_destroy(media_lib_thread_handle_t handle);
+void media_lib_thread_sleep(int ms);
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include "mem_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +49,8 @@ typedef struct {
     void *lock;       /*!< Protect lock */
     void *write_lock; /*!< Write lock to let only one writer at same time */
     void *event;      /*!< Event group to wake up reader or writer */
+    int   writing;    /*!< Writer holds buffer got from `data_queue_get_buffer` and not sent yet */
+    mem_arena_handle_t arena; /*!< Arena which buffer is allocated from, NULL for heap */
 } data_queue_t;
 
 /**
@@ -59,6 +62,19 @@ typedef struct {
  */
 data_queue_t *data_queue_init(int size);
 
+/**
+ * @brief         Initialize data queue with buffer from memory arena
+ *
+ * @note          Buffer is returned to arena in `data_queue_deinit`, so that queue created again with same size
+ *                in later session reuses it instead of allocating from heap
+ *
+ * @param         size: Buffer size
+ * @param         arena: Memory arena, use heap when NULL
+ * @return        - NULL: Fail to initialize queue
+ *                - Others: Data queue instance
+ */
+data_queue_t *data_queue_init_from_arena(int size, mem_arena_handle_t arena);
+
 /**
  * @brief         Wakeup thread which wait on queue data
  *
@@ -102,6 +118,36 @@ void *data_queue_get_write_data(data_queue_t *q);
  */
 int data_queue_send_buffer(data_queue_t *q, int size);
 
+/**
+ * @brief         Reserve buffer in data queue to be committed later
+ *
+ * @note          Unlike `data_queue_get_buffer` write lock is not kept, so other writers can append data after
+ *                the reserved block and commit can be called from any thread
+ *                Reader keeps queue order, it waits on the reserved block until it is committed
+ *                Data queue can not be deinitialized before all reserved blocks are committed
+ *
+ * @param         q: Data queue instance
+ * @param         size: Buffer size want to reserve
+ * @return        - NULL: Fail to reserve buffer
+ *                - Others: Buffer data
+ */
+void *data_queue_reserve_buffer(data_queue_t *q, int size);
+
+/**
+ * @brief         Commit buffer reserved by `data_queue_reserve_buffer`
+ *
+ * @note          If other data is written after the block before commit, reader gets the whole reserved size,
+ *                caller should keep actual data size inside data in that case
+ *                Block consumed by `data_queue_consume_all` before commit is dropped
+ *
+ * @param         q: Data queue instance
+ * @param         buffer: Buffer returned by `data_queue_reserve_buffer`
+ * @param         size: Filled data size, set to 0 to drop the block
+ * @return        - 0: On success
+ *                - Others: Size larger than reserved, block is dropped
+ */
+int data_queue_commit_buffer(data_queue_t *q, void *buffer, int size);
+
 /**
  * @brief         Read data from data queue, and add reference count
  *
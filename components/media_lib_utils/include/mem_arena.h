@@ -0,0 +1,114 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Memory arena handle
+ *
+ * @note  Arena keeps large buffers which are allocated and freed on every session (FIFOs, frame buffers etc.)
+ *        Buffer returned by `mem_arena_free` stays reserved and is handed out again to the next allocation which fits,
+ *        so that repeated session setup and teardown do not punch new holes into the heap
+ *        All reserved buffers are released together in `mem_arena_destroy`
+ *        Only helps when the other per-session buffers are kept too (e.g. `reuse_session` of `esp_webrtc`),
+ *        otherwise they get allocated around reserved regions and heap ends more fragmented than without arena
+ */
+typedef struct mem_arena_t *mem_arena_handle_t;
+
+/**
+ * @brief  Memory arena statistics
+ */
+typedef struct {
+    uint16_t region_num;    /*!< Reserved region number */
+    uint16_t used_num;      /*!< Regions currently in use */
+    uint32_t reserved_size; /*!< Total reserved size of all regions */
+    uint32_t used_size;     /*!< Total size of regions in use */
+    uint32_t reuse_count;   /*!< Allocations served by reserved region */
+    uint32_t alloc_count;   /*!< Allocations which reserved new region from heap */
+} mem_arena_stats_t;
+
+/**
+ * @brief  Create memory arena
+ *
+ * @return
+ *       - NULL    Not enough memory
+ *       - Others  Arena handle
+ */
+mem_arena_handle_t mem_arena_create(void);
+
+/**
+ * @brief  Allocate buffer from arena
+ *
+ * @note  Smallest idle region which fits is reused, otherwise a new region is reserved from heap
+ *        When no idle region fits, one smaller idle region is released first so that arena does not keep growing
+ *
+ * @param[in]  arena  Arena handle
+ * @param[in]  size   Buffer size
+ *
+ * @return
+ *       - NULL    Invalid argument or not enough memory
+ *       - Others  Buffer
+ */
+void *mem_arena_alloc(mem_arena_handle_t arena, int size);
+
+/**
+ * @brief  Return buffer to arena
+ *
+ * @note  Buffer is kept reserved for later `mem_arena_alloc`, it is not given back to heap
+ *
+ * @param[in]  arena   Arena handle
+ * @param[in]  buffer  Buffer allocated by `mem_arena_alloc`
+ */
+void mem_arena_free(mem_arena_handle_t arena, void *buffer);
+
+/**
+ * @brief  Get arena statistics
+ *
+ * @param[in]   arena  Arena handle
+ * @param[out]  stats  Statistics to fill
+ *
+ * @return
+ *       - 0   On success
+ *       - -1  Invalid argument
+ */
+int mem_arena_get_stats(mem_arena_handle_t arena, mem_arena_stats_t *stats);
+
+/**
+ * @brief  Destroy arena and release all reserved regions to heap
+ *
+ * @note  All buffers allocated from arena become invalid after destroy
+ *
+ * @param[in]  arena  Arena handle
+ */
+void mem_arena_destroy(mem_arena_handle_t arena);
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,6 +29,10 @@
 #define DATA_Q_DATA_ARRIVE_BITS  (1)
 #define DATA_Q_DATA_CONSUME_BITS (2)
 #define DATA_Q_USER_FREE_BITS    (4)
+/* Header flags of block added by `data_queue_reserve_buffer` */
+#define DATA_Q_BLOCK_PENDING     (1 << 30)
+#define DATA_Q_BLOCK_SKIP        (1 << 29)
+#define DATA_Q_BLOCK_SIZE(head)  ((head) & ~(DATA_Q_BLOCK_PENDING | DATA_Q_BLOCK_SKIP))
 
 #define _SET_BITS(group, bit)    media_lib_event_group_set_bits((media_lib_event_grp_handle_t) group, bit)
 // Need manual clear bits
@@ -102,13 +106,35 @@ static bool _data_queue_have_data_from_last(data_queue_t *q)
     return q->filled ? true : false;
 }
 
+static void data_queue_consume_front(data_queue_t *q)
+{
+    uint8_t *buffer = (uint8_t *) q->buffer + q->rp;
+    int size = DATA_Q_BLOCK_SIZE(*((int *) buffer));
+    if (size < 0 || size > q->size) {
+        *(int*)0 = 0;
+    }
+    q->rp += size;
+    q->filled -= size;
+    if (q->fill_end && q->rp >= q->fill_end) {
+        q->fill_end = 0;
+        q->rp = 0;
+    }
+    data_queue_data_consumed(q);
+}
+
 data_queue_t *data_queue_init(int size)
+{
+    return data_queue_init_from_arena(size, NULL);
+}
+
+data_queue_t *data_queue_init_from_arena(int size, mem_arena_handle_t arena)
 {
     data_queue_t *q = media_lib_calloc(1, sizeof(data_queue_t));
     if (q == NULL) {
         return NULL;
     }
-    q->buffer = media_lib_malloc(size);
+    q->arena = arena;
+    q->buffer = arena ? mem_arena_alloc(arena, size) : media_lib_malloc(size);
     media_lib_mutex_create(&q->lock);
     media_lib_mutex_create(&q->write_lock);
     media_lib_event_group_create(&q->event);
@@ -143,18 +169,13 @@ int data_queue_consume_all(data_queue_t *q)
             if (q->quit) {
                 break;
             }
-            uint8_t *buffer = (uint8_t *) q->buffer + q->rp;
-            int size = *((int *) buffer);
-            if (size < 0 || size >= q->size) {
-                *(int*)0 = 0;
-            }
-            q->rp += size;
-            q->filled -= size;
-            if (q->fill_end && q->rp >= q->fill_end) {
-                q->fill_end = 0;
-                q->rp = 0;
+            int *head = (int *) ((uint8_t *) q->buffer + q->rp);
+            if (*head & DATA_Q_BLOCK_PENDING) {
+                // Writer still fills it, drop it once committed and keep later data
+                *head |= DATA_Q_BLOCK_SKIP;
+                break;
             }
-            data_queue_data_consumed(q);
+            data_queue_consume_front(q);
         }
         _MUTEX_UNLOCK(q->lock);
     }
@@ -176,7 +197,11 @@ void data_queue_deinit(data_queue_t *q)
         media_lib_event_group_destroy((media_lib_mutex_handle_t) q->event);
     }
     if (q->buffer) {
-        media_lib_free(q->buffer);
+        if (q->arena) {
+            mem_arena_free(q->arena, q->buffer);
+        } else {
+            media_lib_free(q->buffer);
+        }
     }
     media_lib_free(q);
 }
@@ -245,6 +270,7 @@ void *data_queue_get_buffer(data_queue_t *q, int size)
         if (avail >= size) {
             uint8_t *buffer = (uint8_t *) q->buffer + q->wp;
             q->user++;
+            q->writing = 1;
             _MUTEX_UNLOCK(q->lock);
             return buffer + DATA_Q_ALLOC_HEAD_SIZE;
         }
@@ -276,6 +302,7 @@ int data_queue_send_buffer(data_queue_t *q, int size)
         return -1;
     }
     _MUTEX_LOCK(q->lock);
+    q->writing = 0;
     if (size == 0) {
         q->user--;
         data_queue_release_user(q);
@@ -308,6 +335,56 @@ int data_queue_send_buffer(data_queue_t *q, int size)
     return ret;
 }
 
+void *data_queue_reserve_buffer(data_queue_t *q, int size)
+{
+    uint8_t *buffer = (uint8_t *) data_queue_get_buffer(q, size);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    // Publish block as pending so that write lock is released and later writers append after it
+    _MUTEX_LOCK(q->lock);
+    size += DATA_Q_ALLOC_HEAD_SIZE;
+    *((int *) (buffer - DATA_Q_ALLOC_HEAD_SIZE)) = size | DATA_Q_BLOCK_PENDING;
+    q->wp += size;
+    q->filled += size;
+    q->writing = 0;
+    _MUTEX_UNLOCK(q->lock);
+    _MUTEX_UNLOCK(q->write_lock);
+    return buffer;
+}
+
+int data_queue_commit_buffer(data_queue_t *q, void *buffer, int size)
+{
+    if (q == NULL || buffer == NULL) {
+        return -1;
+    }
+    int ret = 0;
+    int *head = (int *) ((uint8_t *) buffer - DATA_Q_ALLOC_HEAD_SIZE);
+    _MUTEX_LOCK(q->lock);
+    int block_size = DATA_Q_BLOCK_SIZE(*head);
+    if (size < 0 || size + DATA_Q_ALLOC_HEAD_SIZE > block_size) {
+        size = 0;
+        ret = -1;
+    }
+    if (size == 0 || (*head & DATA_Q_BLOCK_SKIP)) {
+        *head = block_size | DATA_Q_BLOCK_SKIP;
+    } else {
+        int used = size + DATA_Q_ALLOC_HEAD_SIZE;
+        // Return unused tail when no data is written after the block
+        if (q->writing == 0 && (uint8_t *) head + block_size == (uint8_t *) q->buffer + q->wp) {
+            q->wp -= block_size - used;
+            q->filled -= block_size - used;
+            block_size = used;
+        }
+        *head = block_size;
+    }
+    q->user--;
+    data_queue_notify_data(q);
+    data_queue_release_user(q);
+    _MUTEX_UNLOCK(q->lock);
+    return ret;
+}
+
 bool data_queue_have_data(data_queue_t *q)
 {
     int has_data = false;
@@ -345,6 +422,17 @@ int data_queue_read_lock(data_queue_t *q, void **buffer, int *size)
         }
         uint8_t *data_buffer = (uint8_t *) q->buffer + cur_rp;
         int data_size = *((int *) data_buffer);
+        if (data_size & DATA_Q_BLOCK_PENDING) {
+            // Keep order, wait until reserved block committed
+            if (data_queue_wait_data(q) != 0) {
+                break;
+            }
+            continue;
+        }
+        if (data_size & DATA_Q_BLOCK_SKIP) {
+            data_queue_consume_front(q);
+            continue;
+        }
         if (data_size < 0 || data_size >q->size) {
             *(int*)0 = 0;
         }
@@ -406,7 +494,7 @@ int data_queue_query(data_queue_t *q, int *q_num, int *q_size)
             int rp = q->rp;
             int ring = q->fill_end;
             while (rp != q->wp || ring) {
-                int size = *(int *) (q->buffer + rp);
+                int size = DATA_Q_BLOCK_SIZE(*(int *) (q->buffer + rp));
                 if (size < 0 || size > q->size) {
                     *(int*)0 = 0;
                 }
@@ -0,0 +1,181 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2026 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "media_lib_os.h"
+#include "mem_arena.h"
+#include "esp_log.h"
+
+#define TAG "MEM_ARENA"
+
+// Keep buffer after region header aligned for any data type
+#define ARENA_ALIGN              (8)
+#define ARENA_HEAD_SIZE          ((sizeof(mem_arena_region_t) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+#define REGION_BUFFER(region)    ((uint8_t *)(region) + ARENA_HEAD_SIZE)
+
+#define _MUTEX_LOCK(mutex)   media_lib_mutex_lock((media_lib_mutex_handle_t) mutex, MEDIA_LIB_MAX_LOCK_TIME)
+#define _MUTEX_UNLOCK(mutex) media_lib_mutex_unlock((media_lib_mutex_handle_t) mutex)
+
+typedef struct mem_arena_region_t {
+    struct mem_arena_region_t *next;
+    int                        size;
+    bool                       used;
+} mem_arena_region_t;
+
+typedef struct mem_arena_t {
+    mem_arena_region_t       *regions;
+    media_lib_mutex_handle_t  lock;
+    uint32_t                  reuse_count;
+    uint32_t                  alloc_count;
+} mem_arena_t;
+
+static void arena_release_region(mem_arena_t *arena, mem_arena_region_t *region)
+{
+    mem_arena_region_t **pre = &arena->regions;
+    while (*pre) {
+        if (*pre == region) {
+            *pre = region->next;
+            media_lib_free(region);
+            return;
+        }
+        pre = &(*pre)->next;
+    }
+}
+
+mem_arena_handle_t mem_arena_create(void)
+{
+    mem_arena_t *arena = (mem_arena_t *)media_lib_calloc(1, sizeof(mem_arena_t));
+    if (arena == NULL) {
+        return NULL;
+    }
+    media_lib_mutex_create(&arena->lock);
+    if (arena->lock == NULL) {
+        media_lib_free(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+void *mem_arena_alloc(mem_arena_handle_t arena, int size)
+{
+    if (arena == NULL || size <= 0) {
+        return NULL;
+    }
+    _MUTEX_LOCK(arena->lock);
+    mem_arena_region_t *best = NULL;
+    mem_arena_region_t *smaller = NULL;
+    for (mem_arena_region_t *region = arena->regions; region; region = region->next) {
+        if (region->used) {
+            continue;
+        }
+        if (region->size >= size) {
+            if (best == NULL || region->size < best->size) {
+                best = region;
+            }
+        } else if (smaller == NULL || region->size > smaller->size) {
+            smaller = region;
+        }
+    }
+    if (best) {
+        best->used = true;
+        arena->reuse_count++;
+        _MUTEX_UNLOCK(arena->lock);
+        return REGION_BUFFER(best);
+    }
+    // Nothing fits, drop the largest smaller idle region so that changed size replaces it instead of adding up
+    if (smaller) {
+        arena_release_region(arena, smaller);
+    }
+    mem_arena_region_t *region = (mem_arena_region_t *)media_lib_malloc(ARENA_HEAD_SIZE + size);
+    if (region == NULL) {
+        _MUTEX_UNLOCK(arena->lock);
+        ESP_LOGE(TAG, "Fail to reserve region size %d", size);
+        return NULL;
+    }
+    region->size = size;
+    region->used = true;
+    region->next = arena->regions;
+    arena->regions = region;
+    arena->alloc_count++;
+    _MUTEX_UNLOCK(arena->lock);
+    return REGION_BUFFER(region);
+}
+
+void mem_arena_free(mem_arena_handle_t arena, void *buffer)
+{
+    if (arena == NULL || buffer == NULL) {
+        return;
+    }
+    _MUTEX_LOCK(arena->lock);
+    mem_arena_region_t *region = arena->regions;
+    while (region && REGION_BUFFER(region) != (uint8_t *)buffer) {
+        region = region->next;
+    }
+    if (region) {
+        region->used = false;
+    } else {
+        ESP_LOGE(TAG, "Buffer %p not from arena", buffer);
+    }
+    _MUTEX_UNLOCK(arena->lock);
+}
+
+int mem_arena_get_stats(mem_arena_handle_t arena, mem_arena_stats_t *stats)
+{
+    if (arena == NULL || stats == NULL) {
+        return -1;
+    }
+    memset(stats, 0, sizeof(mem_arena_stats_t));
+    _MUTEX_LOCK(arena->lock);
+    for (mem_arena_region_t *region = arena->regions; region; region = region->next) {
+        stats->region_num++;
+        stats->reserved_size += region->size;
+        if (region->used) {
+            stats->used_num++;
+            stats->used_size += region->size;
+        }
+    }
+    stats->reuse_count = arena->reuse_count;
+    stats->alloc_count = arena->alloc_count;
+    _MUTEX_UNLOCK(arena->lock);
+    return 0;
+}
+
+void mem_arena_destroy(mem_arena_handle_t arena)
+{
+    if (arena == NULL) {
+        return;
+    }
+    mem_arena_region_t *region = arena->regions;
+    while (region) {
+        mem_arena_region_t *next = region->next;
+        if (region->used) {
+            ESP_LOGW(TAG, "Region %p size %d still in use", REGION_BUFFER(region), region->size);
+        }
+        media_lib_free(region);
+        region = next;
+    }
+    media_lib_mutex_destroy(arena->lock);
+    media_lib_free(arena);
+}
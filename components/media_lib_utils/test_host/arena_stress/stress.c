@@ -0,0 +1,278 @@
+/*
+ * Repeated connect / disconnect stress on host
+ *
+ * Models one call per cycle on a first-fit coalescing heap (PSRAM like): peer session buffers, av_render FIFOs
+ * and video convert output are allocated on start and released on stop, while small long-lived allocations of
+ * other subsystems interleave with each setup
+ * Reports largest free block during call and after stop, to compare heap only, arena for render buffers, and
+ * arena together with reused peer session buffers
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "media_lib_os.h"
+#include "data_queue.h"
+#include "mem_arena.h"
+
+/* Peer side buffers (send pool, jitter buffers, data channel caches), kept by parked peer in reuse mode */
+static const size_t peer_sizes[] = { 400 * 1024, 100 * 1024, 400 * 1024, 64 * 1024, 10 * 1024 };
+#define PEER_BUF_NUM (sizeof(peer_sizes) / sizeof(peer_sizes[0]))
+
+/* av_render FIFOs: video raw, audio raw, audio render */
+static const int fifo_sizes[] = { 500 * 1024, 4096, 6 * 1024 };
+#define FIFO_NUM       (sizeof(fifo_sizes) / sizeof(fifo_sizes[0]))
+#define CONVERT_SIZE   (240 * 320 * 2)
+#define LONG_LIVED_NUM (24)
+#define WARMUP_CYCLES  (10)
+
+typedef enum {
+    STRESS_MODE_HEAP,
+    STRESS_MODE_ARENA,
+    STRESS_MODE_ARENA_REUSE,
+} stress_mode_t;
+
+typedef struct blk {
+    size_t      size;
+    int         free;
+    struct blk *next;
+    struct blk *prev;
+} blk_t;
+
+static blk_t *heap_head;
+
+static int heap_init(size_t size)
+{
+    heap_head = (blk_t *)aligned_alloc(16, size);
+    if (heap_head == NULL) {
+        return -1;
+    }
+    heap_head->size = size - sizeof(blk_t);
+    heap_head->free = 1;
+    heap_head->next = heap_head->prev = NULL;
+    return 0;
+}
+
+static void *heap_alloc(size_t n)
+{
+    n = (n + 15) & ~15;
+    for (blk_t *b = heap_head; b; b = b->next) {
+        if (b->free == 0 || b->size < n) {
+            continue;
+        }
+        if (b->size >= n + sizeof(blk_t) + 16) {
+            blk_t *s = (blk_t *)((uint8_t *)(b + 1) + n);
+            s->size = b->size - n - sizeof(blk_t);
+            s->free = 1;
+            s->next = b->next;
+            s->prev = b;
+            if (b->next) {
+                b->next->prev = s;
+            }
+            b->next = s;
+            b->size = n;
+        }
+        b->free = 0;
+        return b + 1;
+    }
+    return NULL;
+}
+
+static void heap_free(void *p)
+{
+    if (p == NULL) {
+        return;
+    }
+    blk_t *b = (blk_t *)p - 1;
+    b->free = 1;
+    if (b->next && b->next->free) {
+        b->size += b->next->size + sizeof(blk_t);
+        b->next = b->next->next;
+        if (b->next) {
+            b->next->prev = b;
+        }
+    }
+    if (b->prev && b->prev->free) {
+        b->prev->size += b->size + sizeof(blk_t);
+        b->prev->next = b->next;
+        if (b->next) {
+            b->next->prev = b->prev;
+        }
+    }
+}
+
+static size_t heap_largest_free(void)
+{
+    size_t largest = 0;
+    for (blk_t *b = heap_head; b; b = b->next) {
+        if (b->free && b->size > largest) {
+            largest = b->size;
+        }
+    }
+    return largest;
+}
+
+void *media_lib_malloc(size_t size)
+{
+    return heap_alloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    void *p = heap_alloc(num * size);
+    if (p) {
+        memset(p, 0, num * size);
+    }
+    return p;
+}
+
+void media_lib_free(void *ptr)
+{
+    heap_free(ptr);
+}
+
+/* Single threaded, locks only need to own some heap like on device */
+int media_lib_mutex_create(media_lib_mutex_handle_t *mutex)
+{
+    *mutex = heap_alloc(32);
+    return *mutex ? 0 : -1;
+}
+
+int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex)
+{
+    heap_free(mutex);
+    return 0;
+}
+
+int media_lib_mutex_lock(media_lib_mutex_handle_t mutex, uint32_t timeout)
+{
+    (void)mutex;
+    (void)timeout;
+    return 0;
+}
+
+int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex)
+{
+    (void)mutex;
+    return 0;
+}
+
+int media_lib_event_group_create(media_lib_event_grp_handle_t *group)
+{
+    *group = heap_alloc(32);
+    return *group ? 0 : -1;
+}
+
+int media_lib_event_group_destroy(media_lib_event_grp_handle_t group)
+{
+    heap_free(group);
+    return 0;
+}
+
+uint32_t media_lib_event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    (void)group;
+    (void)bits;
+    return 0;
+}
+
+uint32_t media_lib_event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    (void)group;
+    (void)bits;
+    return 0;
+}
+
+uint32_t media_lib_event_group_wait_bits(media_lib_event_grp_handle_t group, uint32_t bits, uint32_t timeout)
+{
+    (void)group;
+    (void)timeout;
+    return bits;
+}
+
+static void churn_long_lived(void **long_lived, int churn)
+{
+    int k = rand() % LONG_LIVED_NUM;
+    heap_free(long_lived[k]);
+    long_lived[k] = churn ? heap_alloc(200 + rand() % churn) : NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage: %s heap|arena|reuse [cycles] [churn_bytes] [heap_mb]\n", argv[0]);
+        return 1;
+    }
+    stress_mode_t mode = strcmp(argv[1], "heap") == 0 ? STRESS_MODE_HEAP :
+                         strcmp(argv[1], "arena") == 0 ? STRESS_MODE_ARENA : STRESS_MODE_ARENA_REUSE;
+    int cycles = argc > 2 ? atoi(argv[2]) : 2000;
+    int churn = argc > 3 ? atoi(argv[3]) : 6000;
+    int heap_mb = argc > 4 ? atoi(argv[4]) : 4;
+    if (heap_init((size_t)heap_mb * 1024 * 1024) != 0) {
+        return 1;
+    }
+    srand(7);
+    mem_arena_handle_t arena = mode != STRESS_MODE_HEAP ? mem_arena_create() : NULL;
+    void *peer[PEER_BUF_NUM] = { 0 };
+    void *long_lived[LONG_LIVED_NUM] = { 0 };
+    size_t call_min = SIZE_MAX, call_max = 0, stop_min = SIZE_MAX, stop_max = 0, stop_first = 0;
+    int fails = 0;
+    for (int c = 0; c < cycles; c++) {
+        // Start: signaling and agent allocations interleave with session buffers
+        for (int i = 0; i < (int)PEER_BUF_NUM; i++) {
+            churn_long_lived(long_lived, churn);
+            if (peer[i] == NULL) {
+                peer[i] = heap_alloc(peer_sizes[i]);
+            }
+            fails += peer[i] == NULL;
+        }
+        data_queue_t *fifo[FIFO_NUM];
+        for (int i = 0; i < (int)FIFO_NUM; i++) {
+            churn_long_lived(long_lived, churn);
+            fifo[i] = data_queue_init_from_arena(fifo_sizes[i], arena);
+            fails += fifo[i] == NULL;
+        }
+        void *convert = arena ? mem_arena_alloc(arena, CONVERT_SIZE) : heap_alloc(CONVERT_SIZE);
+        fails += convert == NULL;
+        size_t largest = heap_largest_free();
+        if (c >= WARMUP_CYCLES) {
+            call_min = largest < call_min ? largest : call_min;
+            call_max = largest > call_max ? largest : call_max;
+        }
+        // Stop
+        for (int i = 0; i < (int)FIFO_NUM; i++) {
+            if (fifo[i]) {
+                data_queue_deinit(fifo[i]);
+            }
+        }
+        if (arena) {
+            mem_arena_free(arena, convert);
+        } else {
+            heap_free(convert);
+        }
+        if (mode != STRESS_MODE_ARENA_REUSE) {
+            for (int i = 0; i < (int)PEER_BUF_NUM; i++) {
+                heap_free(peer[i]);
+                peer[i] = NULL;
+            }
+        }
+        largest = heap_largest_free();
+        if (c == 0) {
+            stop_first = largest;
+        }
+        if (c >= WARMUP_CYCLES) {
+            stop_min = largest < stop_min ? largest : stop_min;
+            stop_max = largest > stop_max ? largest : stop_max;
+        }
+    }
+    printf("%s: heap=%dMB churn=%d cycles=%d setup_fail=%d\n", argv[1], heap_mb, churn, cycles, fails);
+    printf("  largest free after stop: cycle0=%zu min=%zu max=%zu\n", stop_first, stop_min, stop_max);
+    printf("  largest free in call: min=%zu max=%zu\n", call_min, call_max);
+    if (arena) {
+        mem_arena_stats_t st;
+        mem_arena_get_stats(arena, &st);
+        printf("  arena regions=%u reserved=%u reuse=%u new=%u\n", st.region_num, (unsigned)st.reserved_size,
+               (unsigned)st.reuse_count, (unsigned)st.alloc_count);
+    }
+    return 0;
+}
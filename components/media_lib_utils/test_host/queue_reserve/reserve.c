@@ -0,0 +1,363 @@
+/*
+ * Reserve / commit stress of data_queue on host
+ *
+ * One thread reserves blocks and hands every other one to a second thread to commit, like a frame assembled
+ * across calls, while another writer keeps sending small blocks and a reader checks order and content
+ * `hold` mode emulates the old way of holding write lock from get to send so that writer latency can be compared
+ * Mutexes are error checking, unlock from thread which does not own the lock fails the run
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "media_lib_os.h"
+#include "data_queue.h"
+
+#define QUEUE_SIZE     (64 * 1024)
+#define RESERVE_MAX    (12 * 1024)
+#define HOLD_US        (2000)
+#define BLOCK_HEAD     (12)
+#define DROP_PERCENT   (10)
+
+typedef struct {
+    uint32_t type;
+    uint32_t seq;
+    uint32_t len;
+} block_head_t;
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint32_t        bits;
+} event_t;
+
+static volatile int fail_num;
+static bool         hold_mode;
+static int          block_num = 20000;
+static data_queue_t *q;
+
+void *media_lib_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *media_lib_calloc(size_t num, size_t size)
+{
+    return calloc(num, size);
+}
+
+void media_lib_free(void *ptr)
+{
+    free(ptr);
+}
+
+int media_lib_mutex_create(media_lib_mutex_handle_t *mutex)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+    pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(m, &attr);
+    *mutex = m;
+    return 0;
+}
+
+int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+    return 0;
+}
+
+int media_lib_mutex_lock(media_lib_mutex_handle_t mutex, uint32_t timeout)
+{
+    (void)timeout;
+    return pthread_mutex_lock(mutex);
+}
+
+int media_lib_mutex_unlock(media_lib_mutex_handle_t mutex)
+{
+    if (pthread_mutex_unlock(mutex) != 0) {
+        printf("Unlock from wrong thread\n");
+        fail_num++;
+    }
+    return 0;
+}
+
+int media_lib_event_group_create(media_lib_event_grp_handle_t *group)
+{
+    event_t *e = calloc(1, sizeof(event_t));
+    pthread_mutex_init(&e->m, NULL);
+    pthread_cond_init(&e->c, NULL);
+    *group = e;
+    return 0;
+}
+
+int media_lib_event_group_destroy(media_lib_event_grp_handle_t group)
+{
+    free(group);
+    return 0;
+}
+
+uint32_t media_lib_event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits |= bits;
+    pthread_cond_broadcast(&e->c);
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    e->bits &= ~bits;
+    pthread_mutex_unlock(&e->m);
+    return 0;
+}
+
+uint32_t media_lib_event_group_wait_bits(media_lib_event_grp_handle_t group, uint32_t bits, uint32_t timeout)
+{
+    (void)timeout;
+    event_t *e = group;
+    pthread_mutex_lock(&e->m);
+    while ((e->bits & bits) == 0) {
+        pthread_cond_wait(&e->c, &e->m);
+    }
+    uint32_t r = e->bits;
+    pthread_mutex_unlock(&e->m);
+    return r;
+}
+
+static int64_t now_us(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000LL + t.tv_nsec / 1000;
+}
+
+static void fill_block(uint8_t *b, uint32_t type, uint32_t seq, uint32_t len)
+{
+    block_head_t head = { type, seq, len };
+    memcpy(b, &head, sizeof(head));
+    for (uint32_t i = 0; i < len; i++) {
+        b[BLOCK_HEAD + i] = (uint8_t)(seq * 31 + i);
+    }
+}
+
+/* Hand over between reserving and committing thread */
+static pthread_mutex_t hand_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  hand_cond = PTHREAD_COND_INITIALIZER;
+static uint8_t        *hand_buf;
+static int             hand_size;
+static bool            hand_quit;
+
+static void commit_block(uint8_t *b, int size)
+{
+    usleep(HOLD_US);
+    if (hold_mode) {
+        data_queue_send_buffer(q, size);
+    } else {
+        data_queue_commit_buffer(q, b, size);
+    }
+}
+
+static void *commit_thread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&hand_lock);
+    while (1) {
+        while (hand_buf == NULL && hand_quit == false) {
+            pthread_cond_wait(&hand_cond, &hand_lock);
+        }
+        if (hand_buf == NULL) {
+            break;
+        }
+        commit_block(hand_buf, hand_size);
+        hand_buf = NULL;
+        pthread_cond_broadcast(&hand_cond);
+    }
+    pthread_mutex_unlock(&hand_lock);
+    return NULL;
+}
+
+static uint8_t *dropped;
+
+static void *reserve_thread(void *arg)
+{
+    (void)arg;
+    for (int seq = 0; seq < block_num; seq++) {
+        int reserve = BLOCK_HEAD + 256 + rand() % (RESERVE_MAX - 256);
+        uint8_t *b = hold_mode ? data_queue_get_buffer(q, reserve) : data_queue_reserve_buffer(q, reserve);
+        if (b == NULL) {
+            printf("Fail to reserve %d\n", reserve);
+            fail_num++;
+            break;
+        }
+        int len = rand() % (reserve - BLOCK_HEAD);
+        fill_block(b, 'R', seq, len);
+        int size = BLOCK_HEAD + len;
+        // Keep last one so that reader knows when to stop
+        if (hold_mode == false && seq != block_num - 1 && rand() % 100 < DROP_PERCENT) {
+            dropped[seq] = 1;
+            size = 0;
+        }
+        // In hold mode lock must be released by the thread which took it
+        if (hold_mode || (seq & 1) == 0) {
+            commit_block(b, size);
+            continue;
+        }
+        pthread_mutex_lock(&hand_lock);
+        hand_buf = b;
+        hand_size = size;
+        pthread_cond_broadcast(&hand_cond);
+        while (hand_buf) {
+            pthread_cond_wait(&hand_cond, &hand_lock);
+        }
+        pthread_mutex_unlock(&hand_lock);
+    }
+    pthread_mutex_lock(&hand_lock);
+    hand_quit = true;
+    pthread_cond_broadcast(&hand_cond);
+    pthread_mutex_unlock(&hand_lock);
+    return NULL;
+}
+
+static int64_t write_max_us;
+static int64_t write_total_us;
+static volatile bool write_going = true;
+static int write_num;
+
+static void *write_thread(void *arg)
+{
+    (void)arg;
+    uint32_t seq = 0;
+    while (write_going) {
+        int len = rand() % 200;
+        int64_t start = now_us();
+        uint8_t *b = data_queue_get_buffer(q, BLOCK_HEAD + len);
+        if (b == NULL) {
+            break;
+        }
+        fill_block(b, 'W', seq++, len);
+        data_queue_send_buffer(q, BLOCK_HEAD + len);
+        int64_t cost = now_us() - start;
+        write_total_us += cost;
+        if (cost > write_max_us) {
+            write_max_us = cost;
+        }
+        write_num++;
+        usleep(500);
+    }
+    return NULL;
+}
+
+static int  exact_num;
+static int  read_r_num;
+
+static void *read_thread(void *arg)
+{
+    (void)arg;
+    int next_r = 0;
+    uint32_t next_w = 0;
+    while (1) {
+        uint8_t *b = NULL;
+        int size = 0;
+        if (data_queue_read_lock(q, (void **)&b, &size) != 0) {
+            break;
+        }
+        block_head_t head;
+        memcpy(&head, b, sizeof(head));
+        bool bad = size < BLOCK_HEAD || (int)head.len > size - BLOCK_HEAD;
+        for (uint32_t i = 0; bad == false && i < head.len; i++) {
+            bad = b[BLOCK_HEAD + i] != (uint8_t)(head.seq * 31 + i);
+        }
+        if (head.type == 'R') {
+            while (next_r < block_num && dropped[next_r]) {
+                next_r++;
+            }
+            bad |= (int)head.seq != next_r;
+            next_r = head.seq + 1;
+            read_r_num++;
+            exact_num += (size == BLOCK_HEAD + (int)head.len);
+        } else if (head.type == 'W') {
+            bad |= head.seq != next_w;
+            next_w = head.seq + 1;
+        } else {
+            bad = true;
+        }
+        if (bad) {
+            printf("Bad block type %c seq %u len %u size %d\n", head.type, head.seq, head.len, size);
+            fail_num++;
+        }
+        data_queue_read_unlock(q);
+        if (head.type == 'R' && (int)head.seq == block_num - 1) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* Flush while reserved block is pending keeps later data and drops the pending block */
+static void check_consume_all(void)
+{
+    data_queue_t *fq = data_queue_init(4096);
+    uint8_t *r = data_queue_reserve_buffer(fq, 100);
+    uint8_t *w = data_queue_get_buffer(fq, 10);
+    fill_block(w, 'W', 0, 0);
+    data_queue_send_buffer(fq, BLOCK_HEAD);
+    data_queue_consume_all(fq);
+    data_queue_commit_buffer(fq, r, 50);
+    int num = 0, size = 0;
+    data_queue_query(fq, &num, &size);
+    uint8_t *b = NULL;
+    data_queue_read_lock(fq, (void **)&b, &size);
+    block_head_t head;
+    memcpy(&head, b, sizeof(head));
+    data_queue_read_unlock(fq);
+    if (head.type != 'W' || size != BLOCK_HEAD || data_queue_have_data(fq)) {
+        printf("Consume all with pending block failed\n");
+        fail_num++;
+    }
+    data_queue_deinit(fq);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || (strcmp(argv[1], "reserve") && strcmp(argv[1], "hold"))) {
+        printf("Usage: %s reserve|hold [blocks]\n", argv[0]);
+        return 1;
+    }
+    hold_mode = strcmp(argv[1], "hold") == 0;
+    if (argc > 2) {
+        block_num = atoi(argv[2]);
+    }
+    srand(1);
+    check_consume_all();
+    dropped = calloc(block_num, 1);
+    q = data_queue_init(QUEUE_SIZE);
+    pthread_t rt, ct, wt, rd;
+    pthread_create(&rd, NULL, read_thread, NULL);
+    pthread_create(&wt, NULL, write_thread, NULL);
+    pthread_create(&ct, NULL, commit_thread, NULL);
+    pthread_create(&rt, NULL, reserve_thread, NULL);
+    pthread_join(rt, NULL);
+    pthread_join(ct, NULL);
+    pthread_join(rd, NULL);
+    write_going = false;
+    // Let writer finish if it waits for space
+    data_queue_wakeup(q);
+    pthread_join(wt, NULL);
+    data_queue_deinit(q);
+    free(dropped);
+    printf("%s: reserved %d read %d exact size %d, writer %d blocks avg %.1f us max %.1f us, %s\n",
+           argv[1], block_num, read_r_num, exact_num, write_num,
+           write_num ? (double)write_total_us / write_num : 0, (double)write_max_us, fail_num ? "FAIL" : "PASS");
+    return fail_num ? 1 : 0;
+}